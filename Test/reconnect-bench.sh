@@ -0,0 +1,59 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Measure how long compute nodes take to check in again after a
+#   dispatchd restart.
+#
+#   Run as root on a test head node, with "auth none" or "auth hmac"
+#   in the config and the simulated nodes added with
+#
+#       lpjs-loadgen --nodes node-count --print-config >> config
+#
+#   Starts lpjs-loadgen with node-count simulated nodes and no clients,
+#   restarts dispatchd once they are all checked in, and reports when
+#   all nodes are back, how many were paced with retry-after replies
+#   (see checkin-rate in lpjs_dispatchd(8)), and the distribution of
+#   per-node reconnect times.
+#
+#   Example:
+#       ./reconnect-bench.sh 1000
+##########################################################################
+
+usage()
+{
+    printf "Usage: $0 node-count\n"
+    exit 1
+}
+
+if [ $# != 1 ]; then
+    usage
+fi
+nodes=$1
+
+loadgen=${LOADGEN:-../lpjs-loadgen}
+out=reconnect-bench.out
+
+$loadgen --nodes $nodes --submitters 0 --listers 0 --cancelers 0 \
+    --duration 120 > $out 2>&1 &
+loadgen_pid=$!
+
+count=0
+while ! grep -q 'nodes checked in\.' $out && [ $count -lt 60 ]; do
+    sleep 1
+    count=$(($count + 1))
+done
+grep 'nodes checked in\.' $out
+
+lpjs stop
+lpjs start
+
+# Wait for the last node to return
+count=0
+while ! grep -q 'checked in again' $out && [ $count -lt 120 ]; do
+    sleep 1
+    count=$(($count + 1))
+done
+grep 'checked in again' $out || printf "Not all nodes returned.\n"
+
+wait $loadgen_pid || true
+grep -E '^Request|^reconnect|retry-after replies to' $out
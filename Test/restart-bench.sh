@@ -0,0 +1,49 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Measure dispatchd restart time with a deep queue.
+#
+#   Run as root on the head node of a test cluster with at least one
+#   compute node up.  Submits test-script-3-job.lpjs until the queue
+#   holds at least the requested number of jobs, restarts dispatchd,
+#   and reports the queue restore time and time to first dispatch
+#   logged by lpjs_journal_load() and lpjs_journal_note_dispatch().
+#
+#   Example:
+#       ./restart-bench.sh 10000
+##########################################################################
+
+usage()
+{
+    printf "Usage: $0 job-count\n"
+    exit 1
+}
+
+if [ $# != 1 ]; then
+    usage
+fi
+jobs=$1
+
+prefix=${PREFIX:-/usr/local}
+log=$prefix/var/log/lpjs/dispatchd
+
+# Each submission of test-script-3-job.lpjs queues 10 jobs
+submitted=0
+while [ $submitted -lt $jobs ]; do
+    ../submit test-script-3-job.lpjs > /dev/null
+    submitted=$(($submitted + 10))
+done
+printf "Queued $submitted jobs.\n"
+
+lpjs stop
+lpjs start
+
+# Wait for the compute nodes to check in and receive a job
+count=0
+while ! grep -q 'First dispatch' $log && [ $count -lt 60 ]; do
+    sleep 1
+    count=$(($count + 1))
+done
+
+grep 'Restored .* jobs in' $log | tail -1
+grep 'First dispatch' $log | tail -1
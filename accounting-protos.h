@@ -0,0 +1,16 @@
+/* accounting.c */
+int lpjs_accounting_open(void);
+void lpjs_accounting_close(void);
+int lpjs_accounting_check_header(const accounting_header_t *header);
+bool lpjs_accounting_indexes_ok(void);
+int lpjs_accounting_recover_block(void);
+int lpjs_accounting_reindex(void);
+int lpjs_accounting_read_record(int fd, uint64_t n, accounting_record_t *rec);
+int lpjs_accounting_add(job_t *job, accounting_disposition_t disposition, int exit_status);
+int lpjs_accounting_index(const accounting_record_t *rec, uint64_t n);
+int lpjs_accounting_map(accounting_map_t *map);
+void lpjs_accounting_unmap(accounting_map_t *map);
+uint64_t lpjs_accounting_first_record(const accounting_map_t *map, int64_t since);
+bool lpjs_accounting_block_after(const accounting_map_t *map, uint64_t n, int64_t until);
+bool lpjs_accounting_match(const accounting_record_t *rec, const accounting_filter_t *filter);
+uint64_t lpjs_accounting_query(const accounting_map_t *map, const accounting_filter_t *filter, void (*report)(const accounting_record_t *rec, void *arg), void *arg);
@@ -0,0 +1,769 @@
+/***************************************************************************
+ *  Description:
+ *      Job accounting log.
+ *
+ *      dispatchd appends one fixed-size record for each job that
+ *      leaves the queue, whether it completed, was canceled, failed
+ *      to start, or was lost with its compute node.  Each record
+ *      is also added to the time index and to the posting list of its
+ *      user, so lpjs history can find the jobs of one user in a time
+ *      range without reading the rest of the log.  See accounting.h
+ *      for the file layout.
+ *
+ *      The files are not synced to disk after each record, since the
+ *      journal already protects the queue.  If dispatchd or the system
+ *      crashes between writing a record and its index entries,
+ *      lpjs_accounting_open() detects the mismatch and rebuilds the
+ *      indexes from the records.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>     // PATH_MAX
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <xtend/string.h>   // strlcpy() on Linux
+#include <xtend/math.h>     // XT_MIN(), XT_MAX()
+
+#include "lpjs.h"
+#include "accounting.h"
+#include "misc.h"
+
+/*
+ *  Only dispatchd writes the log, from the main event loop.  Running
+ *  state for the time index is recovered by lpjs_accounting_open().
+ */
+static int      Records_fd = -1;
+static uint64_t Record_count = 0;
+static int64_t  Max_end_time = INT64_MIN,       // Over all records
+		Block_max_end_before = INT64_MIN,   // Before current block
+		Block_min_end_within = INT64_MAX;   // In current block
+
+/***************************************************************************
+ *  Description:
+ *      Open the accounting log for appending, creating it if necessary.
+ *      Discards a partial record at the end, left by a crash, and
+ *      rebuilds the indexes if they don't match the records.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, LPJS_READ_FAILED, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_open(void)
+
+{
+    accounting_header_t header;
+    struct stat         st;
+    off_t               records_size;
+    int                 status;
+
+    if ( (Records_fd = open(LPJS_HISTORY_RECORDS, O_RDWR|O_CREAT|O_APPEND,
+			    0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot open %s: %s\n", __FUNCTION__,
+		 LPJS_HISTORY_RECORDS, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    fstat(Records_fd, &st);
+
+    if ( st.st_size == 0 )
+    {
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ACCOUNTING_MAGIC, ACCOUNTING_MAGIC_LEN);
+	header.version = ACCOUNTING_VERSION;
+	header.byte_order = ACCOUNTING_BYTE_ORDER;
+	header.record_size = sizeof(accounting_record_t);
+	if ( lpjs_write_all(Records_fd, &header, sizeof(header)) != 0 )
+	{
+	    lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		     LPJS_HISTORY_RECORDS, strerror(errno));
+	    lpjs_accounting_close();
+	    return LPJS_WRITE_FAILED;
+	}
+	st.st_size = sizeof(header);
+    }
+    else if ( (pread(Records_fd, &header, sizeof(header), 0) != sizeof(header)) ||
+	      (lpjs_accounting_check_header(&header) != LPJS_SUCCESS) )
+    {
+	// Leave it for the admin to move aside, rather than lose history
+	lpjs_log("%s(): Error: %s is not a version %d accounting log.  Accounting disabled.\n",
+		 __FUNCTION__, LPJS_HISTORY_RECORDS, ACCOUNTING_VERSION);
+	lpjs_accounting_close();
+	return LPJS_READ_FAILED;
+    }
+
+    Record_count = (st.st_size - sizeof(header)) / sizeof(accounting_record_t);
+    records_size = sizeof(header) + Record_count * sizeof(accounting_record_t);
+    if ( st.st_size != records_size )
+    {
+	lpjs_log("%s(): Discarding partial record at the end of %s.\n",
+		 __FUNCTION__, LPJS_HISTORY_RECORDS);
+	if ( ftruncate(Records_fd, records_size) != 0 )
+	{
+	    lpjs_log("%s(): Error: Cannot truncate %s: %s\n", __FUNCTION__,
+		     LPJS_HISTORY_RECORDS, strerror(errno));
+	    lpjs_accounting_close();
+	    return LPJS_WRITE_FAILED;
+	}
+    }
+
+    if ( ! lpjs_accounting_indexes_ok() )
+	status = lpjs_accounting_reindex();
+    else
+	status = lpjs_accounting_recover_block();
+    if ( status != LPJS_SUCCESS )
+	lpjs_accounting_close();
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stop writing the accounting log
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_accounting_close(void)
+
+{
+    if ( Records_fd != -1 )
+    {
+	close(Records_fd);
+	Records_fd = -1;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Verify that an accounting log was written by this version of
+ *      LPJS on this architecture
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_check_header(const accounting_header_t *header)
+
+{
+    if ( (memcmp(header->magic, ACCOUNTING_MAGIC, ACCOUNTING_MAGIC_LEN) != 0) ||
+	 (header->version != ACCOUNTING_VERSION) ||
+	 (header->byte_order != ACCOUNTING_BYTE_ORDER) ||
+	 (header->record_size != sizeof(accounting_record_t)) )
+	return LPJS_READ_FAILED;
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check that the time index has an entry for each complete block
+ *      and the user posting lists together have one entry per record.
+ *      Index entries are written after the record, so a crash can
+ *      only leave them short.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_accounting_indexes_ok(void)
+
+{
+    struct stat     st;
+    DIR             *dp;
+    struct dirent   *entry;
+    char            path[PATH_MAX + 1];
+    uint64_t        postings = 0;
+
+    if ( stat(LPJS_HISTORY_TIME_INDEX, &st) != 0 )
+	st.st_size = 0;
+    if ( st.st_size != Record_count / ACCOUNTING_BLOCK_RECORDS *
+		       sizeof(accounting_time_index_t) )
+	return false;
+
+    if ( (dp = opendir(LPJS_HISTORY_USER_DIR)) == NULL )
+	return false;
+    while ( (entry = readdir(dp)) != NULL )
+    {
+	if ( entry->d_name[0] == '.' )
+	    continue;
+	snprintf(path, PATH_MAX + 1, "%s/%s", LPJS_HISTORY_USER_DIR,
+		 entry->d_name);
+	if ( stat(path, &st) == 0 )
+	    postings += st.st_size / sizeof(uint64_t);
+    }
+    closedir(dp);
+
+    return postings == Record_count;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Recover time index state for the block being filled, from the
+ *      last index entry and the records after it
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_recover_block(void)
+
+{
+    accounting_time_index_t entry;
+    accounting_record_t     rec;
+    uint64_t                block, first, c;
+    int                     fd;
+
+    Max_end_time = INT64_MIN;
+    Block_max_end_before = INT64_MIN;
+    Block_min_end_within = INT64_MAX;
+
+    // Start of the last complete block, if any
+    block = Record_count / ACCOUNTING_BLOCK_RECORDS;
+    first = 0;
+    if ( block > 0 )
+    {
+	if ( ((fd = open(LPJS_HISTORY_TIME_INDEX, O_RDONLY)) == -1) ||
+	     (pread(fd, &entry, sizeof(entry), (block - 1) * sizeof(entry))
+	      != sizeof(entry)) )
+	{
+	    lpjs_log("%s(): Error: Cannot read %s: %s\n", __FUNCTION__,
+		     LPJS_HISTORY_TIME_INDEX, strerror(errno));
+	    if ( fd != -1 )
+		close(fd);
+	    return LPJS_READ_FAILED;
+	}
+	close(fd);
+	Max_end_time = entry.max_end_before;
+	first = (block - 1) * ACCOUNTING_BLOCK_RECORDS;
+    }
+
+    for (c = first; c < Record_count; ++c)
+    {
+	if ( lpjs_accounting_read_record(Records_fd, c, &rec) != LPJS_SUCCESS )
+	    return LPJS_READ_FAILED;
+	if ( c == block * ACCOUNTING_BLOCK_RECORDS )
+	    Block_max_end_before = Max_end_time;
+	if ( c >= block * ACCOUNTING_BLOCK_RECORDS )
+	    Block_min_end_within = XT_MIN(Block_min_end_within, rec.end_time);
+	Max_end_time = XT_MAX(Max_end_time, rec.end_time);
+    }
+    if ( Record_count == block * ACCOUNTING_BLOCK_RECORDS )
+	Block_max_end_before = Max_end_time;
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Rebuild the time index and user posting lists from the records
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, LPJS_READ_FAILED, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_reindex(void)
+
+{
+    accounting_record_t rec;
+    DIR                 *dp;
+    struct dirent       *entry;
+    char                path[PATH_MAX + 1];
+    uint64_t            c;
+    int                 fd, status = LPJS_SUCCESS;
+
+    lpjs_log("%s(): Rebuilding job history indexes for %ju records...\n",
+	     __FUNCTION__, (uintmax_t)Record_count);
+
+    if ( (dp = opendir(LPJS_HISTORY_USER_DIR)) != NULL )
+    {
+	while ( (entry = readdir(dp)) != NULL )
+	{
+	    if ( entry->d_name[0] == '.' )
+		continue;
+	    snprintf(path, PATH_MAX + 1, "%s/%s", LPJS_HISTORY_USER_DIR,
+		     entry->d_name);
+	    unlink(path);
+	}
+	closedir(dp);
+    }
+    else if ( mkdir(LPJS_HISTORY_USER_DIR, 0755) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 LPJS_HISTORY_USER_DIR, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( (fd = open(LPJS_HISTORY_TIME_INDEX, O_WRONLY|O_CREAT|O_TRUNC,
+		    0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 LPJS_HISTORY_TIME_INDEX, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    close(fd);
+
+    Max_end_time = INT64_MIN;
+    Block_max_end_before = INT64_MIN;
+    Block_min_end_within = INT64_MAX;
+    for (c = 0; (c < Record_count) && (status == LPJS_SUCCESS); ++c)
+    {
+	if ( (status = lpjs_accounting_read_record(Records_fd, c, &rec))
+	     == LPJS_SUCCESS )
+	    status = lpjs_accounting_index(&rec, c);
+    }
+
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read record number n from the accounting log
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_read_record(int fd, uint64_t n,
+				    accounting_record_t *rec)
+
+{
+    off_t   offset;
+
+    offset = sizeof(accounting_header_t) + n * sizeof(*rec);
+    if ( pread(fd, rec, sizeof(*rec), offset) != sizeof(*rec) )
+    {
+	lpjs_log("%s(): Error: Cannot read record %ju from %s.\n",
+		 __FUNCTION__, (uintmax_t)n, LPJS_HISTORY_RECORDS);
+	return LPJS_READ_FAILED;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append an accounting record for a job leaving the queue.
+ *      start_time is 0 for jobs that never started.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record measured usage
+ ***************************************************************************/
+
+int     lpjs_accounting_add(job_t *job, accounting_disposition_t disposition,
+			    int exit_status)
+
+{
+    accounting_record_t rec;
+
+    // Accounting is disabled if the log could not be opened
+    if ( Records_fd == -1 )
+	return LPJS_SUCCESS;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.job_id = job_get_job_id(job);
+    rec.array_index = job_get_array_index(job);
+    rec.submission_id = job_get_submission_id(job);
+    rec.submit_time = job_get_submit_time(job);
+    rec.start_time = job_get_start_time(job);
+    rec.end_time = time(NULL);
+    rec.pmem_per_proc = job_get_pmem_per_proc(job);
+    rec.job_count = job_get_job_count(job);
+    rec.procs_per_job = job_get_procs_per_job(job);
+    rec.min_procs_per_node = job_get_min_procs_per_node(job);
+    rec.used_cpu_sec = job_get_cpu_sec(job) + 0.5;
+    rec.used_max_rss_MiB = job_get_peak_rss_MiB(job);
+    rec.used_read_bytes = job_get_read_bytes(job);
+    rec.used_write_bytes = job_get_write_bytes(job);
+    rec.used_max_threads = job_get_peak_threads(job);
+    rec.exit_status = exit_status;
+    rec.disposition = disposition;
+    strlcpy(rec.user_name, job_get_user_name(job), ACCOUNTING_USER_MAX);
+    strlcpy(rec.primary_group_name, job_get_primary_group_name(job),
+	    ACCOUNTING_USER_MAX);
+    strlcpy(rec.compute_node, job_get_compute_node(job), ACCOUNTING_NODE_MAX);
+    strlcpy(rec.script_name, job_get_script_name(job), ACCOUNTING_SCRIPT_MAX);
+
+    if ( lpjs_write_all(Records_fd, &rec, sizeof(rec)) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		 LPJS_HISTORY_RECORDS, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    return lpjs_accounting_index(&rec, Record_count++);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add record number n to its user's posting list, and to the time
+ *      index when it completes a block
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_index(const accounting_record_t *rec, uint64_t n)
+
+{
+    accounting_time_index_t entry;
+    char                    path[PATH_MAX + 1];
+    int                     fd;
+
+    if ( n % ACCOUNTING_BLOCK_RECORDS == 0 )
+    {
+	Block_max_end_before = Max_end_time;
+	Block_min_end_within = INT64_MAX;
+    }
+    Block_min_end_within = XT_MIN(Block_min_end_within, rec->end_time);
+    Max_end_time = XT_MAX(Max_end_time, rec->end_time);
+
+    // Posting file names come from job specs, so keep them in the dir
+    if ( (strchr(rec->user_name, '/') != NULL) || (rec->user_name[0] == '.') ||
+	 (rec->user_name[0] == '\0') )
+	lpjs_log("%s(): Error: Invalid user name in job %ju.  Not indexed.\n",
+		 __FUNCTION__, (uintmax_t)rec->job_id);
+    else
+    {
+	snprintf(path, PATH_MAX + 1, "%s/%s", LPJS_HISTORY_USER_DIR,
+		 rec->user_name);
+	if ( ((fd = open(path, O_WRONLY|O_CREAT|O_APPEND, 0644)) == -1) ||
+	     (lpjs_write_all(fd, &n, sizeof(n)) != 0) )
+	{
+	    lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		     path, strerror(errno));
+	    if ( fd != -1 )
+		close(fd);
+	    return LPJS_WRITE_FAILED;
+	}
+	close(fd);
+    }
+
+    if ( (n + 1) % ACCOUNTING_BLOCK_RECORDS == 0 )
+    {
+	entry.max_end_before = Block_max_end_before;
+	entry.min_end_within = Block_min_end_within;
+	if ( ((fd = open(LPJS_HISTORY_TIME_INDEX, O_WRONLY|O_CREAT|O_APPEND,
+			 0644)) == -1) ||
+	     (lpjs_write_all(fd, &entry, sizeof(entry)) != 0) )
+	{
+	    lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		     LPJS_HISTORY_TIME_INDEX, strerror(errno));
+	    if ( fd != -1 )
+		close(fd);
+	    return LPJS_WRITE_FAILED;
+	}
+	close(fd);
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Map the accounting log and time index read-only for queries.
+ *      Records appended after this are not seen.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_accounting_map(accounting_map_t *map)
+
+{
+    struct stat st;
+    int         fd;
+
+    memset(map, 0, sizeof(*map));
+    if ( (fd = open(LPJS_HISTORY_RECORDS, O_RDONLY)) == -1 )
+	return LPJS_READ_FAILED;
+    fstat(fd, &st);
+    if ( (size_t)st.st_size < sizeof(accounting_header_t) )
+    {
+	close(fd);
+	return LPJS_READ_FAILED;
+    }
+    map->records_map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( map->records_map == MAP_FAILED )
+    {
+	map->records_map = NULL;
+	return LPJS_READ_FAILED;
+    }
+    map->records_map_size = st.st_size;
+    if ( lpjs_accounting_check_header(map->records_map) != LPJS_SUCCESS )
+    {
+	lpjs_accounting_unmap(map);
+	return LPJS_READ_FAILED;
+    }
+    map->records = (accounting_record_t *)
+		    ((accounting_header_t *)map->records_map + 1);
+    map->record_count = (st.st_size - sizeof(accounting_header_t)) /
+			sizeof(accounting_record_t);
+
+    // Without the time index, queries just scan all records
+    if ( ((fd = open(LPJS_HISTORY_TIME_INDEX, O_RDONLY)) != -1) &&
+	 (fstat(fd, &st) == 0) && (st.st_size > 0) )
+    {
+	map->index_map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if ( map->index_map == MAP_FAILED )
+	    map->index_map = NULL;
+	else
+	{
+	    map->index_map_size = st.st_size;
+	    map->time_index = map->index_map;
+	    map->block_count = XT_MIN(st.st_size / sizeof(accounting_time_index_t),
+				   map->record_count / ACCOUNTING_BLOCK_RECORDS);
+	}
+    }
+    if ( fd != -1 )
+	close(fd);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Release a map from lpjs_accounting_map()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_accounting_unmap(accounting_map_t *map)
+
+{
+    if ( map->records_map != NULL )
+	munmap(map->records_map, map->records_map_size);
+    if ( map->index_map != NULL )
+	munmap(map->index_map, map->index_map_size);
+    memset(map, 0, sizeof(*map));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find the first record that could have ended at or after since.
+ *      Every record before it ended earlier.
+ *
+ *  Returns:
+ *      Record number
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t    lpjs_accounting_first_record(const accounting_map_t *map,
+					 int64_t since)
+
+{
+    uint64_t    low, high, mid;
+
+    // Last block whose predecessors all ended before since
+    low = 0;
+    high = map->block_count;
+    while ( high - low > 1 )
+    {
+	mid = low + (high - low) / 2;
+	if ( map->time_index[mid].max_end_before < since )
+	    low = mid;
+	else
+	    high = mid;
+    }
+
+    return low * ACCOUNTING_BLOCK_RECORDS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether the indexed block containing record n ended
+ *      entirely after until
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_accounting_block_after(const accounting_map_t *map, uint64_t n,
+				    int64_t until)
+
+{
+    uint64_t    block = n / ACCOUNTING_BLOCK_RECORDS;
+
+    return (block < map->block_count) &&
+	   (map->time_index[block].min_end_within > until);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check a record against a query filter
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_accounting_match(const accounting_record_t *rec,
+			      const accounting_filter_t *filter)
+
+{
+    return (rec->end_time >= filter->since) &&
+	   (rec->end_time <= filter->until) &&
+	   ((filter->job_id == 0) || (rec->job_id == filter->job_id)) &&
+	   ((filter->user_name == NULL) ||
+	    (strcmp(rec->user_name, filter->user_name) == 0));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Call report() for each record matching filter, in the order
+ *      the jobs ended.  Uses the user's posting list if filter has a
+ *      user name, and skips blocks outside the time range.
+ *
+ *  Returns:
+ *      The number of matching records
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t    lpjs_accounting_query(const accounting_map_t *map,
+			const accounting_filter_t *filter,
+			void (*report)(const accounting_record_t *rec, void *arg),
+			void *arg)
+
+{
+    uint64_t    first, n, c, low, high, mid, count, matches = 0;
+    uint64_t    *postings;
+    char        path[PATH_MAX + 1];
+    struct stat st;
+    int         fd;
+
+    first = lpjs_accounting_first_record(map, filter->since);
+
+    if ( filter->user_name == NULL )
+    {
+	for (n = first; n < map->record_count; ++n)
+	{
+	    if ( lpjs_accounting_block_after(map, n, filter->until) )
+		n += ACCOUNTING_BLOCK_RECORDS - 1;
+	    else if ( lpjs_accounting_match(&map->records[n], filter) )
+	    {
+		report(&map->records[n], arg);
+		++matches;
+	    }
+	}
+	return matches;
+    }
+
+    if ( (strchr(filter->user_name, '/') != NULL) ||
+	 (filter->user_name[0] == '.') )
+	return 0;
+    snprintf(path, PATH_MAX + 1, "%s/%s", LPJS_HISTORY_USER_DIR,
+	     filter->user_name);
+    if ( (fd = open(path, O_RDONLY)) == -1 )
+	return 0;   // No jobs for this user
+    fstat(fd, &st);
+    count = st.st_size / sizeof(uint64_t);
+    if ( count == 0 )
+    {
+	close(fd);
+	return 0;
+    }
+    postings = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( postings == MAP_FAILED )
+	return 0;
+
+    // Postings are in record order: Find the first at or after first
+    low = 0;
+    high = count;
+    while ( low < high )
+    {
+	mid = low + (high - low) / 2;
+	if ( postings[mid] < first )
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+
+    for (c = low; c < count; ++c)
+    {
+	n = postings[c];
+	if ( n >= map->record_count )
+	    break;  // Appended after the map was made
+	if ( ! lpjs_accounting_block_after(map, n, filter->until) &&
+	     lpjs_accounting_match(&map->records[n], filter) )
+	{
+	    report(&map->records[n], arg);
+	    ++matches;
+	}
+    }
+    munmap(postings, st.st_size);
+
+    return matches;
+}
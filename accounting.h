@@ -0,0 +1,112 @@
+#ifndef _LPJS_ACCOUNTING_H_
+#define _LPJS_ACCOUNTING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifndef _LPJS_JOB_H_
+#include "job.h"
+#endif
+
+/*
+ *  Job accounting log, one fixed-size record per finished job, appended
+ *  by dispatchd and read directly with mmap() by lpjs history.  Files
+ *  in LPJS_JOB_HISTORY:
+ *
+ *      records     accounting_header_t, then accounting_record_t
+ *                  in the order jobs finished
+ *      time-index  accounting_time_index_t for each complete block of
+ *                  ACCOUNTING_BLOCK_RECORDS records
+ *      users/name  uint64_t record numbers of each user's jobs
+ *
+ *  Records are in order of end time unless the clock is set back, so
+ *  the time index holds the latest end time before each block and
+ *  the earliest within it.  A query for a time range can then skip
+ *  to the first block that could hold a match, and over any block
+ *  that ends too early.  Fields are in host byte order, since the
+ *  files are only read on the head node.
+ */
+
+#define ACCOUNTING_MAGIC            "LPJSACCT"
+#define ACCOUNTING_MAGIC_LEN        8
+#define ACCOUNTING_VERSION          2
+#define ACCOUNTING_BYTE_ORDER       0x01020304
+#define ACCOUNTING_BLOCK_RECORDS    64
+
+#define ACCOUNTING_USER_MAX         32
+#define ACCOUNTING_NODE_MAX         64
+#define ACCOUNTING_SCRIPT_MAX       128
+
+typedef enum
+{
+    ACCOUNTING_COMPLETED = 0,   // Chaperone reported exit status
+    ACCOUNTING_CANCELED,
+    ACCOUNTING_FAILED,          // Script could not be started
+    ACCOUNTING_LOST             // Chaperone vanished without a report
+}   accounting_disposition_t;
+
+typedef struct
+{
+    char        magic[ACCOUNTING_MAGIC_LEN];
+    uint32_t    version;
+    uint32_t    byte_order;
+    uint32_t    record_size;
+    uint32_t    reserved[3];
+}   accounting_header_t;
+
+typedef struct
+{
+    uint64_t    job_id;
+    uint64_t    array_index;
+    uint64_t    submission_id;
+    int64_t     submit_time;
+    int64_t     start_time;         // 0 if never started
+    int64_t     end_time;
+    uint64_t    pmem_per_proc;      // Requested MiB
+    uint64_t    used_cpu_sec;       // 0 if not reported, see job-usage.h
+    uint64_t    used_max_rss_MiB;   // 0 if not reported
+    uint64_t    used_read_bytes;    // 0 if not reported
+    uint64_t    used_write_bytes;   // 0 if not reported
+    uint32_t    job_count;
+    uint32_t    procs_per_job;      // Requested
+    uint32_t    min_procs_per_node;
+    int32_t     exit_status;
+    int32_t     disposition;
+    uint32_t    used_max_threads;   // 0 if not reported
+    char        user_name[ACCOUNTING_USER_MAX];
+    char        primary_group_name[ACCOUNTING_USER_MAX];
+    char        compute_node[ACCOUNTING_NODE_MAX];
+    char        script_name[ACCOUNTING_SCRIPT_MAX];
+}   accounting_record_t;
+
+typedef struct
+{
+    int64_t     max_end_before;     // Latest end time before the block
+    int64_t     min_end_within;     // Earliest end time in the block
+}   accounting_time_index_t;
+
+// Read-only view of the log for queries
+typedef struct
+{
+    void                    *records_map;
+    size_t                  records_map_size;
+    accounting_record_t     *records;
+    uint64_t                record_count;
+    void                    *index_map;
+    size_t                  index_map_size;
+    accounting_time_index_t *time_index;
+    uint64_t                block_count;
+}   accounting_map_t;
+
+typedef struct
+{
+    int64_t         since;
+    int64_t         until;
+    const char      *user_name;     // NULL for all users
+    unsigned long   job_id;         // 0 for all jobs
+}   accounting_filter_t;
+
+#include "accounting-protos.h"
+
+#endif  // _LPJS_ACCOUNTING_H_
@@ -0,0 +1,16 @@
+/* auth.c */
+auth_status_t lpjs_auth_encode(const char *msg, char **cred);
+auth_status_t lpjs_auth_decode(int msg_fd, const char *cred, char **payload, int *payload_len, uid_t *uid, gid_t *gid);
+const char *lpjs_auth_strerror(auth_status_t status);
+const char *lpjs_auth_backend_name(auth_backend_t backend);
+auth_status_t lpjs_auth_munge_encode(const char *msg, char **cred);
+auth_status_t lpjs_auth_munge_decode(const char *cred, char **payload, int *payload_len, uid_t *uid, gid_t *gid);
+auth_status_t lpjs_auth_load_key(void);
+void lpjs_auth_random(void *buff, size_t len);
+void lpjs_auth_hmac_hex(const char *header, size_t header_len, const char *payload, size_t payload_len, char mac_hex[64 + 1]);
+auth_status_t lpjs_auth_hmac_encode(const char *msg, char **cred);
+auth_status_t lpjs_auth_replay_add(uint64_t nonce, time_t expires, time_t now);
+auth_status_t lpjs_auth_hmac_decode(const char *cred, char **payload, int *payload_len, uid_t *uid, gid_t *gid);
+auth_status_t lpjs_auth_none_encode(const char *msg, char **cred);
+auth_status_t lpjs_auth_none_decode(int msg_fd, const char *cred, char **payload, int *payload_len, uid_t *uid, gid_t *gid);
+bool lpjs_auth_peer_is_loopback(int msg_fd);
@@ -0,0 +1,629 @@
+/***************************************************************************
+ *  Description:
+ *      Message authentication for lpjs_send_munge() and
+ *      lpjs_recv_munge().  The backend is chosen by the config tag
+ *      auth, so that all nodes and user commands agree:
+ *
+ *      munge   munged credentials, which identify the sending user.
+ *              The default and the only choice where users cannot
+ *              all be trusted.
+ *      hmac    HMAC-SHA256 with a key file shared by all nodes.
+ *              Much cheaper than a munged round trip, but any process
+ *              that can read the key can claim any uid, so it
+ *              authenticates hosts, not users.
+ *      none    Sender's uid and gid in plain text.  Only accepted
+ *              over loopback, for benchmarks and tests on one machine.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <munge.h>
+
+#include "lpjs.h"
+#include "config.h"
+#include "misc.h"
+#include "auth.h"
+#include "sha256.h"
+
+// 256-bit MAC in hex
+#define LPJS_AUTH_MAC_HEX_LEN   (LPJS_SHA256_DIGEST_LEN * 2)
+#define LPJS_AUTH_HEADER_MAX    256
+
+typedef struct
+{
+    uint64_t    nonce;
+    time_t      expires;
+}   auth_replay_t;
+
+static pthread_mutex_t      Auth_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned char        Auth_key[LPJS_AUTH_KEY_MAX];
+static size_t               Auth_key_len = 0;   // 0 until loaded
+static uint64_t             Auth_nonce_base;
+static atomic_uint_fast64_t Auth_nonce_count;
+static auth_replay_t        *Auth_replay = NULL;    // Allocated on first use
+
+/***************************************************************************
+ *  Description:
+ *      Wrap msg in a credential for the configured backend.  *cred
+ *      is allocated and must be freed by the caller.
+ *
+ *  Returns:
+ *      LPJS_AUTH_OK or another auth_status_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_encode(const char *msg, char **cred)
+
+{
+    extern lpjs_config_t    Config;
+
+    switch(Config.auth)
+    {
+	case    LPJS_AUTH_HMAC:
+	    return lpjs_auth_hmac_encode(msg, cred);
+	case    LPJS_AUTH_NONE:
+	    return lpjs_auth_none_encode(msg, cred);
+	default:
+	    return lpjs_auth_munge_encode(msg, cred);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Verify a credential received on msg_fd and extract the payload
+ *      and the sender's uid and gid.  *payload is allocated, NUL
+ *      terminated, and must be freed by the caller.  Nothing is
+ *      allocated if verification fails.
+ *
+ *  Returns:
+ *      LPJS_AUTH_OK or another auth_status_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_decode(int msg_fd, const char *cred, char **payload,
+				 int *payload_len, uid_t *uid, gid_t *gid)
+
+{
+    extern lpjs_config_t    Config;
+
+    switch(Config.auth)
+    {
+	case    LPJS_AUTH_HMAC:
+	    return lpjs_auth_hmac_decode(cred, payload, payload_len, uid, gid);
+	case    LPJS_AUTH_NONE:
+	    return lpjs_auth_none_decode(msg_fd, cred, payload, payload_len,
+					 uid, gid);
+	default:
+	    return lpjs_auth_munge_decode(cred, payload, payload_len, uid, gid);
+    }
+}
+
+
+const char  *lpjs_auth_strerror(auth_status_t status)
+
+{
+    switch(status)
+    {
+	case    LPJS_AUTH_OK:
+	    return "Success";
+	case    LPJS_AUTH_NO_MEMORY:
+	    return "Out of memory";
+	case    LPJS_AUTH_BAD_CRED:
+	    return "Invalid credential";
+	case    LPJS_AUTH_EXPIRED:
+	    return "Expired credential";
+	case    LPJS_AUTH_REPLAYED:
+	    return "Replayed credential";
+	case    LPJS_AUTH_BUSY:
+	    return "Too many recent credentials";
+	case    LPJS_AUTH_NOT_LOOPBACK:
+	    return "auth none is only accepted over loopback";
+	case    LPJS_AUTH_NO_KEY:
+	    return "No usable auth-key-file";
+	case    LPJS_AUTH_MUNGE_ERROR:
+	    return "munge error";
+	default:
+	    return "Unknown auth status";
+    }
+}
+
+
+const char  *lpjs_auth_backend_name(auth_backend_t backend)
+
+{
+    switch(backend)
+    {
+	case    LPJS_AUTH_HMAC:
+	    return "hmac";
+	case    LPJS_AUTH_NONE:
+	    return "none";
+	default:
+	    return "munge";
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      munge backend: Credentials from munged
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Moved from lpjs_send_munge()
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_munge_encode(const char *msg, char **cred)
+
+{
+    munge_err_t munge_status;
+
+    munge_status = munge_encode(cred, NULL, msg, strlen(msg));
+    if ( munge_status != EMUNGE_SUCCESS )
+    {
+	lpjs_log("%s(): Error: munge_encode() failed: %s.\n",
+		 __FUNCTION__, munge_strerror(munge_status));
+	return LPJS_AUTH_MUNGE_ERROR;
+    }
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      munge backend: Decode with munged
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Moved from lpjs_recv_munge()
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_munge_decode(const char *cred, char **payload,
+				       int *payload_len, uid_t *uid, gid_t *gid)
+
+{
+    munge_err_t munge_status;
+
+    munge_status = munge_decode(cred, NULL, (void **)payload, payload_len,
+				uid, gid);
+    if ( munge_status != EMUNGE_SUCCESS )
+    {
+	lpjs_log("%s(): Error: munge_decode() failed: %s.\n",
+		 __FUNCTION__, munge_strerror(munge_status));
+	return LPJS_AUTH_MUNGE_ERROR;
+    }
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Load Config.auth_key_file into Auth_key, if not already done.
+ *      The key is the file contents with trailing whitespace removed,
+ *      so that a key from "openssl rand -hex 32" works whether or not
+ *      it ends with a newline.  The file must not be accessible to
+ *      others, but may be group readable, so that users of a trusted
+ *      group can run commands.
+ *
+ *  Returns:
+ *      LPJS_AUTH_OK or LPJS_AUTH_NO_KEY
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_load_key(void)
+
+{
+    extern lpjs_config_t    Config;
+    struct stat     st;
+    int             fd;
+    ssize_t         bytes;
+    auth_status_t   status = LPJS_AUTH_NO_KEY;
+
+    pthread_mutex_lock(&Auth_mutex);
+    if ( Auth_key_len > 0 )
+    {
+	pthread_mutex_unlock(&Auth_mutex);
+	return LPJS_AUTH_OK;
+    }
+
+    if ( (fd = open(Config.auth_key_file, O_RDONLY)) == -1 )
+	lpjs_log("%s(): Error: Cannot open %s: %s\n", __FUNCTION__,
+		 Config.auth_key_file, strerror(errno));
+    else if ( (fstat(fd, &st) != 0) || (st.st_mode & S_IRWXO) )
+	lpjs_log("%s(): Error: %s must not be accessible to others.\n",
+		 __FUNCTION__, Config.auth_key_file);
+    else if ( (bytes = read(fd, Auth_key, LPJS_AUTH_KEY_MAX)) == -1 )
+	lpjs_log("%s(): Error: Cannot read %s: %s\n", __FUNCTION__,
+		 Config.auth_key_file, strerror(errno));
+    else
+    {
+	while ( (bytes > 0) && strchr(" \t\r\n", Auth_key[bytes - 1]) )
+	    --bytes;
+	if ( bytes < LPJS_AUTH_KEY_MIN )
+	    lpjs_log("%s(): Error: %s must contain at least %d bytes.\n",
+		     __FUNCTION__, Config.auth_key_file, LPJS_AUTH_KEY_MIN);
+	else
+	{
+	    // Unique per process, so nonces from different senders differ
+	    Auth_nonce_base = (uint64_t)getpid() << 40 ^
+			      (uint64_t)lpjs_time_us();
+	    lpjs_auth_random(&Auth_nonce_base, sizeof(Auth_nonce_base));
+	    atomic_init(&Auth_nonce_count, 0);
+	    Auth_key_len = bytes;
+	    status = LPJS_AUTH_OK;
+	}
+    }
+    if ( fd != -1 )
+	close(fd);
+    pthread_mutex_unlock(&Auth_mutex);
+
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      XOR len random bytes into buff.  buff is left unchanged if
+ *      /dev/urandom is unavailable.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_auth_random(void *buff, size_t len)
+
+{
+    unsigned char   random_bytes[64], *p = buff;
+    size_t          c;
+    int             fd;
+
+    if ( len > sizeof(random_bytes) )
+	len = sizeof(random_bytes);
+    if ( (fd = open("/dev/urandom", O_RDONLY)) == -1 )
+	return;
+    if ( read(fd, random_bytes, len) == (ssize_t)len )
+	for (c = 0; c < len; ++c)
+	    p[c] ^= random_bytes[c];
+    close(fd);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compute the HMAC of a credential header and payload in hex
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_auth_hmac_hex(const char *header, size_t header_len,
+			   const char *payload, size_t payload_len,
+			   char mac_hex[LPJS_AUTH_MAC_HEX_LEN + 1])
+
+{
+    lpjs_hmac_sha256_t  hmac;
+    unsigned char       mac[LPJS_SHA256_DIGEST_LEN];
+    int                 c;
+
+    lpjs_hmac_sha256_init(&hmac, Auth_key, Auth_key_len);
+    lpjs_hmac_sha256_update(&hmac, header, header_len);
+    lpjs_hmac_sha256_update(&hmac, payload, payload_len);
+    lpjs_hmac_sha256_final(&hmac, mac);
+    for (c = 0; c < LPJS_SHA256_DIGEST_LEN; ++c)
+	snprintf(mac_hex + c * 2, 3, "%02x", mac[c]);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      hmac backend: Credential is
+ *
+ *          hmac:uid:gid:time:nonce:mac:payload
+ *
+ *      where mac covers "uid:gid:time:nonce:" and the payload.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_hmac_encode(const char *msg, char **cred)
+
+{
+    char        header[LPJS_AUTH_HEADER_MAX + 1],
+		mac_hex[LPJS_AUTH_MAC_HEX_LEN + 1];
+    int         header_len;
+    size_t      msg_len = strlen(msg);
+    uint64_t    nonce;
+
+    if ( lpjs_auth_load_key() != LPJS_AUTH_OK )
+	return LPJS_AUTH_NO_KEY;
+
+    nonce = Auth_nonce_base + atomic_fetch_add(&Auth_nonce_count, 1);
+    header_len = snprintf(header, LPJS_AUTH_HEADER_MAX + 1,
+			  "%u:%u:%jd:%016" PRIx64 ":",
+			  (unsigned)geteuid(), (unsigned)getegid(),
+			  (intmax_t)time(NULL), nonce);
+    lpjs_auth_hmac_hex(header, header_len, msg, msg_len, mac_hex);
+
+    *cred = malloc(strlen(LPJS_AUTH_HMAC_PREFIX) + header_len +
+		   LPJS_AUTH_MAC_HEX_LEN + 1 + msg_len + 1);
+    if ( *cred == NULL )
+	return LPJS_AUTH_NO_MEMORY;
+    sprintf(*cred, "%s%s%s:%s", LPJS_AUTH_HMAC_PREFIX, header, mac_hex, msg);
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      hmac backend: Remember a nonce until its credential expires.
+ *      The replay table is a hash set with linear probing, limited to
+ *      LPJS_AUTH_REPLAY_PROBES slots from the hashed position.  Slots
+ *      whose credentials have expired are reused, but are still
+ *      probed past, and a nonce is never evicted before it expires,
+ *      so any replay within LPJS_AUTH_TTL is caught.  If no slot in
+ *      range is free, the credential is refused rather than risk
+ *      forgetting a nonce.
+ *
+ *  Returns:
+ *      LPJS_AUTH_OK, LPJS_AUTH_REPLAYED if the nonce is still
+ *      remembered, LPJS_AUTH_BUSY if there is no room for it, or
+ *      LPJS_AUTH_NO_MEMORY
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_replay_add(uint64_t nonce, time_t expires,
+				     time_t now)
+
+{
+    auth_replay_t   *slot, *free_slot = NULL;
+    size_t          start, c;
+
+    pthread_mutex_lock(&Auth_mutex);
+    if ( (Auth_replay == NULL) &&
+	 ((Auth_replay = calloc(LPJS_AUTH_REPLAY_SLOTS,
+				sizeof(*Auth_replay))) == NULL) )
+    {
+	pthread_mutex_unlock(&Auth_mutex);
+	return LPJS_AUTH_NO_MEMORY;
+    }
+
+    // Fibonacci hashing, so nonces from one counter are spread out
+    start = (nonce * UINT64_C(0x9e3779b97f4a7c15)) >>
+	    (64 - LPJS_AUTH_REPLAY_BITS);
+    for (c = 0; c < LPJS_AUTH_REPLAY_PROBES; ++c)
+    {
+	slot = &Auth_replay[(start + c) & (LPJS_AUTH_REPLAY_SLOTS - 1)];
+	if ( slot->expires < now )
+	{
+	    if ( free_slot == NULL )
+		free_slot = slot;
+	}
+	else if ( slot->nonce == nonce )
+	{
+	    pthread_mutex_unlock(&Auth_mutex);
+	    return LPJS_AUTH_REPLAYED;
+	}
+    }
+
+    if ( free_slot == NULL )
+    {
+	pthread_mutex_unlock(&Auth_mutex);
+	return LPJS_AUTH_BUSY;
+    }
+    free_slot->nonce = nonce;
+    free_slot->expires = expires;
+    pthread_mutex_unlock(&Auth_mutex);
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      hmac backend: Check the MAC, the time stamp, and that the
+ *      nonce has not been seen within LPJS_AUTH_TTL.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Never forget an unexpired nonce
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_hmac_decode(const char *cred, char **payload,
+				      int *payload_len, uid_t *uid, gid_t *gid)
+
+{
+    const char      *header, *mac_hex, *msg;
+    char            expected_mac[LPJS_AUTH_MAC_HEX_LEN + 1];
+    unsigned        cred_uid, cred_gid;
+    intmax_t        cred_time;
+    uint64_t        nonce;
+    int             header_len, c;
+    unsigned char   diff;
+    size_t          msg_len;
+    time_t          now;
+    auth_status_t   status;
+
+    if ( lpjs_auth_load_key() != LPJS_AUTH_OK )
+	return LPJS_AUTH_NO_KEY;
+
+    if ( strncmp(cred, LPJS_AUTH_HMAC_PREFIX,
+		 strlen(LPJS_AUTH_HMAC_PREFIX)) != 0 )
+	return LPJS_AUTH_BAD_CRED;
+    header = cred + strlen(LPJS_AUTH_HMAC_PREFIX);
+    if ( sscanf(header, "%u:%u:%jd:%" SCNx64 ":%n", &cred_uid, &cred_gid,
+		&cred_time, &nonce, &header_len) != 4 )
+	return LPJS_AUTH_BAD_CRED;
+    mac_hex = header + header_len;
+    if ( (strlen(mac_hex) < LPJS_AUTH_MAC_HEX_LEN + 1) ||
+	 (mac_hex[LPJS_AUTH_MAC_HEX_LEN] != ':') )
+	return LPJS_AUTH_BAD_CRED;
+    msg = mac_hex + LPJS_AUTH_MAC_HEX_LEN + 1;
+    msg_len = strlen(msg);
+
+    // Constant time comparison, so timing reveals nothing about the MAC
+    lpjs_auth_hmac_hex(header, header_len, msg, msg_len, expected_mac);
+    for (c = 0, diff = 0; c < LPJS_AUTH_MAC_HEX_LEN; ++c)
+	diff |= mac_hex[c] ^ expected_mac[c];
+    if ( diff != 0 )
+	return LPJS_AUTH_BAD_CRED;
+
+    now = time(NULL);
+    if ( (cred_time < now - LPJS_AUTH_TTL) || (cred_time > now + LPJS_AUTH_TTL) )
+	return LPJS_AUTH_EXPIRED;
+
+    status = lpjs_auth_replay_add(nonce, cred_time + LPJS_AUTH_TTL, now);
+    if ( status != LPJS_AUTH_OK )
+	return status;
+
+    if ( (*payload = malloc(msg_len + 1)) == NULL )
+	return LPJS_AUTH_NO_MEMORY;
+    memcpy(*payload, msg, msg_len + 1);
+    *payload_len = msg_len;
+    if ( uid != NULL )
+	*uid = cred_uid;
+    if ( gid != NULL )
+	*gid = cred_gid;
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      none backend: Credential is
+ *
+ *          none:uid:gid:payload
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_none_encode(const char *msg, char **cred)
+
+{
+    char    header[LPJS_AUTH_HEADER_MAX + 1];
+    int     header_len;
+    size_t  msg_len = strlen(msg);
+
+    header_len = snprintf(header, LPJS_AUTH_HEADER_MAX + 1, "%s%u:%u:",
+			  LPJS_AUTH_NONE_PREFIX, (unsigned)geteuid(),
+			  (unsigned)getegid());
+    if ( (*cred = malloc(header_len + msg_len + 1)) == NULL )
+	return LPJS_AUTH_NO_MEMORY;
+    memcpy(*cred, header, header_len);
+    memcpy(*cred + header_len, msg, msg_len + 1);
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      none backend: Accept the claimed uid and gid, but only from a
+ *      peer on the same machine
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+auth_status_t   lpjs_auth_none_decode(int msg_fd, const char *cred,
+				      char **payload, int *payload_len,
+				      uid_t *uid, gid_t *gid)
+
+{
+    unsigned    cred_uid, cred_gid;
+    int         header_len;
+    size_t      msg_len;
+
+    if ( ! lpjs_auth_peer_is_loopback(msg_fd) )
+	return LPJS_AUTH_NOT_LOOPBACK;
+
+    if ( (strncmp(cred, LPJS_AUTH_NONE_PREFIX,
+		  strlen(LPJS_AUTH_NONE_PREFIX)) != 0) ||
+	 (sscanf(cred + strlen(LPJS_AUTH_NONE_PREFIX), "%u:%u:%n",
+		 &cred_uid, &cred_gid, &header_len) != 2) )
+	return LPJS_AUTH_BAD_CRED;
+
+    cred += strlen(LPJS_AUTH_NONE_PREFIX) + header_len;
+    msg_len = strlen(cred);
+    if ( (*payload = malloc(msg_len + 1)) == NULL )
+	return LPJS_AUTH_NO_MEMORY;
+    memcpy(*payload, cred, msg_len + 1);
+    *payload_len = msg_len;
+    if ( uid != NULL )
+	*uid = cred_uid;
+    if ( gid != NULL )
+	*gid = cred_gid;
+    return LPJS_AUTH_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether the other end of msg_fd is on this machine
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_auth_peer_is_loopback(int msg_fd)
+
+{
+    struct sockaddr_storage peer;
+    socklen_t               peer_len = sizeof(peer);
+    struct sockaddr_in      *peer4 = (struct sockaddr_in *)&peer;
+    struct sockaddr_in6     *peer6 = (struct sockaddr_in6 *)&peer;
+
+    if ( getpeername(msg_fd, (struct sockaddr *)&peer, &peer_len) != 0 )
+	return false;
+    switch(peer.ss_family)
+    {
+	case    AF_UNIX:
+	    return true;
+	case    AF_INET:
+	    // 127.0.0.0/8
+	    return (ntohl(peer4->sin_addr.s_addr) >> 24) == 127;
+	case    AF_INET6:
+	    return IN6_IS_ADDR_LOOPBACK(&peer6->sin6_addr) ||
+		   (IN6_IS_ADDR_V4MAPPED(&peer6->sin6_addr) &&
+		    (peer6->sin6_addr.s6_addr[12] == 127));
+	default:
+	    return false;
+    }
+}
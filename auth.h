@@ -0,0 +1,47 @@
+#ifndef _LPJS_AUTH_H_
+#define _LPJS_AUTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>  // uid_t, gid_t
+
+/*
+ *  Message authentication backends, selected by the config tag auth.
+ *  All nodes and user commands must use the same backend.
+ */
+typedef enum
+{
+    LPJS_AUTH_MUNGE = 0,    // munged, authenticates users (default)
+    LPJS_AUTH_HMAC,         // Shared key file, authenticates hosts
+    LPJS_AUTH_NONE          // No authentication, loopback only, for testing
+}   auth_backend_t;
+
+typedef enum
+{
+    LPJS_AUTH_OK = 0,
+    LPJS_AUTH_NO_MEMORY,
+    LPJS_AUTH_BAD_CRED,     // Malformed or forged
+    LPJS_AUTH_EXPIRED,
+    LPJS_AUTH_REPLAYED,
+    LPJS_AUTH_BUSY,         // Replay table full, see auth.c
+    LPJS_AUTH_NOT_LOOPBACK,
+    LPJS_AUTH_NO_KEY,
+    LPJS_AUTH_MUNGE_ERROR   // Details are logged
+}   auth_status_t;
+
+#define LPJS_AUTH_KEY_FILE      PREFIX "/etc/lpjs/auth-key"
+#define LPJS_AUTH_KEY_MIN       32      // Bytes, after trimming whitespace
+#define LPJS_AUTH_KEY_MAX       1024
+// Same as munge's default credential lifetime, allowing for clock skew
+#define LPJS_AUTH_TTL           300     // Seconds
+// Recently seen hmac nonces, for 1000 credentials/s over 2 x TTL
+#define LPJS_AUTH_REPLAY_BITS   20
+#define LPJS_AUTH_REPLAY_SLOTS  (1 << LPJS_AUTH_REPLAY_BITS)
+#define LPJS_AUTH_REPLAY_PROBES 64
+
+#define LPJS_AUTH_HMAC_PREFIX   "hmac:"
+#define LPJS_AUTH_NONE_PREFIX   "none:"
+
+#include "auth-protos.h"
+
+#endif  // _LPJS_AUTH_H_
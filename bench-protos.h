@@ -0,0 +1,27 @@
+/* bench.c */
+void bench_measure(bench_t *bench, double min_time);
+void bench_resolve_allocator(void);
+void *bench_bootstrap_alloc(size_t size);
+bool bench_is_bootstrap(void *ptr);
+void *malloc(size_t size);
+void *calloc(size_t count, size_t size);
+void *realloc(void *ptr, size_t size);
+void free(void *ptr);
+void bench_script_setup(void);
+void bench_job_setup(void);
+void bench_job_print(uint64_t iterations);
+void bench_job_read(uint64_t iterations);
+void bench_parse_setup(void);
+void bench_parse_teardown(void);
+void bench_job_parse_script(uint64_t iterations);
+void bench_node_setup(void);
+void bench_node_specs_to_str(uint64_t iterations);
+void bench_node_str_to_specs(uint64_t iterations);
+void bench_socket_setup(void);
+void bench_send_recv(uint64_t iterations);
+void bench_socket_teardown(void);
+void bench_job_list_setup(void);
+void bench_job_list_find(uint64_t iterations);
+void bench_node_list_setup(void);
+void bench_node_list_find(uint64_t iterations);
+void usage(char *argv[]);
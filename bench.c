@@ -0,0 +1,649 @@
+/***************************************************************************
+ *  Description:
+ *      Microbenchmarks for code that runs on every message: job and
+ *      node serialization and parsing, script parsing, lpjs_send() and
+ *      lpjs_recv(), and job and node lookups at realistic list sizes.
+ *      Reports time and heap allocations per operation.
+ *
+ *      Each benchmark is run with increasing iteration counts until it
+ *      takes at least --time seconds, like Go's testing.B.  Allocations
+ *      are counted by interposing malloc(), so they include those made
+ *      inside libc, e.g. by strdup() and getcwd().
+ *
+ *      Parsers that fill a new job or node are measured together with
+ *      job_new()/job_free() or node_new(), since dispatchd always pairs
+ *      them and the strings must be released.
+ *
+ *      Scripts are parsed from a typical generated script, unless
+ *      --script is given.
+ *
+ *      Run with "make bench" or ./lpjs-bench [--time sec]
+ *      [--script file] [name-substring ...]
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // RTLD_NEXT
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include "node-list.h"
+#include "job-list.h"
+#include "network.h"
+#include "misc.h"
+#include "lpjs.h"
+#include "bench.h"
+
+static void         *(*Real_malloc)(size_t);
+static void         *(*Real_calloc)(size_t, size_t);
+static void         *(*Real_realloc)(void *, size_t);
+static void         (*Real_free)(void *);
+static bool         Resolving = false;
+static char         Bootstrap[BENCH_BOOTSTRAP_SIZE];
+static size_t       Bootstrap_used = 0;
+static uint64_t     Allocs = 0;
+
+static const char   *Script_path = NULL;
+static char         Script_temp[] = BENCH_SCRIPT_TEMPLATE;
+static job_t        *Job;
+static char         Job_string[JOB_STR_MAX_LEN + 1];
+static node_t       *Node;
+static char         Node_string[NODE_SPECS_LEN + 1];
+static char         Message[LPJS_MSG_LEN_MAX + 1];
+static int          Socket_fds[2];
+static int          Stderr_fd;
+static job_list_t   *Job_list;
+static node_list_t  *Node_list_bench;
+// Results are stored here so the compiler cannot discard the work
+static volatile uintptr_t   Sink;
+
+static bench_t      Benchmarks[] =
+{
+    { "job_print_to_string", bench_job_setup, bench_job_print, NULL },
+    { "job_read_from_string", bench_job_setup, bench_job_read, NULL },
+    { "job_parse_script", bench_parse_setup, bench_job_parse_script,
+      bench_parse_teardown },
+    { "node_specs_to_str", bench_node_setup, bench_node_specs_to_str, NULL },
+    { "node_str_to_specs", bench_node_setup, bench_node_str_to_specs, NULL },
+    { "lpjs_send+lpjs_recv", bench_socket_setup, bench_send_recv,
+      bench_socket_teardown },
+    { "job_list_find_job_id/100k", bench_job_list_setup,
+      bench_job_list_find, NULL },
+    { "node_list_find_hostname/1k", bench_node_list_setup,
+      bench_node_list_find, NULL }
+};
+
+int     main(int argc, char *argv[])
+
+{
+    extern FILE *Log_stream;
+    double      min_time = BENCH_MIN_TIME;
+    int         arg, first_name, c, n;
+    bool        selected;
+
+    Log_stream = stderr;
+
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); ++arg)
+    {
+	if ( (strcmp(argv[arg], "--time") == 0) && (arg + 1 < argc) )
+	{
+	    min_time = strtod(argv[++arg], NULL);
+	    if ( min_time <= 0 )
+		usage(argv);
+	}
+	else if ( (strcmp(argv[arg], "--script") == 0) && (arg + 1 < argc) )
+	    Script_path = argv[++arg];
+	else
+	    usage(argv);
+    }
+    first_name = arg;
+
+    printf("%-28s %12s %12s %10s\n",
+	   "Benchmark", "Iterations", "ns/op", "allocs/op");
+    for (c = 0; c < sizeof(Benchmarks) / sizeof(*Benchmarks); ++c)
+    {
+	// Names on the command line select benchmarks by substring
+	selected = (first_name == argc);
+	for (n = first_name; n < argc; ++n)
+	    if ( strstr(Benchmarks[c].name, argv[n]) != NULL )
+		selected = true;
+	if ( ! selected )
+	    continue;
+
+	if ( Benchmarks[c].setup != NULL )
+	    Benchmarks[c].setup();
+	bench_measure(&Benchmarks[c], min_time);
+	if ( Benchmarks[c].teardown != NULL )
+	    Benchmarks[c].teardown();
+    }
+    if ( Script_path == Script_temp )
+	unlink(Script_temp);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Run a benchmark with more iterations until it takes min_time,
+ *      and print the time and allocations per iteration of the last run
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_measure(bench_t *bench, double min_time)
+
+{
+    struct timespec start, end;
+    uint64_t        iterations = 1, allocs, next;
+    double          elapsed;
+
+    while ( true )
+    {
+	allocs = Allocs;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	bench->run(iterations);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	allocs = Allocs - allocs;
+	elapsed = (end.tv_sec - start.tv_sec) +
+		  (end.tv_nsec - start.tv_nsec) / 1e9;
+	if ( (elapsed >= min_time) || (iterations >= BENCH_MAX_ITERATIONS) )
+	    break;
+
+	// Aim 20% past min_time, growing at least 2x and at most 100x
+	next = elapsed > 0 ? iterations * min_time * 1.2 / elapsed
+			   : iterations * 100;
+	if ( next < iterations * 2 )
+	    next = iterations * 2;
+	else if ( next > iterations * 100 )
+	    next = iterations * 100;
+	iterations = next < BENCH_MAX_ITERATIONS ? next : BENCH_MAX_ITERATIONS;
+    }
+    printf("%-28s %12" PRIu64 " %12.1f %10.2f\n", bench->name, iterations,
+	   elapsed * 1e9 / iterations, (double)allocs / iterations);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find the next malloc() family implementation for the counting
+ *      wrappers below.  dlsym() may itself allocate, which is served
+ *      from a static bootstrap buffer.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_resolve_allocator(void)
+
+{
+    Resolving = true;
+    Real_malloc = dlsym(RTLD_NEXT, "malloc");
+    Real_calloc = dlsym(RTLD_NEXT, "calloc");
+    Real_realloc = dlsym(RTLD_NEXT, "realloc");
+    Real_free = dlsym(RTLD_NEXT, "free");
+    Resolving = false;
+    if ( (Real_malloc == NULL) || (Real_calloc == NULL) ||
+	 (Real_realloc == NULL) || (Real_free == NULL) )
+    {
+	fputs("lpjs-bench: Cannot find malloc() in libc.\n", stderr);
+	_exit(EX_SOFTWARE);
+    }
+}
+
+
+void    *bench_bootstrap_alloc(size_t size)
+
+{
+    void    *p;
+
+    // Keep 16-byte alignment, as malloc() would
+    size = (size + 15) & ~(size_t)15;
+    if ( Bootstrap_used + size > BENCH_BOOTSTRAP_SIZE )
+	return NULL;
+    p = Bootstrap + Bootstrap_used;
+    Bootstrap_used += size;
+    return p;
+}
+
+
+bool    bench_is_bootstrap(void *ptr)
+
+{
+    return ((char *)ptr >= Bootstrap) &&
+	   ((char *)ptr < Bootstrap + BENCH_BOOTSTRAP_SIZE);
+}
+
+
+void    *malloc(size_t size)
+
+{
+    if ( Real_malloc == NULL )
+    {
+	if ( Resolving )
+	    return bench_bootstrap_alloc(size);
+	bench_resolve_allocator();
+    }
+    ++Allocs;
+    return Real_malloc(size);
+}
+
+
+void    *calloc(size_t count, size_t size)
+
+{
+    if ( Real_calloc == NULL )
+    {
+	// Bootstrap is static, so already zeroed
+	if ( Resolving )
+	    return bench_bootstrap_alloc(count * size);
+	bench_resolve_allocator();
+    }
+    ++Allocs;
+    return Real_calloc(count, size);
+}
+
+
+void    *realloc(void *ptr, size_t size)
+
+{
+    void    *new_ptr;
+
+    if ( Real_realloc == NULL )
+	bench_resolve_allocator();
+    if ( bench_is_bootstrap(ptr) )
+    {
+	if ( (new_ptr = malloc(size)) != NULL )
+	    memcpy(new_ptr, ptr, size);
+	return new_ptr;
+    }
+    ++Allocs;
+    return Real_realloc(ptr, size);
+}
+
+
+void    free(void *ptr)
+
+{
+    if ( (ptr == NULL) || bench_is_bootstrap(ptr) )
+	return;
+    if ( Real_free == NULL )
+	bench_resolve_allocator();
+    Real_free(ptr);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write a script with every #lpjs directive, and a body about the
+ *      size of the scripts in Test/, unless one was given with --script
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_script_setup(void)
+
+{
+    FILE    *fp;
+    int     fd, c;
+
+    if ( Script_path != NULL )
+	return;
+    if ( (fd = mkstemp(Script_temp)) == -1 )
+    {
+	perror("lpjs-bench: mkstemp()");
+	exit(EX_CANTCREAT);
+    }
+    fp = fdopen(fd, "w");
+    fputs("#!/bin/sh -e\n\n"
+	  "#lpjs jobs 10\n"
+	  "#lpjs procs-per-job 2\n"
+	  "#lpjs min-procs-per-node procs-per-job\n"
+	  "#lpjs pmem-per-proc 1GiB\n"
+	  "#lpjs log-dir Logs\n"
+	  "#lpjs push-command rsync -av %w/ %h:%s\n\n", fp);
+    for (c = 0; c < 40; ++c)
+	fprintf(fp, "printf 'Step %d on %%s\\n' $(hostname)\n", c);
+    fclose(fp);
+    Script_path = Script_temp;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      A job as submitted from the test script, with fields that a
+ *      running job would have filled in
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_job_setup(void)
+
+{
+    if ( Job != NULL )
+	return;
+    bench_script_setup();
+    // Terminates process if malloc() fails, no check required
+    Job = job_new();
+    if ( job_parse_script(Job, Script_path) != 0 )
+    {
+	fprintf(stderr, "lpjs-bench: Cannot parse %s.\n", Script_path);
+	exit(EX_NOINPUT);
+    }
+    job_set_job_id(Job, 123456);
+    job_set_array_index(Job, 7);
+    job_set_chaperone_pid(Job, 45678);
+    job_set_job_pid(Job, 45679);
+    job_set_compute_node(Job, lpjs_strdup("compute-0042.example.org"));
+    job_print_to_string(Job, Job_string, JOB_STR_MAX_LEN + 1);
+}
+
+
+void    bench_job_print(uint64_t iterations)
+
+{
+    uint64_t    c;
+
+    for (c = 0; c < iterations; ++c)
+	Sink += job_print_to_string(Job, Job_string, JOB_STR_MAX_LEN + 1);
+}
+
+
+void    bench_job_read(uint64_t iterations)
+
+{
+    uint64_t    c;
+    job_t       *job;
+    char        *end;
+
+    for (c = 0; c < iterations; ++c)
+    {
+	job = job_new();
+	Sink += job_read_from_string(job, Job_string, &end);
+	job_free(&job);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      job_parse_script() reports the job parameters on stderr, as
+ *      lpjs submit should.  Keep the cost, but not the output.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_parse_setup(void)
+
+{
+    int     null_fd;
+
+    bench_script_setup();
+    fflush(stderr);
+    Stderr_fd = dup(STDERR_FILENO);
+    if ( (null_fd = open("/dev/null", O_WRONLY)) != -1 )
+    {
+	dup2(null_fd, STDERR_FILENO);
+	close(null_fd);
+    }
+}
+
+
+void    bench_parse_teardown(void)
+
+{
+    fflush(stderr);
+    dup2(Stderr_fd, STDERR_FILENO);
+    close(Stderr_fd);
+}
+
+
+void    bench_job_parse_script(uint64_t iterations)
+
+{
+    uint64_t    c;
+    job_t       *job;
+
+    for (c = 0; c < iterations; ++c)
+    {
+	job = job_new();
+	Sink += job_parse_script(job, Script_path);
+	// job_init() sets a static "TBD", which job_free() would free
+	job_set_compute_node(job, lpjs_strdup("TBD"));
+	job_free(&job);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      A node as sent by compd at checkin
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_node_setup(void)
+
+{
+    if ( Node != NULL )
+	return;
+    Node = node_new();
+    node_set_hostname(Node, lpjs_strdup("compute-0042.example.org"));
+    node_set_state(Node, "up");
+    node_set_procs(Node, 64);
+    node_set_phys_MiB(Node, 262144);
+    node_set_zfs(Node, 1);
+    node_set_os(Node, "FreeBSD");
+    node_set_arch(Node, "amd64");
+    node_specs_to_str(Node, Node_string, NODE_SPECS_LEN + 1);
+}
+
+
+void    bench_node_specs_to_str(uint64_t iterations)
+
+{
+    uint64_t    c;
+
+    for (c = 0; c < iterations; ++c)
+	Sink += (uintptr_t)node_specs_to_str(Node, Node_string,
+					     NODE_SPECS_LEN + 1);
+}
+
+
+void    bench_node_str_to_specs(uint64_t iterations)
+
+{
+    uint64_t    c;
+    node_t      *node;
+
+    // There is no node_free(), so free the strings strdup()ed by parsing
+    for (c = 0; c < iterations; ++c)
+    {
+	node = node_new();
+	Sink += node_str_to_specs(node, Node_string);
+	free(node_get_hostname(node));
+	free(node_get_state(node));
+	free(node_get_os(node));
+	free(node_get_arch(node));
+	free(node);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      A job submission message, sent and received over a socketpair,
+ *      so the kernel path is included but not the network
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_socket_setup(void)
+
+{
+    FILE    *fp;
+    size_t  len;
+
+    bench_job_setup();
+    if ( socketpair(AF_UNIX, SOCK_STREAM, 0, Socket_fds) != 0 )
+    {
+	perror("lpjs-bench: socketpair()");
+	exit(EX_OSERR);
+    }
+    len = snprintf(Message, LPJS_MSG_LEN_MAX + 1, "%c%s\n",
+		   LPJS_DISPATCHD_REQUEST_SUBMIT, Job_string);
+    if ( (fp = fopen(Script_path, "r")) != NULL )
+    {
+	fread(Message + len, 1, LPJS_MSG_LEN_MAX - len, fp);
+	fclose(fp);
+    }
+}
+
+
+void    bench_send_recv(uint64_t iterations)
+
+{
+    uint64_t    c;
+    char        buff[LPJS_MSG_LEN_MAX + 1];
+
+    for (c = 0; c < iterations; ++c)
+    {
+	lpjs_send(Socket_fds[0], 0, "%s", Message);
+	Sink += lpjs_recv(Socket_fds[1], buff, LPJS_MSG_LEN_MAX + 1, 0, 0);
+    }
+}
+
+
+void    bench_socket_teardown(void)
+
+{
+    close(Socket_fds[0]);
+    close(Socket_fds[1]);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      A full job queue, searched for pseudo-random job IDs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_job_list_setup(void)
+
+{
+    job_t   *job;
+    int     c;
+
+    bench_job_setup();
+    Job_list = job_list_new();
+    for (c = 1; c <= BENCH_JOBS; ++c)
+    {
+	job = job_dup(Job);
+	job_set_job_id(job, c);
+	job_list_add_job(Job_list, job);
+    }
+}
+
+
+void    bench_job_list_find(uint64_t iterations)
+
+{
+    uint64_t    c;
+    uint32_t    random = 1;
+
+    for (c = 0; c < iterations; ++c)
+    {
+	// Numerical Recipes LCG, fast and good enough to spread lookups
+	random = random * 1664525 + 1013904223;
+	Sink += job_list_find_job_id(Job_list, random % BENCH_JOBS + 1);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      A cluster of BENCH_NODES nodes, searched for pseudo-random
+ *      hostnames
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    bench_node_list_setup(void)
+
+{
+    node_t  *node;
+    char    hostname[LPJS_HOSTNAME_MAX + 1];
+    int     c;
+
+    Node_list_bench = node_list_new();
+    for (c = 0; c < BENCH_NODES; ++c)
+    {
+	node = node_new();
+	snprintf(hostname, LPJS_HOSTNAME_MAX + 1,
+		 "compute-%04d.example.org", c);
+	node_set_hostname(node, lpjs_strdup(hostname));
+	node_list_add_compute_node(Node_list_bench, node);
+    }
+}
+
+
+void    bench_node_list_find(uint64_t iterations)
+
+{
+    uint64_t    c;
+    uint32_t    random = 1;
+    char        hostnames[BENCH_NODES][LPJS_HOSTNAME_MAX + 1];
+    int         n;
+
+    // Outside the timed loop in spirit: snprintf() would dominate
+    for (n = 0; n < BENCH_NODES; ++n)
+	snprintf(hostnames[n], LPJS_HOSTNAME_MAX + 1,
+		 "compute-%04d.example.org", n);
+    for (c = 0; c < iterations; ++c)
+    {
+	random = random * 1664525 + 1013904223;
+	Sink += (uintptr_t)node_list_find_hostname(Node_list_bench,
+				hostnames[random % BENCH_NODES]);
+    }
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--time seconds] [--script file] [name ...]\n",
+	    argv[0]);
+    exit(EX_USAGE);
+}
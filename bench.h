@@ -0,0 +1,25 @@
+#ifndef _LPJS_BENCH_H_
+#define _LPJS_BENCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define BENCH_MIN_TIME          0.5     // Seconds per benchmark, default
+#define BENCH_MAX_ITERATIONS    1000000000
+#define BENCH_JOBS              100000  // Realistic queue, JOB_LIST_MAX_JOBS
+#define BENCH_NODES             1000    // Must be <= LPJS_MAX_NODES
+#define BENCH_SCRIPT_TEMPLATE   "/tmp/lpjs-bench.XXXXXX"
+#define BENCH_BOOTSTRAP_SIZE    4096    // malloc() before dlsym() is done
+
+typedef struct
+{
+    const char  *name;
+    void        (*setup)(void);
+    void        (*run)(uint64_t iterations);
+    void        (*teardown)(void);
+}   bench_t;
+
+#include "bench-protos.h"
+
+#endif  // _LPJS_BENCH_H_
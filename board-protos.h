@@ -0,0 +1,8 @@
+/* board.c */
+int lpjs_board_publish(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+void lpjs_board_pack_job(board_job_t *rec, board_job_t *prev_rec, job_t *job);
+int lpjs_board_create(size_t size);
+void lpjs_board_remove(void);
+int lpjs_board_load(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+int lpjs_board_copy(board_header_t *board, size_t board_size, board_header_t *header, char **body);
+int lpjs_board_validate(board_header_t *header, const char *body);
@@ -0,0 +1,534 @@
+/***************************************************************************
+ *  Description:
+ *      Status board: A read-only view of the job queues and node states
+ *      in a shared memory-mapped file.
+ *
+ *      Monitoring scripts on the head node often run lpjs jobs and
+ *      lpjs nodes every few seconds.  Rather than have dispatchd
+ *      authenticate, format, and send its whole state for each of
+ *      them, dispatchd publishes its state to LPJS_STATUS_BOARD after
+ *      each pass of the event loop, and local commands read it
+ *      directly.  Commands on other hosts, or on the head node when
+ *      dispatchd is not running, still send a request.
+ *
+ *      Records are those of the queue snapshot, so publishing involves
+ *      no formatting.  Readers format them with the same functions
+ *      dispatchd uses for replies, so the output is identical.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>      // open()
+#include <signal.h>     // kill()
+#include <sched.h>      // sched_yield()
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "lpjs.h"
+#include "node-list.h"
+#include "job-list.h"
+#include "snapshot.h"
+#include "board.h"
+#include "metrics.h"
+#include "misc.h"
+#include "telemetry.h"
+
+// Only the dispatchd main thread publishes, so no locking
+static board_header_t       *Board = NULL;
+static size_t               Board_size = 0;
+static bool                 Board_failed = false;
+static char                 *Board_recs = NULL;
+static size_t               Board_recs_size = 0;
+static snapshot_strings_t   Board_strings = { NULL, 0, 0 };
+
+/***************************************************************************
+ *  Description:
+ *      Publish the job lists and node states to the status board.
+ *      After an error, publishing stops and the board is removed, so
+ *      commands go back to sending requests rather than showing stale
+ *      state.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add telemetry
+ ***************************************************************************/
+
+int     lpjs_board_publish(job_list_t *pending_jobs, job_list_t *running_jobs,
+			   node_list_t *node_list)
+
+{
+    size_t          running_count = job_list_get_count(running_jobs),
+		    pending_count = job_list_get_count(pending_jobs),
+		    node_count = node_list_get_compute_node_count(node_list),
+		    recs_size, c;
+    board_job_t     *job_recs;
+    board_node_t    *node_recs;
+    node_t          *node;
+    telemetry_t     *telemetry;
+    uint64_t        seq;
+    bool            new_board = false;
+    struct timespec start;
+
+    if ( Board_failed )
+	return LPJS_WRITE_FAILED;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    recs_size = (running_count + pending_count) * sizeof(board_job_t) +
+		node_count * sizeof(board_node_t);
+    if ( recs_size > Board_recs_size )
+    {
+	if ( (Board_recs = realloc(Board_recs, recs_size)) == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+	Board_recs_size = recs_size;
+    }
+    job_recs = (board_job_t *)Board_recs;
+    node_recs = (board_node_t *)(job_recs + running_count + pending_count);
+
+    // Reuse the string table, offset 0 is always valid
+    Board_strings.len = 0;
+    lpjs_snapshot_add_string(&Board_strings, "");
+    for (c = 0; c < running_count; ++c)
+	lpjs_board_pack_job(&job_recs[c], c == 0 ? NULL : &job_recs[c - 1],
+			    job_list_get_jobs_ae(running_jobs, c));
+    for (c = 0; c < pending_count; ++c)
+	lpjs_board_pack_job(&job_recs[running_count + c],
+			    c == 0 ? NULL : &job_recs[running_count + c - 1],
+			    job_list_get_jobs_ae(pending_jobs, c));
+    for (c = 0; c < node_count; ++c)
+    {
+	node = node_list_get_compute_nodes_ae(node_list, c);
+	memset(&node_recs[c], 0, sizeof(node_recs[c]));
+	node_recs[c].phys_MiB = node_get_phys_MiB(node);
+	node_recs[c].phys_MiB_used = node_get_phys_MiB_used(node);
+	node_recs[c].procs = node_get_procs(node);
+	node_recs[c].procs_used = node_get_procs_used(node);
+	node_recs[c].hostname =
+	    lpjs_snapshot_add_string(&Board_strings, node_get_hostname(node));
+	node_recs[c].state =
+	    lpjs_snapshot_add_string(&Board_strings, node_get_state(node));
+	node_recs[c].os =
+	    lpjs_snapshot_add_string(&Board_strings, node_get_os(node));
+	node_recs[c].arch =
+	    lpjs_snapshot_add_string(&Board_strings, node_get_arch(node));
+	if ( (telemetry = node_get_telemetry(node)) != NULL )
+	{
+	    node_recs[c].telemetry_time = telemetry->time;
+	    memcpy(node_recs[c].load_avg, telemetry->load_avg,
+		   sizeof(node_recs[c].load_avg));
+	    node_recs[c].mem_free_MiB = telemetry->mem_free_MiB;
+	    node_recs[c].mem_avail_MiB = telemetry->mem_avail_MiB;
+	    node_recs[c].swap_used_MiB = telemetry->swap_used_MiB;
+	    node_recs[c].jobs_rss_MiB = telemetry->jobs_rss_MiB;
+	}
+    }
+
+    if ( sizeof(board_header_t) + recs_size + Board_strings.len > Board_size )
+    {
+	if ( lpjs_board_create(sizeof(board_header_t) + recs_size +
+			       Board_strings.len) != LPJS_SUCCESS )
+	{
+	    lpjs_board_remove();
+	    Board_failed = true;
+	    return LPJS_WRITE_FAILED;
+	}
+	new_board = true;
+    }
+
+    // Readers retry while seq is odd
+    seq = atomic_load_explicit(&Board->seq, memory_order_relaxed);
+    atomic_store_explicit(&Board->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    Board->published = time(NULL);
+    Board->running_count = running_count;
+    Board->pending_count = pending_count;
+    Board->node_count = node_count;
+    Board->strings_size = Board_strings.len;
+    memcpy(Board + 1, Board_recs, recs_size);
+    memcpy((char *)(Board + 1) + recs_size, Board_strings.buff,
+	   Board_strings.len);
+    atomic_store_explicit(&Board->seq, seq + 2, memory_order_release);
+
+    // Readers see a new file only once it is filled in
+    if ( new_board && (rename(LPJS_STATUS_BOARD ".new",
+			      LPJS_STATUS_BOARD) != 0) )
+    {
+	lpjs_log("%s(): Error: Cannot rename %s.new: %s\n", __FUNCTION__,
+		 LPJS_STATUS_BOARD, strerror(errno));
+	lpjs_board_remove();
+	Board_failed = true;
+	return LPJS_WRITE_FAILED;
+    }
+
+    lpjs_metrics_observe(LPJS_METRIC_BOARD_PUBLISH, &start);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fill in a status board record for job
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add measured usage
+ ***************************************************************************/
+
+void    lpjs_board_pack_job(board_job_t *rec, board_job_t *prev_rec,
+			    job_t *job)
+
+{
+    lpjs_snapshot_pack_job(&rec->job, prev_rec == NULL ? NULL : &prev_rec->job,
+			   job, &Board_strings);
+    rec->pending_reason = job_get_pending_reason(job);
+    rec->reserved = 0;
+    rec->peak_rss_MiB = job_get_peak_rss_MiB(job);
+    rec->cpu_sec = job_get_cpu_sec(job);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create and map a new status board with room for at least size
+ *      bytes, as LPJS_STATUS_BOARD.new.  lpjs_board_publish() renames
+ *      it once it is filled in.  The whole file is written here, so
+ *      a full file system is reported now rather than by SIGBUS on a
+ *      later page fault.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_board_create(size_t size)
+
+{
+    char            *temp_path = LPJS_STATUS_BOARD ".new",
+		    *buff;
+    board_header_t  *header;
+    size_t          new_size;
+    void            *map;
+    int             fd;
+
+    // Room to grow, so the file is rarely replaced
+    for (new_size = LPJS_BOARD_MIN_SIZE; new_size < size * 2; new_size *= 2)
+	;
+    if ( (buff = calloc(new_size, 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: calloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    header = (board_header_t *)buff;
+    memcpy(header->magic, LPJS_BOARD_MAGIC, LPJS_BOARD_MAGIC_LEN);
+    header->version = LPJS_BOARD_VERSION;
+    header->byte_order = LPJS_BOARD_BYTE_ORDER;
+    header->pid = getpid();
+
+    // Readers may be other users
+    if ( (fd = open(temp_path, O_RDWR|O_CREAT|O_TRUNC, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	free(buff);
+	return LPJS_WRITE_FAILED;
+    }
+    if ( lpjs_write_all(fd, buff, new_size) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	free(buff);
+	close(fd);
+	unlink(temp_path);
+	return LPJS_WRITE_FAILED;
+    }
+    free(buff);
+    map = mmap(NULL, new_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( map == MAP_FAILED )
+    {
+	lpjs_log("%s(): Error: Cannot mmap %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	unlink(temp_path);
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( Board != NULL )
+	munmap(Board, Board_size);
+    Board = map;
+    Board_size = new_size;
+    lpjs_log("%s(): Status board size %zu.\n", __FUNCTION__, new_size);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the status board when dispatchd exits, so commands send
+ *      requests instead
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_board_remove(void)
+
+{
+    if ( Board != NULL )
+	unlink(LPJS_STATUS_BOARD);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Load the job lists and node states from the status board, for
+ *      lpjs jobs and lpjs nodes.  Fails quietly if there is no board,
+ *      e.g. not on the head node, or it was left by a dispatchd that is
+ *      no longer running, in which case the caller should send a
+ *      request.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add telemetry
+ *  2026-10-19  Jason Bacon Add measured job usage
+ ***************************************************************************/
+
+int     lpjs_board_load(node_list_t *node_list, job_list_t *pending_jobs,
+			job_list_t *running_jobs)
+
+{
+    int             fd, status;
+    struct stat     st;
+    void            *map;
+    board_header_t  *board, header;
+    board_job_t     *job_recs;
+    board_node_t    *node_recs;
+    const char      *strings;
+    char            *body;
+    job_t           *job;
+    node_t          *node;
+    telemetry_t     *telemetry;
+    size_t          c;
+
+    if ( (fd = open(LPJS_STATUS_BOARD, O_RDONLY)) == -1 )
+	return LPJS_READ_FAILED;
+    if ( (fstat(fd, &st) != 0) ||
+	 ((size_t)st.st_size < sizeof(board_header_t)) )
+    {
+	close(fd);
+	return LPJS_READ_FAILED;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( map == MAP_FAILED )
+	return LPJS_READ_FAILED;
+
+    // kill() fails with EPERM for another user's running process
+    board = map;
+    if ( (memcmp(board->magic, LPJS_BOARD_MAGIC, LPJS_BOARD_MAGIC_LEN) != 0) ||
+	 (board->version != LPJS_BOARD_VERSION) ||
+	 (board->byte_order != LPJS_BOARD_BYTE_ORDER) ||
+	 ((kill(board->pid, 0) != 0) && (errno != EPERM)) )
+	status = LPJS_READ_FAILED;
+    else
+	status = lpjs_board_copy(board, st.st_size, &header, &body);
+    munmap(map, st.st_size);
+    if ( status != LPJS_SUCCESS )
+	return status;
+
+    if ( lpjs_board_validate(&header, body) != LPJS_SUCCESS )
+    {
+	free(body);
+	return LPJS_READ_FAILED;
+    }
+
+    job_recs = (board_job_t *)body;
+    node_recs = (board_node_t *)(job_recs + header.running_count +
+				 header.pending_count);
+    strings = (const char *)(node_recs + header.node_count);
+    for (c = 0; c < header.running_count + header.pending_count; ++c)
+    {
+	job = lpjs_snapshot_unpack_job(&job_recs[c].job, strings);
+	job_set_pending_reason(job, job_recs[c].pending_reason);
+	job_set_peak_rss_MiB(job, job_recs[c].peak_rss_MiB);
+	job_set_cpu_sec(job, job_recs[c].cpu_sec);
+	job_list_add_job(c < header.running_count ? running_jobs : pending_jobs,
+			 job);
+    }
+    for (c = 0; c < header.node_count; ++c)
+    {
+	// node_new() terminates the process if malloc fails
+	node = node_new();
+	node_set_hostname(node, lpjs_strdup(strings + node_recs[c].hostname));
+	node_set_state(node, lpjs_strdup(strings + node_recs[c].state));
+	node_set_os(node, lpjs_strdup(strings + node_recs[c].os));
+	node_set_arch(node, lpjs_strdup(strings + node_recs[c].arch));
+	node_set_procs(node, node_recs[c].procs);
+	node_set_procs_used(node, node_recs[c].procs_used);
+	node_set_phys_MiB(node, node_recs[c].phys_MiB);
+	node_set_phys_MiB_used(node, node_recs[c].phys_MiB_used);
+	if ( node_recs[c].telemetry_time != 0 )
+	{
+	    // Terminates process if malloc() fails, no check required
+	    telemetry = telemetry_new();
+	    telemetry->time = node_recs[c].telemetry_time;
+	    memcpy(telemetry->load_avg, node_recs[c].load_avg,
+		   sizeof(telemetry->load_avg));
+	    telemetry->mem_free_MiB = node_recs[c].mem_free_MiB;
+	    telemetry->mem_avail_MiB = node_recs[c].mem_avail_MiB;
+	    telemetry->swap_used_MiB = node_recs[c].swap_used_MiB;
+	    telemetry->jobs_rss_MiB = node_recs[c].jobs_rss_MiB;
+	    node_set_telemetry(node, telemetry);
+	}
+	node_list_add_compute_node(node_list, node);
+    }
+    free(body);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Copy the counts and body of a mapped status board of board_size
+ *      bytes, retrying until the copy is not torn by a concurrent
+ *      update.  Counts read during an update may be garbage, so they
+ *      are checked against the map before use.  *body is allocated.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if no consistent copy could
+ *      be made
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_board_copy(board_header_t *board, size_t board_size,
+			board_header_t *header, char **body)
+
+{
+    uint64_t    seq;
+    size_t      body_size, body_max = board_size - sizeof(*board);
+    bool        fits;
+    int         tries;
+
+    *body = NULL;
+    for (tries = 0; tries < LPJS_BOARD_READ_TRIES; ++tries)
+    {
+	if ( (seq = atomic_load_explicit(&board->seq, memory_order_acquire))
+	     & 1 )
+	{
+	    sched_yield();
+	    continue;
+	}
+	header->published = board->published;
+	header->running_count = board->running_count;
+	header->pending_count = board->pending_count;
+	header->node_count = board->node_count;
+	header->strings_size = board->strings_size;
+
+	// Guard against overflow before computing the size
+	fits = (header->running_count + header->pending_count <=
+		JOB_LIST_MAX_JOBS) &&
+	       (header->node_count <= LPJS_MAX_NODES) &&
+	       (header->strings_size <= body_max);
+	if ( fits )
+	{
+	    body_size = (header->running_count + header->pending_count) *
+			sizeof(board_job_t) +
+			header->node_count * sizeof(board_node_t) +
+			header->strings_size;
+	    fits = body_size <= body_max;
+	}
+	if ( fits )
+	{
+	    if ( (*body = realloc(*body, body_size)) == NULL )
+	    {
+		lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+		exit(EX_UNAVAILABLE);
+	    }
+	    memcpy(*body, board + 1, body_size);
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+	if ( atomic_load_explicit(&board->seq, memory_order_relaxed) == seq )
+	{
+	    if ( fits )
+		return LPJS_SUCCESS;
+	    break;  // Not torn, just bad
+	}
+    }
+
+    free(*body);
+    *body = NULL;
+    return LPJS_READ_FAILED;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check that the strings in a status board copy are terminated,
+ *      and all string offsets are within the table
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_board_validate(board_header_t *header, const char *body)
+
+{
+    const board_job_t   *job_recs = (const board_job_t *)body;
+    const board_node_t  *node_recs;
+    const char          *strings;
+    uint64_t            job_count = header->running_count +
+				    header->pending_count,
+			size = header->strings_size,
+			c;
+    int                 s;
+
+    node_recs = (const board_node_t *)(job_recs + job_count);
+    strings = (const char *)(node_recs + header->node_count);
+    if ( (size == 0) || (strings[size - 1] != '\0') )
+	return LPJS_READ_FAILED;
+    for (c = 0; c < job_count; ++c)
+	for (s = 0; s < SNAPSHOT_JOB_STRINGS; ++s)
+	    if ( job_recs[c].job.strings[s] >= size )
+		return LPJS_READ_FAILED;
+    for (c = 0; c < header->node_count; ++c)
+	if ( (node_recs[c].hostname >= size) || (node_recs[c].state >= size) ||
+	     (node_recs[c].os >= size) || (node_recs[c].arch >= size) )
+	    return LPJS_READ_FAILED;
+
+    return LPJS_SUCCESS;
+}
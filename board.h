@@ -0,0 +1,83 @@
+#ifndef _LPJS_BOARD_H_
+#define _LPJS_BOARD_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef _LPJS_SNAPSHOT_H_
+#include "snapshot.h"
+#endif
+
+/*
+ *  Status board: The job queues and node states, published by dispatchd
+ *  in a memory-mapped file after every pass of the event loop, so that
+ *  lpjs jobs and lpjs nodes on the head node can read them without a
+ *  request.  Layout:
+ *
+ *      board_header_t
+ *      board_job_t     [running_count]
+ *      board_job_t     [pending_count]
+ *      board_node_t    [node_count]
+ *      char            strings[strings_size]   As in the snapshot
+ *
+ *  dispatchd is the only writer.  seq is odd while the counts and body
+ *  are being updated, and readers retry until they copy everything
+ *  between two reads of the same even seq.  The file is replaced by
+ *  rename() when it must grow, so a reader's mapping is never
+ *  truncated under it.
+ */
+
+#define LPJS_STATUS_BOARD           LPJS_RUN_DIR "/status-board"
+#define LPJS_BOARD_MAGIC            "LPJSBORD"
+#define LPJS_BOARD_MAGIC_LEN        8
+#define LPJS_BOARD_VERSION          3
+#define LPJS_BOARD_BYTE_ORDER       0x01020304
+#define LPJS_BOARD_MIN_SIZE         65536
+#define LPJS_BOARD_READ_TRIES       1000
+
+typedef struct
+{
+    char            magic[LPJS_BOARD_MAGIC_LEN];
+    uint32_t        version;
+    uint32_t        byte_order;
+    int64_t         pid;            // dispatchd, to detect a stale board
+    _Atomic uint64_t seq;
+
+    // Written under seq
+    int64_t         published;      // Wall clock
+    uint64_t        running_count;
+    uint64_t        pending_count;
+    uint64_t        node_count;
+    uint64_t        strings_size;
+}   board_header_t;
+
+typedef struct
+{
+    snapshot_job_t  job;
+    int32_t         pending_reason;
+    uint32_t        reserved;
+    uint64_t        peak_rss_MiB;   // From telemetry, for lpjs jobs --usage
+    double          cpu_sec;
+}   board_job_t;
+
+typedef struct
+{
+    uint64_t        phys_MiB;
+    uint64_t        phys_MiB_used;
+    uint32_t        procs;
+    uint32_t        procs_used;
+    uint32_t        hostname;       // Offsets into the string table
+    uint32_t        state;
+    uint32_t        os;
+    uint32_t        arch;
+    int64_t         telemetry_time; // 0 if no report, see telemetry.h
+    double          load_avg[3];
+    uint64_t        mem_free_MiB;
+    uint64_t        mem_avail_MiB;
+    uint64_t        swap_used_MiB;
+    uint64_t        jobs_rss_MiB;
+}   board_node_t;
+
+#include "board-protos.h"
+
+#endif  // _LPJS_BOARD_H_
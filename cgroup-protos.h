@@ -0,0 +1,14 @@
+/* cgroup.c */
+int lpjs_cgroup_mount(char *mount_point, size_t maxlen);
+int lpjs_cgroup_write(const char *dir, const char *file, const char *value);
+int lpjs_cgroup_init(void);
+char *lpjs_cgroup_job_dir(unsigned long job_id, char *dir, size_t maxlen);
+int lpjs_cgroup_create(unsigned long job_id, unsigned procs, size_t pmem_per_proc);
+int lpjs_cgroup_enter(unsigned long job_id);
+int lpjs_cgroup_usage(const char *dir, cgroup_usage_t *usage);
+char *cgroup_usage_to_str(cgroup_usage_t *usage, char *str, size_t maxlen);
+int lpjs_cgroup_self_usage(cgroup_usage_t *usage);
+unsigned lpjs_cgroup_signal(unsigned long job_id, int sig);
+int lpjs_cgroup_kill(unsigned long job_id);
+unsigned lpjs_cgroup_sweep(inventory_t *inventory);
+void lpjs_cgroup_remove(unsigned long job_id);
@@ -0,0 +1,549 @@
+/***************************************************************************
+ *  Description:
+ *      cgroup v2 containment and accounting for jobs on Linux.  See
+ *      cgroup.h.  Everything here quietly does nothing where cgroups
+ *      are not available, so callers need not check.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>     // PATH_MAX
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "misc.h"
+#include "cgroup.h"
+
+// Parent of job cgroups, empty if cgroups are not available
+static char Cgroup_dir[PATH_MAX + 1] = "";
+
+/***************************************************************************
+ *  Description:
+ *      Find the cgroup2 mount point.  On hybrid systems it is not
+ *      /sys/fs/cgroup, so look it up.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if there is none
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_mount(char *mount_point, size_t maxlen)
+
+{
+#ifdef __linux__
+    FILE    *fp;
+    char    line[PATH_MAX + 128],
+	    dir[PATH_MAX + 1],
+	    type[32];
+    int     status = LPJS_READ_FAILED;
+
+    if ( (fp = fopen("/proc/self/mounts", "r")) == NULL )
+	return LPJS_READ_FAILED;
+    while ( fgets(line, sizeof(line), fp) != NULL )
+    {
+	if ( (sscanf(line, "%*s %4096s %31s", dir, type) == 2) &&
+	     (strcmp(type, "cgroup2") == 0) )
+	{
+	    strlcpy(mount_point, dir, maxlen);
+	    status = LPJS_SUCCESS;
+	    break;
+	}
+    }
+    fclose(fp);
+    return status;
+#else
+    return LPJS_READ_FAILED;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write a value to a cgroup interface file
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED with errno set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_write(const char *dir, const char *file, const char *value)
+
+{
+    char    path[PATH_MAX + 1];
+    int     fd, save_errno;
+    ssize_t len = strlen(value);
+
+    snprintf(path, PATH_MAX + 1, "%s/%s", dir, file);
+    if ( (fd = open(path, O_WRONLY)) == -1 )
+	return LPJS_WRITE_FAILED;
+    if ( write(fd, value, len) != len )
+    {
+	save_errno = errno;
+	close(fd);
+	errno = save_errno;
+	return LPJS_WRITE_FAILED;
+    }
+    close(fd);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Set up the parent cgroup for jobs, for lpjs_compd at startup.
+ *      It must run as root.  Controllers that cannot be enabled for
+ *      jobs are logged and their limits skipped.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if jobs will not use cgroups
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_init(void)
+
+{
+    char    mount_point[PATH_MAX + 1],
+	    dir[PATH_MAX + 1],
+	    *controllers[] = { "memory", "cpu" },
+	    value[LPJS_CGROUP_VALUE_MAX + 1];
+    size_t  c;
+
+    if ( lpjs_cgroup_mount(mount_point, PATH_MAX + 1) != LPJS_SUCCESS )
+    {
+	lpjs_log("%s(): No cgroup2 file system.  Jobs will not use cgroups.\n",
+		 __FUNCTION__);
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( (snprintf(dir, PATH_MAX + 1, "%s/%s", mount_point,
+		   LPJS_CGROUP_NAME) > PATH_MAX) ||
+	 ((mkdir(dir, 0755) != 0) && (errno != EEXIST)) )
+    {
+	lpjs_log("%s(): Cannot create %s: %s.  Jobs will not use cgroups.\n",
+		 __FUNCTION__, dir, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    // Each controller must be enabled in the parent of the parent first
+    for (c = 0; c < sizeof(controllers) / sizeof(*controllers); ++c)
+    {
+	snprintf(value, LPJS_CGROUP_VALUE_MAX + 1, "+%s", controllers[c]);
+	if ( (lpjs_cgroup_write(mount_point, "cgroup.subtree_control",
+				value) != LPJS_SUCCESS) ||
+	     (lpjs_cgroup_write(dir, "cgroup.subtree_control",
+				value) != LPJS_SUCCESS) )
+	    lpjs_log("%s(): Cannot enable %s controller: %s.  Jobs will not be limited by it.\n",
+		     __FUNCTION__, controllers[c], strerror(errno));
+    }
+
+    strlcpy(Cgroup_dir, dir, PATH_MAX + 1);
+    lpjs_log("%s(): Jobs will run in cgroups under %s.\n", __FUNCTION__,
+	     Cgroup_dir);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Path of a job's cgroup
+ *
+ *  Returns:
+ *      dir, or NULL if cgroups are not in use
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *lpjs_cgroup_job_dir(unsigned long job_id, char *dir, size_t maxlen)
+
+{
+    if ( *Cgroup_dir == '\0' )
+	return NULL;
+    snprintf(dir, maxlen, "%s/" LPJS_CGROUP_JOB_PREFIX "%lu",
+	     Cgroup_dir, job_id);
+    return dir;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create and limit a job's cgroup, for lpjs_compd before forking
+ *      the job's chaperone or script.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the job will run without
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_create(unsigned long job_id, unsigned procs,
+			   size_t pmem_per_proc)
+
+{
+    char    dir[PATH_MAX + 1],
+	    value[LPJS_CGROUP_VALUE_MAX + 1];
+    size_t  bytes = (size_t)procs * pmem_per_proc * 1024 * 1024;
+
+    if ( lpjs_cgroup_job_dir(job_id, dir, PATH_MAX + 1) == NULL )
+	return LPJS_WRITE_FAILED;
+
+    // May be left by a compd that died before removing it
+    if ( (mkdir(dir, 0755) != 0) && (errno != EEXIST) )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 dir, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    // Missing controllers were logged by lpjs_cgroup_init()
+    if ( bytes > 0 )
+    {
+	snprintf(value, LPJS_CGROUP_VALUE_MAX + 1, "%zu", bytes);
+	lpjs_cgroup_write(dir, "memory.high", value);
+	snprintf(value, LPJS_CGROUP_VALUE_MAX + 1, "%zu",
+		 bytes / 100 * LPJS_CGROUP_MEMORY_MAX_PCT);
+	lpjs_cgroup_write(dir, "memory.max", value);
+    }
+    if ( procs > 0 )
+    {
+	snprintf(value, LPJS_CGROUP_VALUE_MAX + 1, "%lu %u",
+		 (unsigned long)procs * LPJS_CGROUP_CPU_PERIOD,
+		 LPJS_CGROUP_CPU_PERIOD);
+	lpjs_cgroup_write(dir, "cpu.max", value);
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Move the calling process into a job's cgroup.  Called by the
+ *      child of lpjs_compd that becomes the chaperone or script, while
+ *      still root, so that all of the job's processes follow.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the job will run without
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_enter(unsigned long job_id)
+
+{
+    char    dir[PATH_MAX + 1],
+	    value[LPJS_CGROUP_VALUE_MAX + 1];
+
+    if ( lpjs_cgroup_job_dir(job_id, dir, PATH_MAX + 1) == NULL )
+	return LPJS_WRITE_FAILED;
+    snprintf(value, LPJS_CGROUP_VALUE_MAX + 1, "%d", getpid());
+    if ( lpjs_cgroup_write(dir, "cgroup.procs", value) != LPJS_SUCCESS )
+    {
+	lpjs_log("%s(): Error: Cannot enter %s: %s\n", __FUNCTION__,
+		 dir, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read peak memory and CPU time of a cgroup and its descendants
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if cpu.stat cannot be read
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_usage(const char *dir, cgroup_usage_t *usage)
+
+{
+    char                path[PATH_MAX + 1],
+			line[128];
+    FILE                *fp;
+    unsigned long long  value;
+
+    usage->peak_MiB = 0;
+    usage->user_sec = usage->system_sec = 0.0;
+
+    // Linux 5.19 and later
+    snprintf(path, PATH_MAX + 1, "%s/memory.peak", dir);
+    if ( (fp = fopen(path, "r")) != NULL )
+    {
+	if ( fscanf(fp, "%llu", &value) == 1 )
+	    usage->peak_MiB = value / 1024 / 1024;
+	fclose(fp);
+    }
+
+    // Always present, with or without the cpu controller
+    snprintf(path, PATH_MAX + 1, "%s/cpu.stat", dir);
+    if ( (fp = fopen(path, "r")) == NULL )
+	return LPJS_READ_FAILED;
+    while ( fgets(line, sizeof(line), fp) != NULL )
+    {
+	if ( sscanf(line, "user_usec %llu", &value) == 1 )
+	    usage->user_sec = value / 1000000.0;
+	else if ( sscanf(line, "system_usec %llu", &value) == 1 )
+	    usage->system_sec = value / 1000000.0;
+    }
+    fclose(fp);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Text form of usage for logs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *cgroup_usage_to_str(cgroup_usage_t *usage, char *str, size_t maxlen)
+
+{
+    size_t  len;
+    
+    len = snprintf(str, maxlen, "CPU %.1f s user, %.1f s system, peak memory ",
+		   usage->user_sec, usage->system_sec);
+    if ( len < maxlen )
+    {
+	if ( usage->peak_MiB == 0 )
+	    snprintf(str + len, maxlen - len, "unknown");
+	else
+	    snprintf(str + len, maxlen - len, "%zu MiB", usage->peak_MiB);
+    }
+    return str;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read the usage of the job cgroup containing the calling process,
+ *      for the chaperone, which is in its job's cgroup but runs as the
+ *      submitting user and never calls lpjs_cgroup_init().
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if not in a job cgroup
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_self_usage(cgroup_usage_t *usage)
+
+{
+    char    mount_point[PATH_MAX + 1],
+	    line[PATH_MAX + 1],
+	    dir[PATH_MAX + 1],
+	    *path;
+    FILE    *fp;
+    int     status = LPJS_READ_FAILED;
+
+    if ( lpjs_cgroup_mount(mount_point, PATH_MAX + 1) != LPJS_SUCCESS )
+	return LPJS_READ_FAILED;
+    if ( (fp = fopen("/proc/self/cgroup", "r")) == NULL )
+	return LPJS_READ_FAILED;
+
+    // The cgroup2 entry is "0::/path"
+    while ( fgets(line, sizeof(line), fp) != NULL )
+    {
+	if ( strncmp(line, "0::", 3) != 0 )
+	    continue;
+	path = line + 3;
+	path[strcspn(path, "\n")] = '\0';
+	if ( strstr(path, "/" LPJS_CGROUP_NAME "/" LPJS_CGROUP_JOB_PREFIX)
+		!= NULL )
+	{
+	    if ( snprintf(dir, PATH_MAX + 1, "%s%s", mount_point, path)
+		    <= PATH_MAX )
+		status = lpjs_cgroup_usage(dir, usage);
+	}
+	break;
+    }
+    fclose(fp);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send a signal to every process in a job's cgroup, for canceling
+ *      a job.  Unlike killpg(), this reaches processes that have left
+ *      the job's process group or lost their ancestry.
+ *
+ *  Returns:
+ *      The number of processes signaled, 0 if the job has no cgroup
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_cgroup_signal(unsigned long job_id, int sig)
+
+{
+    char        dir[PATH_MAX + 1],
+		path[PATH_MAX + 1];
+    FILE        *fp;
+    long        pid;
+    unsigned    signaled = 0;
+
+    if ( lpjs_cgroup_job_dir(job_id, dir, PATH_MAX + 1) == NULL )
+	return 0;
+    if ( snprintf(path, PATH_MAX + 1, "%s/cgroup.procs", dir) > PATH_MAX )
+	return 0;
+    if ( (fp = fopen(path, "r")) == NULL )
+	return 0;
+    while ( fscanf(fp, "%ld", &pid) == 1 )
+	if ( kill(pid, sig) == 0 )
+	    ++signaled;
+    fclose(fp);
+    return signaled;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      SIGKILL every process in a job's cgroup at once, including any
+ *      forked while doing so.  Requires cgroup.kill (Linux 5.14).
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the job has no cgroup or
+ *      cgroup.kill is not available
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cgroup_kill(unsigned long job_id)
+
+{
+    char    dir[PATH_MAX + 1];
+
+    if ( lpjs_cgroup_job_dir(job_id, dir, PATH_MAX + 1) == NULL )
+	return LPJS_WRITE_FAILED;
+    return lpjs_cgroup_write(dir, "cgroup.kill", "1");
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the cgroups of jobs no longer in the inventory, for
+ *      lpjs_compd after a chaperone or script exits and at startup.
+ *      Their usage is logged.  Processes a job left behind are killed
+ *      (Linux 5.14 and later), and their cgroups removed on a later
+ *      call, once they are gone.
+ *
+ *  Returns:
+ *      The number of cgroups that could not be removed yet
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_cgroup_sweep(inventory_t *inventory)
+
+{
+    DIR             *dirp;
+    struct dirent   *entry;
+    char            dir[PATH_MAX + 1],
+		    *end;
+    unsigned long   job_id;
+    unsigned        left = 0;
+    cgroup_usage_t  usage;
+    bool            have_usage;
+    char            usage_str[LPJS_CGROUP_USAGE_STR_MAX + 1];
+
+    if ( (*Cgroup_dir == '\0') || ((dirp = opendir(Cgroup_dir)) == NULL) )
+	return 0;
+    while ( (entry = readdir(dirp)) != NULL )
+    {
+	if ( strncmp(entry->d_name, LPJS_CGROUP_JOB_PREFIX,
+		     strlen(LPJS_CGROUP_JOB_PREFIX)) != 0 )
+	    continue;
+	job_id = strtoul(entry->d_name + strlen(LPJS_CGROUP_JOB_PREFIX),
+			 &end, 10);
+	if ( (*end != '\0') ||
+	     (inventory_find(inventory, job_id) != INVENTORY_NOT_FOUND) )
+	    continue;
+
+	if ( snprintf(dir, PATH_MAX + 1, "%s/%s", Cgroup_dir,
+		      entry->d_name) > PATH_MAX )
+	    continue;
+	have_usage = lpjs_cgroup_usage(dir, &usage) == LPJS_SUCCESS;
+	if ( rmdir(dir) == 0 )
+	{
+	    if ( have_usage )
+		lpjs_log("%s(): Job %lu used %s.\n", __FUNCTION__, job_id,
+			 cgroup_usage_to_str(&usage, usage_str,
+					     LPJS_CGROUP_USAGE_STR_MAX + 1));
+	}
+	else if ( errno == EBUSY )
+	{
+	    lpjs_log("%s(): Job %lu has processes left.  Killing them...\n",
+		     __FUNCTION__, job_id);
+	    lpjs_cgroup_write(dir, "cgroup.kill", "1");
+	    ++left;
+	}
+	else
+	    lpjs_log("%s(): Error: Cannot remove %s: %s\n", __FUNCTION__,
+		     dir, strerror(errno));
+    }
+    closedir(dirp);
+    return left;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove a job's cgroup, e.g. when its chaperone could not be
+ *      forked.  It must be empty.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_cgroup_remove(unsigned long job_id)
+
+{
+    char    dir[PATH_MAX + 1];
+
+    if ( lpjs_cgroup_job_dir(job_id, dir, PATH_MAX + 1) != NULL )
+	rmdir(dir);
+}
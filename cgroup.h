@@ -0,0 +1,54 @@
+#ifndef _LPJS_CGROUP_H_
+#define _LPJS_CGROUP_H_
+
+#include <stdbool.h>
+#include <sys/types.h>  // size_t
+
+#ifndef _LPJS_INVENTORY_H_
+#include "inventory.h"
+#endif
+
+/*
+ *  cgroup v2 containment of jobs on Linux.  lpjs_compd creates a
+ *  cgroup for each job under LPJS_CGROUP_NAME in the cgroup2 mount,
+ *  and moves the chaperone or script into it before giving up root,
+ *  so that everything the job starts is limited and accounted
+ *  together, even processes that leave the job's process group.
+ *
+ *  memory.high is set to the job's request, above which the job's own
+ *  pages are reclaimed first, so one runaway job does not push the
+ *  whole node into swap.  memory.max, where the kernel kills it, is
+ *  LPJS_CGROUP_MEMORY_MAX_PCT percent of the request.  cpu.max allows
+ *  procs-per-job CPUs.  Limits whose controllers are not available to
+ *  LPJS_CGROUP_NAME are skipped.  Peak memory and CPU time are read
+ *  from memory.peak and cpu.stat.
+ *
+ *  When a job supervised by compd is canceled, every process in its
+ *  cgroup gets SIGTERM, and cgroup.kill ends any still running after
+ *  the cancel grace period.  Chaperones do not use cgroup.kill on
+ *  cancel, since they run in the job's cgroup themselves.
+ *
+ *  A job's cgroup is removed by compd after its chaperone or script
+ *  has exited and its report is sent, killing any processes left
+ *  behind.  Where there is no writable cgroup2 mount, e.g. on other
+ *  platforms, hybrid hierarchies without one, or when compd is not
+ *  root, jobs run as before, limited only by rlimit.c.  See cgroup.c.
+ */
+
+#define LPJS_CGROUP_NAME            "lpjs"
+#define LPJS_CGROUP_JOB_PREFIX      "job-"
+#define LPJS_CGROUP_MEMORY_MAX_PCT  125
+#define LPJS_CGROUP_CPU_PERIOD      100000  // us, cpu.max default
+#define LPJS_CGROUP_VALUE_MAX       64
+#define LPJS_CGROUP_USAGE_STR_MAX   128
+
+typedef struct
+{
+    size_t  peak_MiB;       // 0 if memory.peak is not available
+    double  user_sec;
+    double  system_sec;
+}   cgroup_usage_t;
+
+#include "cgroup-protos.h"
+
+#endif  // _LPJS_CGROUP_H_
@@ -18,11 +18,12 @@
 #include <unistd.h>
 #include <sysexits.h>
 #include <errno.h>
+#include <stdint.h>         // intmax_t
 #include <fcntl.h>          // open()
-#include <sys/wait.h>       // FIXME: Replace wait() with active monitoring
+#include <sys/wait.h>       // wait4()
+#include <sys/resource.h>   // struct rusage
 #include <signal.h>
-#include <sys/sysctl.h>
-#include <sys/resource.h>   // setrlimit()
+#include <sys/select.h>     // pselect()
 
 #include <xtend/string.h>
 #include <xtend/file.h>
@@ -34,9 +35,16 @@
 #include "misc.h"
 #include "lpjs.h"
 #include "chaperone.h"
+#include "rlimit.h"
+#include "relay.h"
+#include "cgroup.h"
+#include "proctree.h"
+#include "job-usage.h"
 
-// Must be global for job cancel signal handler
+// Job cancel state, see chaperone_cancel_handler()
 pid_t   Pid;
+// Set by chaperone_cancel_handler(), acted on in chaperone_wait()
+volatile sig_atomic_t   Cancel_requested = 0;
 
 int     main (int argc, char *argv[])
 
@@ -61,8 +69,16 @@ int     main (int argc, char *argv[])
 		home_dir[PATH_MAX + 1];
     extern FILE *Log_stream;
     struct stat st;
-
-    signal(SIGHUP, chaperone_cancel_handler);
+    int64_t     exec_time;
+    job_usage_t usage;
+    char        usage_str[JOB_USAGE_STR_MAX + 1];
+    struct sigaction    cancel_action;
+
+    // Cancel is acted on in chaperone_wait(), which is woken by it
+    memset(&cancel_action, 0, sizeof(cancel_action));
+    cancel_action.sa_handler = chaperone_cancel_handler;
+    sigemptyset(&cancel_action.sa_mask);
+    sigaction(SIGHUP, &cancel_action, NULL);
     
     if ( argc != 2 )
     {
@@ -127,23 +143,16 @@ int     main (int argc, char *argv[])
 	// FIXME: Implement input file transfer here
     }
     
+    // The child execs the script immediately, so the fork time is
+    // the best estimate the parent has of when the script started
+    exec_time = lpjs_time_us();
     if ( (Pid = fork()) == 0 )
     {
-	struct rlimit   rss_limit;
-	
 	// Create new process group with the script's PID
 	// This helps track processes that are part of a job
 	setpgid(0, getpid());
 	
-	// Suggest resource limits.  RSS cannot be controlled at all
-	// on Linux, so this has no effect.  On BSD systems, RSS limits
-	// influence pager behavior, so that processes exceeding their
-	// RSS limit are preferentially paged out when memory is tight.
-	rss_limit.rlim_cur = pmem_per_proc * 1024 * 1024;
-	rss_limit.rlim_max = pmem_per_proc * 1024 * 1024;
-	setrlimit(RLIMIT_RSS, &rss_limit);
-	
-	enforce_resource_limits(getpid(), pmem_per_proc);
+	lpjs_set_job_limits(pmem_per_proc);
     
 	// Child, run script
 	// FIXME: Set CPU and memory (virtual and physical) limits
@@ -154,14 +163,18 @@ int     main (int argc, char *argv[])
     }
     // No need for else since child calls execl() and exits if it fails
     
-    lpjs_job_start_notice_loop(node_list, hostname, job_id, Pid);
+    // A report lost with compd is retried, don't die with it
+    signal(SIGPIPE, SIG_IGN);
+    lpjs_job_start_notice_loop(hostname, job_id, Pid, exec_time);
     
-    // FIXME: Monitor resource use of child
-    // Maybe ptrace(), though seemingly not well standardized
-    wait(&status);
+    chaperone_wait(Pid, &status, &usage);
     lpjs_log("%s(): Info: Process exited with status %d.\n", __FUNCTION__, status);
+    lpjs_log("%s(): Info: Job used %s, %lu MiB requested.\n",
+	     __FUNCTION__, job_usage_describe(&usage, usage_str,
+					      JOB_USAGE_STR_MAX + 1),
+	     pmem_per_proc * procs);
 
-    lpjs_chaperone_completion_loop(node_list, hostname, job_id, status);
+    lpjs_chaperone_completion_loop(hostname, job_id, status, &usage);
     
     // Transfer working dir to submit host or according to user
     // settings, if not shared
@@ -273,325 +286,186 @@ int     main (int argc, char *argv[])
 
 /***************************************************************************
  *  Description:
- *  
- *  Returns:
- *      LPJS_SUCCESS, etc.
+ *      Send job start notification to dispatchd, through lpjs_compd.
+ *      Retry indefinitely if failure occurs.
  *
  *  History: 
  *  Date        Name        Modification
- *  ~2024-05-01 Jason Bacon Begin
+ *  2024-01-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Pass script exec time through
+ *  2026-10-19  Jason Bacon Send through compd's report relay
  ***************************************************************************/
 
-int     lpjs_job_start_notice(int msg_fd,
-			       const char *hostname, const char *job_id,
-			       pid_t job_pid)
+void    lpjs_job_start_notice_loop(const char *hostname,
+				    const char *job_id, pid_t job_pid,
+				    int64_t exec_time)
 
 {
-    char        outgoing_msg[LPJS_MSG_LEN_MAX + 1],
-		*munge_payload;
-    ssize_t     bytes;
-    uid_t       uid;
-    gid_t       gid;
-    extern FILE *Log_stream;
+    char    record[RELAY_RECORD_MAX + 1];
     
-    /* Send a message to the server */
-    /* Need to send \0, so xt_dprintf() doesn't work here */
-    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
-	    "%c%s %s %u %d", LPJS_DISPATCHD_REQUEST_JOB_STARTED,
-	    hostname, job_id, getpid(), job_pid);
+    snprintf(record, RELAY_RECORD_MAX + 1,
+	    "%c%s %s %u %d %jd", LPJS_DISPATCHD_REQUEST_JOB_STARTED,
+	    hostname, job_id, getpid(), job_pid, (intmax_t)exec_time);
     lpjs_log("%s(): Sending new PIDs to dispatchd:\n", __FUNCTION__);
-    lpjs_debug("%s(): msg = %s\n", __FUNCTION__, outgoing_msg + 1);
-    if ( lpjs_send_munge(msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
-    {
-	lpjs_log("%s(): Error: Failed to send job start message to dispatchd: %s",
-		__FUNCTION__, strerror(errno));
-	return LPJS_WRITE_FAILED;
-    }
-    lpjs_debug("%s(): Sent job start request.\n", __FUNCTION__);
-
-    // lpjs_recv(msg_fd, incoming_msg, LPJS_MSG_LEN_MAX, 0, 0);
-    // FIXME: Add a timeout and handling code
-    bytes = lpjs_recv_munge(msg_fd, &munge_payload, 0, 0, &uid, &gid, close);
-
-    if ( bytes < 1 )
-    {
-	lpjs_log("%s(): Error: Failed to receive auth message.\n", __FUNCTION__);
-	exit(EX_IOERR); // FIXME: Should we retry?
-    }
-    else if ( strcmp(munge_payload, "Node authorized") != 0 )
-    {
-	lpjs_log("%s(): Error: This node is not authorized to connect.\n"
-		 "It must be added to the etc/lpjs/config on the head node.\n",
-		 __FUNCTION__);
-	exit(EX_NOPERM);
-    }
-    else
-	lpjs_log("%s(): Received authorization from lpjs_dispatchd.\n",
-		__FUNCTION__);
-    free(munge_payload);
-    
-    return LPJS_SUCCESS;
+    lpjs_debug("%s(): msg = %s\n", __FUNCTION__, record + 1);
+    lpjs_relay_report_loop(record);
+    lpjs_debug("%s(): Start notice successful.\n", __FUNCTION__);
 }
 
 
 /***************************************************************************
  *  Description:
- *      Connect to dispatchd and send job start notification.
- *      Retry indefinitely if failure occurs.
+ *      Wait for the script to exit, sampling the resource use of its
+ *      process tree every usage-interval seconds meanwhile.  The
+ *      rusage from wait4() and the job's cgroup, if any, are merged
+ *      into the samples when it exits.  See job-usage.h.
  *
- *  Returns:
- *      File descriptor for ongoing connection to dispatchd.
+ *      SIGHUP and SIGCHLD are blocked except while waiting in
+ *      pselect(), so a cancel from chaperone_cancel_handler() or the
+ *      script's exit that arrives after the checks in the loop
+ *      still ends the wait at once.  The process tree of a canceled
+ *      job is terminated here, outside the handler.
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-01-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Begin, replacing wait()
+ *  2026-10-19  Jason Bacon Terminate canceled jobs here
+ *  2026-10-19  Jason Bacon Wait in pselect(), so no signal is missed
  ***************************************************************************/
 
-int     lpjs_job_start_notice_loop(node_list_t *node_list,
-				    const char *hostname,
-				    const char *job_id, pid_t job_pid)
+void    chaperone_wait(pid_t pid, int *status, job_usage_t *usage)
 
 {
-    int     msg_fd,
-	    status;
+    extern lpjs_config_t   Config;
+    proctree_t      *tree = NULL;
+    struct rusage   ru;
+    cgroup_usage_t  cg_usage;
+    pid_t           waited;
+    sigset_t        wake_mask, orig_mask;
+    struct timespec interval, *timeout = NULL;    // NULL = until signaled
+    
+    job_usage_init(usage);
+    if ( Config.usage_interval > 0 )
+    {
+	tree = proctree_new();
+	interval.tv_sec = Config.usage_interval;
+	interval.tv_nsec = 0;
+	timeout = &interval;
+    }
     
-    /*
-     *  Retry socket connection and job start request indefinitely.
-     *  Close msg_fd if request fails, to prevent deamons from
-     *  hanging on an open socket connection.
-     */
+    // Cut the wait short when the script exits
+    signal(SIGCHLD, chaperone_child_handler);
+    sigemptyset(&wake_mask);
+    sigaddset(&wake_mask, SIGHUP);
+    sigaddset(&wake_mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &wake_mask, &orig_mask);
     
-    do
+    while ( true )
     {
-	msg_fd = lpjs_connect_to_dispatchd(node_list);
-	if ( msg_fd == -1 )
+	if ( Cancel_requested )
 	{
-	    lpjs_log("%s(): Error: Failed to connect to dispatchd: %s\n",
-		    __FUNCTION__, strerror(errno));
-	    lpjs_log("%s(): Retry in %d seconds...\n",
-		    __FUNCTION__, LPJS_RETRY_TIME);
-	    sleep(LPJS_RETRY_TIME);
+	    Cancel_requested = 0;
+	    lpjs_log("%s(): Canceling PID %d...\n", __FUNCTION__, pid);
+	    proctree_terminate(pid, Config.cancel_grace);
 	}
-	else
+	if ( (waited = wait4(pid, status, WNOHANG, &ru)) == pid )
+	    break;
+	if ( waited == -1 )
 	{
-	    status = lpjs_job_start_notice(msg_fd, hostname, job_id, job_pid);
-	    if ( status != LPJS_SUCCESS )
-	    {
-		lpjs_log("%s(): Error: Chaperone start notice failed.\n",
-			__FUNCTION__);
-		lpjs_log("%s(): Retry in %d seconds...\n",
-			 __FUNCTION__, LPJS_RETRY_TIME);
-		sleep(LPJS_RETRY_TIME);
-	    }
-	    close(msg_fd);
+	    lpjs_log("%s(): Error: wait4() failed: %s\n",
+		     __FUNCTION__, strerror(errno));
+	    *status = 0;
+	    memset(&ru, 0, sizeof(ru));
+	    break;
 	}
-    }   while ( (msg_fd == -1) || (status != LPJS_SUCCESS) );
-    
-    lpjs_debug("%s(): Start notice successful.\n", __FUNCTION__);
+	if ( (tree != NULL) && (proctree_load(tree) == LPJS_SUCCESS) )
+	    job_usage_sample(usage, tree, pid);
+	
+	// Signals blocked since the checks above are caught here
+	pselect(0, NULL, NULL, NULL, timeout, &orig_mask);
+    }
+    sigprocmask(SIG_SETMASK, &orig_mask, NULL);
     
-    return LPJS_SUCCESS;
+    if ( tree != NULL )
+	proctree_free(tree);
+    job_usage_add_rusage(usage, &ru);
+    // Includes everything the script started, if compd set up a cgroup
+    if ( lpjs_cgroup_self_usage(&cg_usage) == LPJS_SUCCESS )
+	job_usage_add_cgroup(usage, &cg_usage);
 }
 
 
 /***************************************************************************
  *  Description:
- *      Attempt to send job completion report to dispatchd
- *
- *  Returns:
- *      EX_OK on success, EX_IOERR otherwise
+ *      SIGCHLD handler: Nothing to do but interrupt pselect() in
+ *      chaperone_wait()
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-05-04  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Begin
  ***************************************************************************/
 
-int     lpjs_chaperone_completion(int msg_fd, const char *hostname,
-				  const char *job_id, int status)
+void    chaperone_child_handler(int s2)
 
 {
-    char    outgoing_msg[LPJS_MSG_LEN_MAX + 1];
-    
-    /* Send job completion message to dispatchd */
-    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%s %s %d\n",
-	     LPJS_DISPATCHD_REQUEST_JOB_COMPLETE, hostname,
-	     job_id, status);
-    if ( lpjs_send_munge(msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
-    {
-	lpjs_log("%s(): Failed to send message to dispatchd: %s",
-		__FUNCTION__, strerror(errno));
-	return EX_IOERR;
-    }
-    
-    return EX_OK;
 }
 
+
 /***************************************************************************
  *  Description:
- *      Connect to dispatchd and send job completion request.
+ *      Send job completion report to dispatchd, through lpjs_compd.
  *      Retry indefinitely if failure occurs.
  *
- *  Returns:
- *      File descriptor for ongoing connection to dispatchd.
- *
  *  History: 
  *  Date        Name        Modification
  *  2024-05-04  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Send through compd's report relay
+ *  2026-10-19  Jason Bacon Add measured usage
  ***************************************************************************/
 
-int     lpjs_chaperone_completion_loop(node_list_t *node_list,
-				    const char *hostname,
-				    const char *job_id, int status)
+void    lpjs_chaperone_completion_loop(const char *hostname,
+				       const char *job_id, int status,
+				       const job_usage_t *usage)
 
 {
-    int     msg_fd;
+    char    record[RELAY_RECORD_MAX + 1],
+	    usage_str[JOB_USAGE_STR_MAX + 1];
     
-    // Retry socket connection and message send indefinitely
-    do
-    {
-	msg_fd = lpjs_connect_to_dispatchd(node_list);
-	if ( msg_fd == -1 )
-	{
-	    lpjs_log("%s(): Error: Failed to connect to dispatchd: %s\n",
-		    __FUNCTION__, strerror(errno));
-	    lpjs_log("%s(): Retry in %d seconds...\n",
-		    __FUNCTION__, LPJS_RETRY_TIME);
-	    sleep(LPJS_RETRY_TIME);
-	}
-	else
-	{
-	    status = lpjs_chaperone_completion(msg_fd, hostname, job_id,
-						status);
-	    if ( status != EX_OK )
-	    {
-		lpjs_log("%s(): Error: Message send failed.\n",
-			__FUNCTION__);
-		lpjs_log("%s(): Retry in %d seconds...\n",
-			 __FUNCTION__, LPJS_RETRY_TIME);
-		sleep(LPJS_RETRY_TIME);
-	    }
-	    close(msg_fd);
-	}
-    }   while ( (msg_fd == -1) || (status != EX_OK) );
+    snprintf(record, RELAY_RECORD_MAX + 1, "%c%s %s %d %s",
+	     LPJS_DISPATCHD_REQUEST_JOB_COMPLETE, hostname,
+	     job_id, status,
+	     job_usage_to_str(usage, usage_str, JOB_USAGE_STR_MAX + 1));
+    lpjs_relay_report_loop(record);
     lpjs_log("%s(): Completion report sent.\n", __FUNCTION__);
-    
-    return 0;   // FIXME: Define return codes
-}
-
-
-void    chaperone_cancel_handler(int s2)
-
-{
-    lpjs_log("%s(): Canceling PID %d...\n", __FUNCTION__, Pid);
-    
-    /*
-     *  Terminate mafia-style: Don't just terminate the process, go
-     *  after his family as well.  Although chaperone
-     *  creates a process group for the LPJS script, killpg() will
-     *  not work if programs run by the script create process groups
-     *  as well.  So we need to traverse the process tree, depth-first,
-     *  kill children before their parents to ensure that all descendent
-     *  processes are discovered.
-     */
-    
-    whack_family(Pid);
-    
-    // Try SIGTERM first in case process catches it and cleans up
-    lpjs_log("%s(): Sending SIGTERM to %d...\n", __FUNCTION__, Pid);
-    kill(Pid, SIGTERM);
-    sleep(2);
-    // If SIGTERM worked, this will fail and have no effect
-    lpjs_log("%s(): Sending SIGKILL to %d...\n", __FUNCTION__, Pid);
-    kill(Pid, SIGKILL);
 }
 
 
-
-
 /***************************************************************************
  *  Description:
- *      Kill descendents of a process in depth-first order
+ *      SIGHUP handler: cancel the job.  Only sets a flag, since
+ *      proctree_terminate() is not async-signal-safe.  The
+ *      termination is done by chaperone_wait().
+ *
+ *      Terminate mafia-style: Don't just terminate the process, go
+ *      after his family as well.  Although chaperone creates a process
+ *      group for the LPJS script, killpg() will not work if programs
+ *      run by the script create process groups as well.  So snapshot
+ *      the whole process tree, and signal every descendant at once,
+ *      allowing them cancel-grace seconds to clean up before SIGKILL.
+ *      See proctree_terminate().
+ *
+ *      The job's cgroup, if any, is not used here, since we are in it.
+ *      compd kills anything left in it after we exit.
  *
  *  History: 
  *  Date        Name        Modification
  *  2024-05-08  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Replace pgrep traversal with proctree
+ *  2026-10-19  Jason Bacon Defer termination to chaperone_wait()
  ***************************************************************************/
 
-void    whack_family(pid_t pid)
-
-{
-    char    cmd[LPJS_CMD_MAX + 1],
-	    pid_str[100],
-	    *end;
-    FILE    *fp;
-    pid_t   child_pid;
-    
-    // Get list of child processes in a kludgy, but portable way
-    lpjs_log("%s(): Finding children of %d...\n", __FUNCTION__, pid);
-    snprintf(cmd, LPJS_CMD_MAX + 1, "pgrep -P %u", pid);
-    
-    // Signal each child to terminate
-    if ( (fp = popen(cmd, "r")) == NULL )
-    {
-	lpjs_log("%s(): Error: Failed to run %s.\n", __FUNCTION__, cmd);
-	return;
-    }
-    while ( fgets(pid_str, 100, fp) != NULL )
-    {
-	// FIXME: Check success
-	child_pid = strtoul(pid_str, &end, 10);
-	
-	// Depth-first recursive traversal of process tree
-	if ( child_pid != pid )
-	    whack_family(child_pid);
-	
-	// Try SIGTERM first in case process catches it and cleans up
-	lpjs_log("%s(): Sending SIGTERM to child %d...\n",
-		__FUNCTION__, child_pid);
-	kill(child_pid, SIGTERM);
-	sleep(2);
-	// If SIGTERM worked, this will fail and have no effect
-	lpjs_log("%s(): Sending SIGKILL to child %d...\n",
-		__FUNCTION__, child_pid);
-	kill(child_pid, SIGKILL);
-    }
-    pclose(fp);
-}
-
-
-void    enforce_resource_limits(pid_t pid, size_t mem_per_proc)
+void    chaperone_cancel_handler(int s2)
 
 {
-#if defined(__APPLE__)
-#elif defined(__DragonFly__)
-#elif defined(__FreeBSD__)
-    
-    // Use rctl
-    // FIXME: This needs to be run as root
-    #include <sys/rctl.h>
-    int     enabled;
-    size_t  len = sizeof(int);
-    char    rule[LPJS_RCTL_RULE_MAX + 1];
-    
-    if ( sysctlbyname("kern.racct.enable", &enabled, &len, NULL, 0) != 0 )
-	lpjs_log("%s(): sysctl kern.racct.enable failed.\n", __FUNCTION__);
-    else
-	if ( enabled == 1 )
-	{
-	    // Limit RSS to mem_per_proc MiB
-	    snprintf(rule, LPJS_RCTL_RULE_MAX + 1,
-		    "process:%d:memoryuse:deny=%zu",
-		    pid, mem_per_proc * 1024 * 1024);
-	    lpjs_log("%s(): Adding rctl rule: %s\n", __FUNCTION__, rule);
-	    if ( rctl_add_rule(rule, LPJS_RCTL_RULE_MAX + 1, NULL, 0) != 0 )
-		lpjs_log("%s(): rctl_add_rule() failed: %s\n",
-			__FUNCTION__, strerror(errno));
-	}
-	else
-	    lpjs_log("%s(): kern.racct.enable is not enabled.\n", __FUNCTION__);
-
-#elif defined(__Linux__)
-    // Use cgroups?
-#elif defined(__NetBSD__)
-#elif defined(__OpenBSD__)
-#endif
+    Cancel_requested = 1;
 }
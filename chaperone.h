@@ -5,12 +5,14 @@
 extern "C" {
 #endif
 
-#define LPJS_RCTL_RULE_MAX  128
-
 #ifdef  __cplusplus
 }
 #endif
 
+#ifndef _LPJS_JOB_USAGE_H_
+#include "job-usage.h"
+#endif
+
 #include "chaperone-protos.h"
 
 #endif  // #ifndef __H_
@@ -0,0 +1,7 @@
+/* cleanup.c */
+int lpjs_cleanup_start(void);
+void lpjs_cleanup_queue(const char *path);
+unsigned lpjs_cleanup_report(void);
+void *lpjs_cleanup_worker(void *arg);
+int lpjs_remove_tree(int dir_fd, const char *path);
+cleanup_item_t *lpjs_cleanup_item_new(const char *path, int error);
@@ -0,0 +1,288 @@
+/***************************************************************************
+ *  Description:
+ *      Background removal of spool files and directories.
+ *
+ *      Removing a file tree can take a while on a busy or networked
+ *      file system, and dispatchd must not stall its event loop for
+ *      it.  Paths are queued by lpjs_cleanup_queue(), which returns
+ *      immediately, and removed by a single worker thread using
+ *      openat()/unlinkat(), so there is no need to fork the daemon
+ *      and exec rm -rf.  The worker takes everything queued at once
+ *      and removes the whole batch before waiting again.
+ *
+ *      The worker does not touch the job lists or any other dispatchd
+ *      state.  Failures are saved and logged from the main thread by
+ *      lpjs_cleanup_report().
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>      // openat()
+#include <dirent.h>     // fdopendir()
+#include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+#include "lpjs.h"
+#include "cleanup.h"
+#include "misc.h"
+
+/*
+ *  One cleanup worker per dispatchd, shared by everything that removes
+ *  spool files.  Queued paths and failures are singly-linked lists
+ *  protected by Cleanup_mutex.
+ */
+static pthread_mutex_t  Cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   Cleanup_cond = PTHREAD_COND_INITIALIZER;
+static cleanup_item_t   *Cleanup_head = NULL,
+			*Cleanup_tail = NULL,
+			*Cleanup_failures = NULL;
+static bool             Cleanup_running = false;
+
+/***************************************************************************
+ *  Description:
+ *      Start the cleanup worker thread.  Until this is called, or if
+ *      it fails, lpjs_cleanup_queue() removes paths immediately.
+ *
+ *  Returns:
+ *      0 on success, or the error code from pthread_create()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_cleanup_start(void)
+
+{
+    pthread_t   thread;
+    sigset_t    all_signals, old_mask;
+    int         status;
+
+    // Worker inherits a full signal mask, so signals go to the main thread
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+    status = pthread_create(&thread, NULL, lpjs_cleanup_worker, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if ( status != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot create cleanup thread: %s\n",
+		 __FUNCTION__, strerror(status));
+	return status;
+    }
+    pthread_detach(thread);
+    Cleanup_running = true;
+
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Queue a file or directory tree for removal.  Paths that do not
+ *      exist are silently ignored when the queue is processed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_cleanup_queue(const char *path)
+
+{
+    cleanup_item_t  *item;
+    int             status;
+
+    if ( ! Cleanup_running )
+    {
+	if ( (status = lpjs_remove_tree(AT_FDCWD, path)) != 0 )
+	    lpjs_log("%s(): Error: Cannot remove %s: %s\n", __FUNCTION__,
+		     path, strerror(status));
+	return;
+    }
+
+    item = lpjs_cleanup_item_new(path, 0);
+    pthread_mutex_lock(&Cleanup_mutex);
+    if ( Cleanup_tail == NULL )
+	Cleanup_head = item;
+    else
+	Cleanup_tail->next = item;
+    Cleanup_tail = item;
+    pthread_cond_signal(&Cleanup_cond);
+    pthread_mutex_unlock(&Cleanup_mutex);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Log and discard failures saved by the worker thread.  Called
+ *      from the dispatchd event loop, so that only the main thread
+ *      writes to the log.
+ *
+ *  Returns:
+ *      The number of failures logged
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_cleanup_report(void)
+
+{
+    cleanup_item_t  *failures, *next;
+    unsigned        count = 0;
+
+    pthread_mutex_lock(&Cleanup_mutex);
+    failures = Cleanup_failures;
+    Cleanup_failures = NULL;
+    pthread_mutex_unlock(&Cleanup_mutex);
+
+    for (; failures != NULL; failures = next, ++count)
+    {
+	lpjs_log("%s(): Error: Cannot remove %s: %s\n", __FUNCTION__,
+		 failures->path, strerror(failures->error));
+	next = failures->next;
+	free(failures);
+    }
+
+    return count;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Cleanup thread main loop.  Take the whole queue at once, so
+ *      the mutex is never held during file system operations, and
+ *      lpjs_cleanup_queue() never waits for a removal.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *lpjs_cleanup_worker(void *arg)
+
+{
+    cleanup_item_t  *batch, *next;
+    int             status;
+
+    while ( true )
+    {
+	pthread_mutex_lock(&Cleanup_mutex);
+	while ( Cleanup_head == NULL )
+	    pthread_cond_wait(&Cleanup_cond, &Cleanup_mutex);
+	batch = Cleanup_head;
+	Cleanup_head = Cleanup_tail = NULL;
+	pthread_mutex_unlock(&Cleanup_mutex);
+
+	for (; batch != NULL; batch = next)
+	{
+	    next = batch->next;
+	    if ( (status = lpjs_remove_tree(AT_FDCWD, batch->path)) == 0 )
+		free(batch);
+	    else
+	    {
+		// Reuse the item to report the failure
+		batch->error = status;
+		pthread_mutex_lock(&Cleanup_mutex);
+		batch->next = Cleanup_failures;
+		Cleanup_failures = batch;
+		pthread_mutex_unlock(&Cleanup_mutex);
+	    }
+	}
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove a file or directory tree relative to dir_fd, like
+ *      rm -rf.  Symbolic links are removed, not followed.
+ *
+ *  Returns:
+ *      0 on success or if path does not exist, otherwise the errno
+ *      value of the first failure
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_remove_tree(int dir_fd, const char *path)
+
+{
+    struct stat     st;
+    struct dirent   *entry;
+    DIR             *dp;
+    int             fd, status = 0;
+
+    if ( fstatat(dir_fd, path, &st, AT_SYMLINK_NOFOLLOW) != 0 )
+	return errno == ENOENT ? 0 : errno;
+
+    if ( ! S_ISDIR(st.st_mode) )
+	return (unlinkat(dir_fd, path, 0) == 0) || (errno == ENOENT) ?
+		0 : errno;
+
+    if ( (fd = openat(dir_fd, path, O_RDONLY|O_DIRECTORY|O_NOFOLLOW)) == -1 )
+	return errno;
+    if ( (dp = fdopendir(fd)) == NULL )
+    {
+	status = errno;
+	close(fd);
+	return status;
+    }
+    while ( (entry = readdir(dp)) != NULL )
+    {
+	if ( (strcmp(entry->d_name, ".") == 0) ||
+	     (strcmp(entry->d_name, "..") == 0) )
+	    continue;
+	if ( (status = lpjs_remove_tree(fd, entry->d_name)) != 0 )
+	    break;
+    }
+    closedir(dp);   // Also closes fd
+
+    if ( status != 0 )
+	return status;
+    return (unlinkat(dir_fd, path, AT_REMOVEDIR) == 0) || (errno == ENOENT) ?
+	    0 : errno;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for cleanup_item_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+cleanup_item_t  *lpjs_cleanup_item_new(const char *path, int error)
+
+{
+    cleanup_item_t  *item;
+    size_t          len = strlen(path);
+
+    if ( (item = malloc(sizeof(*item) + len + 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    memcpy(item->path, path, len + 1);
+    item->error = error;
+    item->next = NULL;
+
+    return item;
+}
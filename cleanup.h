@@ -0,0 +1,14 @@
+#ifndef _LPJS_CLEANUP_H_
+#define _LPJS_CLEANUP_H_
+
+// Queued path, or failed removal reported to the main thread
+typedef struct cleanup_item
+{
+    struct cleanup_item *next;
+    int                 error;
+    char                path[];
+}   cleanup_item_t;
+
+#include "cleanup-protos.h"
+
+#endif  // _LPJS_CLEANUP_H_
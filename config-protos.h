@@ -1,3 +1,4 @@
 /* config.c */
 int lpjs_load_config(node_list_t *node_list, int flags, FILE *error_stream);
+void lpjs_load_config_value(FILE *config_fp, char *field, FILE *error_stream);
 int lpjs_load_compute_config(node_list_t *node_list, FILE *input_stream, const char *conf_file);
@@ -11,15 +11,30 @@
 #include "config.h"
 #include "misc.h"
 #include "lpjs.h"
+#include "pool.h"       // LPJS_POOL_THREADS_AUTO
 
 /***************************************************************************
  *  Description:
  *      Load LPJS config file, which contains the names of the head node
- *      and compute nodes.
+ *      and compute nodes, and optional settings saved in Config.
  *  
  *  History: 
  *  Date        Name        Modification
  *  2021-09-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add log-level and log-sync
+ *  2026-10-19  Jason Bacon Add metrics-file and metrics-interval
+ *  2026-10-19  Jason Bacon Add auth and auth-key-file
+ *  2026-10-19  Jason Bacon Add worker-threads
+ *  2026-10-19  Jason Bacon Add job-supervisor
+ *  2026-10-19  Jason Bacon Add checkin-rate
+ *  2026-10-19  Jason Bacon Add heartbeat-interval
+ *  2026-10-19  Jason Bacon Add reconnect-grace
+ *  2026-10-19  Jason Bacon Add telemetry-interval, memory-policy
+ *  2026-10-19  Jason Bacon Add oversubscribe-margin, oversubscribe-reserve
+ *  2026-10-19  Jason Bacon Add job-cgroups
+ *  2026-10-19  Jason Bacon Add cancel-grace
+ *  2026-10-19  Jason Bacon Add usage-interval
+ *  2026-10-19  Jason Bacon Add compd-socket-group
  ***************************************************************************/
 
 /*
@@ -36,6 +51,7 @@ int     lpjs_load_config(node_list_t *node_list, int flags, FILE *error_stream)
     char    config_file[PATH_MAX + 1];
     int     delim;
     size_t  len;
+    extern lpjs_config_t    Config;
     
     snprintf(config_file, PATH_MAX + 1, "%s/etc/lpjs/config", PREFIX);
     lpjs_log("%s(): Loading config file %s...\n", __FUNCTION__, config_file);
@@ -80,6 +96,226 @@ int     lpjs_load_config(node_list_t *node_list, int flags, FILE *error_stream)
 		    xt_dsv_skip_rest_of_line(config_fp);
 	    }
 	}
+	else if ( strcmp(field, "log-level") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "error") == 0 )
+		Config.log_level = LPJS_LOG_LEVEL_ERROR;
+	    else if ( strcmp(field, "normal") == 0 )
+		Config.log_level = LPJS_LOG_LEVEL_NORMAL;
+	    else if ( strcmp(field, "debug1") == 0 )
+		Config.log_level = LPJS_LOG_LEVEL_DEBUG1;
+	    else if ( strcmp(field, "debug2") == 0 )
+		Config.log_level = LPJS_LOG_LEVEL_DEBUG2;
+	    else
+	    {
+		fprintf(error_stream, "load_config(): log-level must be error, normal, debug1, or debug2.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "log-sync") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "always") == 0 )
+		Config.log_sync = LPJS_LOG_SYNC_ALWAYS;
+	    else if ( strcmp(field, "errors") == 0 )
+		Config.log_sync = LPJS_LOG_SYNC_ERRORS;
+	    else if ( xt_strisint(field, 10) && (atoi(field) > 0) )
+	    {
+		Config.log_sync = LPJS_LOG_SYNC_INTERVAL;
+		Config.log_sync_ms = atoi(field);
+	    }
+	    else
+	    {
+		fprintf(error_stream, "load_config(): log-sync must be always, errors, or milliseconds > 0.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "metrics-file") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( field[0] != '/' )
+	    {
+		fprintf(error_stream, "load_config(): metrics-file must be an absolute pathname.\n");
+		exit(EX_DATAERR);
+	    }
+	    strlcpy(Config.metrics_file, field, PATH_MAX + 1);
+	}
+	else if ( strcmp(field, "metrics-interval") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 1) )
+	    {
+		fprintf(error_stream, "load_config(): metrics-interval must be seconds > 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.metrics_interval = atoi(field);
+	}
+	else if ( strcmp(field, "auth") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "munge") == 0 )
+		Config.auth = LPJS_AUTH_MUNGE;
+	    else if ( strcmp(field, "hmac") == 0 )
+		Config.auth = LPJS_AUTH_HMAC;
+	    else if ( strcmp(field, "none") == 0 )
+		Config.auth = LPJS_AUTH_NONE;
+	    else
+	    {
+		fprintf(error_stream, "load_config(): auth must be munge, hmac, or none.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "auth-key-file") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( field[0] != '/' )
+	    {
+		fprintf(error_stream, "load_config(): auth-key-file must be an absolute pathname.\n");
+		exit(EX_DATAERR);
+	    }
+	    strlcpy(Config.auth_key_file, field, PATH_MAX + 1);
+	}
+	else if ( strcmp(field, "worker-threads") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "auto") == 0 )
+		Config.worker_threads = LPJS_POOL_THREADS_AUTO;
+	    else if ( xt_strisint(field, 10) && (atoi(field) >= 0) )
+		Config.worker_threads = atoi(field);
+	    else
+	    {
+		fprintf(error_stream, "load_config(): worker-threads must be auto or a number >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "job-supervisor") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "chaperone") == 0 )
+		Config.job_supervisor = LPJS_SUPERVISOR_CHAPERONE;
+	    else if ( strcmp(field, "compd") == 0 )
+		Config.job_supervisor = LPJS_SUPERVISOR_COMPD;
+	    else
+	    {
+		fprintf(error_stream, "load_config(): job-supervisor must be chaperone or compd.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "job-cgroups") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "yes") == 0 )
+		Config.job_cgroups = true;
+	    else if ( strcmp(field, "no") == 0 )
+		Config.job_cgroups = false;
+	    else
+	    {
+		fprintf(error_stream, "load_config(): job-cgroups must be yes or no.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "cancel-grace") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): cancel-grace must be seconds >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.cancel_grace = atoi(field);
+	}
+	else if ( strcmp(field, "usage-interval") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): usage-interval must be seconds >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.usage_interval = atoi(field);
+	}
+	else if ( strcmp(field, "compd-socket-group") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    strlcpy(Config.compd_socket_group, field, LPJS_FIELD_MAX + 1);
+	}
+	else if ( strcmp(field, "checkin-rate") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): checkin-rate must be checkins per second >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.checkin_rate = atoi(field);
+	}
+	else if ( strcmp(field, "heartbeat-interval") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): heartbeat-interval must be seconds >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.heartbeat_interval = atoi(field);
+	}
+	else if ( strcmp(field, "reconnect-grace") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): reconnect-grace must be seconds >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.reconnect_grace = atoi(field);
+	}
+	else if ( strcmp(field, "telemetry-interval") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): telemetry-interval must be seconds >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.telemetry_interval = atoi(field);
+	}
+	else if ( strcmp(field, "memory-policy") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( strcmp(field, "requested") == 0 )
+		Config.memory_policy = LPJS_MEMORY_REQUESTED;
+	    else if ( strcmp(field, "measured") == 0 )
+		Config.memory_policy = LPJS_MEMORY_MEASURED;
+	    else if ( strcmp(field, "oversubscribe") == 0 )
+		Config.memory_policy = LPJS_MEMORY_OVERSUBSCRIBE;
+	    else
+	    {
+		fprintf(error_stream, "load_config(): memory-policy must be requested, measured, or oversubscribe.\n");
+		exit(EX_DATAERR);
+	    }
+	}
+	else if ( strcmp(field, "oversubscribe-margin") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) )
+	    {
+		fprintf(error_stream, "load_config(): oversubscribe-margin must be a percentage >= 0.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.oversubscribe_margin = atoi(field);
+	}
+	else if ( strcmp(field, "oversubscribe-reserve") == 0 )
+	{
+	    lpjs_load_config_value(config_fp, field, error_stream);
+	    if ( ! xt_strisint(field, 10) || (atoi(field) < 0) ||
+		 (atoi(field) > 100) )
+	    {
+		fprintf(error_stream, "load_config(): oversubscribe-reserve must be a percentage from 0 to 100.\n");
+		exit(EX_DATAERR);
+	    }
+	    Config.oversubscribe_reserve = atoi(field);
+	}
 	else
 	{
 	    fprintf(error_stream, "Skipping unknown tag %s...", field);
@@ -94,6 +330,32 @@ int     lpjs_load_config(node_list_t *node_list, int flags, FILE *error_stream)
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Read the single value following a config tag.  The tag is
+ *      still in field, for the error message.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_load_config_value(FILE *config_fp, char *field, FILE *error_stream)
+
+{
+    char    tag[LPJS_FIELD_MAX + 1];
+    size_t  len;
+    
+    strlcpy(tag, field, LPJS_FIELD_MAX + 1);
+    if ( xt_dsv_read_field(config_fp, field, LPJS_FIELD_MAX + 1, " \t", &len)
+	 != '\n' )
+    {
+	fprintf(error_stream, "load_config(): '%s' must be followed by a single value.\n", tag);
+	exit(EX_DATAERR);
+    }
+}
+
+
 /***************************************************************************
  *  Use auto-c2man to generate a man page from this comment
  *
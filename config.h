@@ -2,17 +2,66 @@
 #define _LPJS_CONFIG_H_
 
 #include <limits.h>     // PATH_MAX
+#include <stdbool.h>
 
 #ifndef _NODE_LIST_H_
 #include "node-list.h"
 #endif
 
+#ifndef _LPJS_H_
+#include "lpjs.h"       // LPJS_FIELD_MAX
+#endif
+
 #define LPJS_CONFIG_ALL         0
 #define LPJS_CONFIG_HEAD_ONLY   1
 
+#ifndef _LPJS_MISC_H_
+#include "misc.h"       // log_sync_t
+#endif
+
+#ifndef _LPJS_AUTH_H_
+#include "auth.h"       // auth_backend_t
+#endif
+
+// Which process watches over running jobs on compute nodes
+typedef enum
+{
+    LPJS_SUPERVISOR_CHAPERONE,  // A chaperone process per job
+    LPJS_SUPERVISOR_COMPD       // lpjs_compd itself, see supervisor.c
+}   job_supervisor_t;
+
+// How dispatchd decides whether a job's memory fits on a node
+typedef enum
+{
+    LPJS_MEMORY_REQUESTED,  // Physical memory less that requested by jobs
+    LPJS_MEMORY_MEASURED,   // Also no more than available, see telemetry.c
+    LPJS_MEMORY_OVERSUBSCRIBE   // Jobs charged by measured peak, ditto
+}   memory_policy_t;
+
+// Settings from the config file other than node names
 typedef struct
 {
-    char    log_dir[PATH_MAX + 1];
+    char        log_dir[PATH_MAX + 1];
+    int         log_level;      // LPJS_LOG_LEVEL_*
+    log_sync_t  log_sync;
+    unsigned    log_sync_ms;    // For LPJS_LOG_SYNC_INTERVAL
+    char        metrics_file[PATH_MAX + 1]; // Empty for no periodic dump
+    unsigned    metrics_interval;           // Seconds between dumps
+    auth_backend_t  auth;
+    char        auth_key_file[PATH_MAX + 1];    // For LPJS_AUTH_HMAC
+    int         worker_threads; // dispatchd, or LPJS_POOL_THREADS_AUTO
+    job_supervisor_t    job_supervisor; // compd
+    unsigned    checkin_rate;   // dispatchd, per second, 0 = unlimited
+    unsigned    heartbeat_interval; // Seconds, 0 = no heartbeats
+    unsigned    reconnect_grace;    // dispatchd, seconds unreachable
+    unsigned    telemetry_interval; // Seconds, 0 = no telemetry
+    memory_policy_t memory_policy;  // dispatchd
+    unsigned    oversubscribe_margin;   // dispatchd, % added to job peaks
+    unsigned    oversubscribe_reserve;  // dispatchd, % of node memory
+    bool        job_cgroups;    // compd, where available, see cgroup.h
+    unsigned    cancel_grace;   // compd, seconds from SIGTERM to SIGKILL
+    unsigned    usage_interval; // compd, seconds between job samples, 0 = none
+    char        compd_socket_group[LPJS_FIELD_MAX + 1]; // compd, see relay.h
 }   lpjs_config_t;
 
 #include "config-protos.h"
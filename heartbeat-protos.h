@@ -0,0 +1,6 @@
+/* heartbeat.c */
+void lpjs_heartbeat_seen(node_t *node, bool beat);
+void lpjs_heartbeat_lost(node_t *node);
+void lpjs_heartbeat_schedule(node_t *node, time_t deadline, time_t now);
+heartbeat_event_t lpjs_heartbeat_next_event(node_t **event_node);
+struct timeval *lpjs_heartbeat_timeout(struct timeval *timeout, struct timeval *tick);
@@ -0,0 +1,272 @@
+/***************************************************************************
+ *  Description:
+ *      Compute node liveness for dispatchd, from heartbeats sent by
+ *      compd on its persistent connection.  See heartbeat.h.
+ *
+ *      Only the main dispatchd thread calls these functions.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+
+#include "lpjs.h"
+#include "misc.h"
+#include "config.h"
+#include "heartbeat.h"
+
+static heartbeat_slot_t Wheel[LPJS_HEARTBEAT_WHEEL_SLOTS];
+static size_t           Wheel_count = 0;    // Nodes in all slots
+static time_t           Wheel_time = 0,     // Next second to process
+			Last_check = 0,
+			Grace_until = 0;    // After an event loop stall
+
+/***************************************************************************
+ *  Description:
+ *      Note activity from a compute node.  beat is true for a
+ *      heartbeat, which starts watching the node if it is not
+ *      watched already, and false for any other message, which only
+ *      counts for nodes already watched.  A suspect node that is
+ *      heard from again is back up.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_heartbeat_seen(node_t *node, bool beat)
+
+{
+    extern lpjs_config_t    Config;
+    time_t                  now;
+    
+    if ( (Config.heartbeat_interval == 0) ||
+	 (! beat && (node_get_last_ping(node) == 0)) )
+	return;
+    
+    now = time(NULL);
+    node_set_last_ping(node, now);
+    if ( strcmp(node_get_state(node), "suspect") == 0 )
+    {
+	lpjs_log("%s(): %s is responding again.\n", __FUNCTION__,
+		 node_get_hostname(node));
+	node_set_state(node, "up");
+    }
+    if ( node_get_heartbeat_slot(node) == LPJS_HEARTBEAT_NOT_WATCHED )
+	lpjs_heartbeat_schedule(node, now + LPJS_HEARTBEAT_SUSPECT_BEATS *
+				Config.heartbeat_interval, now);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Watch a node that has just been marked unreachable, so it can
+ *      be marked down if it does not check in again within
+ *      reconnect-grace seconds of when it was last heard from.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_heartbeat_lost(node_t *node)
+
+{
+    extern lpjs_config_t    Config;
+    time_t                  now;
+    
+    // Not watched for heartbeats, so the connection was all we had
+    now = time(NULL);
+    if ( node_get_last_ping(node) == 0 )
+	node_set_last_ping(node, now);
+    if ( node_get_heartbeat_slot(node) == LPJS_HEARTBEAT_NOT_WATCHED )
+	lpjs_heartbeat_schedule(node, node_get_last_ping(node) +
+				Config.reconnect_grace, now);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Put a node in the wheel slot for deadline.  Deadlines beyond
+ *      the wheel go in the last slot ahead, and are put back when
+ *      that comes up.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_heartbeat_schedule(node_t *node, time_t deadline, time_t now)
+
+{
+    heartbeat_slot_t    *slot;
+    size_t              index;
+    
+    // Nothing is due before now, so skip the idle seconds
+    if ( Wheel_count == 0 )
+	Wheel_time = Last_check = now;
+    
+    // Never the slot being processed, or past a full turn
+    if ( deadline <= Wheel_time )
+	deadline = Wheel_time + 1;
+    else if ( deadline >= Wheel_time + LPJS_HEARTBEAT_WHEEL_SLOTS )
+	deadline = Wheel_time + LPJS_HEARTBEAT_WHEEL_SLOTS - 1;
+    
+    index = deadline % LPJS_HEARTBEAT_WHEEL_SLOTS;
+    slot = &Wheel[index];
+    if ( slot->count == slot->array_size )
+    {
+	slot->array_size = slot->array_size == 0 ? 16 : slot->array_size * 2;
+	slot->nodes = realloc(slot->nodes,
+			      slot->array_size * sizeof(*slot->nodes));
+	if ( slot->nodes == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    slot->nodes[slot->count++] = node;
+    node_set_heartbeat_slot(node, index);
+    ++Wheel_count;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Advance the wheel to the current time, returning the next node
+ *      that has missed too many heartbeats, or has been unreachable
+ *      too long.  Call until it returns LPJS_HEARTBEAT_NONE.  A node
+ *      that is suspect is put back for the lost deadline, and one
+ *      that is unreachable for the end of its grace period.  Nodes
+ *      that have checked in again since their last heartbeat leave
+ *      the wheel, and are watched again from their next heartbeat.
+ *
+ *      If dispatchd itself has not checked for a while, heartbeats
+ *      may be waiting unread, so no node is judged until one more
+ *      interval has passed.
+ *
+ *  Returns:
+ *      LPJS_HEARTBEAT_SUSPECT, LPJS_HEARTBEAT_LOST, or
+ *      LPJS_HEARTBEAT_DOWN with *event_node set, or LPJS_HEARTBEAT_NONE
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Grace period for unreachable nodes
+ ***************************************************************************/
+
+heartbeat_event_t   lpjs_heartbeat_next_event(node_t **event_node)
+
+{
+    extern lpjs_config_t    Config;
+    heartbeat_slot_t        *slot;
+    node_t                  *node;
+    time_t                  now, last_ping, stall,
+			    suspect_time, lost_time, down_time;
+    
+    if ( Wheel_count == 0 )
+	return LPJS_HEARTBEAT_NONE;
+    
+    // Unreachable nodes are watched even without heartbeats
+    stall = Config.heartbeat_interval > 0 ? Config.heartbeat_interval :
+	    LPJS_HEARTBEAT_INTERVAL;
+    now = time(NULL);
+    if ( (Last_check != 0) && (now - Last_check > stall) )
+    {
+	lpjs_log("%s(): Warning: No check for %ld seconds.  Holding off until heartbeats are read.\n",
+		 __FUNCTION__, (long)(now - Last_check));
+	Grace_until = now + stall;
+    }
+    Last_check = now;
+    
+    while ( Wheel_time <= now )
+    {
+	slot = &Wheel[Wheel_time % LPJS_HEARTBEAT_WHEEL_SLOTS];
+	while ( slot->count > 0 )
+	{
+	    node = slot->nodes[--slot->count];
+	    --Wheel_count;
+	    node_set_heartbeat_slot(node, LPJS_HEARTBEAT_NOT_WATCHED);
+	    
+	    last_ping = node_get_last_ping(node);
+	    if ( last_ping == 0 )
+		continue;
+	    
+	    if ( node_get_msg_fd(node) == NODE_MSG_FD_NOT_OPEN )
+	    {
+		// Marked down already, e.g. by a failed dispatch
+		if ( strcmp(node_get_state(node), "unreachable") != 0 )
+		    continue;
+		down_time = last_ping + Config.reconnect_grace;
+		if ( now < Grace_until )
+		    lpjs_heartbeat_schedule(node, Grace_until, now);
+		else if ( now < down_time )
+		    lpjs_heartbeat_schedule(node, down_time, now);
+		else
+		{
+		    *event_node = node;
+		    return LPJS_HEARTBEAT_DOWN;
+		}
+		continue;
+	    }
+	    
+	    suspect_time = last_ping + LPJS_HEARTBEAT_SUSPECT_BEATS *
+			   Config.heartbeat_interval;
+	    lost_time = last_ping + LPJS_HEARTBEAT_DOWN_BEATS *
+			Config.heartbeat_interval;
+	    if ( now < Grace_until )
+		lpjs_heartbeat_schedule(node, Grace_until, now);
+	    else if ( now < suspect_time )
+		lpjs_heartbeat_schedule(node, suspect_time, now);
+	    else if ( now < lost_time )
+	    {
+		lpjs_heartbeat_schedule(node, lost_time, now);
+		*event_node = node;
+		return LPJS_HEARTBEAT_SUSPECT;
+	    }
+	    else
+	    {
+		*event_node = node;
+		return LPJS_HEARTBEAT_LOST;
+	    }
+	}
+	++Wheel_time;
+    }
+    
+    return LPJS_HEARTBEAT_NONE;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Shorten a select() timeout to the next wheel tick while any
+ *      nodes are watched.  tick is storage for the new timeout.
+ *
+ *  Returns:
+ *      timeout or tick, whichever is sooner.  timeout may be
+ *      LPJS_NO_SELECT_TIMEOUT.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Also tick for unreachable nodes
+ ***************************************************************************/
+
+struct timeval  *lpjs_heartbeat_timeout(struct timeval *timeout,
+					struct timeval *tick)
+
+{
+    if ( Wheel_count == 0 )
+	return timeout;
+    
+    tick->tv_sec = 1;
+    tick->tv_usec = 0;
+    if ( (timeout != LPJS_NO_SELECT_TIMEOUT) && (timeout->tv_sec < 1) )
+	return timeout;
+    return tick;
+}
@@ -0,0 +1,58 @@
+#ifndef _LPJS_HEARTBEAT_H_
+#define _LPJS_HEARTBEAT_H_
+
+#include <stdbool.h>
+#include <time.h>
+#include <sys/time.h>   // struct timeval
+
+#ifndef _LPJS_NODE_H_
+#include "node.h"
+#endif
+
+/*
+ *  Compute node liveness.  compd sends LPJS_HEARTBEAT every
+ *  heartbeat-interval seconds (see network.h), and dispatchd records
+ *  the time in the node's last_ping.  A node that misses
+ *  LPJS_HEARTBEAT_SUSPECT_BEATS intervals is marked "suspect" and gets
+ *  no new jobs.  After LPJS_HEARTBEAT_DOWN_BEATS its connection is
+ *  closed and it is marked "unreachable", as is a node whose
+ *  connection is lost.  An unreachable node keeps its jobs and
+ *  resources for reconnect-grace seconds after it was last heard
+ *  from, so that a compd that checks in again within that time
+ *  resumes where it left off.  After that it is marked "down" and its
+ *  jobs' resources are released.
+ *
+ *  Deadlines are kept in a timer wheel of one-second slots.  Each
+ *  watched node is in exactly one slot, and a heartbeat only updates
+ *  last_ping, so the cost is constant per heartbeat and per node
+ *  whose deadline comes up.  A node whose deadline has moved on is
+ *  simply put back in the slot for its new deadline.  Nodes are
+ *  watched from their first heartbeat, so compute nodes running an
+ *  older compd are never marked down for lack of them.
+ */
+
+#define LPJS_HEARTBEAT_INTERVAL         5   // Seconds, default
+#define LPJS_HEARTBEAT_SUSPECT_BEATS    2
+#define LPJS_HEARTBEAT_DOWN_BEATS       5
+#define LPJS_HEARTBEAT_WHEEL_SLOTS      64  // Seconds, power of 2
+#define LPJS_HEARTBEAT_NOT_WATCHED      -1  // node heartbeat_slot
+#define LPJS_RECONNECT_GRACE            60  // Seconds, default
+
+typedef enum
+{
+    LPJS_HEARTBEAT_NONE = 0,
+    LPJS_HEARTBEAT_SUSPECT,     // Missed LPJS_HEARTBEAT_SUSPECT_BEATS
+    LPJS_HEARTBEAT_LOST,        // Missed LPJS_HEARTBEAT_DOWN_BEATS
+    LPJS_HEARTBEAT_DOWN         // Unreachable past reconnect-grace
+}   heartbeat_event_t;
+
+typedef struct
+{
+    node_t  **nodes;
+    size_t  count;
+    size_t  array_size;
+}   heartbeat_slot_t;
+
+#include "heartbeat-protos.h"
+
+#endif  // _LPJS_HEARTBEAT_H_
@@ -0,0 +1,7 @@
+/* history.c */
+int main(int argc, char *argv[]);
+time_t history_parse_time(const char *str);
+void history_print_record(const accounting_record_t *rec, void *arg);
+void history_print_usage(const accounting_record_t *rec, void *arg);
+void history_format_time(int64_t stamp, char *buff, size_t buff_size);
+void usage(char *argv[]);
@@ -0,0 +1,272 @@
+/***************************************************************************
+ *  Description:
+ *      List finished jobs from the accounting log written by
+ *      lpjs_dispatchd.  Reads the log directly, so it must run on the
+ *      head node.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add --usage
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sysexits.h>
+#include <time.h>
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "accounting.h"
+#include "job-usage.h"
+#include "history-protos.h"
+
+#define HISTORY_HEADER \
+    "    JobID  IDX User         Compute-node     Submitted   Started     Ended       Elapsed     Status P/J MiB/P Script\n"
+#define HISTORY_USAGE_HEADER \
+    "    JobID  IDX User         Elapsed      P/J  CPU-sec  CPU% MiB/J Peak-MiB  Mem% Read-MiB Write-MiB Threads\n"
+#define HISTORY_TIME_FORMAT "%m-%d %H:%M"
+#define HISTORY_TIME_MAX    32
+#define HISTORY_SECONDS_PER_DAY 86400
+
+int     main(int argc, char *argv[])
+
+{
+    accounting_filter_t filter;
+    accounting_map_t    map;
+    uint64_t            matches;
+    time_t              now = time(NULL);
+    int                 c;
+    char                *end;
+    bool                show_usage = false;
+    extern FILE         *Log_stream;
+
+    // Shared functions may use lpjs_log
+    Log_stream = stderr;
+
+    // Default: All users, jobs ended within the past day
+    filter.since = now - HISTORY_SECONDS_PER_DAY;
+    filter.until = INT64_MAX;
+    filter.user_name = NULL;
+    filter.job_id = 0;
+
+    for (c = 1; c < argc; ++c)
+    {
+	if ( strcmp(argv[c], "--usage") == 0 )
+	{
+	    show_usage = true;
+	    continue;
+	}
+	if ( c == argc - 1 )
+	    usage(argv);
+	if ( strcmp(argv[c], "--user") == 0 )
+	    filter.user_name = argv[++c];
+	else if ( strcmp(argv[c], "--job") == 0 )
+	{
+	    filter.job_id = strtoul(argv[++c], &end, 10);
+	    if ( (*end != '\0') || (filter.job_id == 0) )
+		usage(argv);
+	    // Job ID alone means whenever it ended
+	    filter.since = INT64_MIN;
+	}
+	else if ( strcmp(argv[c], "--days") == 0 )
+	{
+	    filter.since = now - strtol(argv[++c], &end, 10) *
+			   HISTORY_SECONDS_PER_DAY;
+	    if ( *end != '\0' )
+		usage(argv);
+	}
+	else if ( strcmp(argv[c], "--since") == 0 )
+	{
+	    if ( (filter.since = history_parse_time(argv[++c])) == -1 )
+		usage(argv);
+	}
+	else if ( strcmp(argv[c], "--until") == 0 )
+	{
+	    if ( (filter.until = history_parse_time(argv[++c])) == -1 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    if ( lpjs_accounting_map(&map) != LPJS_SUCCESS )
+    {
+	fprintf(stderr, "%s: Cannot read %s.  Run on the head node.\n",
+		argv[0], LPJS_HISTORY_RECORDS);
+	return EX_NOINPUT;
+    }
+
+    if ( show_usage )
+    {
+	fputs(HISTORY_USAGE_HEADER, stdout);
+	matches = lpjs_accounting_query(&map, &filter, history_print_usage,
+					stdout);
+    }
+    else
+    {
+	fputs(HISTORY_HEADER, stdout);
+	matches = lpjs_accounting_query(&map, &filter, history_print_record,
+					stdout);
+    }
+    lpjs_accounting_unmap(&map);
+    printf("\n%ju jobs\n", (uintmax_t)matches);
+
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert "YYYY-MM-DD" or "YYYY-MM-DD HH:MM" in local time
+ *
+ *  Returns:
+ *      Seconds since the epoch, or -1 if str is malformed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+time_t  history_parse_time(const char *str)
+
+{
+    struct tm   tm;
+    int         items;
+
+    memset(&tm, 0, sizeof(tm));
+    items = sscanf(str, "%d-%d-%d %d:%d", &tm.tm_year, &tm.tm_mon,
+		   &tm.tm_mday, &tm.tm_hour, &tm.tm_min);
+    if ( (items != 3) && (items != 5) )
+	return -1;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;   // Let mktime() decide
+
+    return mktime(&tm);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print one accounting record, called by lpjs_accounting_query()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    history_print_record(const accounting_record_t *rec, void *arg)
+
+{
+    FILE        *stream = arg;
+    char        submitted[HISTORY_TIME_MAX + 1],
+		started[HISTORY_TIME_MAX + 1],
+		ended[HISTORY_TIME_MAX + 1],
+		elapsed[HISTORY_TIME_MAX + 1],
+		status[HISTORY_TIME_MAX + 1];
+    static const char   *dispositions[] =
+			{ "done", "canceled", "failed", "lost" };
+
+    history_format_time(rec->submit_time, submitted, HISTORY_TIME_MAX + 1);
+    history_format_time(rec->start_time, started, HISTORY_TIME_MAX + 1);
+    history_format_time(rec->end_time, ended, HISTORY_TIME_MAX + 1);
+
+    if ( rec->start_time == 0 )
+	strlcpy(elapsed, "-", HISTORY_TIME_MAX + 1);
+    else
+	job_usage_elapsed_str(rec->end_time - rec->start_time, elapsed,
+			      HISTORY_TIME_MAX + 1);
+
+    if ( rec->disposition == ACCOUNTING_COMPLETED )
+	snprintf(status, HISTORY_TIME_MAX + 1, "%d", rec->exit_status);
+    else if ( (rec->disposition >= 0) && (rec->disposition <= ACCOUNTING_LOST) )
+	strlcpy(status, dispositions[rec->disposition], HISTORY_TIME_MAX + 1);
+    else
+	strlcpy(status, "?", HISTORY_TIME_MAX + 1);
+
+    fprintf(stream, "%9ju %4ju %-12s %-16s %-11s %-11s %-11s %11s %8s %3u %5ju %s\n",
+	    (uintmax_t)rec->job_id, (uintmax_t)rec->array_index,
+	    rec->user_name, rec->compute_node, submitted, started, ended,
+	    elapsed, status, rec->procs_per_job,
+	    (uintmax_t)rec->pmem_per_proc, rec->script_name);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print measured resource use and efficiency from one accounting
+ *      record, for --usage.  See job-usage.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    history_print_usage(const accounting_record_t *rec, void *arg)
+
+{
+    FILE        *stream = arg;
+    char        elapsed[HISTORY_TIME_MAX + 1],
+		cpu_pct[JOB_USAGE_PCT_MAX + 1],
+		mem_pct[JOB_USAGE_PCT_MAX + 1];
+    int64_t     seconds = 0;
+    uint64_t    mem_MiB = rec->procs_per_job * rec->pmem_per_proc;
+
+    if ( rec->start_time == 0 )
+	strlcpy(elapsed, "-", HISTORY_TIME_MAX + 1);
+    else
+    {
+	seconds = rec->end_time - rec->start_time;
+	job_usage_elapsed_str(seconds, elapsed, HISTORY_TIME_MAX + 1);
+    }
+    job_usage_pct_str(rec->used_cpu_sec, (double)seconds * rec->procs_per_job,
+		      cpu_pct, JOB_USAGE_PCT_MAX + 1);
+    job_usage_pct_str(rec->used_max_rss_MiB, mem_MiB, mem_pct,
+		      JOB_USAGE_PCT_MAX + 1);
+
+    fprintf(stream, "%9ju %4ju %-12s %-12s %3u %8ju %5s %5ju %8ju %5s %8ju %9ju %7u\n",
+	    (uintmax_t)rec->job_id, (uintmax_t)rec->array_index,
+	    rec->user_name, elapsed, rec->procs_per_job,
+	    (uintmax_t)rec->used_cpu_sec, cpu_pct, (uintmax_t)mem_MiB,
+	    (uintmax_t)rec->used_max_rss_MiB, mem_pct,
+	    (uintmax_t)(rec->used_read_bytes / 1024 / 1024),
+	    (uintmax_t)(rec->used_write_bytes / 1024 / 1024),
+	    rec->used_max_threads);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format a time stamp for history output, "-" if not set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    history_format_time(int64_t stamp, char *buff, size_t buff_size)
+
+{
+    time_t      t = stamp;
+    struct tm   tm;
+
+    if ( stamp == 0 )
+	strlcpy(buff, "-", buff_size);
+    else
+	strftime(buff, buff_size, HISTORY_TIME_FORMAT, localtime_r(&t, &tm));
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--user name] [--job id] [--days N]\n"
+		    "       [--since YYYY-MM-DD[ HH:MM]] [--until YYYY-MM-DD[ HH:MM]]\n"
+		    "       [--usage]\n",
+		    argv[0]);
+    exit(EX_USAGE);
+}
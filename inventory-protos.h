@@ -0,0 +1,10 @@
+/* inventory.c */
+inventory_t *inventory_new(void);
+void inventory_add(inventory_t *inventory, const inventory_entry_t *entry);
+size_t inventory_find(inventory_t *inventory, unsigned long job_id);
+void inventory_remove(inventory_t *inventory, unsigned long job_id);
+unsigned inventory_prune(inventory_t *inventory);
+char *inventory_to_str(inventory_t *inventory, char *str, size_t buff_len);
+ssize_t inventory_from_str(inventory_t *inventory, const char *str);
+int inventory_save(inventory_t *inventory, const char *path);
+int inventory_load(inventory_t *inventory, const char *path);
@@ -0,0 +1,346 @@
+/***************************************************************************
+ *  Description:
+ *      Inventory of live chaperones on a compute node.
+ *
+ *      lpjs_compd records each chaperone it forks and reports the
+ *      inventory with every checkin, so that dispatchd can reconcile
+ *      its running jobs and node usage with what is actually running
+ *      on the node.  Chaperones keep running while compd is down, so
+ *      compd also saves the inventory under LPJS_RUN_DIR and reloads
+ *      it on restart.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>     // kill()
+#include <limits.h>     // PATH_MAX
+
+#include "lpjs.h"
+#include "inventory.h"
+#include "misc.h"
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for inventory_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+inventory_t *inventory_new(void)
+
+{
+    inventory_t *inventory;
+
+    if ( (inventory = malloc(sizeof(*inventory))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    inventory->count = 0;
+    inventory->array_size = 0;
+    inventory->entries = NULL;
+
+    return inventory;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a chaperone to the inventory
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    inventory_add(inventory_t *inventory, const inventory_entry_t *entry)
+
+{
+    if ( inventory->count == inventory->array_size )
+    {
+	inventory->array_size = (inventory->array_size == 0) ? 64 :
+				inventory->array_size * 2;
+	inventory->entries = realloc(inventory->entries,
+			inventory->array_size * sizeof(*inventory->entries));
+	if ( inventory->entries == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    inventory->entries[inventory->count++] = *entry;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find the entry for a job
+ *
+ *  Returns:
+ *      Index of the entry, or INVENTORY_NOT_FOUND
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  inventory_find(inventory_t *inventory, unsigned long job_id)
+
+{
+    size_t  c;
+
+    for (c = 0; c < inventory->count; ++c)
+	if ( inventory->entries[c].job_id == job_id )
+	    return c;
+
+    return INVENTORY_NOT_FOUND;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the entry for a job, once its completion is reported
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    inventory_remove(inventory_t *inventory, unsigned long job_id)
+
+{
+    size_t  c;
+
+    if ( (c = inventory_find(inventory, job_id)) != INVENTORY_NOT_FOUND )
+	inventory->entries[c] = inventory->entries[--inventory->count];
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove entries for chaperones that no longer exist.  A chaperone
+ *      is live until it has sent its completion report to dispatchd
+ *      and exited, so a job missing from the inventory will never
+ *      report again.
+ *
+ *  Returns:
+ *      The number of entries removed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    inventory_prune(inventory_t *inventory)
+
+{
+    size_t      c, kept;
+    unsigned    removed = 0;
+
+    for (c = kept = 0; c < inventory->count; ++c)
+    {
+	// EPERM means the PID exists, though owned by someone else
+	if ( (kill(inventory->entries[c].chaperone_pid, 0) == 0) ||
+	     (errno != ESRCH) )
+	    inventory->entries[kept++] = inventory->entries[c];
+	else
+	{
+	    lpjs_log("%s(): Job %lu chaperone %d has exited.\n", __FUNCTION__,
+		     inventory->entries[c].job_id,
+		     inventory->entries[c].chaperone_pid);
+	    ++removed;
+	}
+    }
+    inventory->count = kept;
+
+    return removed;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert inventory to text for the checkin message or save file
+ *
+ *  Returns:
+ *      str, or NULL if the inventory does not fit in buff_len
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add uid
+ ***************************************************************************/
+
+char    *inventory_to_str(inventory_t *inventory, char *str, size_t buff_len)
+
+{
+    size_t              c, len;
+    inventory_entry_t   *entry;
+
+    len = snprintf(str, buff_len, "%zu\n", inventory->count);
+    for (c = 0; (c < inventory->count) && (len < buff_len); ++c)
+    {
+	entry = &inventory->entries[c];
+	len += snprintf(str + len, buff_len - len, "%lu %d %d %u %zu %u\n",
+			entry->job_id, entry->chaperone_pid, entry->job_pid,
+			entry->procs, entry->pmem_per_proc,
+			(unsigned)entry->uid);
+    }
+
+    return len < buff_len ? str : NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Replace inventory contents with entries parsed from text
+ *      produced by inventory_to_str()
+ *
+ *  Returns:
+ *      The number of entries, or -1 if str is malformed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add uid
+ ***************************************************************************/
+
+ssize_t inventory_from_str(inventory_t *inventory, const char *str)
+
+{
+    inventory_entry_t   entry;
+    unsigned long       count, c;
+    char                *end;
+    int                 chars;
+    unsigned            uid;
+
+    inventory->count = 0;
+    count = strtoul(str, &end, 10);
+    if ( (end == str) || (*end != '\n') )
+	return -1;
+    str = end + 1;
+
+    for (c = 0; c < count; ++c)
+    {
+	if ( sscanf(str, "%lu %d %d %u %zu %u\n%n", &entry.job_id,
+		    &entry.chaperone_pid, &entry.job_pid, &entry.procs,
+		    &entry.pmem_per_proc, &uid, &chars) != 6 )
+	{
+	    inventory->count = 0;
+	    return -1;
+	}
+	entry.uid = uid;
+	inventory_add(inventory, &entry);
+	str += chars;
+    }
+
+    return inventory->count;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Save inventory to path, replacing it atomically
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     inventory_save(inventory_t *inventory, const char *path)
+
+{
+    char    *buff,
+	    temp_path[PATH_MAX + 1];
+    size_t  buff_len;
+    int     fd, status;
+
+    buff_len = INVENTORY_ENTRY_MAX_LEN * (inventory->count + 1);
+    if ( (buff = malloc(buff_len)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    inventory_to_str(inventory, buff, buff_len);
+
+    snprintf(temp_path, PATH_MAX + 1, "%s.new", path);
+    if ( (fd = open(temp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	free(buff);
+	return LPJS_WRITE_FAILED;
+    }
+    status = lpjs_write_all(fd, buff, strlen(buff));
+    close(fd);
+    free(buff);
+    if ( (status != 0) || (rename(temp_path, path) != 0) )
+    {
+	lpjs_log("%s(): Error: Cannot save %s: %s\n", __FUNCTION__,
+		 path, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Load inventory saved by inventory_save().  A missing file
+ *      is an empty inventory.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     inventory_load(inventory_t *inventory, const char *path)
+
+{
+    FILE    *fp;
+    char    *buff;
+    long    size;
+
+    inventory->count = 0;
+    if ( (fp = fopen(path, "r")) == NULL )
+	return errno == ENOENT ? LPJS_SUCCESS : LPJS_READ_FAILED;
+
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    rewind(fp);
+    if ( (buff = malloc(size + 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    buff[fread(buff, 1, size, fp)] = '\0';
+    fclose(fp);
+
+    if ( inventory_from_str(inventory, buff) < 0 )
+    {
+	lpjs_log("%s(): Error: %s is corrupt.  Ignoring.\n",
+		 __FUNCTION__, path);
+	free(buff);
+	return LPJS_READ_FAILED;
+    }
+    free(buff);
+
+    return LPJS_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#ifndef _LPJS_INVENTORY_H_
+#define _LPJS_INVENTORY_H_
+
+#include <sys/types.h>  // pid_t
+
+/*
+ *  Live chaperones on a compute node, reported by lpjs_compd with each
+ *  checkin.  Text form, following the node specs in the checkin message:
+ *
+ *      count
+ *      job-id chaperone-pid job-pid procs pmem-per-proc uid
+ *      ...
+ *
+ *  job-pid is 0 if not known to compd.  uid is the user the job runs
+ *  as, the only one besides root whose reports on LPJS_COMPD_SOCKET
+ *  are accepted for it.  See relay.c.  For jobs supervised by compd
+ *  itself, chaperone-pid is the script PID, the same as job-pid, until
+ *  the script exits, and then compd's own PID until the completion
+ *  report is sent.  See supervisor.c.
+ */
+
+typedef struct
+{
+    unsigned long   job_id;
+    pid_t           chaperone_pid;
+    pid_t           job_pid;
+    unsigned        procs;
+    size_t          pmem_per_proc;  // MiB
+    uid_t           uid;            // Job owner, see relay.c
+}   inventory_entry_t;
+
+typedef struct
+{
+    size_t              count;
+    size_t              array_size;
+    inventory_entry_t   *entries;
+}   inventory_t;
+
+#define INVENTORY_NOT_FOUND     ((size_t)-1)
+#define INVENTORY_ENTRY_MAX_LEN 128
+
+#include "inventory-protos.h"
+
+#endif  // _LPJS_INVENTORY_H_
@@ -320,6 +320,348 @@ job_state_t    job_get_state(job_t *job_ptr)
 }
 
 
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for submit_time member in a job_t structure.
+ *      Use this function to get submit_time in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member submit_time.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      time_t          submit_time;
+ *
+ *      submit_time = job_get_submit_time(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+time_t    job_get_submit_time(job_t *job_ptr)
+
+{
+    return job_ptr->submit_time;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for start_time member in a job_t structure.
+ *      Use this function to get start_time in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member start_time.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      time_t          start_time;
+ *
+ *      start_time = job_get_start_time(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+time_t    job_get_start_time(job_t *job_ptr)
+
+{
+    return job_ptr->start_time;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for timing member in a job_t structure.
+ *      Use this function to get timing in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member timing.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      int64_t *       timing;
+ *
+ *      timing = job_get_timing(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int64_t * job_get_timing(job_t *job_ptr)
+
+{
+    return job_ptr->timing;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for an array element of timing member in a job_t
+ *      structure. Use this function to get job_ptr->timing[c]
+ *      in a job_t object from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to get
+ *      c               Subscript to the timing array
+ *
+ *  Returns:
+ *      Value of one element of structure member timing.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      size_t          c;
+ *      int64_t         timing_element;
+ *
+ *      timing_element = job_get_timing_ae(&job, c);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int64_t   job_get_timing_ae(job_t *job_ptr, size_t c)
+
+{
+    return job_ptr->timing[c];
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for pending_reason member in a job_t structure.
+ *      Use this function to get pending_reason in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member pending_reason.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      job_pending_reason_t pending_reason;
+ *
+ *      pending_reason = job_get_pending_reason(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+job_pending_reason_t    job_get_pending_reason(job_t *job_ptr)
+
+{
+    return job_ptr->pending_reason;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for peak_rss_MiB member in a job_t structure.
+ *      Use this function to get peak_rss_MiB in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member peak_rss_MiB.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      size_t          peak_rss_MiB;
+ *
+ *      peak_rss_MiB = job_get_peak_rss_MiB(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+size_t  job_get_peak_rss_MiB(job_t *job_ptr)
+
+{
+    return job_ptr->peak_rss_MiB;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for cpu_sec member in a job_t structure.
+ *      Use this function to get cpu_sec in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member cpu_sec.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      double          cpu_sec;
+ *
+ *      cpu_sec = job_get_cpu_sec(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+double  job_get_cpu_sec(job_t *job_ptr)
+
+{
+    return job_ptr->cpu_sec;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for read_bytes member in a job_t structure.
+ *      Use this function to get read_bytes in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member read_bytes.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      uint64_t        read_bytes;
+ *
+ *      read_bytes = job_get_read_bytes(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+uint64_t    job_get_read_bytes(job_t *job_ptr)
+
+{
+    return job_ptr->read_bytes;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for write_bytes member in a job_t structure.
+ *      Use this function to get write_bytes in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member write_bytes.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      uint64_t        write_bytes;
+ *
+ *      write_bytes = job_get_write_bytes(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+uint64_t    job_get_write_bytes(job_t *job_ptr)
+
+{
+    return job_ptr->write_bytes;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for peak_threads member in a job_t structure.
+ *      Use this function to get peak_threads in a job_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member peak_threads.
+ *
+ *  Examples:
+ *      job_t           job;
+ *      unsigned        peak_threads;
+ *
+ *      peak_threads = job_get_peak_threads(&job);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+unsigned    job_get_peak_threads(job_t *job_ptr)
+
+{
+    return job_ptr->peak_threads;
+}
+
+
 /***************************************************************************
  *  Library:
  *      #include <job.h>
@@ -23,6 +23,16 @@ size_t job_get_pmem_per_proc(job_t *job_ptr);
 pid_t job_get_chaperone_pid(job_t *job_ptr);
 pid_t job_get_job_pid(job_t *job_ptr);
 job_state_t job_get_state(job_t *job_ptr);
+time_t job_get_submit_time(job_t *job_ptr);
+time_t job_get_start_time(job_t *job_ptr);
+int64_t *job_get_timing(job_t *job_ptr);
+int64_t job_get_timing_ae(job_t *job_ptr, size_t c);
+job_pending_reason_t job_get_pending_reason(job_t *job_ptr);
+size_t job_get_peak_rss_MiB(job_t *job_ptr);
+double job_get_cpu_sec(job_t *job_ptr);
+uint64_t job_get_read_bytes(job_t *job_ptr);
+uint64_t job_get_write_bytes(job_t *job_ptr);
+unsigned job_get_peak_threads(job_t *job_ptr);
 char *job_get_user_name(job_t *job_ptr);
 char job_get_user_name_ae(job_t *job_ptr, size_t c);
 char *job_get_primary_group_name(job_t *job_ptr);
@@ -10,6 +10,7 @@
 #include "job-list-private.h"
 #include "lpjs.h"
 #include "misc.h"           // lpjs_log()
+#include "logger.h"         // lpjs_log_enabled()
 
 
 /***************************************************************************
@@ -104,8 +105,8 @@ job_t   *job_list_remove_job(job_list_t *job_list, unsigned long job_id)
 
 {
     size_t  job_array_index;
-    extern FILE *Log_stream;
     job_t   *job;
+    char    specs[JOB_STR_MAX_LEN + 1];
     
     job_array_index = job_list_find_job_id(job_list, job_id);
     if ( job_array_index == JOB_LIST_NOT_FOUND )
@@ -113,13 +114,14 @@ job_t   *job_list_remove_job(job_list_t *job_list, unsigned long job_id)
     
     // lpjs_debug("%s(): Removing job %lu from list\n", __FUNCTION__, job_id);
     job = job_list->jobs[job_array_index];
-    job_print_full_specs(job, Log_stream);
+    if ( lpjs_log_enabled(LPJS_LOG_LEVEL_DEBUG2) )
+    {
+	job_print_to_string(job, specs, JOB_STR_MAX_LEN + 1);
+	lpjs_debug("%s(): %s", __FUNCTION__, specs);
+    }
     
     for (int c = job_array_index; c < job_list->count - 1; ++c)
-    {
-	fflush(Log_stream);
 	job_list->jobs[c] = job_list->jobs[c + 1];
-    }
     --job_list->count;
 
     return job;
@@ -128,21 +130,116 @@ job_t   *job_list_remove_job(job_list_t *job_list, unsigned long job_id)
 
 /***************************************************************************
  *  Description:
- *      Send current jobs to msg_fd in human-readable format
+ *      Add current jobs to a reply in human-readable format
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-28  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ ***************************************************************************/
+
+void    job_list_reply_params(pool_task_t *reply, job_list_t *job_list)
+
+{
+    unsigned    c;
+
+    job_reply_basic_params_header(reply);
+    for (c = 0; c < job_list->count; ++c)
+	job_reply_basic_params(job_list->jobs[c], reply);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add launch latency breakdown of current jobs to a reply
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
  ***************************************************************************/
 
-void    job_list_send_params(int msg_fd, job_list_t *job_list)
+void    job_list_reply_timing(pool_task_t *reply, job_list_t *job_list)
 
 {
     unsigned    c;
 
-    job_send_basic_params_header(msg_fd);
+    job_reply_timing_header(reply);
     for (c = 0; c < job_list->count; ++c)
-	job_send_basic_params(job_list->jobs[c], msg_fd);
+	job_reply_timing(job_list->jobs[c], reply);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add pending jobs to a reply, with the reason each is not running
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ ***************************************************************************/
+
+void    job_list_reply_pending_params(pool_task_t *reply, job_list_t *job_list)
+
+{
+    unsigned    c;
+
+    job_reply_pending_params_header(reply);
+    for (c = 0; c < job_list->count; ++c)
+	job_reply_pending_params(job_list->jobs[c], reply);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add measured resource use of current jobs to a reply
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_list_reply_usage(pool_task_t *reply, job_list_t *job_list)
+
+{
+    unsigned    c;
+
+    job_reply_usage_header(reply);
+    for (c = 0; c < job_list->count; ++c)
+	job_reply_usage(job_list->jobs[c], reply);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add the running and pending jobs to a reply, as shown by
+ *      lpjs jobs.  format is the second byte of a job list request.
+ *      Pending jobs have no usage, so --usage shows why they wait.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_process_request()
+ *  2026-10-19  Jason Bacon Add JOB_LIST_FORMAT_USAGE
+ ***************************************************************************/
+
+void    job_list_reply_queues(pool_task_t *reply, int format,
+			      job_list_t *running_jobs,
+			      job_list_t *pending_jobs)
+
+{
+    lpjs_reply_add(reply, "Running\n\n");
+    if ( format == JOB_LIST_FORMAT_TIMING )
+	job_list_reply_timing(reply, running_jobs);
+    else if ( format == JOB_LIST_FORMAT_USAGE )
+	job_list_reply_usage(reply, running_jobs);
+    else
+	job_list_reply_params(reply, running_jobs);
+    lpjs_reply_add(reply, "\nPending\n\n");
+    if ( format == JOB_LIST_FORMAT_TIMING )
+	job_list_reply_timing(reply, pending_jobs);
+    else
+	job_list_reply_pending_params(reply, pending_jobs);
 }
 
 
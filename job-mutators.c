@@ -482,6 +482,472 @@ int     job_set_state(job_t *job_ptr, job_state_t new_state)
 }
 
 
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for submit_time member in a job_t structure.
+ *      Use this function to set submit_time in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      submit_time is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_submit_time The new value for submit_time
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      time_t          new_submit_time;
+ *
+ *      if ( job_set_submit_time(&job, new_submit_time)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_submit_time(job_t *job_ptr, time_t new_submit_time)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->submit_time = new_submit_time;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for start_time member in a job_t structure.
+ *      Use this function to set start_time in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      start_time is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_start_time  The new value for start_time
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      time_t          new_start_time;
+ *
+ *      if ( job_set_start_time(&job, new_start_time)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_start_time(job_t *job_ptr, time_t new_start_time)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->start_time = new_start_time;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for an array element of timing member in a job_t
+ *      structure. Use this function to set job_ptr->timing[c]
+ *      in a job_t object from non-member functions.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      c               Subscript to the timing array
+ *      new_timing_element The new value for timing[c]
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      size_t          c;
+ *      int64_t         new_timing_element;
+ *
+ *      if ( job_set_timing_ae(&job, c, new_timing_element)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      JOB_SET_TIMING_AE(3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_timing_ae(job_t *job_ptr, size_t c, int64_t new_timing_element)
+
+{
+    if ( c >= JOB_TIMING_STAGES )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->timing[c] = new_timing_element;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for pending_reason member in a job_t structure.
+ *      Use this function to set pending_reason in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      pending_reason is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_pending_reason The new value for pending_reason
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      job_pending_reason_t new_pending_reason;
+ *
+ *      if ( job_set_pending_reason(&job, new_pending_reason)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_pending_reason(job_t *job_ptr, job_pending_reason_t new_pending_reason)
+
+{
+    if ( new_pending_reason >= JOB_PENDING_REASONS )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->pending_reason = new_pending_reason;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for peak_rss_MiB member in a job_t structure.
+ *      Use this function to set peak_rss_MiB in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      peak_rss_MiB is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_peak_rss_MiB The new value for peak_rss_MiB
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      size_t          new_peak_rss_MiB;
+ *
+ *      if ( job_set_peak_rss_MiB(&job, new_peak_rss_MiB)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_peak_rss_MiB(job_t *job_ptr, size_t new_peak_rss_MiB)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->peak_rss_MiB = new_peak_rss_MiB;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for cpu_sec member in a job_t structure.
+ *      Use this function to set cpu_sec in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      cpu_sec is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_cpu_sec The new value for cpu_sec
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      double          new_cpu_sec;
+ *
+ *      if ( job_set_cpu_sec(&job, new_cpu_sec)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_cpu_sec(job_t *job_ptr, double new_cpu_sec)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->cpu_sec = new_cpu_sec;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for read_bytes member in a job_t structure.
+ *      Use this function to set read_bytes in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      read_bytes is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_read_bytes The new value for read_bytes
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      uint64_t        new_read_bytes;
+ *
+ *      if ( job_set_read_bytes(&job, new_read_bytes)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_read_bytes(job_t *job_ptr, uint64_t new_read_bytes)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->read_bytes = new_read_bytes;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for write_bytes member in a job_t structure.
+ *      Use this function to set write_bytes in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      write_bytes is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_write_bytes The new value for write_bytes
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      uint64_t        new_write_bytes;
+ *
+ *      if ( job_set_write_bytes(&job, new_write_bytes)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_write_bytes(job_t *job_ptr, uint64_t new_write_bytes)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->write_bytes = new_write_bytes;
+	return JOB_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <job.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for peak_threads member in a job_t structure.
+ *      Use this function to set peak_threads in a job_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      peak_threads is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      job_ptr         Pointer to the structure to set
+ *      new_peak_threads The new value for peak_threads
+ *
+ *  Returns:
+ *      JOB_DATA_OK if the new value is acceptable and assigned
+ *      JOB_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      job_t           job;
+ *      unsigned        new_peak_threads;
+ *
+ *      if ( job_set_peak_threads(&job, new_peak_threads)
+ *              == JOB_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from job-private.h
+ ***************************************************************************/
+
+int     job_set_peak_threads(job_t *job_ptr, unsigned new_peak_threads)
+
+{
+    if ( false )
+	return JOB_DATA_OUT_OF_RANGE;
+    else
+    {
+	job_ptr->peak_threads = new_peak_threads;
+	return JOB_DATA_OK;
+    }
+}
+
+
 /***************************************************************************
  *  Library:
  *      #include <job.h>
@@ -19,10 +19,19 @@ int job_set_array_index(job_t *job_ptr, unsigned long new_array_index);
 int job_set_job_count(job_t *job_ptr, unsigned new_job_count);
 int job_set_procs_per_job(job_t *job_ptr, unsigned new_procs_per_job);
 int job_set_min_procs_per_node(job_t *job_ptr, unsigned new_min_procs_per_node);
-int job_set_mem_per_proc(job_t *job_ptr, size_t new_mem_per_proc);
+int job_set_pmem_per_proc(job_t *job_ptr, size_t new_pmem_per_proc);
 int job_set_chaperone_pid(job_t *job_ptr, pid_t new_chaperone_pid);
 int job_set_job_pid(job_t *job_ptr, pid_t new_job_pid);
 int job_set_state(job_t *job_ptr, job_state_t new_state);
+int job_set_submit_time(job_t *job_ptr, time_t new_submit_time);
+int job_set_start_time(job_t *job_ptr, time_t new_start_time);
+int job_set_timing_ae(job_t *job_ptr, size_t c, int64_t new_timing_element);
+int job_set_pending_reason(job_t *job_ptr, job_pending_reason_t new_pending_reason);
+int job_set_peak_rss_MiB(job_t *job_ptr, size_t new_peak_rss_MiB);
+int job_set_cpu_sec(job_t *job_ptr, double new_cpu_sec);
+int job_set_read_bytes(job_t *job_ptr, uint64_t new_read_bytes);
+int job_set_write_bytes(job_t *job_ptr, uint64_t new_write_bytes);
+int job_set_peak_threads(job_t *job_ptr, unsigned new_peak_threads);
 int job_set_user_name(job_t *job_ptr, char *new_user_name);
 int job_set_user_name_ae(job_t *job_ptr, size_t c, char new_user_name_element);
 int job_set_user_name_cpy(job_t *job_ptr, char *new_user_name, size_t array_size);
@@ -28,6 +28,15 @@ struct job
     pid_t           chaperone_pid;
     pid_t           job_pid;
     job_state_t     state;
+    time_t          submit_time;
+    time_t          start_time;     // 0 until the chaperone reports
+    int64_t         timing[JOB_TIMING_STAGES];  // 0 until stage reached
+    job_pending_reason_t    pending_reason; // dispatchd only, not in specs
+    size_t          peak_rss_MiB;   // dispatchd only, from telemetry
+    double          cpu_sec;        // Ditto, and the completion report
+    uint64_t        read_bytes;     // dispatchd only, from completion
+    uint64_t        write_bytes;    // Ditto
+    unsigned        peak_threads;   // Ditto
     char            *user_name;
     char            *primary_group_name;
     char            *submit_node;
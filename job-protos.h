@@ -4,12 +4,22 @@ void job_init(job_t *job);
 job_t *job_dup(job_t *job);
 int job_print_full_specs(job_t *job, FILE *stream);
 int job_print_to_string(job_t *job, char *str, size_t buff_size);
-void job_send_basic_params(job_t *job, int msg_fd);
+void job_reply_basic_params(job_t *job, pool_task_t *reply);
+void job_stamp(job_t *job, job_timing_t stage);
+void job_format_interval(int64_t begin, int64_t end, char *buff, size_t buff_size);
+void job_reply_timing(job_t *job, pool_task_t *reply);
+void job_reply_timing_header(pool_task_t *reply);
+void job_reply_usage(job_t *job, pool_task_t *reply);
+void job_reply_usage_header(pool_task_t *reply);
+const char *job_pending_reason_str(job_t *job);
+void job_reply_pending_params(job_t *job, pool_task_t *reply);
+void job_reply_pending_params_header(pool_task_t *reply);
 int job_parse_script(job_t *job, const char *script_name);
 int job_read_from_string(job_t *job, const char *string, char **end);
 int job_read_from_file(job_t *job, const char *path);
 void job_free(job_t **job);
-void job_send_basic_params_header(int msg_fd);
+void job_reply_basic_params_header(pool_task_t *reply);
 void job_print_basic_params_header(FILE *stream);
 void job_setenv(job_t *job);
 int job_id_cmp(job_t **job1, job_t **job2);
+unsigned long job_get_submission_id(job_t *job);
@@ -0,0 +1,10 @@
+/* job-usage.c */
+void job_usage_init(job_usage_t *usage);
+void job_usage_sample(job_usage_t *usage, proctree_t *tree, pid_t root);
+void job_usage_add_rusage(job_usage_t *usage, const struct rusage *ru);
+void job_usage_add_cgroup(job_usage_t *usage, const cgroup_usage_t *cg);
+char *job_usage_to_str(const job_usage_t *usage, char *str, size_t maxlen);
+int job_usage_from_str(job_usage_t *usage, const char *str);
+char *job_usage_describe(const job_usage_t *usage, char *str, size_t maxlen);
+char *job_usage_pct_str(double used, double available, char *str, size_t maxlen);
+char *job_usage_elapsed_str(int64_t seconds, char *str, size_t maxlen);
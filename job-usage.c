@@ -0,0 +1,262 @@
+/***************************************************************************
+ *  Description:
+ *      Measure the resource use of a job on its compute node, and
+ *      express it as efficiency for users.  See job-usage.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>   // uintmax_t
+
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "job-usage.h"
+
+/***************************************************************************
+ *  Description:
+ *      Start a job's usage at zero
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_usage_init(job_usage_t *usage)
+
+{
+    memset(usage, 0, sizeof(*usage));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Update a job's usage from root and its descendants in tree,
+ *      which must be loaded.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_usage_sample(job_usage_t *usage, proctree_t *tree, pid_t root)
+
+{
+    proctree_proc_t *proc;
+    size_t          c, rss_KiB = 0;
+    double          cpu_sec = 0.0;
+    uint64_t        read_bytes = 0, write_bytes = 0, r, w;
+    unsigned        threads = 0;
+
+    for (c = 0; c < tree->count; ++c)
+    {
+	proc = &tree->procs[c];
+	if ( ! proctree_is_descendant(tree, proc->pid, root) )
+	    continue;
+	rss_KiB += proc->rss_KiB;
+	cpu_sec += proc->cpu_sec;
+	threads += proc->threads;
+	if ( ! proc->zombie &&
+	     (proctree_io_bytes(proc->pid, &r, &w) == LPJS_SUCCESS) )
+	{
+	    read_bytes += r;
+	    write_bytes += w;
+	}
+    }
+
+    if ( rss_KiB / 1024 > usage->peak_rss_MiB )
+	usage->peak_rss_MiB = rss_KiB / 1024;
+    if ( cpu_sec > usage->cpu_sec )
+	usage->cpu_sec = cpu_sec;
+    if ( read_bytes > usage->read_bytes )
+	usage->read_bytes = read_bytes;
+    if ( write_bytes > usage->write_bytes )
+	usage->write_bytes = write_bytes;
+    if ( threads > usage->peak_threads )
+	usage->peak_threads = threads;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Merge the rusage of a job's script from wait4()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_usage_add_rusage(job_usage_t *usage, const struct rusage *ru)
+
+{
+    double      cpu_sec = TIMEVAL_SEC(ru->ru_utime) + TIMEVAL_SEC(ru->ru_stime);
+    // Bytes on macOS, KiB elsewhere
+#ifdef __APPLE__
+    size_t      max_rss_MiB = ru->ru_maxrss / 1024 / 1024;
+#else
+    size_t      max_rss_MiB = ru->ru_maxrss / 1024;
+#endif
+    // Blocks are counted in units of 512 bytes
+    uint64_t    read_bytes = (uint64_t)ru->ru_inblock * 512,
+		write_bytes = (uint64_t)ru->ru_oublock * 512;
+
+    if ( max_rss_MiB > usage->peak_rss_MiB )
+	usage->peak_rss_MiB = max_rss_MiB;
+    if ( cpu_sec > usage->cpu_sec )
+	usage->cpu_sec = cpu_sec;
+    if ( read_bytes > usage->read_bytes )
+	usage->read_bytes = read_bytes;
+    if ( write_bytes > usage->write_bytes )
+	usage->write_bytes = write_bytes;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Merge the usage of a job's cgroup
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_usage_add_cgroup(job_usage_t *usage, const cgroup_usage_t *cg)
+
+{
+    if ( cg->peak_MiB > usage->peak_rss_MiB )
+	usage->peak_rss_MiB = cg->peak_MiB;
+    if ( cg->user_sec + cg->system_sec > usage->cpu_sec )
+	usage->cpu_sec = cg->user_sec + cg->system_sec;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Text form of a job's usage, as described in job-usage.h
+ *
+ *  Returns:
+ *      str
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *job_usage_to_str(const job_usage_t *usage, char *str, size_t maxlen)
+
+{
+    snprintf(str, maxlen, "%zu %.2f %ju %ju %u", usage->peak_rss_MiB,
+	     usage->cpu_sec, (uintmax_t)usage->read_bytes,
+	     (uintmax_t)usage->write_bytes, usage->peak_threads);
+    return str;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse the text form of a job's usage from job_usage_to_str()
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if str is malformed, in which
+ *      case usage is all zeros
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     job_usage_from_str(job_usage_t *usage, const char *str)
+
+{
+    uintmax_t   read_bytes, write_bytes;
+
+    if ( sscanf(str, "%zu %lf %ju %ju %u", &usage->peak_rss_MiB,
+		&usage->cpu_sec, &read_bytes, &write_bytes,
+		&usage->peak_threads) != 5 )
+    {
+	job_usage_init(usage);
+	return LPJS_READ_FAILED;
+    }
+    usage->read_bytes = read_bytes;
+    usage->write_bytes = write_bytes;
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Describe a job's usage for log messages
+ *
+ *  Returns:
+ *      str
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *job_usage_describe(const job_usage_t *usage, char *str,
+			    size_t maxlen)
+
+{
+    snprintf(str, maxlen, "peak memory %zu MiB, CPU %.1f s, "
+	     "read %ju MiB, written %ju MiB, peak threads %u",
+	     usage->peak_rss_MiB, usage->cpu_sec,
+	     (uintmax_t)(usage->read_bytes / 1024 / 1024),
+	     (uintmax_t)(usage->write_bytes / 1024 / 1024),
+	     usage->peak_threads);
+    return str;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format used as a percentage of available, for efficiency
+ *      columns, or "-" if available is 0 or nothing was measured
+ *
+ *  Returns:
+ *      str
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *job_usage_pct_str(double used, double available, char *str,
+			   size_t maxlen)
+
+{
+    if ( (available <= 0.0) || (used <= 0.0) )
+	strlcpy(str, "-", maxlen);
+    else
+	snprintf(str, maxlen, "%.0f%%", used * 100.0 / available);
+    return str;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format elapsed time as days-hh:mm:ss, for lpjs jobs and
+ *      lpjs history
+ *
+ *  Returns:
+ *      str
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from history_print_record()
+ ***************************************************************************/
+
+char    *job_usage_elapsed_str(int64_t seconds, char *str, size_t maxlen)
+
+{
+    snprintf(str, maxlen, "%jd-%02d:%02d:%02d",
+	     (intmax_t)(seconds / JOB_USAGE_SECONDS_PER_DAY),
+	     (int)(seconds % JOB_USAGE_SECONDS_PER_DAY / 3600),
+	     (int)(seconds % 3600 / 60), (int)(seconds % 60));
+    return str;
+}
@@ -0,0 +1,54 @@
+#ifndef _LPJS_JOB_USAGE_H_
+#define _LPJS_JOB_USAGE_H_
+
+#include <stdint.h>
+#include <sys/types.h>      // size_t, pid_t
+#include <sys/resource.h>   // struct rusage
+
+#ifndef _LPJS_PROCTREE_H_
+#include "proctree.h"
+#endif
+
+#ifndef _LPJS_CGROUP_H_
+#include "cgroup.h"
+#endif
+
+/*
+ *  Resource use of a job, measured on the compute node by its chaperone,
+ *  or by lpjs_compd for "job-supervisor compd", and sent with its
+ *  completion report for the accounting log.
+ *
+ *  The job's processes are sampled every usage-interval seconds for
+ *  their total RSS, threads, CPU time, and storage I/O.  When the
+ *  script exits, the rusage from wait4(), which covers everything the
+ *  script waited for, and the job's cgroup, if any, are merged in.
+ *  Each method misses something: Samples miss short-lived processes
+ *  and peaks between samples, rusage has the RSS of the largest single
+ *  process rather than the total, and not every node has cgroups.  So
+ *  each figure is the largest measured.  Text form:
+ *
+ *      peak-rss-MiB cpu-sec read-bytes write-bytes peak-threads
+ *
+ *  Efficiency, as shown by lpjs jobs and lpjs history, is CPU time as
+ *  a percentage of elapsed time * procs-per-job, and peak RSS as a
+ *  percentage of procs-per-job * pmem-per-proc.  See job-usage.c.
+ */
+
+#define LPJS_USAGE_INTERVAL     5   // Seconds, default
+#define JOB_USAGE_STR_MAX       128
+#define JOB_USAGE_PCT_MAX       16
+#define JOB_USAGE_ELAPSED_MAX   32
+#define JOB_USAGE_SECONDS_PER_DAY   86400
+
+typedef struct
+{
+    size_t      peak_rss_MiB;
+    double      cpu_sec;        // User + system
+    uint64_t    read_bytes;     // Storage, not page cache
+    uint64_t    write_bytes;
+    unsigned    peak_threads;
+}   job_usage_t;
+
+#include "job-usage-protos.h"
+
+#endif  // _LPJS_JOB_USAGE_H_
@@ -7,6 +7,7 @@
 #include <limits.h>     // PATH_MAX
 #include <errno.h>
 #include <fcntl.h>      // open()
+#include <time.h>
 
 #include <xtend/dsv.h>
 #include <xtend/file.h>
@@ -17,6 +18,7 @@
 #include "network.h"
 #include "lpjs.h"
 #include "misc.h"
+#include "job-usage.h"
 #include "realpath-protos.h"
 
 /***************************************************************************
@@ -59,6 +61,7 @@ void    job_init(job_t *job)
 {
     // FIXME: Check strdup() failure
     job->job_id = 0;
+    job->array_index = 0;
     job->job_count = 0;
     job->procs_per_job = 0;
     job->min_procs_per_node = 0;
@@ -66,6 +69,15 @@ void    job_init(job_t *job)
     job->chaperone_pid = 0;
     job->job_pid = 0;
     job->state = JOB_STATE_PENDING;
+    job->submit_time = 0;
+    job->start_time = 0;
+    memset(job->timing, 0, sizeof(job->timing));
+    job->pending_reason = JOB_PENDING_NONE;
+    job->peak_rss_MiB = 0;
+    job->cpu_sec = 0.0;
+    job->read_bytes = 0;
+    job->write_bytes = 0;
+    job->peak_threads = 0;
     job->user_name = NULL;
     job->primary_group_name = NULL;
     job->submit_node = NULL;
@@ -93,6 +105,8 @@ job_t   *job_dup(job_t *job)
     new_job->procs_per_job = job->procs_per_job;
     new_job->min_procs_per_node = job->min_procs_per_node;
     new_job->pmem_per_proc = job->pmem_per_proc;
+    new_job->submit_time = job->submit_time;
+    memcpy(new_job->timing, job->timing, sizeof(job->timing));
     
     // FIXME: Check malloc success
     if ( job->user_name != NULL )
@@ -165,14 +179,15 @@ int     job_print_to_string(job_t *job, char *str, size_t buff_size)
 
 /***************************************************************************
  *  Description:
- *      Send job parameters to msg_fd, e.g. in response to lpjs-jobs request
+ *      Add job parameters to a reply, e.g. in response to lpjs-jobs request
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-28  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
  ***************************************************************************/
 
-void    job_send_basic_params(job_t *job, int msg_fd)
+void    job_reply_basic_params(job_t *job, pool_task_t *reply)
 
 {
     char    msg[LPJS_MSG_LEN_MAX + 1];
@@ -185,13 +200,226 @@ void    job_send_basic_params(job_t *job, int msg_fd)
 	    job->script_name,
 	    job->compute_node);
     
-    // FIXME: Combine into one message
     // Used by dispatchd to send to lpjs jobs command
-    if ( lpjs_send_munge(msg_fd, msg, lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
+    lpjs_reply_add(reply, msg);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record the time a job reached a launch pipeline stage
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_stamp(job_t *job, job_timing_t stage)
+
+{
+    job->timing[stage] = lpjs_time_us();
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format the seconds between two stage stamps, "-" if either
+ *      has not been reached
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_format_interval(int64_t begin, int64_t end, char *buff,
+			    size_t buff_size)
+
+{
+    if ( (begin == 0) || (end == 0) )
+	strlcpy(buff, "-", buff_size);
+    else
+	snprintf(buff, buff_size, "%.3f", (end - begin) / 1000000.0);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add the launch latency breakdown to a reply, for lpjs jobs --timing
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ ***************************************************************************/
+
+void    job_reply_timing(job_t *job, pool_task_t *reply)
+
+{
+    char    msg[LPJS_MSG_LEN_MAX + 1],
+	    fields[JOB_TIMING_STAGES - 1][JOB_TIMING_FIELD_MAX + 1];
+    int64_t end;
+    int     c, last;
+    
+    // Latest stage reached, measured to now until the job completes
+    for (last = JOB_TIMING_STAGES - 1; last > 0; --last)
+	if ( job->timing[last] != 0 )
+	    break;
+    
+    for (c = 0; c < JOB_TIMING_STAGES - 1; ++c)
+    {
+	end = job->timing[c + 1];
+	if ( (c == last) && (job->timing[c] != 0) )
+	    end = lpjs_time_us();
+	job_format_interval(job->timing[c], end, fields[c],
+			    JOB_TIMING_FIELD_MAX + 1);
+    }
+    
+    snprintf(msg, LPJS_MSG_LEN_MAX + 1,
+	    "%9lu %4lu %-12s %-8s %-8s %-8s %-8s %-8s %s\n",
+	    job->job_id, job->array_index, job->user_name,
+	    fields[JOB_TIMING_SUBMITTED], fields[JOB_TIMING_SELECTED],
+	    fields[JOB_TIMING_SENT], fields[JOB_TIMING_FORKED],
+	    fields[JOB_TIMING_EXECED], fields[JOB_TIMING_STARTED]);
+    
+    lpjs_reply_add(reply, msg);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add the column headers for job_reply_timing()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_reply_timing_header(pool_task_t *reply)
+
+{
+    lpjs_reply_add(reply, JOB_TIMING_HEADER);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add measured resource use and efficiency so far to a reply, for
+ *      lpjs jobs --usage.  Usage is from compd telemetry, so it lags
+ *      by up to a telemetry interval.  See job-usage.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_reply_usage(job_t *job, pool_task_t *reply)
+
+{
+    char    msg[LPJS_MSG_LEN_MAX + 1],
+	    elapsed_str[JOB_USAGE_ELAPSED_MAX + 1],
+	    cpu_pct[JOB_USAGE_PCT_MAX + 1],
+	    mem_pct[JOB_USAGE_PCT_MAX + 1];
+    time_t  elapsed = 0;
+    size_t  mem_MiB = job->procs_per_job * job->pmem_per_proc;
+    
+    if ( job->start_time == 0 )
+	strlcpy(elapsed_str, "-", JOB_USAGE_ELAPSED_MAX + 1);
+    else
     {
-	lpjs_log("%s(): Error: Send failed.\n", __FUNCTION__);
-	exit(EX_IOERR);
+	elapsed = time(NULL) - job->start_time;
+	job_usage_elapsed_str(elapsed, elapsed_str, JOB_USAGE_ELAPSED_MAX + 1);
     }
+    job_usage_pct_str(job->cpu_sec, (double)elapsed * job->procs_per_job,
+		      cpu_pct, JOB_USAGE_PCT_MAX + 1);
+    job_usage_pct_str(job->peak_rss_MiB, mem_MiB, mem_pct,
+		      JOB_USAGE_PCT_MAX + 1);
+    
+    snprintf(msg, LPJS_MSG_LEN_MAX + 1,
+	    "%9lu %4lu %-12s %-12s %3u %8.0f %5s %5zu %8zu %5s %s\n",
+	    job->job_id, job->array_index, job->user_name, elapsed_str,
+	    job->procs_per_job, job->cpu_sec, cpu_pct, mem_MiB,
+	    job->peak_rss_MiB, mem_pct,
+	    job->compute_node == NULL ? "-" : job->compute_node);
+    
+    lpjs_reply_add(reply, msg);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add the column headers for job_reply_usage()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    job_reply_usage_header(pool_task_t *reply)
+
+{
+    lpjs_reply_add(reply, JOB_USAGE_HEADER);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Short description of why a job in the pending queue is not
+ *      running, for lpjs jobs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+const char  *job_pending_reason_str(job_t *job)
+
+{
+    static const char   *names[JOB_PENDING_REASONS] =
+    {
+	"Priority", "NoNodes", "Procs", "Memory"
+    };
+    
+    // Sent to compd, awaiting the chaperone start notice
+    if ( job->state != JOB_STATE_PENDING )
+	return "Starting";
+    else if ( job->pending_reason < JOB_PENDING_REASONS )
+	return names[job->pending_reason];
+    else
+	return "Unknown";
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add pending job parameters and reason to a reply, for lpjs jobs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ ***************************************************************************/
+
+void    job_reply_pending_params(job_t *job, pool_task_t *reply)
+
+{
+    char    msg[LPJS_MSG_LEN_MAX + 1];
+    
+    snprintf(msg, LPJS_MSG_LEN_MAX + 1, JOB_BASIC_PARAMS_FORMAT,
+	    job->job_id, job->array_index,
+	    job->job_count, job->procs_per_job,
+	    job->min_procs_per_node, job->pmem_per_proc,
+	    job->user_name,
+	    job->script_name,
+	    job_pending_reason_str(job));
+    
+    lpjs_reply_add(reply, msg);
+}
+
+
+void    job_reply_pending_params_header(pool_task_t *reply)
+
+{
+    lpjs_reply_add(reply, JOB_PENDING_PARAMS_HEADER);
 }
 
 
@@ -638,13 +866,13 @@ void    job_free(job_t **job)
  *  History: 
  *  Date        Name        Modification
  *  2024-02-01  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
  ***************************************************************************/
 
-void    job_send_basic_params_header(int msg_fd)
+void    job_reply_basic_params_header(pool_task_t *reply)
 
 {
-    // FIXME: Combine into one message
-    lpjs_send_munge(msg_fd, JOB_BASIC_PARAMS_HEADER, lpjs_dispatchd_safe_close);
+    lpjs_reply_add(reply, JOB_BASIC_PARAMS_HEADER);
 }
 
 
@@ -736,3 +964,21 @@ int     job_id_cmp(job_t **job1, job_t **job2)
 {
     return (*job1)->job_id - (*job2)->job_id;
 }
+
+
+/***************************************************************************
+ *  Description:
+ *      Get the ID of the submission a job belongs to, i.e. the job ID
+ *      of the first element of its job array.  Array elements are
+ *      always assigned consecutive job IDs.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned long   job_get_submission_id(job_t *job)
+
+{
+    return job->job_id - job->array_index + 1;
+}
@@ -32,9 +32,65 @@ typedef enum
     JOB_STATE_RUNNING
 }   job_state_t;
 
+/*
+ *  Launch pipeline stages, stamped in microseconds since the epoch
+ *  by lpjs_time_us().  All but JOB_TIMING_EXECED are stamped by
+ *  dispatchd.  JOB_TIMING_EXECED is reported by the chaperone, so
+ *  stages before and after it include clock skew between the head
+ *  and compute nodes.
+ */
+typedef enum
+{
+    JOB_TIMING_SUBMITTED = 0,
+    JOB_TIMING_SELECTED,        // Matched to available nodes
+    JOB_TIMING_SENT,            // Sent to compd
+    JOB_TIMING_FORKED,          // compd verified chaperone fork
+    JOB_TIMING_EXECED,          // Chaperone started script
+    JOB_TIMING_STARTED,         // Start notice received
+    JOB_TIMING_COMPLETED,       // Finished, canceled, or lost
+    JOB_TIMING_STAGES
+}   job_timing_t;
+
+// For lpjs jobs --timing output, seconds between stages
+#define JOB_TIMING_HEADER \
+    "    JobID  IDX User         Wait     Schedule Dispatch Setup    Notice   Run\n"
+#define JOB_TIMING_FIELD_MAX    32
+
+// For lpjs jobs --usage output, measured use and efficiency so far
+#define JOB_USAGE_HEADER \
+    "    JobID  IDX User         Elapsed      P/J  CPU-sec  CPU% MiB/J Peak-MiB  Mem% Compute-node\n"
+
+// Second byte of LPJS_DISPATCHD_REQUEST_JOB_LIST, params if absent
+#define JOB_LIST_FORMAT_TIMING  't'
+#define JOB_LIST_FORMAT_USAGE   'u'
+
+/*
+ *  Why a pending job has not been dispatched, recorded by the scheduler
+ *  when the job is at the head of the queue and cannot be matched to
+ *  nodes.  Jobs behind it have not been examined and show "Priority".
+ */
+typedef enum
+{
+    JOB_PENDING_NONE = 0,       // Not examined since last change
+    JOB_PENDING_NO_NODES,       // No compute nodes are up
+    JOB_PENDING_PROCS,          // Not enough free procs on up nodes
+    JOB_PENDING_MEMORY,         // Procs free, but not with enough memory
+    JOB_PENDING_REASONS
+}   job_pending_reason_t;
+
+// For lpjs jobs output of the pending queue
+#define JOB_PENDING_PARAMS_HEADER \
+    "    JobID  IDX  J/S P/J P/N MiB/P User Script Reason\n"
+
 typedef struct job  job_t;
 
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef _LPJS_POOL_H_
+#include "pool.h"       // pool_task_t for replies
+#endif
 
 #include "job-rvs.h"
 #include "job-accessors.h"
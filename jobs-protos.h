@@ -0,0 +1,2 @@
+/* jobs.c */
+void print_legend(int format);
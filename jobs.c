@@ -1,11 +1,13 @@
 /***************************************************************************
  *  Description:
- *      List currently running and queued jobs.  Job info is queried from
- *      lpjs_dispatchd.
+ *      List currently running and queued jobs.  Job info is read from
+ *      the status board on the head node, or queried from lpjs_dispatchd.
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-27  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Read the status board if available
+ *  2026-10-19  Jason Bacon Add --usage
  ***************************************************************************/
 
 #include <stdio.h>
@@ -13,11 +15,16 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <sysexits.h>
+#include <stdbool.h>
 
 #include "node-list.h"
+#include "job-list.h"
 #include "config.h"
 #include "network.h"
 #include "lpjs.h"
+#include "pool.h"
+#include "board.h"
+#include "jobs-protos.h"
 
 int     main(int argc,char *argv[])
 
@@ -25,18 +32,37 @@ int     main(int argc,char *argv[])
     int         msg_fd;
     // Terminates process if malloc() fails, no check required
     node_list_t *node_list = node_list_new();
+    job_list_t  *pending_jobs = job_list_new(),
+		*running_jobs = job_list_new();
+    pool_task_t *reply;
     extern FILE *Log_stream;
     char        outgoing_msg[LPJS_MSG_LEN_MAX + 1];
+    int         format = '\0';
     
-    if (argc != 1)
+    if ( (argc == 2) && (strcmp(argv[1], "--timing") == 0) )
+	format = JOB_LIST_FORMAT_TIMING;
+    else if ( (argc == 2) && (strcmp(argv[1], "--usage") == 0) )
+	format = JOB_LIST_FORMAT_USAGE;
+    else if (argc != 1)
     {
-	fprintf (stderr, "Usage: %s\n", argv[0]);
+	fprintf (stderr, "Usage: %s [--timing|--usage]\n", argv[0]);
 	return EX_USAGE;
     }
 
     // Shared functions may use lpjs_log
     Log_stream = stderr;
     
+    // No request needed on the head node while dispatchd is running
+    if ( lpjs_board_load(node_list, pending_jobs, running_jobs)
+	 == LPJS_SUCCESS )
+    {
+	print_legend(format);
+	reply = lpjs_reply_new(-1, LPJS_REPLY_EOT);
+	job_list_reply_queues(reply, format, running_jobs, pending_jobs);
+	lpjs_reply_print(reply, stdout);
+	return EX_OK;
+    }
+    
     // Get hostname of head node
     lpjs_load_config(node_list, LPJS_CONFIG_HEAD_ONLY, stderr);
 
@@ -47,7 +73,8 @@ int     main(int argc,char *argv[])
     }
 
     outgoing_msg[0] = LPJS_DISPATCHD_REQUEST_JOB_LIST;
-    outgoing_msg[1] = '\0';
+    outgoing_msg[1] = format;
+    outgoing_msg[2] = '\0';
     if ( lpjs_send_munge(msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
     {
 	perror("lpjs-jobs: Failed to send message to dispatch");
@@ -55,9 +82,21 @@ int     main(int argc,char *argv[])
 	return EX_IOERR;
     }
 
-    puts("\nLegend: P = processor  J = job  N = node  S = submission\n");
+    print_legend(format);
     lpjs_print_response(msg_fd, "lpjs-jobs");
     close (msg_fd);
 
     return EX_OK;
 }
+
+
+void    print_legend(int format)
+
+{
+    if ( format == JOB_LIST_FORMAT_TIMING )
+	puts("\nSeconds in each launch stage, see lpjs-jobs(1)\n");
+    else if ( format == JOB_LIST_FORMAT_USAGE )
+	puts("\nMeasured use so far, as a percentage of requested, see lpjs-jobs(1)\n");
+    else
+	puts("\nLegend: P = processor  J = job  N = node  S = submission\n");
+}
@@ -0,0 +1,26 @@
+/* journal.c */
+uint32_t lpjs_crc32(const void *buff, size_t len);
+uint32_t lpjs_crc32_update(uint32_t crc, const void *buff, size_t len);
+int lpjs_journal_open(void);
+unsigned long lpjs_journal_reserve_job_ids(unsigned long count);
+unsigned long lpjs_journal_uncommitted_job_id(void);
+void lpjs_journal_discard_uncommitted(void);
+void lpjs_journal_clear_uncommitted(void);
+void lpjs_journal_note_submit(size_t start, size_t end);
+int lpjs_journal_append(journal_event_t event, job_t *job);
+int lpjs_journal_commit(void);
+void lpjs_journal_rollback(off_t start_offset);
+int lpjs_journal_checkpoint(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+int lpjs_journal_compact(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+int lpjs_journal_load(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+void lpjs_journal_note_dispatch(void);
+int lpjs_journal_replay(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+void lpjs_journal_apply(const char *payload, job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
+void lpjs_journal_read_times(job_t *job, const char *str);
+void lpjs_journal_adjust_node(node_list_t *node_list, job_t *job, node_resource_t direction);
+int lpjs_journal_import_legacy(job_list_t *job_list, const char *spool_dir);
+void lpjs_spool_script_path(job_t *job, char *path, size_t array_size);
+int lpjs_spool_script(unsigned long submission_id, const char *script_text);
+void lpjs_spool_remove_orphan_scripts(job_list_t *pending_jobs, job_list_t *running_jobs);
+int lpjs_ulong_cmp(const unsigned long *n1, const unsigned long *n2);
+int lpjs_sync_dir(const char *dir);
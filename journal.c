@@ -0,0 +1,1053 @@
+/***************************************************************************
+ *  Description:
+ *      Write-ahead journal for the dispatchd job queues.
+ *
+ *      Every change to the pending and running job lists is appended
+ *      to LPJS_JOURNAL as a checksummed record.  Records are buffered
+ *      in memory and written out with a single write() and fsync()
+ *      by lpjs_journal_commit(), so a large job array costs one disk
+ *      sync instead of several file operations per array element.
+ *      The journal is periodically compacted into LPJS_SNAPSHOT, which
+ *      holds the complete queue state, and then truncated.
+ *
+ *      Record format:
+ *
+ *          uint32_t    Payload length, network byte order
+ *          uint32_t    CRC-32 of payload, network byte order
+ *          payload     journal_event_t byte followed by text
+ *
+ *      SUBMIT, DISPATCH, and START payloads are job specs in
+ *      JOB_SPEC_FORMAT, followed by a line with the submit and start
+ *      times and the job_timing_t stamps, which are not part of the
+ *      specs sent to other nodes.  COMPLETE and CANCEL payloads are
+ *      just the job ID.  A record with a bad length or checksum can
+ *      only be the result of a crash in the middle of a commit, so
+ *      replay stops there and the torn tail is discarded.
+ *
+ *      Job scripts are stored once per submission, not once per job,
+ *      in LPJS_SCRIPT_DIR/<submission ID>.  The submission ID is the
+ *      job ID of the first element of the job array.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>      // open()
+#include <limits.h>     // PATH_MAX
+#include <dirent.h>     // opendir(), ...
+#include <stdint.h>     // intmax_t
+#include <inttypes.h>   // strtoimax()
+#include <stdbool.h>
+#include <arpa/inet.h>  // htonl()
+#include <sys/stat.h>
+#include <time.h>       // clock_gettime()
+
+#include <xtend/string.h>   // xt_strisint()
+
+#include "lpjs.h"
+#include "node-list.h"
+#include "job-list.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "cleanup.h"
+#include "misc.h"
+#include "metrics.h"
+
+/*
+ *  There is only one journal per dispatchd, and it is only accessed
+ *  from the main event loop, so keep its state private to this file
+ *  rather than passing it through every function that modifies the
+ *  job lists.
+ */
+static int              Journal_fd = -1;
+static char             *Journal_buff = NULL;
+static size_t           Journal_buff_len = 0,
+			Journal_buff_size = 0;
+static unsigned long    Journal_records = 0,
+			Next_job_id = 1,
+			// First job ID reserved since the last commit, or 0
+			Uncommitted_job_id = 0;
+// Where the SUBMIT records of Uncommitted_job_id on are buffered
+static journal_range_t  *Submit_ranges = NULL;
+static size_t           Submit_range_count = 0,
+			Submit_range_size = 0;
+// For measuring restart time
+static struct timespec  Load_start;
+static bool             Awaiting_first_dispatch = false;
+
+/***************************************************************************
+ *  Description:
+ *      Compute the standard (IEEE 802.3) CRC-32 of a buffer.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint32_t    lpjs_crc32(const void *buff, size_t len)
+
+{
+    return lpjs_crc32_update(0, buff, len);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Continue a CRC-32 computation, so that the CRC of data in
+ *      separate buffers is the same as if they were contiguous:
+ *      lpjs_crc32_update(lpjs_crc32(a, a_len), b, b_len)
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Split out of lpjs_crc32()
+ ***************************************************************************/
+
+uint32_t    lpjs_crc32_update(uint32_t crc, const void *buff, size_t len)
+
+{
+    static uint32_t table[256];
+    static bool     table_ready = false;
+    const unsigned char *p = buff;
+    uint32_t        entry;
+
+    if ( ! table_ready )
+    {
+	for (uint32_t n = 0; n < 256; ++n)
+	{
+	    entry = n;
+	    for (int bit = 0; bit < 8; ++bit)
+		entry = (entry & 1) ? 0xEDB88320 ^ (entry >> 1) : entry >> 1;
+	    table[n] = entry;
+	}
+	table_ready = true;
+    }
+
+    crc ^= 0xFFFFFFFF;
+    while ( len-- > 0 )
+	crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open the journal for appending new records.  Call after
+ *      lpjs_journal_load(), which replays any existing records.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the journal cannot be opened
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_journal_open(void)
+
+{
+    if ( (Journal_fd = open(LPJS_JOURNAL, O_WRONLY|O_CREAT|O_APPEND, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot open %s: %s\n", __FUNCTION__,
+		 LPJS_JOURNAL, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Reserve a block of consecutive job IDs for a new submission.
+ *      IDs are recovered from the journal and snapshot after a
+ *      restart, so there is no need to write a counter file.
+ *
+ *  Returns:
+ *      The first job ID in the block
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Note uncommitted submissions
+ ***************************************************************************/
+
+unsigned long   lpjs_journal_reserve_job_ids(unsigned long count)
+
+{
+    unsigned long   first_job_id = Next_job_id;
+
+    Next_job_id += count;
+    if ( Uncommitted_job_id == 0 )
+	Uncommitted_job_id = first_job_id;
+    return first_job_id;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Lowest job ID submitted since the last successful commit.
+ *      Such jobs must not be dispatched, since they would be lost
+ *      if dispatchd crashed before the commit, and are removed by
+ *      lpjs_drop_uncommitted() if the commit fails.
+ *
+ *  Returns:
+ *      Job ID, or 0 if all submitted jobs are committed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned long   lpjs_journal_uncommitted_job_id(void)
+
+{
+    return Uncommitted_job_id;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the SUBMIT records of uncommitted submissions from the
+ *      buffer, once their jobs are removed from the queue, so that
+ *      they do not hold up later commits.  Other records buffered
+ *      with them are kept for the next commit.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_discard_uncommitted(void)
+
+{
+    size_t          c;
+    journal_range_t *range;
+
+    // Last first, so earlier offsets are not moved
+    for (c = Submit_range_count; c-- > 0; )
+    {
+	range = &Submit_ranges[c];
+	memmove(Journal_buff + range->start, Journal_buff + range->end,
+		Journal_buff_len - range->end);
+	Journal_buff_len -= range->end - range->start;
+	Journal_records -= range->records;
+    }
+    lpjs_journal_clear_uncommitted();
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Note that all submissions are committed, or discarded
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_clear_uncommitted(void)
+
+{
+    Uncommitted_job_id = 0;
+    Submit_range_count = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Note where a SUBMIT record was buffered, for
+ *      lpjs_journal_discard_uncommitted().  The records of one
+ *      submission are consecutive, so usually just extend the last
+ *      range.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_note_submit(size_t start, size_t end)
+
+{
+    journal_range_t *range;
+
+    if ( (Submit_range_count > 0) &&
+	 (Submit_ranges[Submit_range_count - 1].end == start) )
+    {
+	range = &Submit_ranges[Submit_range_count - 1];
+	range->end = end;
+	++range->records;
+	return;
+    }
+
+    if ( Submit_range_count == Submit_range_size )
+    {
+	Submit_range_size = (Submit_range_size == 0) ? 16 :
+			    Submit_range_size * 2;
+	Submit_ranges = realloc(Submit_ranges,
+				Submit_range_size * sizeof(*Submit_ranges));
+	if ( Submit_ranges == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    range = &Submit_ranges[Submit_range_count++];
+    range->start = start;
+    range->end = end;
+    range->records = 1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Buffer a journal record for a queue event.  Nothing is written
+ *      until lpjs_journal_commit(), so a whole batch of events costs
+ *      only one write() and one fsync().
+ *
+ *  Returns:
+ *      LPJS_SUCCESS
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Note uncommitted submissions
+ ***************************************************************************/
+
+int     lpjs_journal_append(journal_event_t event, job_t *job)
+
+{
+    char        payload[LPJS_JOURNAL_PAYLOAD_MAX + 1];
+    size_t      payload_len;
+    uint32_t    header[2];
+    int         c;
+
+    // Journal is not open for some tools, e.g. when replaying traces
+    if ( Journal_fd == -1 )
+	return LPJS_SUCCESS;
+
+    payload[0] = event;
+    if ( (event == LPJS_JOURNAL_COMPLETE) || (event == LPJS_JOURNAL_CANCEL) )
+	snprintf(payload + 1, LPJS_JOURNAL_PAYLOAD_MAX, "%lu\n",
+		 job_get_job_id(job));
+    else
+    {
+	job_print_to_string(job, payload + 1, LPJS_JOURNAL_PAYLOAD_MAX);
+	payload_len = strlen(payload);
+	snprintf(payload + payload_len, LPJS_JOURNAL_PAYLOAD_MAX + 1 - payload_len,
+		 "%jd %jd", (intmax_t)job_get_submit_time(job),
+		 (intmax_t)job_get_start_time(job));
+	for (c = 0; c < JOB_TIMING_STAGES; ++c)
+	{
+	    payload_len = strlen(payload);
+	    snprintf(payload + payload_len,
+		     LPJS_JOURNAL_PAYLOAD_MAX + 1 - payload_len, " %jd",
+		     (intmax_t)job_get_timing_ae(job, c));
+	}
+	strlcat(payload, "\n", LPJS_JOURNAL_PAYLOAD_MAX + 1);
+    }
+    payload_len = strlen(payload);
+
+    if ( Journal_buff_len + LPJS_JOURNAL_HEADER_SIZE + payload_len >
+	 Journal_buff_size )
+    {
+	Journal_buff_size = (Journal_buff_size == 0) ? 65536 :
+			    Journal_buff_size * 2;
+	if ( (Journal_buff = realloc(Journal_buff, Journal_buff_size)) == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+
+    header[0] = htonl(payload_len);
+    header[1] = htonl(lpjs_crc32(payload, payload_len));
+    memcpy(Journal_buff + Journal_buff_len, header, LPJS_JOURNAL_HEADER_SIZE);
+    memcpy(Journal_buff + Journal_buff_len + LPJS_JOURNAL_HEADER_SIZE,
+	   payload, payload_len);
+    if ( event == LPJS_JOURNAL_SUBMIT )
+	lpjs_journal_note_submit(Journal_buff_len, Journal_buff_len +
+				 LPJS_JOURNAL_HEADER_SIZE + payload_len);
+    Journal_buff_len += LPJS_JOURNAL_HEADER_SIZE + payload_len;
+    ++Journal_records;
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write all buffered records to the journal and sync to disk.
+ *      Not async-signal-safe, and must not interrupt an append, so
+ *      it is only called from the event loop, including on shutdown.
+ *      See lpjs_dispatchd_terminate_handler().
+ *
+ *      If the write or sync fails, e.g. with ENOSPC, the journal is
+ *      truncated back to where it was and the records stay buffered
+ *      for the next commit.  A torn record left in place would end
+ *      replay there, discarding everything committed after it.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record spool write time
+ *  2026-10-19  Jason Bacon Truncate partial commits
+ ***************************************************************************/
+
+int     lpjs_journal_commit(void)
+
+{
+    ssize_t bytes;
+    size_t  offset;
+    off_t   start_offset;
+    struct timespec start;
+
+    if ( (Journal_fd == -1) || (Journal_buff_len == 0) )
+    {
+	lpjs_journal_clear_uncommitted();
+	return LPJS_SUCCESS;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // O_APPEND writes go to the end, so that is where a commit starts
+    if ( (start_offset = lseek(Journal_fd, 0, SEEK_END)) == -1 )
+    {
+	lpjs_log("%s(): Error: lseek() failed on %s: %s\n", __FUNCTION__,
+		 LPJS_JOURNAL, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    for (offset = 0; offset < Journal_buff_len; offset += bytes)
+    {
+	bytes = write(Journal_fd, Journal_buff + offset,
+		      Journal_buff_len - offset);
+	if ( bytes == -1 )
+	{
+	    if ( errno == EINTR )
+	    {
+		bytes = 0;
+		continue;
+	    }
+	    lpjs_log("%s(): Error: write() failed on %s: %s\n", __FUNCTION__,
+		     LPJS_JOURNAL, strerror(errno));
+	    lpjs_journal_rollback(start_offset);
+	    return LPJS_WRITE_FAILED;
+	}
+    }
+
+    if ( fsync(Journal_fd) != 0 )
+    {
+	lpjs_log("%s(): Error: fsync() failed on %s: %s\n", __FUNCTION__,
+		 LPJS_JOURNAL, strerror(errno));
+	lpjs_journal_rollback(start_offset);
+	return LPJS_WRITE_FAILED;
+    }
+    Journal_buff_len = 0;
+    lpjs_journal_clear_uncommitted();
+    lpjs_metrics_observe(LPJS_METRIC_SPOOL_WRITE, &start);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Discard a failed commit from the journal, so that the next
+ *      commit rewrites the buffered records where it started
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_rollback(off_t start_offset)
+
+{
+    if ( ftruncate(Journal_fd, start_offset) != 0 )
+	lpjs_log("%s(): Error: ftruncate() failed on %s: %s\n", __FUNCTION__,
+		 LPJS_JOURNAL, strerror(errno));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Commit buffered records and compact the journal into a new
+ *      snapshot if it has grown large enough.  Called once per
+ *      iteration of the dispatchd event loop, so all events processed
+ *      in one iteration share a single fsync().
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_journal_checkpoint(job_list_t *pending_jobs, job_list_t *running_jobs,
+				node_list_t *node_list)
+
+{
+    if ( Journal_records >= LPJS_JOURNAL_COMPACT_RECORDS )
+	return lpjs_journal_compact(pending_jobs, running_jobs, node_list);
+    else
+	return lpjs_journal_commit();
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the complete queue state to a new snapshot and truncate
+ *      the journal.  A crash at any point leaves either the old
+ *      snapshot plus the full journal, or the new snapshot.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Binary snapshot
+ *  2026-10-19  Jason Bacon Record snapshot write time
+ *  2026-10-19  Jason Bacon Note that submissions are committed
+ ***************************************************************************/
+
+int     lpjs_journal_compact(job_list_t *pending_jobs, job_list_t *running_jobs,
+			     node_list_t *node_list)
+
+{
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ( lpjs_snapshot_write(pending_jobs, running_jobs, node_list,
+			     Next_job_id) != LPJS_SUCCESS )
+	return LPJS_WRITE_FAILED;
+
+    /*
+     *  Buffered records are already reflected in the snapshot, since
+     *  it was written from the in-memory lists.
+     */
+    Journal_buff_len = 0;
+    Journal_records = 0;
+    lpjs_journal_clear_uncommitted();
+    if ( Journal_fd != -1 )
+    {
+	if ( (ftruncate(Journal_fd, 0) != 0) || (fsync(Journal_fd) != 0) )
+	{
+	    lpjs_log("%s(): Error: Cannot truncate %s: %s\n", __FUNCTION__,
+		     LPJS_JOURNAL, strerror(errno));
+	    return LPJS_WRITE_FAILED;
+	}
+    }
+
+    lpjs_spool_remove_orphan_scripts(pending_jobs, running_jobs);
+    lpjs_metrics_observe(LPJS_METRIC_SNAPSHOT_WRITE, &start);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Restore the pending and running job lists from the snapshot
+ *      and replay the journal on top of it.  Node allocations are
+ *      restored along with the jobs.  The time taken is logged, and
+ *      lpjs_journal_note_dispatch() logs the time to first dispatch.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if there is neither a snapshot
+ *      nor a journal, i.e. the queue has never been journaled.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Binary snapshot, restart timing
+ ***************************************************************************/
+
+int     lpjs_journal_load(job_list_t *pending_jobs, job_list_t *running_jobs,
+			  node_list_t *node_list)
+
+{
+    int         snapshot_status,
+		journal_status;
+    struct timespec end_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Load_start);
+    snapshot_status = lpjs_snapshot_load(pending_jobs, running_jobs,
+					 node_list, &Next_job_id);
+    journal_status = lpjs_journal_replay(pending_jobs, running_jobs, node_list);
+    if ( (snapshot_status != LPJS_SUCCESS) && (journal_status != LPJS_SUCCESS) )
+	return LPJS_READ_FAILED;
+
+    /*
+     *  Jobs that were dispatched but never reported as started stay
+     *  dispatched until their compute node checks in and reports
+     *  whether the chaperone is alive.  Returning them to the queue
+     *  now could run them twice.  See lpjs_reconcile_node().
+     */
+
+    job_list_sort(pending_jobs);
+    job_list_sort(running_jobs);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    lpjs_log("%s(): Restored %zu pending and %zu running jobs in %.3f ms.  Next job ID = %lu.\n",
+	     __FUNCTION__, job_list_get_count(pending_jobs),
+	     job_list_get_count(running_jobs),
+	     lpjs_elapsed_ms(&Load_start, &end_time), Next_job_id);
+    Awaiting_first_dispatch = true;
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Log the time from the start of lpjs_journal_load() to the first
+ *      job dispatch after a restart.  Called by the scheduler after
+ *      every dispatch, but only logs once.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_note_dispatch(void)
+
+{
+    struct timespec now;
+
+    if ( Awaiting_first_dispatch )
+    {
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	lpjs_log("%s(): First dispatch %.3f ms after starting queue restore.\n",
+		 __FUNCTION__, lpjs_elapsed_ms(&Load_start, &now));
+	Awaiting_first_dispatch = false;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Apply all intact journal records to the job lists, and truncate
+ *      the journal after the last intact record.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if there is no journal
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_journal_replay(job_list_t *pending_jobs, job_list_t *running_jobs,
+			    node_list_t *node_list)
+
+{
+    int         fd;
+    uint32_t    header[2],
+		payload_len;
+    char        payload[LPJS_JOURNAL_PAYLOAD_MAX + 1];
+    off_t       good_offset = 0;
+    unsigned long   records = 0;
+
+    if ( (fd = open(LPJS_JOURNAL, O_RDWR)) == -1 )
+	return LPJS_READ_FAILED;
+
+    while ( read(fd, header, LPJS_JOURNAL_HEADER_SIZE) == LPJS_JOURNAL_HEADER_SIZE )
+    {
+	payload_len = ntohl(header[0]);
+	if ( (payload_len < 2) || (payload_len > LPJS_JOURNAL_PAYLOAD_MAX) ||
+	     (read(fd, payload, payload_len) != payload_len) ||
+	     (lpjs_crc32(payload, payload_len) != ntohl(header[1])) )
+	    break;
+	payload[payload_len] = '\0';
+	lpjs_journal_apply(payload, pending_jobs, running_jobs, node_list);
+	good_offset += LPJS_JOURNAL_HEADER_SIZE + payload_len;
+	++records;
+    }
+
+    if ( lseek(fd, 0, SEEK_END) != good_offset )
+    {
+	lpjs_log("%s(): Warning: Discarding incomplete record at offset %jd in %s.\n",
+		 __FUNCTION__, (intmax_t)good_offset, LPJS_JOURNAL);
+	if ( ftruncate(fd, good_offset) != 0 )
+	    lpjs_log("%s(): Error: Cannot truncate %s: %s\n", __FUNCTION__,
+		     LPJS_JOURNAL, strerror(errno));
+    }
+    close(fd);
+
+    lpjs_log("%s(): Replayed %lu records from %s.\n", __FUNCTION__,
+	     records, LPJS_JOURNAL);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Apply one journal record to the job lists.  Node allocations
+ *      restored from the snapshot are adjusted for jobs that started
+ *      or finished since, so they always equal the sum over running
+ *      jobs.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_apply(const char *payload,
+			   job_list_t *pending_jobs, job_list_t *running_jobs,
+			   node_list_t *node_list)
+
+{
+    job_t           *job, *old_job;
+    char            *end;
+    unsigned long   job_id;
+    bool            was_running = false;
+
+    switch(payload[0])
+    {
+	case    LPJS_JOURNAL_SUBMIT:
+	    // job_new() terminates the process if malloc fails
+	    job = job_new();
+	    job_read_from_string(job, payload + 1, &end);
+	    lpjs_journal_read_times(job, end);
+	    job_list_add_job(pending_jobs, job);
+	    if ( job_get_job_id(job) >= Next_job_id )
+		Next_job_id = job_get_job_id(job) + 1;
+	    break;
+
+	case    LPJS_JOURNAL_DISPATCH:
+	case    LPJS_JOURNAL_START:
+	    // Record holds the complete updated specs, so just replace
+	    job = job_new();
+	    job_read_from_string(job, payload + 1, &end);
+	    lpjs_journal_read_times(job, end);
+	    job_id = job_get_job_id(job);
+	    if ( (old_job = job_list_remove_job(pending_jobs, job_id)) == NULL )
+	    {
+		old_job = job_list_remove_job(running_jobs, job_id);
+		was_running = (old_job != NULL);
+	    }
+	    if ( old_job == NULL )
+		lpjs_log("%s(): Error: Journal event for unknown job %lu.\n",
+			 __FUNCTION__, job_id);
+	    else
+		job_free(&old_job);
+	    if ( payload[0] == LPJS_JOURNAL_START )
+	    {
+		job_list_add_job(running_jobs, job);
+		if ( ! was_running )
+		    lpjs_journal_adjust_node(node_list, job,
+					     NODE_RESOURCE_ALLOCATE);
+	    }
+	    else
+		job_list_add_job(pending_jobs, job);
+	    break;
+
+	case    LPJS_JOURNAL_COMPLETE:
+	case    LPJS_JOURNAL_CANCEL:
+	    job_id = strtoul(payload + 1, &end, 10);
+	    if ( (job = job_list_remove_job(running_jobs, job_id)) != NULL )
+		lpjs_journal_adjust_node(node_list, job, NODE_RESOURCE_RELEASE);
+	    else
+		job = job_list_remove_job(pending_jobs, job_id);
+	    if ( job == NULL )
+		lpjs_log("%s(): Error: Journal event for unknown job %lu.\n",
+			 __FUNCTION__, job_id);
+	    else
+		job_free(&job);
+	    break;
+
+	default:
+	    lpjs_log("%s(): Bug: Invalid journal event code %d.\n",
+		     __FUNCTION__, payload[0]);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read the submit and start times and launch stage stamps
+ *      following the job specs in a journal record.  Records written
+ *      before times or stamps were kept don't have them, so leave
+ *      them at 0.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_read_times(job_t *job, const char *str)
+
+{
+    intmax_t    submit_time, start_time, stamp;
+    char        *end;
+    int         c, consumed;
+    
+    if ( sscanf(str, "%jd %jd%n", &submit_time, &start_time, &consumed) == 2 )
+    {
+	job_set_submit_time(job, submit_time);
+	job_set_start_time(job, start_time);
+	
+	// Take as many stamps as are present
+	end = (char *)str + consumed;
+	for (c = 0; c < JOB_TIMING_STAGES; ++c)
+	{
+	    str = end;
+	    stamp = strtoimax(str, &end, 10);
+	    if ( end == str )
+		break;
+	    job_set_timing_ae(job, c, stamp);
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Allocate or release the resources of a running job on its
+ *      compute node during replay
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_journal_adjust_node(node_list_t *node_list, job_t *job,
+				 node_resource_t direction)
+
+{
+    node_t  *node;
+
+    node = node_list_find_hostname(node_list, job_get_compute_node(job));
+    if ( node == NULL )
+	lpjs_log("%s(): Error: Job %lu is running on unknown node %s.\n",
+		 __FUNCTION__, job_get_job_id(job), job_get_compute_node(job));
+    else
+	node_adjust_resources(node, job, direction);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert a queue loaded from the per-job spool directories used
+ *      by earlier versions.  Job scripts are copied to LPJS_SCRIPT_DIR
+ *      and the next job ID is taken from the old next-job file.  The
+ *      caller must then compact the journal to record the queue.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if a script cannot be copied
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_journal_import_legacy(job_list_t *job_list, const char *spool_dir)
+
+{
+    char    path[PATH_MAX + 1],
+	    script_buff[LPJS_SCRIPT_SIZE_MAX + 1];
+    size_t  c;
+    job_t   *job;
+    FILE    *fp;
+    unsigned long   next_job_id;
+    ssize_t script_size;
+
+    if ( (fp = fopen(LPJS_SPOOL_DIR "/next-job", "r")) != NULL )
+    {
+	if ( (fscanf(fp, "%lu", &next_job_id) == 1) &&
+	     (next_job_id > Next_job_id) )
+	    Next_job_id = next_job_id;
+	fclose(fp);
+    }
+
+    for (c = 0; c < job_list_get_count(job_list); ++c)
+    {
+	job = job_list_get_jobs_ae(job_list, c);
+	if ( job_get_job_id(job) >= Next_job_id )
+	    Next_job_id = job_get_job_id(job) + 1;
+
+	lpjs_spool_script_path(job, path, PATH_MAX + 1);
+	if ( access(path, F_OK) == 0 )
+	    continue;   // Another element of the same array
+
+	snprintf(path, PATH_MAX + 1, "%s/%lu/%s", spool_dir,
+		 job_get_job_id(job), job_get_script_name(job));
+	script_size = lpjs_load_script(path, script_buff,
+				       LPJS_SCRIPT_SIZE_MAX + 1);
+	if ( (script_size < 0) ||
+	     (lpjs_spool_script(job_get_submission_id(job), script_buff)
+	      != LPJS_SUCCESS) )
+	    return LPJS_WRITE_FAILED;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Get the path of the spooled copy of a job's script
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_spool_script_path(job_t *job, char *path, size_t array_size)
+
+{
+    snprintf(path, array_size, "%s/%lu", LPJS_SCRIPT_DIR,
+	     job_get_submission_id(job));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Store a copy of a submitted script, shared by all jobs in
+ *      the submission, and sync it to disk.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_spool_script(unsigned long submission_id, const char *script_text)
+
+{
+    char    script_path[PATH_MAX + 1];
+    int     fd;
+    size_t  len = strlen(script_text);
+
+    snprintf(script_path, PATH_MAX + 1, "%s/%lu", LPJS_SCRIPT_DIR,
+	     submission_id);
+    if ( (fd = open(script_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 script_path, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    if ( (write(fd, script_text, len) != len) || (fsync(fd) != 0) )
+    {
+	lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		 script_path, strerror(errno));
+	close(fd);
+	return LPJS_WRITE_FAILED;
+    }
+    close(fd);
+    lpjs_sync_dir(LPJS_SCRIPT_DIR);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove spooled scripts no longer referenced by any queued job.
+ *      Done at compaction time, so completions don't have to check
+ *      whether other elements of the same array are still queued.
+ *      The unlink()s are left to the cleanup thread.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_spool_remove_orphan_scripts(job_list_t *pending_jobs,
+					 job_list_t *running_jobs)
+
+{
+    DIR             *dp;
+    struct dirent   *entry;
+    unsigned long   *live_ids,
+		    id;
+    size_t          count, c;
+    char            path[PATH_MAX + 1];
+
+    count = job_list_get_count(pending_jobs) + job_list_get_count(running_jobs);
+    if ( (live_ids = malloc((count + 1) * sizeof(*live_ids))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    for (c = 0; c < job_list_get_count(pending_jobs); ++c)
+	live_ids[c] = job_get_submission_id(job_list_get_jobs_ae(pending_jobs, c));
+    for (c = 0; c < job_list_get_count(running_jobs); ++c)
+	live_ids[job_list_get_count(pending_jobs) + c] =
+	    job_get_submission_id(job_list_get_jobs_ae(running_jobs, c));
+    qsort(live_ids, count, sizeof(*live_ids),
+	  (int (*)(const void *, const void *))lpjs_ulong_cmp);
+
+    if ( (dp = opendir(LPJS_SCRIPT_DIR)) == NULL )
+    {
+	lpjs_log("%s(): Error: Cannot open %s: %s\n", __FUNCTION__,
+		 LPJS_SCRIPT_DIR, strerror(errno));
+	free(live_ids);
+	return;
+    }
+    while ( (entry = readdir(dp)) != NULL )
+    {
+	if ( ! xt_strisint(entry->d_name, 10) )
+	    continue;
+	id = strtoul(entry->d_name, NULL, 10);
+	if ( bsearch(&id, live_ids, count, sizeof(*live_ids),
+		     (int (*)(const void *, const void *))lpjs_ulong_cmp) == NULL )
+	{
+	    snprintf(path, PATH_MAX + 1, "%s/%s", LPJS_SCRIPT_DIR, entry->d_name);
+	    lpjs_cleanup_queue(path);
+	}
+    }
+    closedir(dp);
+    free(live_ids);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compare two unsigned longs for qsort() and bsearch()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_ulong_cmp(const unsigned long *n1, const unsigned long *n2)
+
+{
+    return (*n1 > *n2) - (*n1 < *n2);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      fsync() a directory, so that new, renamed, or removed entries
+ *      survive a power loss.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_sync_dir(const char *dir)
+
+{
+    int     fd, status;
+
+    if ( (fd = open(dir, O_RDONLY)) == -1 )
+	return -1;
+    status = fsync(fd);
+    close(fd);
+    return status;
+}
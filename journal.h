@@ -0,0 +1,49 @@
+#ifndef _LPJS_JOURNAL_H_
+#define _LPJS_JOURNAL_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#ifndef _LPJS_JOB_LIST_H_
+#include "job-list.h"
+#endif
+
+#ifndef _NODE_LIST_H_
+#include "node-list.h"
+#endif
+
+/*
+ *  Queue events recorded in the journal.  The event code is the first
+ *  byte of each record payload.  Don't start at 0, so payloads are
+ *  always valid non-empty strings.
+ */
+
+typedef enum
+{
+    LPJS_JOURNAL_SUBMIT = 1,
+    LPJS_JOURNAL_DISPATCH,
+    LPJS_JOURNAL_START,
+    LPJS_JOURNAL_COMPLETE,
+    LPJS_JOURNAL_CANCEL
+}   journal_event_t;
+
+// Buffered records of a submission not yet committed
+typedef struct
+{
+    size_t          start;
+    size_t          end;
+    unsigned long   records;
+}   journal_range_t;
+
+// uint32_t payload length + uint32_t CRC-32, both network byte order
+#define LPJS_JOURNAL_HEADER_SIZE        8
+// Event byte + specs + submit and start times + launch stage stamps
+#define LPJS_JOURNAL_PAYLOAD_MAX        (JOB_STR_MAX_LEN + 1 + \
+	(2 + JOB_TIMING_STAGES) * (LPJS_MAX_INT_DIGITS + 1))
+
+// Rewrite the snapshot and truncate the journal after this many records
+#define LPJS_JOURNAL_COMPACT_RECORDS    10000
+
+#include "journal-protos.h"
+
+#endif  // _LPJS_JOURNAL_H_
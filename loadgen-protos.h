@@ -0,0 +1,27 @@
+/* loadgen.c */
+unsigned long loadgen_uint_arg(char *argv[], int arg, unsigned long min, unsigned long max);
+double loadgen_seconds_arg(char *argv[], int arg);
+void loadgen_raise_fd_limit(void);
+void loadgen_build_submission(void);
+void loadgen_start_thread(void *(*function)(void *), void *arg);
+void loadgen_sleep(double seconds);
+int loadgen_connect(void);
+int loadgen_request(loadgen_request_t type, const char *msg, loadgen_response_t response_type, char *response, size_t response_size);
+void *loadgen_node(void *arg);
+void *loadgen_reporter(void *arg);
+void *loadgen_submitter(void *arg);
+void *loadgen_lister(void *arg);
+void *loadgen_canceler(void *arg);
+void loadgen_latency_init(loadgen_latency_t *latency);
+void loadgen_latency_add(loadgen_latency_t *latency, double ms);
+void loadgen_latency_error(loadgen_latency_t *latency);
+int loadgen_double_cmp(const double *d1, const double *d2);
+void loadgen_print_latency(FILE *stream);
+void loadgen_queue_init(loadgen_queue_t *queue);
+int loadgen_time_before(const struct timespec *t1, const struct timespec *t2);
+int loadgen_event_before(const loadgen_event_t *e1, const loadgen_event_t *e2);
+void loadgen_queue_push(loadgen_queue_t *queue, loadgen_request_t type, double delay, unsigned long job_id, pid_t chaperone_pid, unsigned node);
+void loadgen_queue_pop(loadgen_queue_t *queue, loadgen_event_t *event);
+void loadgen_queue_cancel(loadgen_queue_t *queue, pid_t chaperone_pid);
+void loadgen_monotonic_to_realtime(struct timespec *ts);
+void usage(char *argv[]);
@@ -0,0 +1,1164 @@
+/***************************************************************************
+ *  Description:
+ *      Load generator for lpjs_dispatchd.  Simulates many compute nodes
+ *      and concurrent lpjs submit, jobs, and cancel clients in one
+ *      process, and reports sustained job throughput and the latency
+ *      of each request type as seen by clients.
+ *
+ *      Each simulated node checks in like lpjs_compd_checkin(),
+ *      answers new jobs with LPJS_CHAPERONE_FORKED, and sends the start
+ *      and completion reports that a chaperone would after a simulated
+ *      run time.  No processes are started.  The simulated nodes must
+ *      be listed as compute nodes in the dispatchd config.  Use
+ *      --print-config to generate the line.
+ *
+ *      Run with "auth none" in the config to measure dispatchd
+ *      without credential costs on one machine, or "auth hmac" to
+ *      include a cheap credential without munged.  See auth.c.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Use auth backends instead of a munge stand-in
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sysexits.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/select.h>     // FD_SETSIZE
+#include <sys/socket.h>
+#include <sys/resource.h>   // setrlimit()
+#include <netinet/in.h>
+#include <arpa/inet.h>      // inet_addr()
+
+#include <xtend/string.h>   // strlcpy() on Linux
+#include <xtend/net.h>      // xt_resolve_hostname()
+
+#include "node-list.h"
+#include "config.h"
+#include "network.h"
+#include "misc.h"
+#include "lpjs.h"
+#include "loadgen.h"
+
+static loadgen_options_t    Options =
+{
+    .nodes = 100,
+    .procs = 16,
+    .phys_MiB = 65536,
+    .reporters = 64,     // Chaperones report independently
+    .submitters = 4,
+    .listers = 1,
+    .cancelers = 1,
+    .jobs_per_submit = 10,
+    .procs_per_job = 1,
+    .pmem_per_proc = 10,
+    .run_time = 1.0,
+    .start_delay = 0.01,
+    .duration = 60.0,
+    .submit_interval = 0.1,
+    .list_interval = 1.0,
+    .cancel_interval = 1.0,
+    .node_prefix = LOADGEN_NODE_PREFIX,
+    .user_name = NULL,
+    .verbose = false
+};
+
+static const char           *Request_names[LOADGEN_REQUEST_TYPES] =
+    { "checkin", "submit", "jobs", "cancel", "start", "complete",
+      "reconnect" };
+static loadgen_latency_t    Latency[LOADGEN_REQUEST_TYPES];
+static loadgen_queue_t      Queue;
+static loadgen_node_t       *Nodes;
+static struct sockaddr_in   Dispatchd_address;
+static char                 Submission[LPJS_MSG_LEN_MAX + 1];
+
+// Job IDs from recent submissions, for cancel clients
+static pthread_mutex_t      Recent_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long        Recent_jobs[LOADGEN_RECENT_JOBS];
+static size_t               Recent_count;
+
+static atomic_bool          Stop;
+static atomic_uint          Checked_in;
+static atomic_uint          Retry_hints;
+// When the first node of a full set was dropped, or 0
+static atomic_int_fast64_t  Drop_us;
+static atomic_int           Next_pid = LOADGEN_FIRST_PID;
+static atomic_uint_fast64_t Submitted, Dispatched, Completed, Canceled;
+
+int     main(int argc, char *argv[])
+
+{
+    // Terminates process if malloc() fails, no check required
+    node_list_t     *node_list = node_list_new();
+    extern FILE     *Log_stream;
+    char            head_text_ip[LPJS_TEXT_IP_ADDRESS_MAX + 1];
+    struct timespec start, now;
+    uint64_t        dispatched_start, completed_start;
+    double          elapsed;
+    unsigned        c;
+    int             arg;
+    bool            print_config = false;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( strcmp(argv[arg], "--print-config") == 0 )
+	    print_config = true;
+	else if ( strcmp(argv[arg], "--verbose") == 0 )
+	    Options.verbose = true;
+	else if ( arg == argc - 1 )
+	    usage(argv);
+	else if ( strcmp(argv[arg], "--nodes") == 0 )
+	    Options.nodes = loadgen_uint_arg(argv, ++arg, 1, LPJS_MAX_NODES);
+	else if ( strcmp(argv[arg], "--procs") == 0 )
+	    Options.procs = loadgen_uint_arg(argv, ++arg, 1, 65536);
+	else if ( strcmp(argv[arg], "--mem") == 0 )
+	    Options.phys_MiB = loadgen_uint_arg(argv, ++arg, 1, UINT32_MAX);
+	else if ( strcmp(argv[arg], "--reporters") == 0 )
+	    Options.reporters = loadgen_uint_arg(argv, ++arg, 1, 1024);
+	else if ( strcmp(argv[arg], "--submitters") == 0 )
+	    Options.submitters = loadgen_uint_arg(argv, ++arg, 0, 1024);
+	else if ( strcmp(argv[arg], "--listers") == 0 )
+	    Options.listers = loadgen_uint_arg(argv, ++arg, 0, 1024);
+	else if ( strcmp(argv[arg], "--cancelers") == 0 )
+	    Options.cancelers = loadgen_uint_arg(argv, ++arg, 0, 1024);
+	else if ( strcmp(argv[arg], "--jobs") == 0 )
+	    Options.jobs_per_submit = loadgen_uint_arg(argv, ++arg, 1, 100000);
+	else if ( strcmp(argv[arg], "--procs-per-job") == 0 )
+	    Options.procs_per_job = loadgen_uint_arg(argv, ++arg, 1, 65536);
+	else if ( strcmp(argv[arg], "--pmem-per-proc") == 0 )
+	    Options.pmem_per_proc = loadgen_uint_arg(argv, ++arg, 1, UINT32_MAX);
+	else if ( strcmp(argv[arg], "--run-time") == 0 )
+	    Options.run_time = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--start-delay") == 0 )
+	    Options.start_delay = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--duration") == 0 )
+	    Options.duration = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--submit-interval") == 0 )
+	    Options.submit_interval = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--list-interval") == 0 )
+	    Options.list_interval = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--cancel-interval") == 0 )
+	    Options.cancel_interval = loadgen_seconds_arg(argv, ++arg);
+	else if ( strcmp(argv[arg], "--node-prefix") == 0 )
+	    Options.node_prefix = argv[++arg];
+	else if ( strcmp(argv[arg], "--user") == 0 )
+	    Options.user_name = argv[++arg];
+	else
+	    usage(argv);
+    }
+
+    if ( (Nodes = malloc(Options.nodes * sizeof(*Nodes))) == NULL )
+    {
+	fprintf(stderr, "%s: malloc() failed.\n", argv[0]);
+	return EX_UNAVAILABLE;
+    }
+    for (c = 0; c < Options.nodes; ++c)
+    {
+	Nodes[c].index = c;
+	snprintf(Nodes[c].hostname, LOADGEN_HOSTNAME_MAX + 1, "%s%04u",
+		 Options.node_prefix, c + 1);
+    }
+
+    if ( print_config )
+    {
+	printf("compute");
+	for (c = 0; c < Options.nodes; ++c)
+	    printf("%s %s", c == 0 ? "" : ",", Nodes[c].hostname);
+	putchar('\n');
+	return EX_OK;
+    }
+
+    // Library functions log heavily, which would distort the results
+    if ( Options.verbose )
+	Log_stream = stderr;
+    else if ( (Log_stream = fopen("/dev/null", "w")) == NULL )
+    {
+	fprintf(stderr, "%s: Cannot open /dev/null.\n", argv[0]);
+	return EX_OSERR;
+    }
+
+    // dispatchd must not see root as the job owner
+    if ( Options.user_name == NULL )
+	Options.user_name = getuid() == 0 ? "nobody" : getenv("USER");
+    if ( Options.user_name == NULL )
+	Options.user_name = "nobody";
+
+    // Resolve once, rather than on every connection
+    lpjs_load_config(node_list, LPJS_CONFIG_HEAD_ONLY, stderr);
+    if ( xt_resolve_hostname(node_list_get_head_node(node_list), head_text_ip,
+			     LPJS_TEXT_IP_ADDRESS_MAX + 1) != XT_OK )
+    {
+	fprintf(stderr, "%s: Cannot resolve %s.\n", argv[0],
+		node_list_get_head_node(node_list));
+	return EX_NOHOST;
+    }
+    memset(&Dispatchd_address, 0, sizeof(Dispatchd_address));
+    Dispatchd_address.sin_family = AF_INET;
+    Dispatchd_address.sin_addr.s_addr = inet_addr(head_text_ip);
+    Dispatchd_address.sin_port = htons(LPJS_IP_TCP_PORT);
+
+    // Progress may be followed in a file, see Test/reconnect-bench.sh
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    
+    // Failed sends should show up as errors, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    loadgen_raise_fd_limit();
+    loadgen_build_submission();
+    for (c = 0; c < LOADGEN_REQUEST_TYPES; ++c)
+	loadgen_latency_init(&Latency[c]);
+    loadgen_queue_init(&Queue);
+
+    for (c = 0; c < Options.reporters; ++c)
+	loadgen_start_thread(loadgen_reporter, NULL);
+    for (c = 0; c < Options.nodes; ++c)
+	loadgen_start_thread(loadgen_node, &Nodes[c]);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+	usleep(100000);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+    }   while ( (atomic_load(&Checked_in) < Options.nodes) &&
+		(now.tv_sec - start.tv_sec < LOADGEN_CHECKIN_TIMEOUT) );
+    printf("%u of %u nodes checked in.\n", atomic_load(&Checked_in),
+	   Options.nodes);
+    if ( atomic_load(&Checked_in) == 0 )
+    {
+	fprintf(stderr, "%s: No nodes checked in.  Are they in the dispatchd config?\n",
+		argv[0]);
+	return EX_UNAVAILABLE;
+    }
+
+    // Measure only the period with clients running
+    dispatched_start = atomic_load(&Dispatched);
+    completed_start = atomic_load(&Completed);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (c = 0; c < Options.submitters; ++c)
+	loadgen_start_thread(loadgen_submitter, NULL);
+    for (c = 0; c < Options.listers; ++c)
+	loadgen_start_thread(loadgen_lister, NULL);
+    for (c = 0; c < Options.cancelers; ++c)
+	loadgen_start_thread(loadgen_canceler, NULL);
+
+    do
+    {
+	loadgen_sleep(LOADGEN_REPORT_INTERVAL < Options.duration ?
+		      LOADGEN_REPORT_INTERVAL : Options.duration);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = lpjs_elapsed_ms(&start, &now) / 1000.0;
+	printf("%6.0fs  nodes %u  submitted %ju  dispatched %ju  completed %ju  canceled %ju\n",
+	       elapsed, atomic_load(&Checked_in),
+	       (uintmax_t)atomic_load(&Submitted),
+	       (uintmax_t)atomic_load(&Dispatched),
+	       (uintmax_t)atomic_load(&Completed),
+	       (uintmax_t)atomic_load(&Canceled));
+    }   while ( elapsed < Options.duration );
+    atomic_store(&Stop, true);
+
+    printf("\nSustained over %.1f seconds:\n", elapsed);
+    printf("    %.1f jobs/s dispatched\n",
+	   (atomic_load(&Dispatched) - dispatched_start) / elapsed);
+    printf("    %.1f jobs/s completed\n",
+	   (atomic_load(&Completed) - completed_start) / elapsed);
+    printf("    %u retry-after replies to checkins\n\n",
+	   atomic_load(&Retry_hints));
+    loadgen_print_latency(stdout);
+
+    // Simulated nodes and clients in progress end with the process
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse an unsigned integer option value within [min, max]
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned long   loadgen_uint_arg(char *argv[], int arg, unsigned long min,
+				 unsigned long max)
+
+{
+    unsigned long   value;
+    char            *end;
+
+    value = strtoul(argv[arg], &end, 10);
+    if ( (*end != '\0') || (value < min) || (value > max) )
+    {
+	fprintf(stderr, "%s: %s must be an integer from %lu to %lu.\n",
+		argv[0], argv[arg - 1], min, max);
+	exit(EX_USAGE);
+    }
+    return value;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse a non-negative number of seconds
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+double  loadgen_seconds_arg(char *argv[], int arg)
+
+{
+    double  value;
+    char    *end;
+
+    value = strtod(argv[arg], &end);
+    if ( (*end != '\0') || (value < 0) )
+    {
+	fprintf(stderr, "%s: %s must be a number of seconds.\n",
+		argv[0], argv[arg - 1]);
+	exit(EX_USAGE);
+    }
+    return value;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Each simulated node holds a connection open, so allow as many
+ *      descriptors as the hard limit permits
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_raise_fd_limit(void)
+
+{
+    struct rlimit   limit;
+
+    if ( getrlimit(RLIMIT_NOFILE, &limit) == 0 )
+    {
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+	getrlimit(RLIMIT_NOFILE, &limit);
+	if ( limit.rlim_cur < Options.nodes + 64 )
+	    fprintf(stderr, "Warning: Open file limit %ju may be too low for %u nodes.\n",
+		    (uintmax_t)limit.rlim_cur, Options.nodes);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Build the submit request sent by all submitter threads, as
+ *      lpjs submit would for a trivial script
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_build_submission(void)
+
+{
+    // Terminates process if malloc() fails, no check required
+    job_t   *job = job_new();
+    char    hostname[LOADGEN_HOSTNAME_MAX + 1],
+	    job_string[LPJS_PAYLOAD_MAX + 1];
+
+    gethostname(hostname, LOADGEN_HOSTNAME_MAX + 1);
+    job_set_job_count(job, Options.jobs_per_submit);
+    job_set_procs_per_job(job, Options.procs_per_job);
+    job_set_min_procs_per_node(job, Options.procs_per_job);
+    job_set_pmem_per_proc(job, Options.pmem_per_proc);
+    job_set_user_name(job, lpjs_strdup(Options.user_name));
+    job_set_primary_group_name(job, lpjs_strdup(Options.user_name));
+    job_set_submit_node(job, lpjs_strdup(hostname));
+    job_set_submit_dir(job, lpjs_strdup("/tmp"));
+    job_set_script_name(job, lpjs_strdup("loadgen.lpjs"));
+    job_set_log_dir(job, lpjs_strdup("/tmp"));
+    // job_init() sets a static "TBD", which job_free() would free
+    job_set_compute_node(job, lpjs_strdup("TBD"));
+    job_print_to_string(job, job_string, LPJS_PAYLOAD_MAX + 1);
+    job_free(&job);
+
+    snprintf(Submission, LPJS_MSG_LEN_MAX + 1,
+	     "%c%s\n#!/bin/sh\n\n# Generated by lpjs-loadgen\nsleep %g\n",
+	     LPJS_DISPATCHD_REQUEST_SUBMIT, job_string, Options.run_time);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Start a detached thread
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_start_thread(void *(*function)(void *), void *arg)
+
+{
+    pthread_t   thread;
+
+    if ( pthread_create(&thread, NULL, function, arg) != 0 )
+    {
+	fprintf(stderr, "lpjs-loadgen: pthread_create() failed: %s\n",
+		strerror(errno));
+	exit(EX_OSERR);
+    }
+    pthread_detach(thread);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Sleep for a fractional number of seconds
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_sleep(double seconds)
+
+{
+    struct timespec interval;
+
+    interval.tv_sec = seconds;
+    interval.tv_nsec = (seconds - interval.tv_sec) * 1000000000.0;
+    while ( nanosleep(&interval, &interval) == -1 )
+	;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Connect to dispatchd at the address resolved at startup
+ *
+ *  Returns:
+ *      Connected socket, or -1 on failure
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     loadgen_connect(void)
+
+{
+    int     msg_fd;
+
+    if ( (msg_fd = socket(PF_INET, SOCK_STREAM, 0)) < 0 )
+	return -1;
+    if ( connect(msg_fd, (struct sockaddr *)&Dispatchd_address,
+		 sizeof(Dispatchd_address)) < 0 )
+    {
+	close(msg_fd);
+	return -1;
+    }
+    return msg_fd;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Connect, send one request, and collect the response, if any,
+ *      like lpjs_print_response().  The time from
+ *      connect to the end of the response is added to the latency of
+ *      the request type.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     loadgen_request(loadgen_request_t type, const char *msg,
+			loadgen_response_t response_type, char *response,
+			size_t response_size)
+
+{
+    struct timespec start, end;
+    char            *payload;
+    ssize_t         bytes;
+    size_t          len = 0;
+    uid_t           uid;
+    gid_t           gid;
+    int             msg_fd, timeout;
+    bool            done = (response_type == LOADGEN_RESPONSE_NONE);
+
+    if ( response != NULL )
+	*response = '\0';
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ( (msg_fd = loadgen_connect()) == -1 )
+    {
+	loadgen_latency_error(&Latency[type]);
+	return LPJS_WRITE_FAILED;
+    }
+    if ( lpjs_send_munge(msg_fd, msg, lpjs_no_close) != LPJS_MSG_SENT )
+    {
+	// lpjs_no_close(): Closing twice could hit another thread's socket
+	close(msg_fd);
+	loadgen_latency_error(&Latency[type]);
+	return LPJS_WRITE_FAILED;
+    }
+
+    // lpjs_recv() uses select(), which cannot handle larger descriptors
+    timeout = msg_fd < FD_SETSIZE ? LOADGEN_RESPONSE_TIMEOUT : 0;
+    while ( ! done &&
+	    (bytes = lpjs_recv_munge(msg_fd, &payload, 0, timeout,
+				     &uid, &gid, lpjs_no_close)) > 0 )
+    {
+	done = (response_type == LOADGEN_RESPONSE_ONE) ||
+	       (payload[bytes - 1] == LPJS_EOT);
+	if ( (response != NULL) && (len + 1 < response_size) )
+	{
+	    strlcpy(response + len, payload, response_size - len);
+	    len += strlen(response + len);
+	}
+	free(payload);
+    }
+    close(msg_fd);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    loadgen_latency_add(&Latency[type], lpjs_elapsed_ms(&start, &end));
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Simulated compute node: Check in like lpjs_compd, then answer
+ *      new jobs and cancel requests on the checkin connection until
+ *      dispatchd closes it, checking in again with the same backoff
+ *      and retry-after handling as lpjs_compd_checkin_loop().  Records
+ *      the time from each drop to checking in again, and reports when
+ *      all nodes are back after a dispatchd restart.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Back off and honor retry-after like compd
+ *  2026-10-19  Jason Bacon No verification replies after checkin, like compd
+ ***************************************************************************/
+
+void    *loadgen_node(void *arg)
+
+{
+    loadgen_node_t  *lnode = arg;
+    char            outgoing_msg[LPJS_MSG_LEN_MAX + 1],
+		    specs[NODE_SPECS_LEN + 1],
+		    forked_msg[2] = { LPJS_CHAPERONE_FORKED, '\0' },
+		    *munge_payload,
+		    *end;
+    // Terminates process if malloc() fails, no check required
+    node_t          *node = node_new();
+    job_t           *job;
+    struct timespec start, now, dropped;
+    ssize_t         bytes;
+    uid_t           uid;
+    gid_t           gid;
+    int             msg_fd;
+    pid_t           chaperone_pid;
+    bool            reconnecting = false;
+    lpjs_backoff_t  backoff;
+    int_fast64_t    drop_us;
+
+    node_set_hostname(node, lnode->hostname);
+    node_set_state(node, "up");
+    node_set_procs(node, Options.procs);
+    node_set_phys_MiB(node, Options.phys_MiB);
+    node_set_zfs(node, 0);
+    node_set_os(node, "loadgen");
+    node_set_arch(node, "none");
+
+    // No inventory after the specs: Nothing is running yet
+    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%s",
+	     LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN,
+	     node_specs_to_str(node, specs, NODE_SPECS_LEN + 1));
+
+    lpjs_backoff_init(&backoff);
+    while ( true )
+    {
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if ( ((msg_fd = loadgen_connect()) == -1) ||
+	     (lpjs_send_munge(msg_fd, outgoing_msg, lpjs_no_close)
+	      != LPJS_MSG_SENT) ||
+	     (lpjs_recv_munge(msg_fd, &munge_payload, 0, 0, &uid, &gid,
+			      lpjs_no_close) < 1) )
+	{
+	    loadgen_latency_error(&Latency[LOADGEN_REQUEST_CHECKIN]);
+	    if ( msg_fd != -1 )
+		close(msg_fd);
+	    lpjs_backoff_wait(&backoff);
+	    continue;
+	}
+	if ( lpjs_backoff_hint(&backoff, munge_payload) )
+	{
+	    atomic_fetch_add(&Retry_hints, 1);
+	    free(munge_payload);
+	    close(msg_fd);
+	    lpjs_backoff_wait(&backoff);
+	    continue;
+	}
+	if ( strcmp(munge_payload, "Node authorized") != 0 )
+	{
+	    fprintf(stderr, "lpjs-loadgen: %s is not in the dispatchd config.\n",
+		    lnode->hostname);
+	    free(munge_payload);
+	    close(msg_fd);
+	    return NULL;
+	}
+	free(munge_payload);
+	lpjs_backoff_init(&backoff);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	loadgen_latency_add(&Latency[LOADGEN_REQUEST_CHECKIN],
+			    lpjs_elapsed_ms(&start, &now));
+	if ( reconnecting )
+	    loadgen_latency_add(&Latency[LOADGEN_REQUEST_RECONNECT],
+				lpjs_elapsed_ms(&dropped, &now));
+	
+	// Last one back after a dispatchd restart?
+	if ( (atomic_fetch_add(&Checked_in, 1) + 1 == Options.nodes) &&
+	     ((drop_us = atomic_exchange(&Drop_us, 0)) != 0) )
+	    printf("All %u nodes checked in again %.1f s after the first drop, "
+		   "%u retry-after replies so far.\n", Options.nodes,
+		   (lpjs_monotonic_us() - drop_us) / 1000000.0,
+		   atomic_load(&Retry_hints));
+
+	while ( (bytes = lpjs_recv_node_munge(msg_fd, &munge_payload, 0, 0,
+					      &uid, &gid, lpjs_no_close)) > 0 )
+	{
+	    if ( munge_payload[0] == LPJS_EOT )
+	    {
+		free(munge_payload);
+		break;
+	    }
+	    else if ( munge_payload[0] == LPJS_COMPD_REQUEST_NEW_JOB )
+	    {
+		// Terminates process if malloc() fails, no check required
+		job = job_new();
+		job_read_from_string(job, munge_payload + 1, &end);
+		if ( lpjs_send_node_munge(msg_fd, forked_msg, lpjs_no_close)
+		     == LPJS_MSG_SENT )
+		{
+		    atomic_fetch_add(&Dispatched, 1);
+		    loadgen_queue_push(&Queue, LOADGEN_REQUEST_START,
+				       Options.start_delay,
+				       job_get_job_id(job),
+				       atomic_fetch_add(&Next_pid, 2),
+				       lnode->index);
+		}
+		job_free(&job);
+	    }
+	    else if ( munge_payload[0] == LPJS_COMPD_REQUEST_CANCEL )
+	    {
+		chaperone_pid = strtoul(munge_payload + 1, &end, 10);
+		loadgen_queue_cancel(&Queue, chaperone_pid);
+	    }
+	    free(munge_payload);
+	}
+
+	// Dispatchd closed the connection, check in again like compd
+	close(msg_fd);
+	clock_gettime(CLOCK_MONOTONIC, &dropped);
+	reconnecting = true;
+	if ( atomic_fetch_sub(&Checked_in, 1) == Options.nodes )
+	    atomic_store(&Drop_us, lpjs_monotonic_us());
+	lpjs_backoff_wait(&backoff);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send start and completion reports as simulated chaperones,
+ *      each on a new connection.  Chaperones now send them through
+ *      compd, but dispatchd still accepts them directly, and this is
+ *      the worst case for the listening socket.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *loadgen_reporter(void *arg)
+
+{
+    loadgen_event_t event;
+    char            outgoing_msg[LPJS_MSG_LEN_MAX + 1];
+    const char      *hostname;
+
+    while ( true )
+    {
+	loadgen_queue_pop(&Queue, &event);
+	hostname = Nodes[event.node].hostname;
+	if ( event.type == LOADGEN_REQUEST_START )
+	{
+	    // Same as lpjs_job_start_notice_loop(), job PID follows chaperone
+	    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%s %lu %d %d %jd",
+		     LPJS_DISPATCHD_REQUEST_JOB_STARTED, hostname,
+		     event.job_id, event.chaperone_pid,
+		     event.chaperone_pid + 1, (intmax_t)lpjs_time_us());
+	    if ( loadgen_request(LOADGEN_REQUEST_START, outgoing_msg,
+				 LOADGEN_RESPONSE_ONE, NULL, 0) == LPJS_SUCCESS )
+		loadgen_queue_push(&Queue, LOADGEN_REQUEST_COMPLETE,
+				   Options.run_time, event.job_id,
+				   event.chaperone_pid, event.node);
+	    else
+		loadgen_queue_push(&Queue, LOADGEN_REQUEST_START,
+				   LOADGEN_RETRY_SECONDS, event.job_id,
+				   event.chaperone_pid, event.node);
+	}
+	else
+	{
+	    // Same as lpjs_chaperone_completion_loop()
+	    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%s %lu %d\n",
+		     LPJS_DISPATCHD_REQUEST_JOB_COMPLETE, hostname,
+		     event.job_id, 0);
+	    if ( loadgen_request(LOADGEN_REQUEST_COMPLETE, outgoing_msg,
+				 LOADGEN_RESPONSE_NONE, NULL, 0) == LPJS_SUCCESS )
+		atomic_fetch_add(&Completed, 1);
+	    else
+		loadgen_queue_push(&Queue, LOADGEN_REQUEST_COMPLETE,
+				   LOADGEN_RETRY_SECONDS, event.job_id,
+				   event.chaperone_pid, event.node);
+	}
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Submit client, like repeated lpjs submit
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *loadgen_submitter(void *arg)
+
+{
+    char            response[LPJS_MSG_LEN_MAX + 1];
+    unsigned long   first_job_id, last_job_id, job_id;
+
+    while ( ! atomic_load(&Stop) )
+    {
+	if ( loadgen_request(LOADGEN_REQUEST_SUBMIT, Submission,
+			     LOADGEN_RESPONSE_EOT, response, LPJS_MSG_LEN_MAX + 1) == LPJS_SUCCESS )
+	{
+	    if ( sscanf(response, "Spooled jobs %lu through %lu",
+			&first_job_id, &last_job_id) == 2 )
+		;
+	    else if ( sscanf(response, "Spooled job %lu", &first_job_id) == 1 )
+		last_job_id = first_job_id;
+	    else
+	    {
+		// Commit failure or rejection
+		loadgen_latency_error(&Latency[LOADGEN_REQUEST_SUBMIT]);
+		loadgen_sleep(Options.submit_interval);
+		continue;
+	    }
+
+	    atomic_fetch_add(&Submitted, last_job_id - first_job_id + 1);
+	    pthread_mutex_lock(&Recent_lock);
+	    for (job_id = first_job_id; job_id <= last_job_id; ++job_id)
+		Recent_jobs[Recent_count++ % LOADGEN_RECENT_JOBS] = job_id;
+	    pthread_mutex_unlock(&Recent_lock);
+	}
+	loadgen_sleep(Options.submit_interval);
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Job list client, like repeated lpjs jobs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *loadgen_lister(void *arg)
+
+{
+    char    outgoing_msg[2] = { LPJS_DISPATCHD_REQUEST_JOB_LIST, '\0' };
+
+    while ( ! atomic_load(&Stop) )
+    {
+	loadgen_request(LOADGEN_REQUEST_JOBS, outgoing_msg,
+			LOADGEN_RESPONSE_EOT, NULL, 0);
+	loadgen_sleep(Options.list_interval);
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Cancel client, like lpjs cancel on a random recent job, which
+ *      may be pending, running, or already finished
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *loadgen_canceler(void *arg)
+
+{
+    char            outgoing_msg[LPJS_MSG_LEN_MAX + 1];
+    unsigned long   job_id;
+    unsigned        seed = (unsigned)(uintptr_t)&job_id;
+    size_t          count;
+
+    while ( ! atomic_load(&Stop) )
+    {
+	loadgen_sleep(Options.cancel_interval);
+	pthread_mutex_lock(&Recent_lock);
+	count = Recent_count < LOADGEN_RECENT_JOBS ? Recent_count :
+		LOADGEN_RECENT_JOBS;
+	job_id = count == 0 ? 0 : Recent_jobs[rand_r(&seed) % count];
+	pthread_mutex_unlock(&Recent_lock);
+	if ( job_id == 0 )
+	    continue;
+
+	snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%lu",
+		 LPJS_DISPATCHD_REQUEST_CANCEL, job_id);
+	if ( loadgen_request(LOADGEN_REQUEST_CANCEL, outgoing_msg,
+			     LOADGEN_RESPONSE_EOT, NULL, 0) == LPJS_SUCCESS )
+	    atomic_fetch_add(&Canceled, 1);
+    }
+
+    return NULL;
+}
+
+
+void    loadgen_latency_init(loadgen_latency_t *latency)
+
+{
+    pthread_mutex_init(&latency->lock, NULL);
+    latency->ms = NULL;
+    latency->count = latency->size = 0;
+    latency->errors = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record one round trip time in milliseconds
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_latency_add(loadgen_latency_t *latency, double ms)
+
+{
+    pthread_mutex_lock(&latency->lock);
+    if ( latency->count == latency->size )
+    {
+	latency->size = latency->size == 0 ? 1024 : latency->size * 2;
+	latency->ms = realloc(latency->ms, latency->size * sizeof(double));
+	if ( latency->ms == NULL )
+	{
+	    fprintf(stderr, "lpjs-loadgen: realloc() failed.\n");
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    latency->ms[latency->count++] = ms;
+    pthread_mutex_unlock(&latency->lock);
+}
+
+
+void    loadgen_latency_error(loadgen_latency_t *latency)
+
+{
+    pthread_mutex_lock(&latency->lock);
+    ++latency->errors;
+    pthread_mutex_unlock(&latency->lock);
+}
+
+
+int     loadgen_double_cmp(const double *d1, const double *d2)
+
+{
+    return *d1 < *d2 ? -1 : *d1 > *d2;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print the latency distribution of each request type
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_print_latency(FILE *stream)
+
+{
+    loadgen_latency_t   *latency;
+    unsigned            c;
+
+    fprintf(stream, "Request      Count   Errors   p50 ms   p99 ms   max ms\n");
+    for (c = 0; c < LOADGEN_REQUEST_TYPES; ++c)
+    {
+	latency = &Latency[c];
+	pthread_mutex_lock(&latency->lock);
+	fprintf(stream, "%-8s %9zu %8ju", Request_names[c], latency->count,
+		(uintmax_t)latency->errors);
+	if ( latency->count == 0 )
+	    fprintf(stream, "        -        -        -\n");
+	else
+	{
+	    qsort(latency->ms, latency->count, sizeof(double),
+		  (int (*)(const void *, const void *))loadgen_double_cmp);
+	    fprintf(stream, " %8.2f %8.2f %8.2f\n",
+		    latency->ms[(latency->count - 1) / 2],
+		    latency->ms[(size_t)((latency->count - 1) * 0.99)],
+		    latency->ms[latency->count - 1]);
+	}
+	pthread_mutex_unlock(&latency->lock);
+    }
+}
+
+
+void    loadgen_queue_init(loadgen_queue_t *queue)
+
+{
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    queue->heap = NULL;
+    queue->count = queue->size = 0;
+}
+
+
+int     loadgen_time_before(const struct timespec *t1,
+			    const struct timespec *t2)
+
+{
+    return (t1->tv_sec < t2->tv_sec) ||
+	   ((t1->tv_sec == t2->tv_sec) && (t1->tv_nsec < t2->tv_nsec));
+}
+
+
+int     loadgen_event_before(const loadgen_event_t *e1,
+			     const loadgen_event_t *e2)
+
+{
+    return loadgen_time_before(&e1->due, &e2->due);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Schedule a report delay seconds from now
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_queue_push(loadgen_queue_t *queue, loadgen_request_t type,
+			   double delay, unsigned long job_id,
+			   pid_t chaperone_pid, unsigned node)
+
+{
+    loadgen_event_t event, temp;
+    size_t          c, parent;
+
+    clock_gettime(CLOCK_MONOTONIC, &event.due);
+    event.due.tv_sec += (time_t)delay;
+    event.due.tv_nsec += (delay - (time_t)delay) * 1000000000.0;
+    if ( event.due.tv_nsec >= 1000000000 )
+    {
+	++event.due.tv_sec;
+	event.due.tv_nsec -= 1000000000;
+    }
+    event.type = type;
+    event.job_id = job_id;
+    event.chaperone_pid = chaperone_pid;
+    event.node = node;
+    event.canceled = false;
+
+    pthread_mutex_lock(&queue->lock);
+    if ( queue->count == queue->size )
+    {
+	queue->size = queue->size == 0 ? 1024 : queue->size * 2;
+	queue->heap = realloc(queue->heap, queue->size * sizeof(*queue->heap));
+	if ( queue->heap == NULL )
+	{
+	    fprintf(stderr, "lpjs-loadgen: realloc() failed.\n");
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+
+    // Sift up
+    c = queue->count++;
+    queue->heap[c] = event;
+    while ( c > 0 )
+    {
+	parent = (c - 1) / 2;
+	if ( ! loadgen_event_before(&queue->heap[c], &queue->heap[parent]) )
+	    break;
+	temp = queue->heap[c];
+	queue->heap[c] = queue->heap[parent];
+	queue->heap[parent] = temp;
+	c = parent;
+    }
+
+    // New event may be due before the one reporters are waiting for
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wait for the earliest report to come due and remove it,
+ *      skipping those for canceled jobs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_queue_pop(loadgen_queue_t *queue, loadgen_event_t *event)
+
+{
+    struct timespec now, due;
+    loadgen_event_t temp;
+    size_t          c, child;
+
+    pthread_mutex_lock(&queue->lock);
+    while ( true )
+    {
+	if ( queue->count == 0 )
+	{
+	    pthread_cond_wait(&queue->cond, &queue->lock);
+	    continue;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	due = queue->heap[0].due;
+	if ( loadgen_time_before(&now, &due) )
+	{
+	    // pthread_cond_timedwait() uses CLOCK_REALTIME by default
+	    loadgen_monotonic_to_realtime(&due);
+	    pthread_cond_timedwait(&queue->cond, &queue->lock, &due);
+	    continue;
+	}
+
+	*event = queue->heap[0];
+
+	// Sift down
+	queue->heap[0] = queue->heap[--queue->count];
+	c = 0;
+	while ( (child = 2 * c + 1) < queue->count )
+	{
+	    if ( (child + 1 < queue->count) &&
+		 loadgen_event_before(&queue->heap[child + 1],
+				      &queue->heap[child]) )
+		++child;
+	    if ( ! loadgen_event_before(&queue->heap[child], &queue->heap[c]) )
+		break;
+	    temp = queue->heap[c];
+	    queue->heap[c] = queue->heap[child];
+	    queue->heap[child] = temp;
+	    c = child;
+	}
+
+	if ( ! event->canceled )
+	    break;
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Drop pending reports for a canceled chaperone, which would
+ *      have been killed by compd
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_queue_cancel(loadgen_queue_t *queue, pid_t chaperone_pid)
+
+{
+    size_t  c;
+
+    pthread_mutex_lock(&queue->lock);
+    for (c = 0; c < queue->count; ++c)
+	if ( queue->heap[c].chaperone_pid == chaperone_pid )
+	    queue->heap[c].canceled = true;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert a CLOCK_MONOTONIC time to CLOCK_REALTIME in place
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    loadgen_monotonic_to_realtime(struct timespec *ts)
+
+{
+    struct timespec mono, real;
+
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    ts->tv_sec += real.tv_sec - mono.tv_sec;
+    ts->tv_nsec += real.tv_nsec - mono.tv_nsec;
+    if ( ts->tv_nsec < 0 )
+    {
+	--ts->tv_sec;
+	ts->tv_nsec += 1000000000;
+    }
+    else if ( ts->tv_nsec >= 1000000000 )
+    {
+	++ts->tv_sec;
+	ts->tv_nsec -= 1000000000;
+    }
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--print-config] [--verbose] [--nodes N]\n"
+	"       [--procs N] [--mem MiB] [--reporters N] [--submitters N]\n"
+	"       [--listers N] [--cancelers N] [--jobs N] [--procs-per-job N]\n"
+	"       [--pmem-per-proc MiB] [--run-time sec] [--start-delay sec]\n"
+	"       [--duration sec] [--submit-interval sec] [--list-interval sec]\n"
+	"       [--cancel-interval sec] [--node-prefix name] [--user name]\n",
+	argv[0]);
+    exit(EX_USAGE);
+}
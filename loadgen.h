@@ -0,0 +1,103 @@
+#ifndef _LPJS_LOADGEN_H_
+#define _LPJS_LOADGEN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define LOADGEN_NODE_PREFIX         "loadgen-"
+#define LOADGEN_HOSTNAME_MAX        64
+#define LOADGEN_RECENT_JOBS         4096    // Job IDs for cancel clients
+#define LOADGEN_CHECKIN_TIMEOUT     30      // Seconds to wait for all nodes
+#define LOADGEN_REPORT_INTERVAL     10      // Seconds between progress lines
+#define LOADGEN_RETRY_SECONDS       1.0     // After a failed report
+// Under heavy load dispatchd may take a while to get to a request
+#define LOADGEN_RESPONSE_TIMEOUT    10000000    // useconds
+// Fake chaperone PIDs, well above real PIDs on the same machine
+#define LOADGEN_FIRST_PID           10000000
+
+typedef enum
+{
+    LOADGEN_REQUEST_CHECKIN = 0,
+    LOADGEN_REQUEST_SUBMIT,
+    LOADGEN_REQUEST_JOBS,
+    LOADGEN_REQUEST_CANCEL,
+    LOADGEN_REQUEST_START,
+    LOADGEN_REQUEST_COMPLETE,
+    LOADGEN_REQUEST_RECONNECT,  // From losing dispatchd to checked in
+    LOADGEN_REQUEST_TYPES
+}   loadgen_request_t;
+
+// How much of the response loadgen_request() waits for
+typedef enum
+{
+    LOADGEN_RESPONSE_NONE = 0,
+    LOADGEN_RESPONSE_ONE,       // dispatchd then waits for us to close
+    LOADGEN_RESPONSE_EOT
+}   loadgen_response_t;
+
+// Client side round trip times of one request type
+typedef struct
+{
+    pthread_mutex_t lock;
+    double          *ms;
+    size_t          count;
+    size_t          size;
+    uint64_t        errors;
+}   loadgen_latency_t;
+
+// A start or completion report that a chaperone would send
+typedef struct
+{
+    struct timespec     due;
+    unsigned long       job_id;
+    pid_t               chaperone_pid;
+    unsigned            node;
+    loadgen_request_t   type;
+    bool                canceled;
+}   loadgen_event_t;
+
+// Min-heap of events ordered by due time
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    loadgen_event_t *heap;
+    size_t          count;
+    size_t          size;
+}   loadgen_queue_t;
+
+typedef struct
+{
+    unsigned        index;
+    char            hostname[LOADGEN_HOSTNAME_MAX + 1];
+}   loadgen_node_t;
+
+typedef struct
+{
+    unsigned        nodes;
+    unsigned        procs;
+    unsigned long   phys_MiB;
+    unsigned        reporters;
+    unsigned        submitters;
+    unsigned        listers;
+    unsigned        cancelers;
+    unsigned        jobs_per_submit;
+    unsigned        procs_per_job;
+    unsigned long   pmem_per_proc;
+    double          run_time;
+    double          start_delay;
+    double          duration;
+    double          submit_interval;
+    double          list_interval;
+    double          cancel_interval;
+    const char      *node_prefix;
+    const char      *user_name;
+    bool            verbose;
+}   loadgen_options_t;
+
+#include "loadgen-protos.h"
+
+#endif  // _LPJS_LOADGEN_H_
@@ -0,0 +1,13 @@
+/* logger.c */
+int lpjs_log_start(void);
+int lpjs_log_vwrite(int level, const char *format, va_list ap);
+int lpjs_log_vwrite_direct(int level, const char *format, va_list ap);
+void *lpjs_log_writer(void *arg);
+void lpjs_log_flush(void);
+void lpjs_log_wait_synced(size_t count);
+void lpjs_log_wake(void);
+int lpjs_log_format(char *buff, size_t buff_size, const char *format, va_list ap);
+const char *lpjs_log_stamp(void);
+bool lpjs_log_enabled(int level);
+bool lpjs_log_must_sync(int level);
+int lpjs_log_level(const char *format);
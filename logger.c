@@ -0,0 +1,517 @@
+/***************************************************************************
+ *  Description:
+ *      Buffered logging for lpjs_log() and lpjs_debug().
+ *
+ *      By default, messages are written directly to Log_stream by the
+ *      calling thread.  Daemons with a busy event loop call
+ *      lpjs_log_start() to hand messages to a background writer
+ *      thread instead, so that a log message costs only formatting
+ *      into a lock-free ring buffer.  Timestamps are cached and
+ *      reformatted at most once per second per thread.
+ *
+ *      Whether a message must reach the disk before lpjs_log()
+ *      returns is set by Config.log_sync (config tag log-sync):
+ *
+ *      always      Every message, as in earlier versions
+ *      errors      Only error messages (default).  Other messages are
+ *                  passed to the kernel as soon as the writer is idle,
+ *                  so they survive a crash of the daemon, but not
+ *                  necessarily of the OS.
+ *      N           Sync at most every N milliseconds
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <sched.h>      // sched_yield()
+#include <signal.h>
+#include <pthread.h>
+
+#include "lpjs.h"
+#include "config.h"
+#include "misc.h"
+#include "logger.h"
+
+#define LPJS_LOG_RING_MASK  (LPJS_LOG_RING_SLOTS - 1)
+
+/*
+ *  Tail is advanced by producers, head only by the writer thread.
+ *  Keep them on separate cache lines.
+ */
+static log_slot_t               *Log_ring = NULL;
+static _Alignas(64) atomic_size_t   Log_tail;
+static _Alignas(64) atomic_size_t   Log_head;
+static atomic_size_t            Log_synced;     // Messages on disk
+static atomic_bool              Log_writer_idle;
+static int                      Log_wake_fd[2] = { -1, -1 };
+static bool                     Log_async = false;
+
+/***************************************************************************
+ *  Description:
+ *      Start the background writer thread.  Until this is called, or
+ *      if it fails, messages are written by the calling thread.
+ *      Must be called after daemonizing, since threads do not survive
+ *      fork().
+ *
+ *  Returns:
+ *      0 on success, or an errno value
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_log_start(void)
+
+{
+    pthread_t   thread;
+    sigset_t    all_signals, old_mask;
+    size_t      c;
+    int         status;
+
+    if ( (Log_ring = malloc(LPJS_LOG_RING_SLOTS * sizeof(*Log_ring))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    for (c = 0; c < LPJS_LOG_RING_SLOTS; ++c)
+	atomic_init(&Log_ring[c].seq, c);
+    atomic_init(&Log_tail, 0);
+    atomic_init(&Log_head, 0);
+    atomic_init(&Log_synced, 0);
+    atomic_init(&Log_writer_idle, false);
+
+    // Producers wake an idle writer through a pipe, since write() is
+    // safe to use in signal handlers
+    if ( pipe(Log_wake_fd) != 0 )
+    {
+	status = errno;
+	lpjs_log("%s(): Error: pipe() failed: %s\n", __FUNCTION__,
+		 strerror(status));
+	return status;
+    }
+    for (c = 0; c < 2; ++c)
+    {
+	fcntl(Log_wake_fd[c], F_SETFL, O_NONBLOCK);
+	fcntl(Log_wake_fd[c], F_SETFD, FD_CLOEXEC);
+    }
+
+    // Writer inherits a full signal mask, so signals go to the main thread
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+    status = pthread_create(&thread, NULL, lpjs_log_writer, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if ( status != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot create log writer thread: %s\n",
+		 __FUNCTION__, strerror(status));
+	close(Log_wake_fd[0]);
+	close(Log_wake_fd[1]);
+	return status;
+    }
+    pthread_detach(thread);
+    Log_async = true;
+    atexit(lpjs_log_flush);
+
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Log a message at the given level.  Backend for lpjs_log()
+ *      and lpjs_debug().
+ *
+ *  Returns:
+ *      Length of the message, or a negative value on error
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_log_vwrite(int level, const char *format, va_list ap)
+
+{
+    log_slot_t  *slot;
+    size_t      pos, seq;
+    intptr_t    diff;
+    int         len;
+
+    if ( ! lpjs_log_enabled(level) )
+	return 0;
+    if ( ! Log_async )
+	return lpjs_log_vwrite_direct(level, format, ap);
+
+    // Reserve a slot
+    pos = atomic_load_explicit(&Log_tail, memory_order_relaxed);
+    while ( true )
+    {
+	slot = &Log_ring[pos & LPJS_LOG_RING_MASK];
+	seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+	diff = (intptr_t)seq - (intptr_t)pos;
+	if ( diff == 0 )
+	{
+	    if ( atomic_compare_exchange_weak_explicit(&Log_tail, &pos,
+		    pos + 1, memory_order_relaxed, memory_order_relaxed) )
+		break;
+	}
+	else if ( diff < 0 )
+	{
+	    // Ring is full.  Never drop messages: Wait for the writer.
+	    lpjs_log_wake();
+	    sched_yield();
+	    pos = atomic_load_explicit(&Log_tail, memory_order_relaxed);
+	}
+	else
+	    pos = atomic_load_explicit(&Log_tail, memory_order_relaxed);
+    }
+
+    // Fill and publish
+    len = lpjs_log_format(slot->text, LPJS_LOG_LINE_MAX, format, ap);
+    slot->level = level;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    // Pairs with the fence in lpjs_log_writer() before going idle
+    atomic_thread_fence(memory_order_seq_cst);
+    if ( atomic_load_explicit(&Log_writer_idle, memory_order_relaxed) )
+	lpjs_log_wake();
+
+    if ( lpjs_log_must_sync(level) )
+	lpjs_log_wait_synced(pos + 1);
+
+    return len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write a message from the calling thread, used until
+ *      lpjs_log_start() is called and by programs that don't call it
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_log_vwrite_direct(int level, const char *format, va_list ap)
+
+{
+    static struct timespec  last_sync;
+    struct timespec         now;
+    int                     status;
+    extern FILE             *Log_stream;
+    extern lpjs_config_t    Config;
+
+    fprintf(Log_stream, "%s ", lpjs_log_stamp());
+    status = vfprintf(Log_stream, format, ap);
+    fflush(Log_stream);
+
+    if ( lpjs_log_must_sync(level) )
+	fsync(fileno(Log_stream));
+    else if ( Config.log_sync == LPJS_LOG_SYNC_INTERVAL )
+    {
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if ( lpjs_elapsed_ms(&last_sync, &now) >= Config.log_sync_ms )
+	{
+	    fsync(fileno(Log_stream));
+	    last_sync = now;
+	}
+    }
+
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Writer thread main loop.  Write messages in order as they are
+ *      published, sync according to Config.log_sync, and sleep on the
+ *      wake pipe when there is nothing to do.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *lpjs_log_writer(void *arg)
+
+{
+    log_slot_t      *slot;
+    size_t          head = 0;
+    bool            dirty = false,
+		    sync_now;
+    struct timespec last_sync, now;
+    struct pollfd   wake_poll = { .fd = Log_wake_fd[0], .events = POLLIN };
+    char            junk[64];
+    int             timeout_ms;
+    double          since_sync_ms;
+    extern FILE     *Log_stream;
+    extern lpjs_config_t    Config;
+
+    clock_gettime(CLOCK_MONOTONIC, &last_sync);
+    while ( true )
+    {
+	sync_now = false;
+	while ( true )
+	{
+	    slot = &Log_ring[head & LPJS_LOG_RING_MASK];
+	    if ( atomic_load_explicit(&slot->seq, memory_order_acquire)
+		 != head + 1 )
+		break;
+	    fputs(slot->text, Log_stream);
+	    if ( lpjs_log_must_sync(slot->level) )
+		sync_now = true;
+	    // Free the slot for the next pass around the ring
+	    atomic_store_explicit(&slot->seq, head + LPJS_LOG_RING_SLOTS,
+				  memory_order_release);
+	    atomic_store_explicit(&Log_head, ++head, memory_order_release);
+	    dirty = true;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	since_sync_ms = lpjs_elapsed_ms(&last_sync, &now);
+	if ( dirty && (sync_now ||
+	     ((Config.log_sync == LPJS_LOG_SYNC_INTERVAL) &&
+	      (since_sync_ms >= Config.log_sync_ms))) )
+	{
+	    fflush(Log_stream);
+	    fsync(fileno(Log_stream));
+	    atomic_store(&Log_synced, head);
+	    last_sync = now;
+	    dirty = false;
+	    since_sync_ms = 0;
+	}
+
+	// Announce idle, then check once more for a message published
+	// before the producer could see the flag
+	atomic_store(&Log_writer_idle, true);
+	atomic_thread_fence(memory_order_seq_cst);
+	slot = &Log_ring[head & LPJS_LOG_RING_MASK];
+	if ( atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1 )
+	{
+	    // Hand everything to the kernel while idle
+	    fflush(Log_stream);
+	    if ( dirty && (Config.log_sync == LPJS_LOG_SYNC_INTERVAL) )
+		timeout_ms = Config.log_sync_ms - since_sync_ms + 1;
+	    else
+		timeout_ms = -1;
+	    poll(&wake_poll, 1, timeout_ms);
+	    while ( read(Log_wake_fd[0], junk, sizeof(junk)) > 0 )
+		;
+	}
+	atomic_store(&Log_writer_idle, false);
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wait until all messages logged so far are written and synced.
+ *      Registered with atexit() by lpjs_log_start(), and may be
+ *      called before abort() or other abnormal termination.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_log_flush(void)
+
+{
+    struct timespec delay = { 0, 1000000 };     // 1 ms
+    size_t          count;
+    unsigned        waited_ms;
+    extern FILE     *Log_stream;
+
+    if ( ! Log_async )
+	return;
+
+    count = atomic_load(&Log_tail);
+    lpjs_log_wake();
+    for (waited_ms = 0; (atomic_load(&Log_head) < count) &&
+			(waited_ms < LPJS_LOG_FLUSH_WAIT_MS); ++waited_ms)
+	nanosleep(&delay, NULL);
+    fflush(Log_stream);
+    fsync(fileno(Log_stream));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wait until the first count messages are on disk.  Polls rather
+ *      than using a condition variable, so that error messages can be
+ *      logged from signal handlers.  The wait is limited, since a
+ *      handler may have interrupted a thread that reserved an earlier
+ *      slot, which the writer cannot pass until it is filled.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_log_wait_synced(size_t count)
+
+{
+    struct timespec delay = { 0, 100000 };      // 100 us
+    unsigned        polls;
+
+    for (polls = 0; (atomic_load(&Log_synced) < count) &&
+		    (polls < LPJS_LOG_FLUSH_WAIT_MS * 10); ++polls)
+	nanosleep(&delay, NULL);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wake the writer thread if it is waiting for messages
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_log_wake(void)
+
+{
+    // Pipe full means a wakeup is already pending
+    write(Log_wake_fd[1], "", 1);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format a timestamped message into buff.  Truncated messages
+ *      are marked with "...".
+ *
+ *  Returns:
+ *      Length of the message in buff
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_log_format(char *buff, size_t buff_size, const char *format,
+			va_list ap)
+
+{
+    int     len;
+
+    len = snprintf(buff, buff_size, "%s ", lpjs_log_stamp());
+    len += vsnprintf(buff + len, buff_size - len, format, ap);
+    if ( len >= (int)buff_size )
+    {
+	memcpy(buff + buff_size - 5, "...\n", 5);
+	len = buff_size - 1;
+    }
+
+    return len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the current time formatted for the log.  Formatting is
+ *      redone only when the second changes.  Each thread has its own
+ *      copy, so no locking is needed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+const char  *lpjs_log_stamp(void)
+
+{
+    static _Thread_local time_t stamp_time = -1;
+    static _Thread_local char   stamp[LPJS_LOG_STAMP_MAX + 1];
+    time_t      now;
+    struct tm   tm;
+
+    if ( (now = time(NULL)) != stamp_time )
+    {
+	localtime_r(&now, &tm);
+	strftime(stamp, LPJS_LOG_STAMP_MAX + 1, LPJS_LOG_STAMP_FORMAT, &tm);
+	stamp_time = now;
+    }
+
+    return stamp;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether messages at level are logged under the
+ *      configured log level.  Use to skip expensive debug output.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_log_enabled(int level)
+
+{
+    extern lpjs_config_t    Config;
+
+    return level <= Config.log_level;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether a message must be on disk before lpjs_log()
+ *      returns
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_log_must_sync(int level)
+
+{
+    extern lpjs_config_t    Config;
+
+    return (Config.log_sync == LPJS_LOG_SYNC_ALWAYS) ||
+	   ((Config.log_sync == LPJS_LOG_SYNC_ERRORS) &&
+	    (level == LPJS_LOG_LEVEL_ERROR));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Classify a message by the tags used throughout LPJS
+ *
+ *  Returns:
+ *      LPJS_LOG_LEVEL_ERROR for "Error:" and "Bug:" messages,
+ *      otherwise LPJS_LOG_LEVEL_NORMAL
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_log_level(const char *format)
+
+{
+    if ( (strstr(format, "Error:") != NULL) ||
+	 (strstr(format, "Bug:") != NULL) )
+	return LPJS_LOG_LEVEL_ERROR;
+    return LPJS_LOG_LEVEL_NORMAL;
+}
@@ -0,0 +1,30 @@
+#ifndef _LPJS_LOGGER_H_
+#define _LPJS_LOGGER_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/*
+ *  Ring buffer for lpjs_log_start().  Producers reserve a slot by
+ *  advancing the tail with compare-and-swap, format the message into
+ *  it, and publish it by setting the slot sequence number.  A single
+ *  writer thread consumes slots in order.  See logger.c.
+ */
+
+#define LPJS_LOG_RING_SLOTS     4096    // Must be a power of 2
+#define LPJS_LOG_LINE_MAX       1024    // Longer messages are truncated
+#define LPJS_LOG_STAMP_FORMAT   "%m-%d %H:%M:%S"
+#define LPJS_LOG_STAMP_MAX      32
+#define LPJS_LOG_FLUSH_WAIT_MS  2000    // Max wait for the writer thread
+
+typedef struct
+{
+    atomic_size_t   seq;
+    int             level;
+    char            text[LPJS_LOG_LINE_MAX];
+}   log_slot_t;
+
+#include "logger-protos.h"
+
+#endif  // _LPJS_LOGGER_H_
@@ -38,11 +38,17 @@ enum
 #define LPJS_COMPD_LOG          LPJS_LOG_DIR "/compd"
 #define LPJS_DISPATCHD_LOG      LPJS_LOG_DIR "/dispatchd"
 #define LPJS_JOB_HISTORY        LPJS_LOG_DIR "/job-history"
+#define LPJS_HISTORY_RECORDS    LPJS_JOB_HISTORY "/records"
+#define LPJS_HISTORY_TIME_INDEX LPJS_JOB_HISTORY "/time-index"
+#define LPJS_HISTORY_USER_DIR   LPJS_JOB_HISTORY "/users"
 
 #define LPJS_SPOOL_DIR          PREFIX "/var/spool/lpjs"
 #define LPJS_PENDING_DIR        LPJS_SPOOL_DIR "/pending"
 #define LPJS_RUNNING_DIR        LPJS_SPOOL_DIR "/running"
 #define LPJS_SPECS_FILE_NAME    "job.specs"
+#define LPJS_SCRIPT_DIR         LPJS_SPOOL_DIR "/scripts"
+#define LPJS_JOURNAL            LPJS_SPOOL_DIR "/journal"
+#define LPJS_SNAPSHOT           LPJS_SPOOL_DIR "/snapshot"
 
 /*
  *  Job scripts should be quite small, usually no more than a few dozen lines.
@@ -57,6 +63,8 @@ enum
 #define LPJS_JOB_MSG_MAX        JOB_STR_MAX_LEN + LPJS_SCRIPT_SIZE_MAX
 
 #define LPJS_RUN_DIR            PREFIX "/var/run/lpjs"
+#define LPJS_COMPD_INVENTORY    LPJS_RUN_DIR "/compd-inventory"
+#define LPJS_COMPD_SOCKET       LPJS_RUN_DIR "/compd-socket"
 
 #define LPJS_MB                 1000000
 #define LPJS_MiB                1048576
@@ -1,9 +1,13 @@
 /* lpjs_compd.c */
-int lpjs_compd_checkin(int msg_fd, node_t *node);
-int lpjs_compd_checkin_loop(node_list_t *node_list, node_t *node);
+int lpjs_compd_checkin(int compd_msg_fd, node_t *node, inventory_t *inventory, lpjs_backoff_t *backoff);
+int lpjs_compd_checkin_loop(node_list_t *node_list, node_t *node, inventory_t *inventory);
 int lpjs_working_dir_setup(job_t *job, const char *script_start, char *job_script_name, size_t maxlen);
-int lpjs_send_chaperone_status(int msg_fd, unsigned long job_id, chaperone_status_t status);
-int lpjs_send_chaperone_status_loop(node_list_t *node_list, unsigned long job_id, chaperone_status_t status);
-int lpjs_run_chaperone(job_t *job, const char *script_start, int msg_fd, node_list_t *node_list);
+void lpjs_send_chaperone_status_loop(unsigned long job_id, chaperone_status_t chaperone_status);
+chaperone_status_t lpjs_job_process_setup(job_t *job, const char *script_start, char *job_script_name, size_t maxlen);
+uid_t lpjs_job_uid(job_t *job);
+int lpjs_send_fork_verification(int compd_msg_fd);
+int lpjs_run_chaperone(job_t *job, const char *script_start, int compd_msg_fd, node_list_t *node_list, inventory_t *inventory);
+bool lpjs_submit_dir_is_shared(job_t *job);
+int lpjs_supervise_job(supervisor_t *supervisor, job_t *job, const char *script_start, int compd_msg_fd, node_list_t *node_list, inventory_t *inventory);
 void lpjs_chown(job_t *job, const char *path);
 void sigchld_handler(int s2);
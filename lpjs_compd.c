@@ -6,6 +6,7 @@
  *  History: 
  *  Date        Name        Modification
  *  2021-09-30  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Relay reports after taking messages from dispatchd
  ***************************************************************************/
 
 #include <stdio.h>
@@ -24,6 +25,8 @@
 #include <fcntl.h>          // open()
 #include <signal.h>
 #include <sys/wait.h>
+#include <stdint.h>         // int64_t
+#include <time.h>
 
 #include <xtend/string.h>
 #include <xtend/proc.h>
@@ -35,6 +38,12 @@
 #include "network.h"
 #include "misc.h"
 #include "job.h"
+#include "inventory.h"
+#include "supervisor.h"
+#include "relay.h"
+#include "rlimit.h"
+#include "cgroup.h"
+#include "telemetry.h"
 #include "lpjs_compd.h"
 
 int     main (int argc, char *argv[])
@@ -44,12 +53,31 @@ int     main (int argc, char *argv[])
     node_list_t *node_list = node_list_new();
     // Terminates process if malloc() fails, no check required
     node_t      *node = node_new();
+    // Terminates process if malloc() fails, no check required
+    inventory_t *inventory = inventory_new();
+    // Terminates process if malloc() fails, no check required
+    supervisor_t    *supervisor = supervisor_new();
+    // Terminates process if malloc() fails, no check required
+    relay_t     *relay = relay_new();
+    // Terminates process if malloc() fails, no check required
+    telemetry_t *telemetry = telemetry_new();
+    // Terminates process if malloc() fails, no check required
+    proctree_t  *proctree = proctree_new();
     char        *munge_payload,
-		vis_msg[LPJS_MSG_LEN_MAX + 1];
+		vis_msg[LPJS_MSG_LEN_MAX + 1],
+		telemetry_str[LPJS_MSG_LEN_MAX];
     ssize_t     bytes;
     int         compd_msg_fd;
-    struct pollfd   poll_fd;
+    struct pollfd   *poll_fd;
+    nfds_t      nfds;
+    time_t      now,
+		next_heartbeat = 0,
+		next_telemetry = 0;
+    int         poll_ms;
+    size_t      swept_count;
+    unsigned    cgroups_left;
     extern FILE *Log_stream;
+    extern lpjs_config_t    Config;
     uid_t       uid;
     gid_t       gid;
 
@@ -97,49 +125,131 @@ int     main (int argc, char *argv[])
     // Get hostname of head node
     lpjs_load_config(node_list, LPJS_CONFIG_HEAD_ONLY, Log_stream);
 
-    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node);
-    poll_fd.fd = compd_msg_fd;
-    // POLLERR and POLLHUP are actually always set.  Listing POLLHUP here just
-    // for documentation.
-    poll_fd.events = POLLIN | POLLHUP;
+    // Chaperones started before a compd restart are still running
+    xt_rmkdir(LPJS_RUN_DIR, 0755);
+    inventory_load(inventory, LPJS_COMPD_INVENTORY);
+    if ( inventory_prune(inventory) > 0 )
+	inventory_save(inventory, LPJS_COMPD_INVENTORY);
+    lpjs_log("%s(): %zu chaperones still running.\n", __FUNCTION__,
+	     inventory->count);
+    
+    // Remove cgroups of jobs that finished while compd was down
+    if ( Config.job_cgroups )
+	lpjs_cgroup_init();
+    cgroups_left = lpjs_cgroup_sweep(inventory);
+    swept_count = inventory->count;
+    
+    // Scripts started by a previous compd in job-supervisor compd mode
+    supervisor_adopt(supervisor, inventory);
+    
+    // Failed sends are seen as a lost connection by the event loop
+    signal(SIGPIPE, SIG_IGN);
+    if ( (Config.job_supervisor != LPJS_SUPERVISOR_COMPD) ||
+	 (supervisor_start(supervisor) != LPJS_SUCCESS) )
+	signal(SIGCHLD, sigchld_handler);
+    
+    // Chaperones send their reports to dispatchd through us
+    if ( relay_listen(relay) != LPJS_SUCCESS )
+    {
+#ifdef __linux__
+	unlink(Pid_path);
+#endif
+	return EX_CONFIG;
+    }
+
+    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node, inventory);
+    
+    // Wake up in time for heartbeats and telemetry, see heartbeat.h
+    poll_ms = 2000;
+    if ( (Config.heartbeat_interval > 0) &&
+	 (Config.heartbeat_interval * 1000 < poll_ms) )
+	poll_ms = Config.heartbeat_interval * 1000;
+    if ( (Config.telemetry_interval > 0) &&
+	 (Config.telemetry_interval * 1000 < poll_ms) )
+	poll_ms = Config.telemetry_interval * 1000;
+    // Ditto for SIGKILL to canceled jobs, see supervisor_check()
+    if ( (Config.cancel_grace > 0) && (Config.cancel_grace * 1000 < poll_ms) )
+	poll_ms = Config.cancel_grace * 1000;
+    // And usage samples of supervised jobs
+    if ( (Config.job_supervisor == LPJS_SUPERVISOR_COMPD) &&
+	 (Config.usage_interval > 0) &&
+	 (Config.usage_interval * 1000 < poll_ms) )
+	poll_ms = Config.usage_interval * 1000;
     
     // Now keep daemon running, awaiting jobs
     // Almost correct: https://unix.stackexchange.com/questions/581426/how-to-get-notified-when-the-other-end-of-a-socketpair-is-closed
     while ( true )
     {
-	// Just poll the dedicated socket connection with dispatchd
-	// Time out after 2 seconds
-	poll(&poll_fd, 1, 2000);
+	// Poll the dedicated socket connection with dispatchd, supervised
+	// jobs, and chaperone reports, if any.  Time out after 2 seconds,
+	// or the heartbeat, telemetry, cancel-grace, or usage interval if
+	// shorter.
+	supervisor_poll_fds(supervisor, compd_msg_fd, &nfds);
+	relay_poll_fds(relay, &supervisor->poll_fds,
+		       &supervisor->poll_fds_size, &nfds);
+	poll_fd = supervisor->poll_fds;
+	poll(poll_fd, nfds, poll_ms);
+	
+	// Reap and report supervised jobs before pruning the inventory
+	supervisor_check(supervisor, relay, inventory);
+	
+	// A lost connection is noticed below.  A resource report goes
+	// with a heartbeat, so counts as one.
+	now = time(NULL);
+	if ( (Config.telemetry_interval > 0) && (now >= next_telemetry) )
+	{
+	    telemetry_sample(telemetry, inventory, proctree);
+	    lpjs_send_heartbeat(compd_msg_fd,
+				telemetry_to_str(telemetry, telemetry_str,
+						 sizeof(telemetry_str)));
+	    next_telemetry = now + Config.telemetry_interval;
+	    next_heartbeat = now + Config.heartbeat_interval;
+	}
+	else if ( (Config.heartbeat_interval > 0) && (now >= next_heartbeat) )
+	{
+	    lpjs_send_heartbeat(compd_msg_fd, NULL);
+	    next_heartbeat = now + Config.heartbeat_interval;
+	}
+	
+	// Keep the saved inventory current in case compd is restarted
+	if ( inventory_prune(inventory) > 0 )
+	    inventory_save(inventory, LPJS_COMPD_INVENTORY);
+	
+	// Jobs leave the inventory here, at checkin, or when the relay
+	// sends a supervised job's report.  Catch them all.
+	if ( (inventory->count < swept_count) || (cgroups_left > 0) )
+	    cgroups_left = lpjs_cgroup_sweep(inventory);
+	swept_count = inventory->count;
 
 	// dispatchd closed its end of the socket?
-	if (poll_fd.revents & POLLHUP)
+	if (poll_fd->revents & POLLHUP)
 	{
-	    poll_fd.revents &= ~POLLHUP;
+	    poll_fd->revents &= ~POLLHUP;
 	    
 	    // Close this end, or dispatchd gets "address already in use"
 	    // When trying to restart
 	    close(compd_msg_fd);
 	    lpjs_log("%s(): Error: Lost connection to dispatchd: HUP received.\n",
 		    __FUNCTION__);
-	    sleep(LPJS_RETRY_TIME);  // No point trying immediately after drop
-	    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node);
+	    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node, inventory);
+	    relay_requeue(relay, compd_msg_fd);
 	}
 	
-	if (poll_fd.revents & POLLERR)
+	if (poll_fd->revents & POLLERR)
 	{
-	    poll_fd.revents &= ~POLLERR;
+	    poll_fd->revents &= ~POLLERR;
 	    lpjs_log("%s(): Error: Problem polling dispatchd: %s\n",
 		    __FUNCTION__, strerror(errno));
 	    break;
 	}
 	
-	if (poll_fd.revents & POLLIN)
+	if (poll_fd->revents & POLLIN)
 	{
-	    poll_fd.revents &= ~POLLIN;
+	    poll_fd->revents &= ~POLLIN;
 	    // FIXME: Add a timeout and handling code
 	    lpjs_log("%s(): New message from dispatchd.\n", __FUNCTION__);
-	    bytes = lpjs_recv_munge(compd_msg_fd, &munge_payload, 0, 0,
-				    &uid, &gid, close);
+	    bytes = lpjs_recv_node_munge(compd_msg_fd, &munge_payload, 0, 0,
+					 &uid, &gid, close);
 	    if ( bytes < 0 )
 	    {
 		// FIXME: Not sure what this actually means
@@ -147,8 +257,9 @@ int     main (int argc, char *argv[])
 		close(compd_msg_fd);
 		lpjs_log("%s(): Error: Got %zd bytes from dispatchd.  Something is wrong.\n",
 			__FUNCTION__, bytes);
-		poll_fd.revents = 0;
-		compd_msg_fd = lpjs_compd_checkin_loop(node_list, node);
+		poll_fd->revents = 0;
+		compd_msg_fd = lpjs_compd_checkin_loop(node_list, node, inventory);
+		relay_requeue(relay, compd_msg_fd);
 	    }
 	    else if ( bytes == 0 )
 	    {
@@ -160,8 +271,9 @@ int     main (int argc, char *argv[])
 		lpjs_log("%s(): Error: 0 bytes received from dispatchd.  Disconnecting...\n",
 			__FUNCTION__);
 		close(compd_msg_fd);
-		poll_fd.revents = 0;
-		compd_msg_fd = lpjs_compd_checkin_loop(node_list, node);
+		poll_fd->revents = 0;
+		compd_msg_fd = lpjs_compd_checkin_loop(node_list, node, inventory);
+		relay_requeue(relay, compd_msg_fd);
 	    }
 	    else
 	    {
@@ -176,12 +288,12 @@ int     main (int argc, char *argv[])
 		    lpjs_log("%s(): Dispatchd sent EOT.  Closing connection.\n",
 			    __FUNCTION__);
 		    close(compd_msg_fd);
-		    sleep(LPJS_RETRY_TIME);  // No point trying immediately after drop
     
 		    // Ignore HUP that follows EOT
 		    // FIXME: This might be bad timing
-		    poll_fd.revents &= ~POLLHUP;
-		    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node);
+		    poll_fd->revents &= ~POLLHUP;
+		    compd_msg_fd = lpjs_compd_checkin_loop(node_list, node, inventory);
+		    relay_requeue(relay, compd_msg_fd);
 		}
 		else if ( munge_payload[0] == LPJS_COMPD_REQUEST_NEW_JOB )
 		{
@@ -199,12 +311,16 @@ int     main (int argc, char *argv[])
 		    job_print_full_specs(job, Log_stream);
 		    
 		    /*
-		     *  lpjs_run_chaperone() forks, and the child process
-		     *  sends a response to lpjs_compd, depending on
-		     *  whether the dispatch succeeds.
+		     *  lpjs_run_chaperone() and lpjs_supervise_job() fork,
+		     *  and send dispatchd verification of the fork.
 		     */
 		    
-		    lpjs_run_chaperone(job, script_start, compd_msg_fd, node_list);
+		    if ( Config.job_supervisor == LPJS_SUPERVISOR_COMPD )
+			lpjs_supervise_job(supervisor, job, script_start,
+					   compd_msg_fd, node_list, inventory);
+		    else
+			lpjs_run_chaperone(job, script_start, compd_msg_fd,
+					   node_list, inventory);
 		}
 		else if ( munge_payload[0] == LPJS_COMPD_REQUEST_CANCEL )
 		{
@@ -218,7 +334,7 @@ int     main (int argc, char *argv[])
 		    if ( *end != '\0' )
 			lpjs_log("%s(): Bug: Malformed cancel payload.\n",
 				__FUNCTION__);
-		    else
+		    else if ( ! supervisor_cancel(supervisor, chaperone_pid) )
 		    {
 			lpjs_log("%s(): Sending SIGHUP to %d...\n",
 				__FUNCTION__, chaperone_pid);
@@ -226,9 +342,15 @@ int     main (int argc, char *argv[])
 			// FIXME: Verify termination
 		    }
 		}
+		else if ( munge_payload[0] == LPJS_COMPD_REQUEST_REPORTS_ACK )
+		    relay_ack(relay, munge_payload + 1, compd_msg_fd, inventory);
 		free(munge_payload);
 	    }
 	}
+	
+	// After taking any ack from dispatchd above, so a batch that
+	// was just acknowledged is not sent again
+	relay_check(relay, compd_msg_fd, inventory);
     }
 
     close(compd_msg_fd);
@@ -236,13 +358,30 @@ int     main (int argc, char *argv[])
 }
 
 
-int     lpjs_compd_checkin(int compd_msg_fd, node_t *node)
+/***************************************************************************
+ *  Description:
+ *      Send node specs and running chaperones to dispatchd on a new
+ *      connection and wait for authorization.  A retry-after reply
+ *      is saved in backoff for lpjs_compd_checkin_loop().
+ *
+ *  Returns:
+ *      EX_OK on success, EX_IOERR or EX_TEMPFAIL after closing
+ *      compd_msg_fd.  Exits if the node is not authorized.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Retry on lost connection, honor retry-after
+ ***************************************************************************/
+
+int     lpjs_compd_checkin(int compd_msg_fd, node_t *node,
+			   inventory_t *inventory, lpjs_backoff_t *backoff)
 
 {
     char        outgoing_msg[LPJS_MSG_LEN_MAX + 1],
 		*munge_payload,
 		specs[NODE_SPECS_LEN + 1];
     ssize_t     bytes;
+    size_t      len;
     uid_t       uid;
     gid_t       gid;
     extern FILE *Log_stream;
@@ -250,13 +389,33 @@ int     lpjs_compd_checkin(int compd_msg_fd, node_t *node)
     /* Send a message to the server */
     /* Need to send \0, so xt_dprintf() doesn't work here */
     node_detect_specs(node);
-    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
-	    "%c%s", LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN,
+    len = snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
+	    "%c%s\n", LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN,
 	    node_specs_to_str(node, specs, NODE_SPECS_LEN + 1));
     lpjs_log("%s(): Sending node specs:\n", __FUNCTION__);
     node_print_specs_header(Log_stream);
-    fprintf(Log_stream, "%s\n", outgoing_msg + 1);
-    if ( lpjs_send_munge(compd_msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
+    fprintf(Log_stream, "%s", outgoing_msg + 1);
+    
+    /*
+     *  Append live chaperones, so dispatchd can correct its running
+     *  jobs and node usage.  If they don't fit, send none, and
+     *  dispatchd will keep what it has rather than dropping jobs.
+     */
+    inventory_prune(inventory);
+    if ( inventory_to_str(inventory, outgoing_msg + len,
+			  LPJS_MSG_LEN_MAX + 1 - len) == NULL )
+    {
+	lpjs_log("%s(): Error: Inventory of %zu chaperones is too large to send.\n",
+		 __FUNCTION__, inventory->count);
+	outgoing_msg[len] = '\0';
+    }
+    else
+	lpjs_log("%s(): Reporting %zu running chaperones.\n", __FUNCTION__,
+		 inventory->count);
+    
+    // Close compd_msg_fd here on all failures, not in lpjs_*_munge()
+    if ( lpjs_send_munge(compd_msg_fd, outgoing_msg, lpjs_no_close)
+	 != LPJS_MSG_SENT )
     {
 	lpjs_log("%s(): Error: Failed to send checkin message to dispatchd: %s",
 		__FUNCTION__, strerror(errno));
@@ -266,12 +425,24 @@ int     lpjs_compd_checkin(int compd_msg_fd, node_t *node)
     lpjs_log("%s(): Sent checkin request.\n", __FUNCTION__);
 
     // FIXME: Add a timeout and handling code
-    bytes = lpjs_recv_munge(compd_msg_fd, &munge_payload, 0, 0, &uid, &gid, close);
+    bytes = lpjs_recv_munge(compd_msg_fd, &munge_payload, 0, 0, &uid, &gid,
+			    lpjs_no_close);
     if ( bytes < 1 )
     {
-	lpjs_log("%s(): Error: Failed to receve auth message.\n",
+	// dispatchd may have dropped us while restarting, try again
+	lpjs_log("%s(): Error: Failed to receive auth message.\n",
 		__FUNCTION__);
-	exit(EX_IOERR); // FIXME: Should we retry?
+	close(compd_msg_fd);
+	return EX_IOERR;
+    }
+    else if ( lpjs_backoff_hint(backoff, munge_payload) )
+    {
+	// dispatchd is pacing checkins and closes this connection
+	lpjs_log("%s(): dispatchd is busy: %s ms.\n", __FUNCTION__,
+		 munge_payload);
+	free(munge_payload);
+	close(compd_msg_fd);
+	return EX_TEMPFAIL;
     }
     else if ( strcmp(munge_payload, "Node authorized") != 0 )
     {
@@ -290,58 +461,14 @@ int     lpjs_compd_checkin(int compd_msg_fd, node_t *node)
 }
 
 
-/***************************************************************************
- *  Use auto-c2man to generate a man page from this comment
- *
- *  Name:
- *      -
- *
- *  Library:
- *      #include <>
- *      -l
- *
- *  Description:
- *  
- *  Arguments:
- *
- *  Returns:
- *
- *  Examples:
- *
- *  Files:
- *
- *  Environment
- *
- *  See also:
- *
- *  History: 
- *  Date        Name        Modification
- *  2024-12-05  Jason Bacon Begin
- ***************************************************************************/
-
-int     lpjs_dispatchd_connect_loop(node_list_t *node_list)
-
-{
-    int     compd_msg_fd;
-    
-    // Retry socket connection indefinitely
-    while ( (compd_msg_fd = lpjs_connect_to_dispatchd(node_list)) == -1 )
-    {
-	lpjs_log("%s(): Error: Failed to connect to dispatchd: %s\n",
-		__FUNCTION__, strerror(errno));
-	lpjs_log("%s(): Retry in %d seconds...\n",
-		__FUNCTION__, LPJS_RETRY_TIME);
-	sleep(LPJS_RETRY_TIME);
-    }
-    
-    return compd_msg_fd;
-}
-
-
 /***************************************************************************
  *  Description:
  *      Connect to dispatchd and send checkin request.
- *      Retry indefinitely if failure occurs.
+ *      Retry indefinitely if failure occurs, backing off exponentially
+ *      with random jitter, or as advised by dispatchd, so that all
+ *      nodes dropped by a dispatchd restart do not return at once.
+ *      Also waits briefly before the first attempt, to spread out
+ *      nodes that lost the connection at the same time.
  *
  *  Returns:
  *      File descriptor for ongoing connection to dispatchd.
@@ -349,27 +476,31 @@ int     lpjs_dispatchd_connect_loop(node_list_t *node_list)
  *  History: 
  *  Date        Name        Modification
  *  2024-01-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Back off with jitter, honor retry-after
  ***************************************************************************/
 
-int     lpjs_compd_checkin_loop(node_list_t *node_list, node_t *node)
+int     lpjs_compd_checkin_loop(node_list_t *node_list, node_t *node,
+				inventory_t *inventory)
 
 {
-    int     compd_msg_fd,
-	    status;
+    int             compd_msg_fd;
+    unsigned        delay;
+    lpjs_backoff_t  backoff;
 
-    // Does not return until successful
-    compd_msg_fd = lpjs_dispatchd_connect_loop(node_list);
-    
-    // Retry checking request indefinitely
-    while ( (status = lpjs_compd_checkin(compd_msg_fd, node)) != EX_OK )
+    lpjs_backoff_init(&backoff);
+    while ( true )
     {
-	// In case failure is due to disconnect
-	close(compd_msg_fd);
-	compd_msg_fd = lpjs_dispatchd_connect_loop(node_list);
-	
-	lpjs_log("%s(): Error: compd checkin failed.  Retry in %d seconds...\n",
-		 __FUNCTION__, LPJS_RETRY_TIME);
-	sleep(LPJS_RETRY_TIME);
+	delay = lpjs_backoff_wait(&backoff);
+	lpjs_debug("%s(): Waited %u ms.\n", __FUNCTION__, delay);
+	if ( (compd_msg_fd = lpjs_connect_to_dispatchd(node_list)) == -1 )
+	    lpjs_log("%s(): Error: Failed to connect to dispatchd: %s\n",
+		    __FUNCTION__, strerror(errno));
+	else if ( lpjs_compd_checkin(compd_msg_fd, node, inventory,
+				     &backoff) == EX_OK )
+	    break;
+	else
+	    lpjs_log("%s(): Error: compd checkin failed.\n", __FUNCTION__);
+	// lpjs_compd_checkin() closes compd_msg_fd on failure
     }
     
     lpjs_log("%s(): Checkin successful.\n", __FUNCTION__);
@@ -526,98 +657,218 @@ int     lpjs_working_dir_setup(job_t *job, const char *script_start,
 
 /***************************************************************************
  *  Description:
- *      Attempt to send job completion report to dispatchd
- *
- *  Returns:
- *      EX_OK on success, EX_IOERR otherwise
+ *      Report launch status of a chaperone to dispatchd, through the
+ *      parent lpjs_compd.  Retry indefinitely if failure occurs.
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-12-07  Jason Bacon Adapt from lpjs_chaperone_completion
+ *  2024-12-07  Jason Bacon Adapt from lpjs_chaperone_completion_loop
+ *  2026-10-19  Jason Bacon Send through compd's report relay
  ***************************************************************************/
 
-int     lpjs_send_chaperone_status(int msg_fd, unsigned long job_id,
-				   chaperone_status_t chaperone_status)
+void    lpjs_send_chaperone_status_loop(unsigned long job_id,
+					chaperone_status_t chaperone_status)
 
 {
-    char    outgoing_msg[LPJS_MSG_LEN_MAX + 1],
+    char    record[RELAY_RECORD_MAX + 1],
 	    hostname[sysconf(_SC_HOST_NAME_MAX) + 1];
     
-    lpjs_log("%s(): job_id %lu sending status %d on fd %d\n", __FUNCTION__,
-	     job_id, chaperone_status, msg_fd);
-    /* Send job completion message to dispatchd */
+    lpjs_debug("%s(): job_id %lu sending status %d\n", __FUNCTION__,
+	     job_id, chaperone_status);
     gethostname(hostname, sysconf(_SC_HOST_NAME_MAX));
-    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%lu %d %s",
+    snprintf(record, RELAY_RECORD_MAX + 1, "%c%lu %d %s",
 	     LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS, job_id,
 	     chaperone_status, hostname);
-    lpjs_debug("%s(): msg = %s\n", __FUNCTION__, outgoing_msg + 1);
-    if ( lpjs_send_munge(msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
-    {
-	lpjs_log("%s(): Error: Failed to send message to dispatchd: %s\n",
-		 __FUNCTION__, strerror(errno));
-	close(msg_fd);
-	return LPJS_WRITE_FAILED;
-    }
-    lpjs_debug("%s(): Status %d sent by job_id %lu.\n",
-	     __FUNCTION__, chaperone_status, job_id);
-    
-    return EX_OK;   // FIXME: Use LPJS return values
+    lpjs_relay_report_loop(record);
+    lpjs_debug("%s(): Chaperone status %d sent.\n", __FUNCTION__, chaperone_status);
 }
 
 
 /***************************************************************************
  *  Description:
- *      Connect to dispatchd and send checkin request.
- *      Retry indefinitely if failure occurs.
+ *      Prepare a forked child to run a job: become the submitting
+ *      user, set LPJS_* env vars, enter the working dir, save the
+ *      script, and redirect stdout and stderr to files next to it.
  *
  *  Returns:
- *      File descriptor for ongoing connection to dispatchd.
+ *      LPJS_CHAPERONE_OK, or the failure to report to dispatchd
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-12-07  Jason Bacon Adapt from lpjs_chaperone_completion_loop
+ *  2026-10-19  Jason Bacon Factor out from lpjs_run_chaperone()
+ *  2026-10-19  Jason Bacon Set user's groups and compd-socket-group
  ***************************************************************************/
 
-int     lpjs_send_chaperone_status_loop(node_list_t *node_list,
-					unsigned long job_id,
-					chaperone_status_t chaperone_status)
+chaperone_status_t  lpjs_job_process_setup(job_t *job,
+					   const char *script_start,
+					   char *job_script_name,
+					   size_t maxlen)
 
 {
-    int     msg_fd, send_status;
+    char        out_file[PATH_MAX + 1],
+		err_file[PATH_MAX + 1];
     
-    lpjs_debug("%s(): job_id %lu sendind status %d\n", __FUNCTION__,
-	     job_id, chaperone_status);
-    // Retry socket connection and message send indefinitely
-    do
+    // If lpjs_compd is running as root, use setuid() to switch
+    // to submitting user
+    if ( getuid() == 0 )
     {
-	msg_fd = lpjs_connect_to_dispatchd(node_list);
-	if ( msg_fd == -1 )
+	struct passwd   *pw_ent;
+	uid_t           uid;
+	struct group    *gr_ent;
+	gid_t           gid;
+	char            *user_name, *group_name;
+	
+	uid = getuid();
+	gid = getgid();
+
+	user_name = job_get_user_name(job);
+	if ( (pw_ent = getpwnam(user_name)) == NULL )
 	{
-	    lpjs_log("%s(): Error: Failed to connect to dispatchd: %s\n",
-		    __FUNCTION__, strerror(errno));
-	    lpjs_log("%s(): Retry in %d seconds...\n",
-		    __FUNCTION__, LPJS_RETRY_TIME);
-	    sleep(LPJS_RETRY_TIME);
+	    lpjs_log("%s(): Error: %s: No such user.\n", __FUNCTION__, user_name);
+	    return LPJS_CHAPERONE_OSERR;
+	}
+	
+	group_name = job_get_primary_group_name(job);
+	if ( (gr_ent = getgrnam(group_name)) == NULL )
+	{
+	    lpjs_log("%s(): Info: %s: No such group.\n", __FUNCTION__, group_name);
+	    gid = pw_ent->pw_gid;
 	}
 	else
+	    gid = gr_ent->gr_gid;
+	
+	// Set gid before uid, while still running as root
+	if ( setgid(gid) != 0 )
+	    lpjs_log("%s(): Info: Failed to set gid to %u.\n", __FUNCTION__, gid);
+	
+	// Groups of the user rather than root, plus one for reporting
+	if ( (initgroups(user_name, gid) != 0) ||
+	     (relay_join_socket_group() != LPJS_SUCCESS) )
 	{
-	    send_status = lpjs_send_chaperone_status(msg_fd, job_id,
-						     chaperone_status);
-	    if ( send_status != EX_OK )
-	    {
-		lpjs_log("%s(): Error: Message send failed.  Retry in %d seconds...\n",
-			 __FUNCTION__, LPJS_RETRY_TIME);
-		sleep(LPJS_RETRY_TIME);
-	    }
-	    close(msg_fd);
+	    lpjs_log("%s(): Error: Failed to set groups for %s.\n",
+		     __FUNCTION__, user_name);
+	    return LPJS_CHAPERONE_OSERR;
+	}
+	
+	uid = pw_ent->pw_uid;
+	if ( setuid(uid) != 0 )
+	{
+	    lpjs_log("%s(): Error: Failed to set uid to %u.\n", __FUNCTION__, uid);
+	    return LPJS_CHAPERONE_OSERR;
 	}
-	lpjs_debug("%s(): msg_fd = %d  send_status = %d\n", 
-		 __FUNCTION__, msg_fd, send_status);
-    }   while ( (msg_fd == -1) || (send_status != EX_OK) );
+	
+	lpjs_log("%s(): user = %s  group = %s\n", __FUNCTION__,
+		user_name, group_name);
+	lpjs_log("%s(): uid = %u  gid = %u\n", __FUNCTION__, uid, gid);
+    }
     
-    lpjs_debug("%s(): Chaperone status %d sent.\n", __FUNCTION__, chaperone_status);
+    /*
+     *  Set LPJS_USER, LPJS_SUBMIT_HOST, etc. for chaperone and
+     *  job scripts
+     */
+    job_setenv(job);
+    
+    if ( lpjs_working_dir_setup(job, script_start, job_script_name,
+				maxlen) != LPJS_SUCCESS )
+    {
+	// FIXME: Take node down and reschedule jobs elsewhere
+	// FIXME: Terminating here causes dispatchd to crash
+	// dispatchd should be able to tolerate lost connections at any time
+	lpjs_log("%s(): Error: lpjs_working_dir_setup() failed.\n", __FUNCTION__);
+	return LPJS_CHAPERONE_OSERR;
+    }
+    
+    // FIXME: Make sure filenames are not truncated
+    
+    // Redirect stdout
+    strlcpy(out_file, job_script_name, PATH_MAX + 1);
+    strlcat(out_file, ".stdout", PATH_MAX + 1);
+    close(1);
+    if ( open(out_file, O_WRONLY|O_CREAT, 0644) == -1 )
+    {
+	lpjs_log("%s(): Error: Could not open %s: %s\n", __FUNCTION__,
+		 out_file, strerror(errno));
+	return LPJS_CHAPERONE_CANTCREAT;
+    }
+    
+    // Redirect stderr
+    strlcpy(err_file, job_script_name, PATH_MAX + 1);
+    strlcat(err_file, ".stderr", PATH_MAX + 1);
+    close(2);
+    if ( open(err_file, O_WRONLY|O_CREAT, 0644) == -1 )
+    {
+	lpjs_log("%s(): Error: Could not open %s: %s\n", __FUNCTION__,
+		 err_file, strerror(errno));
+	return LPJS_CHAPERONE_CANTCREAT;
+    }
+    
+    return LPJS_CHAPERONE_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Get the user a job's processes run as, as set by
+ *      lpjs_job_process_setup()
+ *
+ *  Returns:
+ *      The uid, or 0 if the job's user does not exist here
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uid_t   lpjs_job_uid(job_t *job)
+
+{
+    struct passwd   *pw_ent;
+    
+    if ( getuid() != 0 )
+	return getuid();
+    else if ( (pw_ent = getpwnam(job_get_user_name(job))) == NULL )
+	return 0;
+    else
+	return pw_ent->pw_uid;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Tell dispatchd that the process for a new job was forked, so it
+ *      can resume listening for new events.  The work that follows
+ *      (creating directories, redirecting, running the script, etc)
+ *      can take a while on a busy compute node, and we don't want
+ *      dispatchd stuck waiting.  Sent by compd rather than the child,
+ *      so that it is not interleaved with the job reports compd also
+ *      sends on the connection.  dispatchd sends on it as well, so no
+ *      verification reply is awaited.  See lpjs_send_node_munge().
+ *
+ *  Returns:
+ *      LPJS_MSG_SENT, or lpjs_send_node_munge() failure status
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_run_chaperone()
+ *  2026-10-19  Jason Bacon Don't wait for a verification reply
+ ***************************************************************************/
+
+int     lpjs_send_fork_verification(int compd_msg_fd)
+
+{
+    char    response[2] = { LPJS_CHAPERONE_FORKED, '\0' };
+    int     status;
     
-    return 0;   // FIXME: Define return codes
+    lpjs_debug("%s(): Sending chaperone forked verification.\n",
+	    __FUNCTION__);
+    if ( (status = lpjs_send_node_munge(compd_msg_fd, response,
+					lpjs_no_close)) != LPJS_MSG_SENT )
+	lpjs_log("%s(): Error: Failed to send chaperone forked verification.\n",
+		__FUNCTION__);
+    else
+	lpjs_debug("%s(): Verification sent.\n", __FUNCTION__);
+    
+    return status;
 }
 
 
@@ -629,29 +880,36 @@ int     lpjs_send_chaperone_status_loop(node_list_t *node_list,
  *  History: 
  *  Date        Name        Modification
  *  2024-03-10  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add chaperone to inventory
+ *  2026-10-19  Jason Bacon Send fork verification from compd
+ *  2026-10-19  Jason Bacon Report launch status through the relay
+ *  2026-10-19  Jason Bacon Run chaperone in the job's cgroup
+ *  2026-10-19  Jason Bacon Record job uid in inventory
  ***************************************************************************/
 
 int     lpjs_run_chaperone(job_t *job, const char *script_start,
-			    int compd_msg_fd, node_list_t *node_list)
+			    int compd_msg_fd, node_list_t *node_list,
+			    inventory_t *inventory)
 
 {
     char        *chaperone_bin = PREFIX "/libexec/lpjs/chaperone",
-		chaperone_response[LPJS_MSG_LEN_MAX + 1],
-		job_script_name[PATH_MAX + 1],
-		out_file[PATH_MAX + 1],
-		err_file[PATH_MAX + 1];
+		job_script_name[PATH_MAX + 1];
     unsigned long   job_id = job_get_job_id(job);
-    extern FILE *Log_stream;
+    pid_t       chaperone_pid;
+    inventory_entry_t   entry;
+    chaperone_status_t  setup_status;
+    
+    // The job runs without a cgroup if this fails, already logged
+    lpjs_cgroup_create(job_id, job_get_procs_per_job(job),
+		       job_get_pmem_per_proc(job));
     
-    signal(SIGCHLD, sigchld_handler);
-
     /*
      *  Child process must tell lpjs_compd whether chaperone was
      *  successfully launched.  Script failures are reported by
-     *  chaperone directly to lpjs_dispatchd.
+     *  chaperone to lpjs_dispatchd, through the relay in lpjs_compd.
      */
     
-    if ( fork() == 0 )
+    if ( (chaperone_pid = fork()) == 0 )
     {
 	/*
 	 *  Child: This is now the chaperone process.
@@ -666,128 +924,22 @@ int     lpjs_run_chaperone(job_t *job, const char *script_start,
 	 *  merely lead to job failure.
 	 */
 	
-	/*
-	 *  Send verification that the chaperone process started
-	 *  back to lpjs_dispatchd immediately, so it can resume
-	 *  listening for new events.  The work that follows
-	 *  (creating directories, redirecting, running the script,
-	 *  etc) can take a while on a busy compute node, and we
-	 *  don't want dispatchd stuck waiting.
-	 */
-	
-	lpjs_debug("%s(): Sending chaperone forked verification.\n",
-		__FUNCTION__);
-	snprintf(chaperone_response, LPJS_MSG_LEN_MAX + 1,
-		"%c", LPJS_CHAPERONE_FORKED);
-	if ( lpjs_send_munge(compd_msg_fd, chaperone_response, close)
-			     != LPJS_MSG_SENT )
-	{
-	    lpjs_log("%s(): Error: Failed to send chaperone forked verification.\n",
-		    __FUNCTION__);
-	    close(compd_msg_fd);
-	    exit(EX_UNAVAILABLE);
-	}
-	lpjs_debug("%s(): Verification sent.\n", __FUNCTION__);
-
 	// We don't want chaperone and its children to inherit
 	// the socket connection between dispatchd and compd.
 	// The parent process lpjs_compd will continue to use it,
 	// but we're done with it here.
 	close(compd_msg_fd);
 	
-	// If lpjs_compd is running as root, use setuid() to switch
-	// to submitting user
-	if ( getuid() == 0 )
-	{
-	    struct passwd   *pw_ent;
-	    uid_t           uid;
-	    struct group    *gr_ent;
-	    gid_t           gid;
-	    char            *user_name, *group_name;
-	    
-	    uid = getuid();
-	    gid = getgid();
-
-	    user_name = job_get_user_name(job);
-	    if ( (pw_ent = getpwnam(user_name)) == NULL )
-	    {
-		lpjs_log("%s(): Error: %s: No such user.\n", __FUNCTION__, user_name);
-		lpjs_send_chaperone_status_loop(node_list, job_id,
-						LPJS_CHAPERONE_OSERR);
-		exit(EX_OSERR);
-	    }
-	    
-	    group_name = job_get_primary_group_name(job);
-	    if ( (gr_ent = getgrnam(group_name)) == NULL )
-	    {
-		lpjs_log("%s(): Info: %s: No such group.\n", __FUNCTION__, group_name);
-		gid = pw_ent->pw_gid;
-	    }
-	    else
-		gid = gr_ent->gr_gid;
-	    
-	    // Set gid before uid, while still running as root
-	    if ( setgid(gid) != 0 )
-		lpjs_log("%s(): Info: Failed to set gid to %u.\n", __FUNCTION__, gid);
-	    
-	    uid = pw_ent->pw_uid;
-	    if ( setuid(uid) != 0 )
-	    {
-		lpjs_log("%s(): Error: Failed to set uid to %u.\n", __FUNCTION__, uid);
-		lpjs_send_chaperone_status_loop(node_list, job_id,
-						LPJS_CHAPERONE_OSERR);
-		exit(EX_OSERR);
-	    }
-	    
-	    lpjs_log("%s(): user = %s  group = %s\n", __FUNCTION__,
-		    user_name, group_name);
-	    lpjs_log("%s(): uid = %u  gid = %u\n", __FUNCTION__, uid, gid);
-	}
-	
-	/*
-	 *  Set LPJS_USER, LPJS_SUBMIT_HOST, etc. for chaperone and
-	 *  job scripts
-	 */
-	job_setenv(job);
+	// While still root, so the chaperone and job are contained
+	lpjs_cgroup_enter(job_id);
 	
-	if ( lpjs_working_dir_setup(job, script_start, job_script_name,
-				    PATH_MAX + 1) != LPJS_SUCCESS )
+	// Become the submitting user, enter the working dir, redirect output
+	if ( (setup_status = lpjs_job_process_setup(job, script_start,
+				job_script_name, PATH_MAX + 1)) != LPJS_CHAPERONE_OK )
 	{
-	    // FIXME: Take node down and reschedule jobs elsewhere
-	    // FIXME: Terminating here causes dispatchd to crash
-	    // dispatchd should be able to tolerate lost connections at any time
-	    lpjs_log("%s(): Error: lpjs_working_dir_setup() failed.\n", __FUNCTION__);
-	    lpjs_send_chaperone_status_loop(node_list, job_id,
-					    LPJS_CHAPERONE_OSERR);
-	    exit(EX_OSERR);
-	}
-	
-	// FIXME: Make sure filenames are not truncated
-	
-	// Redirect stdout
-	strlcpy(out_file, job_script_name, PATH_MAX + 1);
-	strlcat(out_file, ".stdout", PATH_MAX + 1);
-	close(1);
-	if ( open(out_file, O_WRONLY|O_CREAT, 0644) == -1 )
-	{
-	    lpjs_log("%s(): Error: Could not open %s: %s\n", __FUNCTION__,
-		     out_file, strerror(errno));
-	    lpjs_send_chaperone_status_loop(node_list, job_id,
-					    LPJS_CHAPERONE_CANTCREAT);
-	    exit(EX_CANTCREAT);
-	}
-	
-	// Redirect stderr
-	strlcpy(err_file, job_script_name, PATH_MAX + 1);
-	strlcat(err_file, ".stderr", PATH_MAX + 1);
-	close(2);
-	if ( open(err_file, O_WRONLY|O_CREAT, 0644) == -1 )
-	{
-	    lpjs_log("%s(): Error: Could not open %s: %s\n", __FUNCTION__,
-		     err_file, strerror(errno));
-	    lpjs_send_chaperone_status_loop(node_list, job_id,
-					    LPJS_CHAPERONE_CANTCREAT);
-	    exit(EX_CANTCREAT);
+	    lpjs_send_chaperone_status_loop(job_id, setup_status);
+	    exit(setup_status == LPJS_CHAPERONE_CANTCREAT ?
+		 EX_CANTCREAT : EX_OSERR);
 	}
 	
 	// Note: This will be redirected to err_file
@@ -798,9 +950,13 @@ int     lpjs_run_chaperone(job_t *job, const char *script_start,
 	// FIXME: This assumes execl() will succeed, which is all but certain.
 	// It would be better to send msg_fd value to chaperone and let
 	// it respond to dispatchd, or send a failure message after execl().
-	lpjs_send_chaperone_status_loop(node_list, job_id, LPJS_CHAPERONE_OK);
+	lpjs_send_chaperone_status_loop(job_id, LPJS_CHAPERONE_OK);
 	
 	lpjs_debug("%s(): Execing %s\n", __FUNCTION__, chaperone_bin);
+	
+	// compd ignores it, which would be inherited by the script.
+	// Keep ignoring it until here, so a lost report is retried.
+	signal(SIGPIPE, SIG_DFL);
 
 	execl(chaperone_bin, chaperone_bin, job_script_name, NULL);
 	
@@ -809,7 +965,7 @@ int     lpjs_run_chaperone(job_t *job, const char *script_start,
 	lpjs_log("%s(): Error: Failed to exec %s %u %u %s\n",
 		__FUNCTION__, chaperone_bin, job_script_name);
 	// See FIXME above
-	lpjs_send_chaperone_status_loop(node_list, job_id, LPJS_CHAPERONE_EXEC_FAILED);
+	lpjs_send_chaperone_status_loop(job_id, LPJS_CHAPERONE_EXEC_FAILED);
 	exit(EX_SOFTWARE);
     }
     
@@ -818,11 +974,191 @@ int     lpjs_run_chaperone(job_t *job, const char *script_start,
      *  lpjs_compd does not wait for chaperone, but resumes listening
      *  for more jobs.
      */
+    
+    if ( chaperone_pid == -1 )
+    {
+	lpjs_log("%s(): Error: fork() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	lpjs_cgroup_remove(job_id);
+	return EX_OSERR;
+    }
+    
+    // A lost connection is noticed by the event loop in main()
+    lpjs_send_fork_verification(compd_msg_fd);
+    
+    // Report the chaperone in future checkins until it exits
+    entry.job_id = job_id;
+    entry.chaperone_pid = chaperone_pid;
+    entry.job_pid = 0;
+    entry.procs = job_get_procs_per_job(job);
+    entry.pmem_per_proc = job_get_pmem_per_proc(job);
+    entry.uid = lpjs_job_uid(job);
+    inventory_add(inventory, &entry);
+    inventory_save(inventory, LPJS_COMPD_INVENTORY);
 
     return EX_OK;
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Check whether the job's submit directory is shared with this
+ *      node, so that the job runs there and nothing needs to be
+ *      transferred back when it is done.  Checked as root, so this
+ *      may report false for a shared directory that root cannot
+ *      search, such as NFS with root squashing.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_submit_dir_is_shared(job_t *job)
+
+{
+    char        shared_fs_marker[LPJS_SHARED_FS_MARKER_MAX + 1],
+		shared_fs_marker_path[PATH_MAX + 1];
+    struct stat st;
+    
+    lpjs_get_marker_filename(shared_fs_marker, job_get_submit_node(job),
+			     LPJS_SHARED_FS_MARKER_MAX + 1);
+    snprintf(shared_fs_marker_path, PATH_MAX + 1, "%s/%s",
+	     job_get_submit_dir(job), shared_fs_marker);
+    
+    return stat(shared_fs_marker_path, &st) == 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Run a job script as a child of compd, with no chaperone.  See
+ *      supervisor.c.  Jobs that need a temporary working dir still
+ *      get a chaperone, which pushes the dir back to the submit node
+ *      as the user when the job is done.
+ *
+ *      The script is not started with posix_spawn(), since the child
+ *      must switch to the submitting user and set up the working dir
+ *      first, which posix_spawn() cannot do portably.
+ *
+ *  Returns:
+ *      EX_OK, or EX_OSERR if the job could not be forked
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Run script in the job's cgroup
+ *  2026-10-19  Jason Bacon Record job uid in inventory
+ ***************************************************************************/
+
+int     lpjs_supervise_job(supervisor_t *supervisor, job_t *job,
+			   const char *script_start, int compd_msg_fd,
+			   node_list_t *node_list, inventory_t *inventory)
+
+{
+    char        job_script_name[PATH_MAX + 1],
+		new_path[LPJS_PATH_ENV_MAX + 1],
+		home_dir[PATH_MAX + 1];
+    int         launch_pipe[2];
+    pid_t       job_pid;
+    inventory_entry_t   entry;
+    supervisor_launch_t launch;
+    
+    if ( ! lpjs_submit_dir_is_shared(job) )
+    {
+	lpjs_log("%s(): Submit dir is not shared.  Using chaperone.\n",
+		 __FUNCTION__);
+	return lpjs_run_chaperone(job, script_start, compd_msg_fd,
+				  node_list, inventory);
+    }
+    
+    // Closed on exec(), so EOF after the last record means exec() worked
+    if ( pipe(launch_pipe) != 0 )
+    {
+	lpjs_log("%s(): Error: pipe() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	return EX_OSERR;
+    }
+    fcntl(launch_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(launch_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(launch_pipe[1], F_SETFD, FD_CLOEXEC);
+    
+    // The job runs without a cgroup if this fails, already logged
+    lpjs_cgroup_create(job_get_job_id(job), job_get_procs_per_job(job),
+		       job_get_pmem_per_proc(job));
+    
+    if ( (job_pid = fork()) == 0 )
+    {
+	// Child: Becomes the job script, as the chaperone's child does
+	close(compd_msg_fd);
+	close(launch_pipe[0]);
+	signal(SIGCHLD, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+	
+	// Create new process group with the script's PID, for cancel
+	setpgid(0, 0);
+	
+	// While still root, so rctl rules can be added
+	lpjs_cgroup_enter(job_get_job_id(job));
+	lpjs_set_job_limits(job_get_pmem_per_proc(job));
+	
+	if ( (launch.status = lpjs_job_process_setup(job, script_start,
+				job_script_name, PATH_MAX + 1)) == LPJS_CHAPERONE_OK )
+	{
+	    // Env normally set by the chaperone
+	    snprintf(new_path, LPJS_PATH_ENV_MAX + 1, "%s/bin:%s/bin:%s",
+		     LOCALBASE, PREFIX, getenv("PATH"));
+	    setenv("PATH", new_path, 1);
+	    xt_get_home_dir(home_dir, PATH_MAX + 1);
+	    setenv("LPJS_HOME_DIR", home_dir, 1);
+	    
+	    launch.exec_time = lpjs_time_us();
+	    write(launch_pipe[1], &launch, sizeof(launch));
+	    execl(job_script_name, job_script_name, NULL);
+	    
+	    // Note: This will be redirected to err_file
+	    lpjs_log("%s(): Error: Failed to exec %s: %s\n", __FUNCTION__,
+		     job_script_name, strerror(errno));
+	    launch.status = LPJS_CHAPERONE_EXEC_FAILED;
+	}
+	write(launch_pipe[1], &launch, sizeof(launch));
+	_exit(EX_OSERR);
+    }
+    close(launch_pipe[1]);
+    
+    if ( job_pid == -1 )
+    {
+	lpjs_log("%s(): Error: fork() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	close(launch_pipe[0]);
+	lpjs_cgroup_remove(job_get_job_id(job));
+	return EX_OSERR;
+    }
+    
+    // Also in the parent, in case of a cancel before the child runs
+    setpgid(job_pid, job_pid);
+    
+    // A lost connection is noticed by the event loop in main()
+    lpjs_send_fork_verification(compd_msg_fd);
+    
+    supervisor_add(supervisor, job_get_job_id(job), job_pid, launch_pipe[0]);
+    
+    // Report in future checkins until the completion is sent
+    entry.job_id = job_get_job_id(job);
+    entry.chaperone_pid = job_pid;
+    entry.job_pid = job_pid;
+    entry.procs = job_get_procs_per_job(job);
+    entry.pmem_per_proc = job_get_pmem_per_proc(job);
+    entry.uid = lpjs_job_uid(job);
+    inventory_add(inventory, &entry);
+    inventory_save(inventory, LPJS_COMPD_INVENTORY);
+    
+    lpjs_log("%s(): Job %lu is PID %d.\n", __FUNCTION__,
+	     job_get_job_id(job), job_pid);
+    
+    return EX_OK;
+}
+
+
 void    lpjs_chown(job_t *job, const char *path)
 
 {
@@ -861,12 +1197,18 @@ void    lpjs_chown(job_t *job, const char *path)
  *  History: 
  *  Date        Name        Modification
  *  2024-05-04  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Reap all exited children
  ***************************************************************************/
 
 void    sigchld_handler(int s2)
 
 {
-    int     status;
+    int     status,
+	    saved_errno = errno;
     
-    wait(&status);
+    // Signals may be merged, so reap every exited child.  A zombie
+    // would look alive to inventory_prune().
+    while ( waitpid(-1, &status, WNOHANG) > 0 )
+	;
+    errno = saved_errno;
 }
@@ -1,16 +1,33 @@
 /* lpjs_dispatchd.c */
 int lpjs_process_events(node_list_t *node_list);
-void lpjs_log_job(const char *incoming_msg);
-void lpjs_check_comp_fds(fd_set *read_fds, node_list_t *node_list, job_list_t *running_jobs);
+int lpjs_load_queues(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+int lpjs_replay(const char *trace_path, node_list_t *node_list);
+void lpjs_log_job(job_t *job, accounting_disposition_t disposition, int exit_status);
+void lpjs_check_comp_fds(fd_set *read_fds, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_node_message(node_t *node, int fd, char *payload, ssize_t bytes, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_job_report(node_t *node, char *record, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_deferred(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+unsigned lpjs_check_heartbeats(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_node_unreachable(node_t *node, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_node_down(node_t *node, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
 int lpjs_listen(struct sockaddr_in *server_address);
 int lpjs_check_listen_fd(int listen_fd, fd_set *read_fds, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
-void lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg, node_list_t *node_list, uid_t munge_uid, gid_t munge_gid);
+void lpjs_check_pool(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_received(pool_task_t *task, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_request(int msg_fd, char *munge_payload, uid_t munge_uid, gid_t munge_gid, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_chaperone_status(char *payload, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_job_complete(char *payload, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs, uid_t munge_uid, gid_t munge_gid);
+void lpjs_reconcile_node(node_t *node, inventory_t *inventory, job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list);
 int lpjs_submit(int msg_fd, const char *incoming_msg, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs, uid_t munge_uid, gid_t munge_gid);
 int lpjs_cancel(int msg_fd, const char *incoming_msg, node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs, uid_t munge_uid, gid_t munge_gid);
 int lpjs_kill_processes(node_list_t *node_list, job_t *job);
-int lpjs_queue_job(int msg_fd, job_list_t *pending_jobs, job_t *job, unsigned long job_array_index, const char *script_text);
+void lpjs_commit_pass(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
+void lpjs_drop_uncommitted(job_list_t *pending_jobs);
+int lpjs_queue_job(job_list_t *pending_jobs, job_t *job, unsigned long job_id, unsigned long job_array_index);
 int lpjs_update_job(node_list_t *node_list, char *payload, job_list_t *pending_jobs, job_list_t *running_jobs);
-int lpjs_load_job_list(job_list_t *job_list, node_list_t *node_list, char *spool_dir);
+int lpjs_load_job_list(job_list_t *job_list, char *spool_dir);
 void lpjs_dispatchd_terminate_handler(int s2);
+void lpjs_dispatchd_terminate(node_list_t *node_list);
 void lpjs_dispatchd_sigpipe(int s2);
 int adjust_resources(node_list_t *node_list, job_list_t *job_list, const char *hostname, unsigned long job_id, node_resource_t direction);
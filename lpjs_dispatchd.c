@@ -21,6 +21,7 @@
 #include <arpa/inet.h>  // inet_ntoa()
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <errno.h>
@@ -45,8 +46,25 @@
 #include "scheduler.h"
 #include "network.h"
 #include "misc.h"
+#include "journal.h"
+#include "cleanup.h"
+#include "inventory.h"
+#include "logger.h"
+#include "accounting.h"
+#include "metrics.h"
+#include "trace.h"
+#include "pool.h"
+#include "board.h"
+#include "pace.h"
+#include "heartbeat.h"
+#include "telemetry.h"
+#include "job-usage.h"
 #include "lpjs_dispatchd.h"
 
+// Set by lpjs_dispatchd_terminate_handler(), acted on in the event loop
+volatile sig_atomic_t   Terminate_requested = 0;
+int                     Terminate_pipe[2] = { -1, -1 };
+
 int     main(int argc,char *argv[])
 
 {
@@ -54,11 +72,14 @@ int     main(int argc,char *argv[])
     node_list_t *node_list = node_list_new();
     uid_t       daemon_uid;
     gid_t       daemon_gid;
+    char        *capture_path = NULL,
+		*replay_path = NULL;
     
     // Must be global for signal handler
     // FIXME: Maybe use ucontext to pass these to handler
     extern FILE         *Log_stream;
     extern node_list_t  *Node_list;
+    extern lpjs_config_t Config;
 
     Node_list = node_list;
     Log_stream = stderr;
@@ -128,9 +149,20 @@ int     main(int argc,char *argv[])
 	    }
 	    daemon_gid = gr_ent->gr_gid;
 	}
+	else if ( (strcmp(argv[arg], "--capture") == 0) && (arg + 1 < argc) )
+	{
+	    // Record input for --replay, see trace.c
+	    capture_path = argv[++arg];
+	}
+	else if ( (strcmp(argv[arg], "--replay") == 0) && (arg + 1 < argc) )
+	{
+	    // Run a capture through the handlers instead of listening
+	    replay_path = argv[++arg];
+	}
 	else
 	{
-	    fprintf (stderr, "Usage: %s [--daemonize|--log-output] [--user username] [--group groupname]\n", argv[0]);
+	    fprintf (stderr, "Usage: %s [--daemonize|--log-output] [--user username] [--group groupname]\n"
+		     "        [--capture file | --replay file]\n", argv[0]);
 	    return EX_USAGE;
 	}
     }
@@ -157,10 +189,31 @@ int     main(int argc,char *argv[])
 	return EX_CANTCREAT;
     }
     
+    // One copy of each submitted script, shared by all jobs in an array
+    if ( xt_rmkdir(LPJS_SCRIPT_DIR, 0755) != 0 )
+    {
+	fprintf(stderr, "Cannot create %s: %s\n", LPJS_SCRIPT_DIR, strerror(errno));
+	return EX_CANTCREAT;
+    }
+    
+    // Job accounting log and indexes
+    if ( xt_rmkdir(LPJS_HISTORY_USER_DIR, 0755) != 0 )
+    {
+	fprintf(stderr, "Cannot create %s: %s\n", LPJS_HISTORY_USER_DIR, strerror(errno));
+	return EX_CANTCREAT;
+    }
+    chown(LPJS_JOB_HISTORY, daemon_uid, daemon_gid);
+    chown(LPJS_HISTORY_USER_DIR, daemon_uid, daemon_gid);
+    chown(LPJS_HISTORY_RECORDS, daemon_uid, daemon_gid);
+    chown(LPJS_HISTORY_TIME_INDEX, daemon_uid, daemon_gid);
+    
     // Make spool dir writable to daemon owner after root creates it
+    chown(LPJS_SPOOL_DIR, daemon_uid, daemon_gid);
     chown(LPJS_PENDING_DIR, daemon_uid, daemon_gid);
     chown(LPJS_RUNNING_DIR, daemon_uid, daemon_gid);
-    chown(LPJS_SPOOL_DIR "/next-job", daemon_uid, daemon_gid);
+    chown(LPJS_SCRIPT_DIR, daemon_uid, daemon_gid);
+    chown(LPJS_JOURNAL, daemon_uid, daemon_gid);
+    chown(LPJS_SNAPSHOT, daemon_uid, daemon_gid);
 
 /*
  *  systemd needs a pid file for forking daemons.  BSD systems don't
@@ -210,6 +263,11 @@ int     main(int argc,char *argv[])
     
     // Read etc/lpjs/config, created by lpjs-admin
     lpjs_load_config(node_list, LPJS_CONFIG_ALL, Log_stream);
+    lpjs_log("%s(): Authentication backend: %s\n", __FUNCTION__,
+	     lpjs_auth_backend_name(Config.auth));
+    
+    // Hand log output to a writer thread, so I/O stays off the event loop
+    lpjs_log_start();
     
     /*
      *  bind(): address already in use during testing with frequent restarts.
@@ -229,7 +287,28 @@ int     main(int argc,char *argv[])
      */
     
     signal(SIGPIPE, lpjs_dispatchd_sigpipe);
+    
+    // Remove spool files in the background, after dropping privileges
+    lpjs_cleanup_start();
 
+    if ( replay_path != NULL )
+    {
+	int replay_status = lpjs_replay(replay_path, node_list);
+#ifdef __linux__
+	unlink(Pid_path);
+#endif
+	return replay_status;
+    }
+    
+    // After dropping privileges, so the daemon user can read the capture
+    if ( (capture_path != NULL) &&
+	 (lpjs_trace_capture_open(capture_path) != LPJS_SUCCESS) )
+	return EX_CANTCREAT;
+    
+    // Not for replay, which must process everything in capture order
+    lpjs_pool_start(Config.worker_threads);
+    lpjs_pace_start(Config.checkin_rate);
+    
     return lpjs_process_events(node_list);
 }
 
@@ -242,25 +321,52 @@ int     main(int argc,char *argv[])
  *  History: 
  *  Date        Name        Modification
  *  2021-09-25  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record metrics, periodic metrics dump
+ *  2026-10-19  Jason Bacon Factor out lpjs_load_queues()
+ *  2026-10-19  Jason Bacon Worker pool, replies wait for journal commit
+ *  2026-10-19  Jason Bacon Publish status board
+ *  2026-10-19  Jason Bacon Check compute node heartbeats
+ *  2026-10-19  Jason Bacon Shut down on request from signal handler
  ***************************************************************************/
 
 int     lpjs_process_events(node_list_t *node_list)
 
 {
-    int                 listen_fd;
+    int                 listen_fd, ready, status, pool_fd;
+    unsigned            heartbeat_events;
     struct sockaddr_in  server_address = { 0 };
+    struct timeval      dump_timeout, tick_timeout, *timeout;
+    struct timespec     loop_start;
     // job_list_new() terminates process if malloc fails, no need to check
     job_list_t          *pending_jobs = job_list_new(),
 			*running_jobs = job_list_new();
 
-    lpjs_load_job_list(pending_jobs, node_list, LPJS_PENDING_DIR);
-    lpjs_load_job_list(running_jobs, node_list, LPJS_RUNNING_DIR);
+    if ( (status = lpjs_load_queues(node_list, pending_jobs,
+				    running_jobs)) != EX_OK )
+	return status;
     
     /*
      *  Step 1: Create a socket for listening for new connections.
      */
     
     listen_fd = lpjs_listen(&server_address);
+    pool_fd = lpjs_pool_done_fd();
+    lpjs_board_publish(pending_jobs, running_jobs, node_list);
+    
+    // Wakes up select() when a signal goes to another thread
+    if ( pipe(Terminate_pipe) == 0 )
+    {
+	fcntl(Terminate_pipe[0], F_SETFL, O_NONBLOCK);
+	fcntl(Terminate_pipe[1], F_SETFL, O_NONBLOCK);
+	fcntl(Terminate_pipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl(Terminate_pipe[1], F_SETFD, FD_CLOEXEC);
+    }
+    else
+    {
+	lpjs_log("%s(): Error: pipe() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	Terminate_pipe[0] = Terminate_pipe[1] = -1;
+    }
 
     /*
      *  Step 2: Accept new connections, and create a separate socket
@@ -272,12 +378,31 @@ int     lpjs_process_events(node_list_t *node_list)
 	fd_set  read_fds;
 	int     nfds, highest_fd;
 	
+	// Between passes, so the journal is not in the middle of a commit
+	if ( Terminate_requested )
+	    lpjs_dispatchd_terminate(node_list);
+	
 	// FIXME: Might this erase pending messages?
 	// Use poll() instead of select()?
 	FD_ZERO(&read_fds);
 	FD_SET(listen_fd, &read_fds);
 	highest_fd = listen_fd;
 	
+	if ( Terminate_pipe[0] != -1 )
+	{
+	    FD_SET(Terminate_pipe[0], &read_fds);
+	    if ( Terminate_pipe[0] > highest_fd )
+		highest_fd = Terminate_pipe[0];
+	}
+	
+	// Requests received by worker threads
+	if ( pool_fd != -1 )
+	{
+	    FD_SET(pool_fd, &read_fds);
+	    if ( pool_fd > highest_fd )
+		highest_fd = pool_fd;
+	}
+	
 	for (unsigned c = 0; c < node_list_get_compute_node_count(node_list); ++c)
 	{
 	    node_t *node = node_list_get_compute_nodes_ae(node_list, c);
@@ -302,23 +427,51 @@ int     lpjs_process_events(node_list_t *node_list)
 	nfds = highest_fd + 1;
 	
 	lpjs_log("%s(): Waiting for input events...\n", __FUNCTION__);
-	if ( select(nfds, &read_fds, NULL, NULL, LPJS_NO_SELECT_TIMEOUT) > 0 )
+	// No timeout unless metrics are dumped periodically or
+	// heartbeats are watched
+	timeout = lpjs_metrics_dump_timeout(&dump_timeout);
+	timeout = lpjs_heartbeat_timeout(timeout, &tick_timeout);
+	ready = select(nfds, &read_fds, NULL, NULL, timeout);
+	clock_gettime(CLOCK_MONOTONIC, &loop_start);
+	if ( ready > 0 )
 	{
 	    //lpjs_debug("%s(): Checking comp fds...\n", __FUNCTION__);
-	    // compd doesn't presently initiate conversations on
-	    // the persistend socket.  It is used only for dispatchd
-	    // to send new jobs to compd.  This function only serves
-	    // to check for lost connections with compd daemons.
-	    lpjs_check_comp_fds(&read_fds, node_list, running_jobs);
+	    // compd initiates conversations on the persistent socket
+	    // only to report jobs it supervises itself.  Otherwise
+	    // this only serves to check for lost connections with
+	    // compd daemons.
+	    lpjs_check_comp_fds(&read_fds, node_list, pending_jobs,
+				running_jobs);
 	    
 	    //lpjs_debug("%s(): Checking listen fd...\n", __FUNCTION__);
 	    // Check FD_ISSET before calling function to avoid overhead
 	    if ( FD_ISSET(listen_fd, &read_fds) )
 		lpjs_check_listen_fd(listen_fd, &read_fds,
 				     node_list, pending_jobs, running_jobs);
+	    
+	    if ( (pool_fd != -1) && FD_ISSET(pool_fd, &read_fds) )
+		lpjs_check_pool(node_list, pending_jobs, running_jobs);
 	}
-	else
+	else if ( (ready == 0) && (timeout == LPJS_NO_SELECT_TIMEOUT) )
 	    lpjs_log("%s(): Bug: select() returned 0. This should never happen with no timeout.\n");
+	lpjs_process_deferred(node_list, pending_jobs, running_jobs);
+	heartbeat_events = lpjs_check_heartbeats(node_list, pending_jobs,
+						 running_jobs);
+	
+	// One journal sync for all events processed above, and
+	// acknowledge submissions only once they are on disk
+	lpjs_commit_pass(node_list, pending_jobs, running_jobs);
+	lpjs_cleanup_report();
+	
+	// Nothing changed on a timeout unless a node missed heartbeats
+	if ( (ready > 0) || (heartbeat_events > 0) )
+	    lpjs_board_publish(pending_jobs, running_jobs, node_list);
+	
+	lpjs_metrics_set_queue_depth(job_list_get_count(pending_jobs),
+				     job_list_get_count(running_jobs));
+	if ( ready > 0 )
+	    lpjs_metrics_observe(LPJS_METRIC_EVENT_LOOP, &loop_start);
+	lpjs_metrics_dump_if_due();
     }
     
     // Never actually get here, but make the compiler happy
@@ -328,20 +481,224 @@ int     lpjs_process_events(node_list_t *node_list)
 
 /***************************************************************************
  *  Description:
- *      Record job info such as command, exit status, run time, etc.
- *      Incoming message is sent by lpjs-chaperone when its child
- *      (a dispatched computational process) terminates.
+ *      Restore the job queues from the spool, and open the journal
+ *      and accounting log
+ *
+ *  Returns:
+ *      EX_OK, or an exit status for main()
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_process_events()
+ ***************************************************************************/
+
+int     lpjs_load_queues(node_list_t *node_list, job_list_t *pending_jobs,
+			 job_list_t *running_jobs)
+
+{
+    if ( lpjs_journal_load(pending_jobs, running_jobs, node_list) != LPJS_SUCCESS )
+    {
+	// No journal yet: Convert per-job spool directories from older versions
+	lpjs_load_job_list(pending_jobs, LPJS_PENDING_DIR);
+	lpjs_load_job_list(running_jobs, LPJS_RUNNING_DIR);
+	if ( (lpjs_journal_import_legacy(pending_jobs, LPJS_PENDING_DIR) != LPJS_SUCCESS) ||
+	     (lpjs_journal_import_legacy(running_jobs, LPJS_RUNNING_DIR) != LPJS_SUCCESS) )
+	{
+	    lpjs_log("%s(): Error: Failed to import spooled jobs.\n", __FUNCTION__);
+	    return EX_DATAERR;
+	}
+    }
+    
+    // Start each run with a fresh snapshot and an empty journal
+    if ( (lpjs_journal_open() != LPJS_SUCCESS) ||
+	 (lpjs_journal_compact(pending_jobs, running_jobs, node_list) != LPJS_SUCCESS) )
+	return EX_CANTCREAT;
+    
+    // Not fatal: Jobs can still run without accounting
+    lpjs_accounting_open();
+    lpjs_metrics_init();
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Feed a capture from "lpjs_dispatchd --capture" through the same
+ *      handlers as live input, and report handler times on stdout.
+ *      See trace.c.
+ *
+ *      Replay starts from the queues in the spool and modifies them,
+ *      as a live dispatchd would.  For results that match the
+ *      capture, restore a copy of the spool taken when the capturing
+ *      dispatchd started, before each replay.
+ *
+ *  Returns:
+ *      EX_OK, or an exit status for main()
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_replay(const char *trace_path, node_list_t *node_list)
+
+{
+    // job_list_new() terminates process if malloc fails, no need to check
+    job_list_t      *pending_jobs = job_list_new(),
+		    *running_jobs = job_list_new();
+    trace_record_t  record;
+    char            source[LPJS_TRACE_SOURCE_MAX + 1],
+		    *payload,
+		    *metrics_text;
+    node_t          *node;
+    unsigned long   records = 0,
+		    unexpected = 0,
+		    replies,
+		    mismatches;
+    uint64_t        capture_ns = 0;
+    double          handler_ms = 0;
+    struct timespec start, end;
+    int             status;
+
+    if ( (status = lpjs_load_queues(node_list, pending_jobs,
+				    running_jobs)) != EX_OK )
+	return status;
+    if ( lpjs_trace_replay_open(trace_path) != LPJS_SUCCESS )
+	return EX_NOINPUT;
+
+    while ( ! Terminate_requested &&
+	    ((status = lpjs_trace_read(&record, source, &payload))
+	     == LPJS_SUCCESS) )
+    {
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	switch(record.kind)
+	{
+	    case    LPJS_TRACE_REQUEST:
+		if ( payload != NULL )
+		{
+		    lpjs_process_request(LPJS_TRACE_REPLAY_FD, payload,
+					 record.uid, record.gid, node_list,
+					 pending_jobs, running_jobs);
+		    lpjs_metrics_observe_request(payload[0], &start);
+		    free(payload);
+		}
+		break;
+	    
+	    case    LPJS_TRACE_NODE:
+		if ( (node = node_list_find_hostname(node_list, source)) == NULL )
+		{
+		    lpjs_log("%s(): Warning: Message from unknown node %s.\n",
+			     __FUNCTION__, source);
+		    ++unexpected;
+		    free(payload);
+		}
+		else
+		    lpjs_process_node_message(node, LPJS_TRACE_REPLAY_FD,
+					      payload, record.bytes, node_list,
+					      pending_jobs, running_jobs);
+		break;
+	    
+	    default:
+		// A reply that this run did not wait for
+		lpjs_log("%s(): Warning: Unexpected reply from %s.\n",
+			 __FUNCTION__, source);
+		++unexpected;
+		free(payload);
+	}
+	
+	// As in lpjs_process_events(), once per event loop iteration
+	lpjs_process_deferred(node_list, pending_jobs, running_jobs);
+	lpjs_commit_pass(node_list, pending_jobs, running_jobs);
+	lpjs_cleanup_report();
+	lpjs_metrics_observe(LPJS_METRIC_EVENT_LOOP, &start);
+	
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	handler_ms += lpjs_elapsed_ms(&start, &end);
+	capture_ns = record.time_ns;
+	++records;
+    }
+    if ( status == LPJS_READ_FAILED )
+	lpjs_log("%s(): Warning: Stopped at a truncated or corrupt record.\n",
+		 __FUNCTION__);
+    
+    lpjs_trace_replay_counts(&replies, &mismatches);
+    printf("%lu events and %lu replies captured over %.3f s, replayed in %.3f ms\n",
+	   records, replies, capture_ns / 1e9, handler_ms);
+    printf("Replies missing: %lu  Unexpected records: %lu\n",
+	   mismatches, unexpected);
+    printf("Final queues: %lu pending, %lu running\n\n",
+	   job_list_get_count(pending_jobs), job_list_get_count(running_jobs));
+    
+    lpjs_metrics_set_queue_depth(job_list_get_count(pending_jobs),
+				 job_list_get_count(running_jobs));
+    if ( (metrics_text = malloc(LPJS_METRICS_TEXT_MAX + 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    lpjs_metrics_format(metrics_text, LPJS_METRICS_TEXT_MAX + 1,
+			LPJS_METRICS_FORMAT_SUMMARY);
+    fputs(metrics_text, stdout);
+    free(metrics_text);
+    
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record job info such as exit status, run time, etc. when a job
+ *      leaves the queue, in the main log and the accounting log.
+ *      exit_status is only meaningful for ACCOUNTING_COMPLETED.
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-28  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Write accounting record
+ *  2026-10-19  Jason Bacon Stamp completion, log launch latency
+ *  2026-10-19  Jason Bacon Log usage and efficiency
  ***************************************************************************/
 
-void    lpjs_log_job(const char *incoming_msg)
+void    lpjs_log_job(job_t *job, accounting_disposition_t disposition,
+		     int exit_status)
 
 {
-    // FIXME: Add extensive info about the job
-    lpjs_log(incoming_msg);
+    static const char   *dispositions[] =
+			{ "completed", "canceled", "failed", "lost" };
+    time_t              start_time = job_get_start_time(job),
+			elapsed = start_time == 0 ? 0 : time(NULL) - start_time;
+    char                fields[JOB_TIMING_STAGES - 1][JOB_TIMING_FIELD_MAX + 1],
+			cpu_pct[JOB_USAGE_PCT_MAX + 1],
+			mem_pct[JOB_USAGE_PCT_MAX + 1];
+    int                 c;
+    size_t              mem_MiB = job_get_procs_per_job(job) *
+				  job_get_pmem_per_proc(job);
+    
+    job_stamp(job, JOB_TIMING_COMPLETED);
+    for (c = 0; c < JOB_TIMING_STAGES - 1; ++c)
+	job_format_interval(job_get_timing_ae(job, c),
+			    job_get_timing_ae(job, c + 1),
+			    fields[c], JOB_TIMING_FIELD_MAX + 1);
+    
+    lpjs_log("%s(): Job %lu %s on %s, status %d, %ld seconds.\n",
+	     __FUNCTION__, job_get_job_id(job), dispositions[disposition],
+	     job_get_compute_node(job), exit_status, (long)elapsed);
+    lpjs_log("%s(): Job %lu wait %s schedule %s dispatch %s setup %s notice %s run %s\n",
+	     __FUNCTION__, job_get_job_id(job), fields[0], fields[1],
+	     fields[2], fields[3], fields[4], fields[5]);
+    job_usage_pct_str(job_get_cpu_sec(job),
+		      (double)elapsed * job_get_procs_per_job(job),
+		      cpu_pct, JOB_USAGE_PCT_MAX + 1);
+    job_usage_pct_str(job_get_peak_rss_MiB(job), mem_MiB, mem_pct,
+		      JOB_USAGE_PCT_MAX + 1);
+    lpjs_log("%s(): Job %lu CPU %.1f s (%s), peak %zu of %zu MiB (%s), "
+	     "read %ju MiB, written %ju MiB, peak threads %u\n",
+	     __FUNCTION__, job_get_job_id(job), job_get_cpu_sec(job), cpu_pct,
+	     job_get_peak_rss_MiB(job), mem_MiB, mem_pct,
+	     (uintmax_t)(job_get_read_bytes(job) / 1024 / 1024),
+	     (uintmax_t)(job_get_write_bytes(job) / 1024 / 1024),
+	     job_get_peak_threads(job));
+    lpjs_accounting_add(job, disposition, exit_status);
 }
 
 
@@ -352,19 +709,25 @@ void    lpjs_log_job(const char *incoming_msg)
  *  History: 
  *  Date        Name        Modification
  *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Capture input
+ *  2026-10-19  Jason Bacon Process job reports from supervising compd
+ *  2026-10-19  Jason Bacon Note heartbeats and other node activity
+ *  2026-10-19  Jason Bacon Record telemetry sent with heartbeats
+ *  2026-10-19  Jason Bacon Accept heartbeats only from nodes
  ***************************************************************************/
 
 void    lpjs_check_comp_fds(fd_set *read_fds, node_list_t *node_list,
-			    job_list_t *running_jobs)
+			    job_list_t *pending_jobs, job_list_t *running_jobs)
 
 {
     // Terminates process if malloc() fails, no check required
     node_t  *node = node_new();
     int     fd;
     ssize_t bytes;
-    char    *munge_payload;
+    char    *munge_payload = NULL;
     uid_t   uid;
     gid_t   gid;
+    struct pollfd   poll_fd;
     
     // Top priority: Active compute nodes (move existing jobs along)
     // Second priority: New compute node checkins (make resources available)
@@ -377,6 +740,16 @@ void    lpjs_check_comp_fds(fd_set *read_fds, node_list_t *node_list,
 	{
 	    // lpjs_debug("Activity on fd %d\n", fd);
 	    
+	    /*
+	     *  A job dispatched while handling an earlier node's report
+	     *  may have read this node's report already.  Don't block
+	     *  waiting for another.
+	     */
+	    poll_fd.fd = fd;
+	    poll_fd.events = POLLIN;
+	    if ( poll(&poll_fd, 1, 0) < 1 )
+		continue;
+	    
 	    /*
 	     *  select() returns when a peer has closed the connection.
 	     *  lpjs_recv() will return 0 in this case.
@@ -384,33 +757,328 @@ void    lpjs_check_comp_fds(fd_set *read_fds, node_list_t *node_list,
 	    
 	    // FIXME: Verify that lost connections are handled properly
 	    // FIXME: Use lpjs_recv_munge
-	    bytes = lpjs_recv_munge(fd, &munge_payload,
-				    0, 0, &uid, &gid,
-				    lpjs_dispatchd_safe_close);
-	    if ( bytes < 1 )
-	    {
-		lpjs_log("%s(): Lost connection to %s.  Closing %d...\n",
-			__FUNCTION__, node_get_hostname(node), fd);
-		lpjs_dispatchd_safe_close(fd);
-		node_set_msg_fd(node, NODE_MSG_FD_NOT_OPEN);
-		node_set_state(node, "down");
-	    }
-	    else
+	    bytes = lpjs_recv_node_munge(fd, &munge_payload,
+					 0, 0, &uid, &gid,
+					 lpjs_dispatchd_safe_close);
+	    if ( bytes == LPJS_RECV_HEARTBEAT )
 	    {
-		// At present, compd never messages dispatchd after checkin
-		switch(munge_payload[0])
+		lpjs_heartbeat_seen(node, true);
+		if ( munge_payload != NULL )
 		{
-		    default:
-			lpjs_log("%s(): Error: Invalid notification on fd %d: %d\n",
-				__FUNCTION__, fd, munge_payload[0]);
+		    lpjs_telemetry_update(node, munge_payload, running_jobs);
+		    free(munge_payload);
 		}
-		free(munge_payload);
+		continue;
 	    }
+	    else if ( bytes > 0 )
+		lpjs_heartbeat_seen(node, false);
+	    
+	    lpjs_trace_capture(LPJS_TRACE_NODE, node_get_hostname(node),
+			       munge_payload, bytes, uid, gid);
+	    lpjs_process_node_message(node, fd, munge_payload, bytes,
+				      node_list, pending_jobs, running_jobs);
 	}
     }
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Act on a message or hangup from a compute node.  bytes is the
+ *      lpjs_recv_munge() return value.  Frees payload.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_check_comp_fds()
+ *  2026-10-19  Jason Bacon Accept job reports from supervising compd
+ *  2026-10-19  Jason Bacon Accept batches of relayed chaperone reports
+ *  2026-10-19  Jason Bacon Lost connection makes node unreachable
+ *  2026-10-19  Jason Bacon Acknowledge batches without a verification reply
+ ***************************************************************************/
+
+void    lpjs_process_node_message(node_t *node, int fd, char *payload,
+				  ssize_t bytes, node_list_t *node_list,
+				  job_list_t *pending_jobs,
+				  job_list_t *running_jobs)
+
+{
+    char            outgoing_msg[LPJS_MSG_LEN_MAX + 1],
+		    *p,
+		    *record,
+		    *end;
+    unsigned long   batch;
+    unsigned        count;
+    struct timespec start;
+    
+    if ( bytes < 1 )
+    {
+	lpjs_log("%s(): Lost connection to %s.  Closing %d...\n",
+		__FUNCTION__, node_get_hostname(node), fd);
+	lpjs_dispatchd_safe_close(fd);
+	node_set_msg_fd(node, NODE_MSG_FD_NOT_OPEN);
+	lpjs_node_unreachable(node, node_list, pending_jobs, running_jobs);
+    }
+    else if ( payload[0] == LPJS_DISPATCHD_REQUEST_JOB_REPORTS )
+    {
+	/*
+	 *  Chaperone reports relayed by compd, one per line following
+	 *  the batch number.  See relay.h.  Acknowledge the batch only
+	 *  after processing all of them, so none are lost if we crash.
+	 */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	p = payload + 1;
+	batch = strtoul(strsep(&p, "\n"), &end, 10);
+	for (count = 0; (p != NULL) && (*p != '\0'); ++count)
+	{
+	    record = strsep(&p, "\n");
+	    lpjs_process_job_report(node, record, node_list,
+				    pending_jobs, running_jobs);
+	}
+	lpjs_log("%s(): %u reports in batch %lu from %s\n", __FUNCTION__,
+		 count, batch, node_get_hostname(node));
+	
+	if ( (fd != LPJS_TRACE_REPLAY_FD) && (fd != NODE_MSG_FD_NOT_OPEN) )
+	{
+	    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%lu",
+		     LPJS_COMPD_REQUEST_REPORTS_ACK, batch);
+	    if ( lpjs_send_node_munge(fd, outgoing_msg,
+				      lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
+		lpjs_log("%s(): Error: Failed to acknowledge batch %lu.\n",
+			 __FUNCTION__, batch);
+	}
+	lpjs_metrics_observe_request(payload[0], &start);
+	free(payload);
+    }
+    else
+    {
+	/*
+	 *  compd also sends single reports when it supervises jobs
+	 *  itself ("job-supervisor compd").  The reports are the same
+	 *  as a chaperone's, but need no reply, since the connection
+	 *  was authorized at checkin.
+	 */
+	lpjs_process_job_report(node, payload, node_list,
+				pending_jobs, running_jobs);
+	free(payload);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Act on a launch status, start, or completion report received
+ *      on a compute node's connection.  record begins with the
+ *      request code.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_process_node_message()
+ ***************************************************************************/
+
+void    lpjs_process_job_report(node_t *node, char *record,
+				node_list_t *node_list,
+				job_list_t *pending_jobs,
+				job_list_t *running_jobs)
+
+{
+    switch(record[0])
+    {
+	case    LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS:
+	    lpjs_log("%s(): Launch status from %s\n",
+		     __FUNCTION__, node_get_hostname(node));
+	    lpjs_chaperone_status(record + 1, node_list,
+				  pending_jobs, running_jobs);
+	    break;
+	
+	case    LPJS_DISPATCHD_REQUEST_JOB_STARTED:
+	    lpjs_log("%s(): Job started on %s\n",
+		     __FUNCTION__, node_get_hostname(node));
+	    lpjs_update_job(node_list, record + 1,
+			    pending_jobs, running_jobs);
+	    break;
+	
+	case    LPJS_DISPATCHD_REQUEST_JOB_COMPLETE:
+	    lpjs_log("%s(): Job complete on %s\n",
+		     __FUNCTION__, node_get_hostname(node));
+	    lpjs_job_complete(record + 1, node_list,
+			      pending_jobs, running_jobs);
+	    break;
+	
+	default:
+	    lpjs_log("%s(): Error: Invalid report from %s: %d\n",
+		    __FUNCTION__, node_get_hostname(node), record[0]);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Process job reports set aside by lpjs_dispatch_next_job() while
+ *      it awaited a fork verification.  Handling one may dispatch
+ *      more jobs and defer more reports, so continue until none are
+ *      left.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_process_deferred(node_list_t *node_list,
+			      job_list_t *pending_jobs,
+			      job_list_t *running_jobs)
+
+{
+    node_t  *node;
+    char    *payload;
+    ssize_t bytes;
+    
+    while ( lpjs_next_deferred_message(&node, &payload, &bytes) )
+	lpjs_process_node_message(node, node_get_msg_fd(node), payload,
+				  bytes, node_list, pending_jobs,
+				  running_jobs);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Act on compute nodes that have missed heartbeats, or have been
+ *      unreachable too long.  Suspect nodes get no new jobs until
+ *      heard from again.  Nodes that remain silent are disconnected
+ *      and become unreachable, and unreachable nodes that do not
+ *      check in again in time are marked down.  See heartbeat.h.
+ *
+ *  Returns:
+ *      The number of nodes whose state changed
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Grace period for unreachable nodes
+ ***************************************************************************/
+
+unsigned    lpjs_check_heartbeats(node_list_t *node_list,
+			      job_list_t *pending_jobs,
+			      job_list_t *running_jobs)
+
+{
+    node_t              *node;
+    heartbeat_event_t   event;
+    unsigned            changed = 0,
+			down = 0;
+    
+    while ( (event = lpjs_heartbeat_next_event(&node))
+	    != LPJS_HEARTBEAT_NONE )
+    {
+	switch(event)
+	{
+	    case    LPJS_HEARTBEAT_SUSPECT:
+		if ( strcmp(node_get_state(node), "up") == 0 )
+		{
+		    lpjs_log("%s(): Warning: No heartbeat from %s for %ld seconds.  Marking suspect.\n",
+			     __FUNCTION__, node_get_hostname(node),
+			     (long)(time(NULL) - node_get_last_ping(node)));
+		    node_set_state(node, "suspect");
+		    ++changed;
+		}
+		break;
+	    
+	    case    LPJS_HEARTBEAT_LOST:
+		// Don't wait on the peer, which may be gone
+		lpjs_log("%s(): Error: No heartbeat from %s for %ld seconds.  Closing %d...\n",
+			 __FUNCTION__, node_get_hostname(node),
+			 (long)(time(NULL) - node_get_last_ping(node)),
+			 node_get_msg_fd(node));
+		close(node_get_msg_fd(node));
+		node_set_msg_fd(node, NODE_MSG_FD_NOT_OPEN);
+		lpjs_node_unreachable(node, node_list, pending_jobs,
+				      running_jobs);
+		++changed;
+		break;
+	    
+	    default:
+		lpjs_log("%s(): Error: %s has been unreachable for %ld seconds.\n",
+			 __FUNCTION__, node_get_hostname(node),
+			 (long)(time(NULL) - node_get_last_ping(node)));
+		lpjs_node_down(node, node_list, pending_jobs, running_jobs);
+		++changed;
+		++down;
+	}
+    }
+    
+    // Requeued jobs may fit elsewhere
+    if ( down > 0 )
+	lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+    return changed;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Hold on to a compute node whose connection has been lost.  Its
+ *      jobs keep running and their resources stay allocated, but it
+ *      gets no new jobs.  If compd checks in again within
+ *      reconnect-grace seconds, it reconciles its live chaperones and
+ *      sends any reports queued meanwhile, as after a dispatchd
+ *      restart.  Otherwise, or if reconnect-grace is 0, the node is
+ *      marked down.  The caller has closed the connection.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_node_unreachable(node_t *node, node_list_t *node_list,
+			      job_list_t *pending_jobs,
+			      job_list_t *running_jobs)
+
+{
+    extern lpjs_config_t    Config;
+    
+    if ( Config.reconnect_grace == 0 )
+    {
+	lpjs_node_down(node, node_list, pending_jobs, running_jobs);
+	lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	return;
+    }
+    
+    lpjs_log("%s(): %s is unreachable.  Keeping its jobs for up to %u seconds.\n",
+	     __FUNCTION__, node_get_hostname(node), Config.reconnect_grace);
+    node_set_state(node, "unreachable");
+    lpjs_heartbeat_lost(node);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Give up on a compute node, releasing its resources as if it
+ *      had checked in with no live chaperones: Running jobs are lost
+ *      and dispatched jobs are requeued.  If compd is alive after
+ *      all, it checks in again and its live chaperones are adopted
+ *      back.  The caller dispatches any requeued jobs.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Connection is closed by the caller
+ ***************************************************************************/
+
+void    lpjs_node_down(node_t *node, node_list_t *node_list,
+		       job_list_t *pending_jobs, job_list_t *running_jobs)
+
+{
+    // Terminates process if malloc() fails, no check required
+    inventory_t *inventory = inventory_new();
+    
+    lpjs_log("%s(): Setting %s to down and releasing its resources...\n",
+	     __FUNCTION__, node_get_hostname(node));
+    node_set_state(node, "down");
+    lpjs_reconcile_node(node, inventory, pending_jobs, running_jobs,
+			node_list);
+    free(inventory->entries);
+    free(inventory);
+}
+
+
 /***************************************************************************
  *  Description:
  *      Create listener socket
@@ -463,334 +1131,451 @@ int     lpjs_listen(struct sockaddr_in *server_address)
     while ( bind(listen_fd, (struct sockaddr *)server_address,
 	      sizeof (*server_address)) < 0 )
     {
-	lpjs_log("%s(): Error: bind() failed: %s\n", __FUNCTION__, strerror(errno));
-	lpjs_log("%s(): Retry in 10 seconds...\n", __FUNCTION__);
-	sleep(10);
+	lpjs_log("%s(): Error: bind() failed: %s\n", __FUNCTION__, strerror(errno));
+	lpjs_log("%s(): Retry in 10 seconds...\n", __FUNCTION__);
+	sleep(10);
+    }
+    lpjs_log("%s(): Bound to port %d...\n", __FUNCTION__, LPJS_IP_TCP_PORT);
+    
+    /*
+     *  Create queue for incoming connection requests
+     */
+    if (listen(listen_fd, LPJS_CONNECTION_QUEUE_MAX) != 0)
+    {
+	lpjs_log("%s(): Error: listen() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    return listen_fd;
+}
+
+
+
+/***************************************************************************
+ *  Description
+ *      Process events arriving on the listening socket.  The request
+ *      is read and decoded by a worker thread if the pool is running,
+ *      and comes back through lpjs_check_pool().
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Record request latency, add STATS request
+ *  2026-10-19  Jason Bacon Capture input, factor out lpjs_process_request()
+ *  2026-10-19  Jason Bacon Receive in a worker thread
+ ***************************************************************************/
+
+int     lpjs_check_listen_fd(int listen_fd, fd_set *read_fds,
+			     node_list_t *node_list,
+			     job_list_t *pending_jobs, job_list_t *running_jobs)
+
+{
+    int             msg_fd;
+    socklen_t       address_len = sizeof (struct sockaddr_in);
+    struct sockaddr_in client_address = { 0 };
+    pool_task_t     *task;
+    
+    /* Accept a connection request */
+    if ((msg_fd = accept(listen_fd,
+	    (struct sockaddr *)&client_address, &address_len)) == -1)
+    {
+	lpjs_log("%s(): Error: accept() failed, even though select indicated listen_fd.\n",
+		__FUNCTION__);
+	return -1;
+    }
+    
+    task = lpjs_pool_task_new(LPJS_POOL_TASK_RECV, msg_fd);
+    clock_gettime(CLOCK_MONOTONIC, &task->start);
+    strlcpy(task->source, inet_ntoa(client_address.sin_addr),
+	    LPJS_POOL_SOURCE_MAX + 1);
+    lpjs_log("%s(): Accepted connection. fd = %d  addr = %s  port = %u\n",
+	     __FUNCTION__, msg_fd, task->source, client_address.sin_port);
+
+    // Read a message through the socket now if no worker can
+    if ( ! lpjs_pool_submit(task) )
+    {
+	lpjs_pool_run_task(task);
+	lpjs_process_received(task, node_list, pending_jobs, running_jobs);
+    }
+    
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description
+ *      Process requests received by worker threads
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_check_pool(node_list_t *node_list,
+			job_list_t *pending_jobs, job_list_t *running_jobs)
+
+{
+    pool_task_t *task;
+    
+    while ( (task = lpjs_pool_next_done()) != NULL )
+	lpjs_process_received(task, node_list, pending_jobs, running_jobs);
+}
+
+
+/***************************************************************************
+ *  Description
+ *      Handle the result of receiving a request, and free the task.
+ *      Request latency is measured from accept() to the end of
+ *      processing here.  Replies sent by worker threads afterward
+ *      are not included.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_check_listen_fd()
+ ***************************************************************************/
+
+void    lpjs_process_received(pool_task_t *task, node_list_t *node_list,
+			      job_list_t *pending_jobs,
+			      job_list_t *running_jobs)
+
+{
+    lpjs_debug("%s(): Got %zd byte message.\n", __FUNCTION__, task->bytes);
+
+    if ( task->bytes == LPJS_RECV_TIMEOUT )
+    {
+	lpjs_log("%s(): Error: lpjs_recv_munge() timed out after %dus: %s, closing %d.\n",
+		__FUNCTION__, LPJS_CONNECT_TIMEOUT, strerror(errno),
+		task->msg_fd);
+	lpjs_dispatchd_safe_close(task->msg_fd);
+	lpjs_metrics_observe_request(0, &task->start);
+    }
+    else if ( task->bytes == LPJS_RECV_FAILED )
+    {
+	lpjs_log("%s(): Error: lpjs_recv_munge() failed (%zd bytes), closing %d.\n",
+		__FUNCTION__, task->bytes, task->msg_fd);
+	lpjs_dispatchd_safe_close(task->msg_fd);
+	lpjs_metrics_observe_request(0, &task->start);
+    }
+    // bytes must be at least 1, or no mem is allocated
+    else if ( task->bytes < 1 )
+    {
+	lpjs_log("%s(): Bug: Invalid return code from lpjs_recv_munge(): %zd\n",
+		 __FUNCTION__, task->bytes);
+	close(task->msg_fd);
+	lpjs_metrics_observe_request(0, &task->start);
+    }
+    else
+    {
+	lpjs_trace_capture(LPJS_TRACE_REQUEST, task->source,
+			   task->payload, task->bytes, task->uid, task->gid);
+	lpjs_process_request(task->msg_fd, task->payload, task->uid, task->gid,
+			     node_list, pending_jobs, running_jobs);
+	lpjs_metrics_observe_request(task->payload[0], &task->start);
+    }
+    lpjs_pool_task_free(task);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Act on a request received on the listening socket.  Called for
+ *      live connections by lpjs_check_listen_fd() and for captured
+ *      requests by lpjs_replay(), with msg_fd = LPJS_TRACE_REPLAY_FD.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_check_listen_fd()
+ *  2026-10-19  Jason Bacon Send replies from worker threads
+ *  2026-10-19  Jason Bacon Factor out job report handlers
+ ***************************************************************************/
+
+void    lpjs_process_request(int msg_fd, char *munge_payload,
+			     uid_t munge_uid, gid_t munge_gid,
+			     node_list_t *node_list,
+			     job_list_t *pending_jobs, job_list_t *running_jobs)
+
+{
+    pool_task_t     *reply;
+    
+    switch(munge_payload[0])
+    {
+	case    LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN\n",
+		    __FUNCTION__);
+	    lpjs_process_compute_node_checkin(msg_fd, munge_payload,
+					      node_list, pending_jobs,
+					      running_jobs,
+					      munge_uid, munge_gid);
+	    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	    // This connection is sustained, don't close it
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_NODE_LIST:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_NODE_STATUS\n",
+		    __FUNCTION__);
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	    node_list_reply_status(reply, node_list);
+	    lpjs_reply_send(reply);
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_PAUSE:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_PAUSE\n",
+		    __FUNCTION__);
+	    node_list_set_state(node_list, munge_payload + 1);
+	    lpjs_reply_send(lpjs_reply_new(msg_fd, LPJS_REPLY_EOT));
+	    break;
+	
+	case    LPJS_DISPATCHD_REQUEST_RESUME:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_RESUME\n",
+		    __FUNCTION__);
+	    node_list_set_state(node_list, munge_payload + 1);
+	    lpjs_reply_send(lpjs_reply_new(msg_fd, LPJS_REPLY_EOT));
+	    // New resources might be available
+	    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_JOB_LIST:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_STATUS\n",
+		    __FUNCTION__);
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	    job_list_reply_queues(reply, munge_payload[1], running_jobs,
+				  pending_jobs);
+	    lpjs_reply_send(reply);
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_STATS:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_STATS\n",
+		    __FUNCTION__);
+	    lpjs_metrics_set_queue_depth(job_list_get_count(pending_jobs),
+					 job_list_get_count(running_jobs));
+	    // Second byte selects the format
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	    lpjs_metrics_reply(reply, munge_payload[1]);
+	    lpjs_reply_send(reply);
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_SUBMIT:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_SUBMIT\n",
+		    __FUNCTION__);
+	    lpjs_submit(msg_fd, munge_payload, node_list,
+			pending_jobs, running_jobs,
+			munge_uid, munge_gid);
+	    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	    break;
+    
+	case    LPJS_DISPATCHD_REQUEST_CANCEL:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_CANCEL\n",
+		    __FUNCTION__);
+	    lpjs_cancel(msg_fd, munge_payload + 1, node_list,
+			pending_jobs, running_jobs,
+			munge_uid, munge_gid);
+	    // Resources might become available here
+	    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	    break;
+	
+	case    LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS:
+	    // This is a temporary connection from the chaperone
+	    // for just this message.  Don't keep it open.
+	    // FIXME: Seeing if this causes stalls
+	    // lpjs_dispatchd_safe_close(msg_fd);
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS\n",
+		    __FUNCTION__);
+	    lpjs_chaperone_status(munge_payload + 1, node_list,
+				  pending_jobs, running_jobs);
+	    break;
+
+	case    LPJS_DISPATCHD_REQUEST_JOB_STARTED:
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_STARTED:\n",
+		    __FUNCTION__);
+
+	    // This is a temporary connection from the chaperone
+	    // for just this message.  Don't keep it open.
+	    // Don't sent EOT, but wait for other end to close
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_WAIT);
+	    lpjs_reply_add(reply, "Node authorized");
+	    lpjs_reply_send(reply);
+	
+	    /*
+	     *  No change in node status, don't try to dispatch jobs.
+	     *  Resources were allocated at dispatch time.
+	     */
+	
+	    // Job compute node and PIDs are in text form following
+	    // the one byte LPJS_DISPATCHD_REQUEST_JOB_STARTED
+	    lpjs_update_job(node_list, munge_payload + 1, pending_jobs, running_jobs);
+	    break;
+	
+	case    LPJS_DISPATCHD_REQUEST_JOB_COMPLETE:
+	    // This is a temporary connection from the chaperone
+	    // for just this message.  Don't keep it open.
+	    // Don't sent EOT, but wait for other end to close
+	    lpjs_reply_send(lpjs_reply_new(msg_fd, LPJS_REPLY_WAIT));
+
+	    lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_COMPLETE\n",
+		    __FUNCTION__);
+	    lpjs_job_complete(munge_payload + 1, node_list,
+			      pending_jobs, running_jobs);
+	    break;
+	
+	default:
+	    lpjs_log("%s(): Error: Invalid request code byte on listen_fd: %d\n",
+		    __FUNCTION__, munge_payload[0]);
+	
+    }   // switch
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Act on a launch status report for a job, from a chaperone or
+ *      a supervising compd.  payload follows the request code.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_process_request()
+ ***************************************************************************/
+
+void    lpjs_chaperone_status(char *payload, node_list_t *node_list,
+			      job_list_t *pending_jobs,
+			      job_list_t *running_jobs)
+
+{
+    int             chaperone_status;
+    char            chaperone_hostname[LPJS_HOSTNAME_MAX + 1];
+    unsigned long   job_id;
+    node_t          *node;
+    job_t           *job;
+    
+    // FIXME: %s is unsafe.  Send hostname first and use strsep().
+    sscanf(payload, "%lu %d %s",
+	   &job_id, &chaperone_status, chaperone_hostname);
+    lpjs_debug("%s(): job_id = %lu status = %d  hostname = %s\n",
+	     __FUNCTION__, job_id, chaperone_status,
+	     chaperone_hostname);
+
+    // Errors that occur before exec()ing script
+    if ( chaperone_status == LPJS_CHAPERONE_SCRIPT_FAILED )
+    {
+	lpjs_log("%s(): Error: Job script failed to start: %d\n",
+		__FUNCTION__, chaperone_status);
+	// Don't try to restart a script that failed
+	// Either the user needs to fix it, or something
+	// is not installed properly
+	adjust_resources(node_list, pending_jobs, chaperone_hostname,
+			 job_id, NODE_RESOURCE_RELEASE);
+	if ( (job = lpjs_remove_pending_job(pending_jobs, job_id))
+	     != NULL )
+	{
+	    lpjs_log_job(job, ACCOUNTING_FAILED, chaperone_status);
+	    job_free(&job);
+	}
     }
-    lpjs_log("%s(): Bound to port %d...\n", __FUNCTION__, LPJS_IP_TCP_PORT);
-    
-    /*
-     *  Create queue for incoming connection requests
-     */
-    if (listen(listen_fd, LPJS_CONNECTION_QUEUE_MAX) != 0)
+    else if ( (chaperone_status == LPJS_CHAPERONE_OSERR) ||
+	      (chaperone_status == LPJS_CHAPERONE_EXEC_FAILED) )
     {
-	lpjs_log("%s(): Error: listen() failed.\n", __FUNCTION__);
-	exit(EX_UNAVAILABLE);
+	lpjs_log("%s(): Error: OS error or failed exec() detected on %s.\n",
+		__FUNCTION__, chaperone_hostname);
+    
+	lpjs_log("%s(): Releasing resourcesfor job %lu...\n",
+		 __FUNCTION__, job_id);
+	adjust_resources(node_list, pending_jobs, chaperone_hostname,
+			 job_id, NODE_RESOURCE_RELEASE);
+
+	// FIXME: Node should not come back up from here when daemons
+	// are restarted.  It should require "lpjs nodes up nodename"
+	// node_set_state(node, "malfunction");
+	lpjs_log("%s(): Setting %s state to down...\n",
+		 __FUNCTION__, chaperone_hostname);
+	node = node_list_find_hostname(node_list, chaperone_hostname);
+	if ( node == NULL )
+	    lpjs_log("%s(): Bug: No such node in list.\n",
+		     __FUNCTION__);
+	else
+	    node_set_state(node, "down");
+	lpjs_debug("%s(): Done.\n");
+	// FIXME: Make sure job state is reset, but don't remove
+    }
+    else if ( chaperone_status == LPJS_CHAPERONE_OK )
+    {
+	lpjs_log("%s(): Chaperone status OK.\n",__FUNCTION__);
+	// FIXME: Anything to do here?
+    }
+    else
+    {
+	lpjs_log("%s(): Error: Unknown chaperone_status for job %lu: %d\n",
+		 __FUNCTION__, job_id, chaperone_status);
     }
-    return listen_fd;
 }
 
 
-
 /***************************************************************************
- *  Description
- *      Process events arriving on the listening socket
+ *  Description:
+ *      Act on a job completion report, from a chaperone or a
+ *      supervising compd.  payload follows the request code.
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Factor out from lpjs_process_request()
+ *  2026-10-19  Jason Bacon Record measured usage, if reported
  ***************************************************************************/
 
-int     lpjs_check_listen_fd(int listen_fd, fd_set *read_fds,
-			     node_list_t *node_list,
-			     job_list_t *pending_jobs, job_list_t *running_jobs)
+void    lpjs_job_complete(char *payload, node_list_t *node_list,
+			  job_list_t *pending_jobs, job_list_t *running_jobs)
 
 {
-    int             msg_fd,
-		    chaperone_status,
-		    exit_status;
-    ssize_t         bytes;
-    char            *munge_payload,
-		    *p,
-		    *hostname,
-		    chaperone_hostname[LPJS_HOSTNAME_MAX + 1];
-    socklen_t       address_len = sizeof (struct sockaddr_in);
-    uid_t           munge_uid;
-    gid_t           munge_gid;
+    int             exit_status,
+		    items,
+		    len = 0;
+    char            *p,
+		    *hostname;
     unsigned long   job_id;
     node_t          *node;
-    int             items;
     job_t           *job;
-    struct sockaddr_in client_address = { 0 };
+    job_usage_t     usage;
     
-    bytes = 0;
-    /* Accept a connection request */
-    if ((msg_fd = accept(listen_fd,
-	    (struct sockaddr *)&client_address, &address_len)) == -1)
+    p = payload;
+    hostname = strsep(&p, " ");
+    lpjs_debug("%s(): hostname = %s ", __FUNCTION__, hostname);
+    node = node_list_find_hostname(node_list, hostname);
+    if ( node == NULL )
     {
-	lpjs_log("%s(): Error: accept() failed, even though select indicated listen_fd.\n",
+	lpjs_log("%s(): Error: Invalid hostname in job completion report.\n",
 		__FUNCTION__);
-	return -1;
+	return;
     }
-    else
+    if ( (items = sscanf(p, "%lu %d%n", &job_id,
+			 &exit_status, &len)) != 2 )
     {
-	lpjs_log("%s(): Accepted connection. fd = %d  addr = %s  port = %u\n",
-		 __FUNCTION__, msg_fd, inet_ntoa(client_address.sin_addr),
-		 client_address.sin_port);
-
-	/* Read a message through the socket */
-	// FIXME: Timeouts temporarily disabled to debug hung connections
-	//              &munge_payload, 0, LPJS_CONNECT_TIMEOUT,
-	bytes = lpjs_recv_munge(msg_fd,
-		     &munge_payload, 0, 0,
-		     &munge_uid, &munge_gid,
-		     lpjs_dispatchd_safe_close);
-
-	lpjs_debug("%s(): Got %zd byte message.\n", __FUNCTION__, bytes);
+	lpjs_log("%s(): Error: Got %d items reading job_id, procs, mem, status.\n",
+		items);
+	return;
+    }
+    lpjs_debug("%s(): job_id = %lu  status = %d\n",
+	__FUNCTION__, job_id, exit_status);
+    // Zeros if absent, as from lpjs-loadgen or older compute nodes
+    job_usage_from_str(&usage, p + len);
 
-	if ( bytes == LPJS_RECV_TIMEOUT )
-	{
-	    lpjs_log("%s(): Error: lpjs_recv_munge() timed out after %dus: %s, closing %d.\n",
-		    __FUNCTION__, LPJS_CONNECT_TIMEOUT, strerror(errno), msg_fd);
-	    lpjs_dispatchd_safe_close(msg_fd);
-	    // Nothing to free if munge_decode() failed, since it
-	    // allocates the buffer
-	    // free(munge_payload);
-	    return LPJS_RECV_TIMEOUT;
-	}
-	else if ( bytes == LPJS_RECV_FAILED )
-	{
-	    lpjs_log("%s(): Error: lpjs_recv_munge() failed (%zd bytes): %s, closing %d.\n",
-		    __FUNCTION__, bytes, strerror(errno), msg_fd);
-	    lpjs_dispatchd_safe_close(msg_fd);
-	    // Nothing to free if munge_decode() failed, since it
-	    // allocates the buffer
-	    // free(munge_payload);
-	    return LPJS_RECV_FAILED;
-	}
-	// bytes must be at least 1, or no mem is allocated
-	else if ( bytes < 1 )
-	{
-	    lpjs_log("%s(): Bug: Invalid return code from lpjs_recv_munge(): %d\n",
-		     __FUNCTION__, bytes);
-	    return LPJS_RECV_FAILED;
-	}
-	
-	/* Process request */
-	switch(munge_payload[0])
-	{
-	    case    LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN\n",
-			__FUNCTION__);
-		lpjs_process_compute_node_checkin(msg_fd, munge_payload,
-						  node_list, munge_uid, munge_gid);
-		lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
-		// This connection is sustained, don't close it
-		break;
-	    
-	    case    LPJS_DISPATCHD_REQUEST_NODE_LIST:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_NODE_STATUS\n",
-			__FUNCTION__);
-		node_list_send_status(msg_fd, node_list);
-		// lpjs_dispatchd_safe_close(msg_fd);
-		// node_list_send_status() sends EOT,
-		// so don't use safe_close here.
-		lpjs_debug("%s(): Closing %d.\n", __FUNCTION__, msg_fd);
-		close(msg_fd);
-		break;
-	    
-	    case    LPJS_DISPATCHD_REQUEST_PAUSE:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_PAUSE\n",
-			__FUNCTION__);
-		node_list_set_state(node_list, munge_payload + 1);
-		lpjs_dispatchd_safe_close(msg_fd);
-		break;
-		
-	    case    LPJS_DISPATCHD_REQUEST_RESUME:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_RESUME\n",
-			__FUNCTION__);
-		node_list_set_state(node_list, munge_payload + 1);
-		lpjs_dispatchd_safe_close(msg_fd);
-		// New resources might be available
-		lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
-		break;
-	    
-	    case    LPJS_DISPATCHD_REQUEST_JOB_LIST:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_STATUS\n",
-			__FUNCTION__);
-		// FIXME: factor out to lpjs_send_job_list(), check
-		// all messages for success
-		if ( lpjs_send_munge(msg_fd, "Running\n\n",
-				lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
-		{
-		    lpjs_log("%s(): Error: Failed to send \"Running\".\n", __FUNCTION__);
-		    break;
-		}
-		job_list_send_params(msg_fd, running_jobs);
-		if ( lpjs_send_munge(msg_fd, "\nPending\n\n",
-				lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
-		{
-		    lpjs_log("%s(): Failed to send \"Pending\".\n", __FUNCTION__);
-		    break;
-		}
-		job_list_send_params(msg_fd, pending_jobs);
-		// FIXME: Same as LPJS_DISPATCHD_REQUEST_NODE_LIST?
-		lpjs_dispatchd_safe_close(msg_fd);
-		break;
-	    
-	    case    LPJS_DISPATCHD_REQUEST_SUBMIT:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_SUBMIT\n",
-			__FUNCTION__);
-		lpjs_submit(msg_fd, munge_payload, node_list,
-			    pending_jobs, running_jobs,
-			    munge_uid, munge_gid);
-		lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
-		// FIXME: Same as LPJS_DISPATCHD_REQUEST_NODE_LIST?
-		lpjs_dispatchd_safe_close(msg_fd);
-		break;
-	    
-	    case    LPJS_DISPATCHD_REQUEST_CANCEL:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_CANCEL\n",
-			__FUNCTION__);
-		lpjs_cancel(msg_fd, munge_payload + 1, node_list,
-			    pending_jobs, running_jobs,
-			    munge_uid, munge_gid);
-		// Resources might become available here
-		lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
-		// FIXME: Same as LPJS_DISPATCHD_REQUEST_NODE_LIST?
-		lpjs_dispatchd_safe_close(msg_fd);
-		break;
-		
-	    case    LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS:
-		// This is a temporary connection from the chaperone
-		// for just this message.  Don't keep it open.
-		// FIXME: Seeing if this causes stalls
-		// lpjs_dispatchd_safe_close(msg_fd);
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS\n",
-			__FUNCTION__);
-		// FIXME: %s is unsafe.  Send hostname first and use strsep().
-		sscanf(munge_payload+1, "%lu %d %s",
-		       &job_id, &chaperone_status, chaperone_hostname);
-		lpjs_debug("%s(): job_id = %lu status = %d  hostname = %s\n",
-			 __FUNCTION__, job_id, chaperone_status,
-			 chaperone_hostname);
-		
-		// Errors that occur before exec()ing script
-		if ( chaperone_status == LPJS_CHAPERONE_SCRIPT_FAILED )
-		{
-		    lpjs_log("%s(): Error: Job script failed to start: %d\n",
-			    __FUNCTION__, chaperone_status);
-		    // Don't try to restart a script that failed
-		    // Either the user needs to fix it, or something
-		    // is not installed properly
-		    adjust_resources(node_list, pending_jobs, hostname, job_id, NODE_RESOURCE_RELEASE);
-		    lpjs_remove_pending_job(pending_jobs, job_id);
-		}
-		else if ( (chaperone_status == LPJS_CHAPERONE_OSERR) ||
-			  (chaperone_status == LPJS_CHAPERONE_EXEC_FAILED) )
-		{
-		    lpjs_log("%s(): Error: OS error or failed exec() detected on %s.\n",
-			    __FUNCTION__, chaperone_hostname);
-		    
-		    lpjs_log("%s(): Releasing resourcesfor job %lu...\n",
-			     __FUNCTION__, job_id);
-		    adjust_resources(node_list, pending_jobs, hostname,
-				     job_id, NODE_RESOURCE_RELEASE);
-
-		    // FIXME: Node should not come back up from here when daemons
-		    // are restarted.  It should require "lpjs nodes up nodename"
-		    // node_set_state(node, "malfunction");
-		    lpjs_log("%s(): Setting %s state to down...\n",
-			     __FUNCTION__, chaperone_hostname);
-		    node = node_list_find_hostname(node_list, chaperone_hostname);
-		    if ( node == NULL )
-			lpjs_log("%s(): Bug: No such node in list.\n",
-				 __FUNCTION__);
-		    else
-			node_set_state(node, "down");
-		    lpjs_debug("%s(): Done.\n");
-		    // FIXME: Make sure job state is reset, but don't remove
-		}
-		else if ( chaperone_status == LPJS_CHAPERONE_OK )
-		{
-		    lpjs_log("%s(): Chaperone status OK.\n",__FUNCTION__);
-		    // FIXME: Anything to do here?
-		}
-		else
-		{
-		    lpjs_log("%s(): Error: Unknown chaperone_status for job %lu: %d\n",
-			     __FUNCTION__, job_id, chaperone_status);
-		}
-		break;
+    adjust_resources(node_list, running_jobs, hostname, job_id, NODE_RESOURCE_RELEASE);
 
-	    case    LPJS_DISPATCHD_REQUEST_JOB_STARTED:
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_STARTED:\n",
-			__FUNCTION__);
-		lpjs_send_munge(msg_fd, "Node authorized",
-				lpjs_wait_close);
-		// lpjs_debug("%s(): Auth sent.\n", __FUNCTION__);
-
-		// This is a temporary connection from the chaperone
-		// for just this message.  Don't keep it open.
-		// Don't sent EOT, but wait for other end to close
-		lpjs_wait_close(msg_fd);
-		
-		/*
-		 *  No change in node status, don't try to dispatch jobs.
-		 *  Resources were allocated at dispatch time.
-		 */
-		
-		// Job compute node and PIDs are in text form following
-		// the one byte LPJS_DISPATCHD_REQUEST_JOB_STARTED
-		lpjs_update_job(node_list, munge_payload + 1, pending_jobs, running_jobs);
-		break;
-		
-	    case    LPJS_DISPATCHD_REQUEST_JOB_COMPLETE:
-		// This is a temporary connection from the chaperone
-		// for just this message.  Don't keep it open.
-		// Don't sent EOT, but wait for other end to close
-		lpjs_wait_close(msg_fd);
-
-		lpjs_log("%s(): LPJS_DISPATCHD_REQUEST_JOB_COMPLETE\n",
-			__FUNCTION__);
-		p = munge_payload + 1;
-		hostname = strsep(&p, " ");
-		lpjs_debug("%s(): hostname = %s ", __FUNCTION__, hostname);
-		node = node_list_find_hostname(node_list, hostname);
-		if ( node == NULL )
-		{
-		    lpjs_log("%s(): Error: Invalid hostname in job completion report.\n",
-			    __FUNCTION__);
-		    break;
-		}
-		if ( (items = sscanf(p, "%lu %d", &job_id,
-				     &exit_status)) != 2 )
-		{
-		    lpjs_log("%s(): Error: Got %d items reading job_id, procs, mem, status.\n",
-			    items);
-		    break;
-		}
-		lpjs_debug("%s(): job_id = %lu  status = %d\n",
-		    __FUNCTION__, job_id, exit_status);
-		
-		adjust_resources(node_list, running_jobs, hostname, job_id, NODE_RESOURCE_RELEASE);
-		
-		/*
-		 *  FIXME:
-		 *      Write a completed job record to accounting log
-		 *      Note the job completion in the main log
-		 */
-		// lpjs_log_job();
-		
-		if ( (job = lpjs_remove_running_job(running_jobs,
-						    job_id)) != NULL )
-		    job_free(&job);
-		else
-		    lpjs_log("%s(): Error: remove_running_job returned NULL.  This is a bug.\n",
-			    __FUNCTION__);
-		
-		lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
-		break;
-		
-	    default:
-		lpjs_log("%s(): Error: Invalid request code byte on listen_fd: %d\n",
-			__FUNCTION__, munge_payload[0]);
-		
-	}   // switch
-	free(munge_payload);
+    if ( (job = lpjs_remove_running_job(running_jobs,
+					job_id)) != NULL )
+    {
+	// Telemetry may have seen a higher peak than the compute node's
+	// samples, or the only one, if it sent no usage
+	if ( usage.peak_rss_MiB > job_get_peak_rss_MiB(job) )
+	    job_set_peak_rss_MiB(job, usage.peak_rss_MiB);
+	if ( usage.cpu_sec > job_get_cpu_sec(job) )
+	    job_set_cpu_sec(job, usage.cpu_sec);
+	job_set_read_bytes(job, usage.read_bytes);
+	job_set_write_bytes(job, usage.write_bytes);
+	job_set_peak_threads(job, usage.peak_threads);
+	lpjs_log_job(job, ACCOUNTING_COMPLETED, exit_status);
+	job_free(&job);
     }
-    
-    return bytes;
+    else
+	lpjs_log("%s(): Error: remove_running_job returned NULL.  This is a bug.\n",
+		__FUNCTION__);
+
+    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
 }
 
 
@@ -801,15 +1586,26 @@ int     lpjs_check_listen_fd(int listen_fd, fd_set *read_fds,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Reconcile with chaperone inventory
+ *  2026-10-19  Jason Bacon Pace checkins with retry-after replies
+ *  2026-10-19  Jason Bacon Resume unreachable nodes, drop stale connections
  ***************************************************************************/
 
 void    lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg,
 					  node_list_t *node_list,
+					  job_list_t *pending_jobs,
+					  job_list_t *running_jobs,
 					  uid_t munge_uid, gid_t munge_gid)
 
 {
     // Terminates process if malloc() fails, no check required
-    node_t      *new_node = node_new();
+    node_t      *new_node = node_new(),
+		*node;
+    inventory_t *inventory;
+    const char  *inventory_str;
+    char        retry_msg[sizeof(LPJS_RETRY_AFTER_MSG) + 16];
+    unsigned    delay;
+    pool_task_t *reply;
     extern FILE *Log_stream;
     
     // FIXME: Check for duplicate checkins.  We should not get
@@ -833,7 +1629,7 @@ void    lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg,
     // +1 to skip command code
     node_str_to_specs(new_node, incoming_msg + 1);
     
-    // Keep in sync with node_list_send_status()
+    // Keep in sync with node_list_reply_status()
     node_print_status_header(Log_stream);
     node_print_status(new_node, Log_stream);
     
@@ -856,15 +1652,220 @@ void    lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg,
 		__FUNCTION__, node_get_hostname(new_node));
 	lpjs_dispatchd_safe_close(msg_fd);
     }
+    else if ( (delay = lpjs_pace_checkin(node_get_hostname(new_node))) > 0 )
+    {
+	// Too many nodes checking in at once, see pace.c
+	lpjs_log("%s(): %s to retry after %u ms.\n", __FUNCTION__,
+		 node_get_hostname(new_node), delay);
+	snprintf(retry_msg, sizeof(retry_msg), LPJS_RETRY_AFTER_MSG "%u",
+		 delay);
+	reply = lpjs_reply_new(msg_fd, LPJS_REPLY_WAIT);
+	lpjs_reply_add(reply, retry_msg);
+	lpjs_reply_send(reply);
+    }
     else
     {
 	lpjs_send_munge(msg_fd, "Node authorized", lpjs_dispatchd_safe_close);
 	node_set_msg_fd(new_node, msg_fd);
 	
+	/*
+	 *  An unreachable node still has its jobs and resources, and
+	 *  picks up where it left off.  If we never noticed that the
+	 *  old connection was lost, compd has given up on it.
+	 */
+	node = node_list_find_hostname(node_list, node_get_hostname(new_node));
+	if ( (node != NULL) &&
+	     (strcmp(node_get_state(node), "unreachable") == 0) )
+	    lpjs_log("%s(): %s is back after %ld seconds.  Resuming...\n",
+		     __FUNCTION__, node_get_hostname(node),
+		     (long)(time(NULL) - node_get_last_ping(node)));
+	else if ( (node != NULL) &&
+		  (node_get_msg_fd(node) != NODE_MSG_FD_NOT_OPEN) )
+	{
+	    lpjs_log("%s(): Closing stale connection %d to %s.\n",
+		     __FUNCTION__, node_get_msg_fd(node),
+		     node_get_hostname(node));
+	    close(node_get_msg_fd(node));
+	}
+	
 	// Nodes were added to node_list by lpjs_load_config()
 	// Just update the fields here
 	node_list_update_compute(node_list, new_node);
+	
+	/*
+	 *  Live chaperones follow the specs.  Compute nodes running
+	 *  older versions don't send them, in which case the job lists
+	 *  are left as they are.
+	 */
+	node = node_list_find_hostname(node_list, node_get_hostname(new_node));
+	if ( (node != NULL) &&
+	     ((inventory_str = strchr(incoming_msg + 1, '\n')) != NULL) )
+	{
+	    // Terminates process if malloc() fails, no check required
+	    inventory = inventory_new();
+	    if ( inventory_from_str(inventory, inventory_str + 1) < 0 )
+		lpjs_log("%s(): Error: No valid chaperone inventory from %s.\n",
+			 __FUNCTION__, node_get_hostname(node));
+	    else
+		lpjs_reconcile_node(node, inventory, pending_jobs,
+				    running_jobs, node_list);
+	    free(inventory->entries);
+	    free(inventory);
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Reconcile the job lists and node usage with the live chaperones
+ *      reported by a compute node at checkin.  After a dispatchd
+ *      restart, this corrects the restored state for jobs that
+ *      finished, failed, or started while dispatchd was down.
+ *
+ *      Running jobs on the node with no live chaperone are removed,
+ *      since the chaperone would still be alive if it had a report
+ *      left to send.  Dispatched jobs with no live chaperone are
+ *      returned to the queue.  Queued jobs with a live chaperone are
+ *      moved to the running list.  Node usage is recomputed from the
+ *      inventory, including any chaperones for unknown jobs, since
+ *      they are using the resources whether we know about them or not.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Forget unused requests of jobs
+ ***************************************************************************/
+
+void    lpjs_reconcile_node(node_t *node, inventory_t *inventory,
+			    job_list_t *pending_jobs, job_list_t *running_jobs,
+			    node_list_t *node_list)
+
+{
+    char                *hostname = node_get_hostname(node);
+    size_t              c, index;
+    job_t               *job;
+    inventory_entry_t   *entry;
+    unsigned            lost = 0,
+			requeued = 0,
+			adopted = 0,
+			unknown = 0;
+    
+    for (c = 0; c < job_list_get_count(running_jobs); )
+    {
+	job = job_list_get_jobs_ae(running_jobs, c);
+	if ( (strcmp(job_get_compute_node(job), hostname) == 0) &&
+	     (inventory_find(inventory, job_get_job_id(job)) == INVENTORY_NOT_FOUND) )
+	{
+	    lpjs_log("%s(): Job %lu is no longer running on %s.  Removing...\n",
+		     __FUNCTION__, job_get_job_id(job), hostname);
+	    // Does not advance c
+	    lpjs_remove_running_job(running_jobs, job_get_job_id(job));
+	    lpjs_log_job(job, ACCOUNTING_LOST, 0);
+	    job_free(&job);
+	    ++lost;
+	}
+	else
+	    ++c;
+    }
+    
+    for (c = 0; c < job_list_get_count(pending_jobs); )
+    {
+	job = job_list_get_jobs_ae(pending_jobs, c);
+	if ( (job_get_state(job) != JOB_STATE_PENDING) &&
+	     (strcmp(job_get_compute_node(job), hostname) == 0) &&
+	     (inventory_find(inventory, job_get_job_id(job)) == INVENTORY_NOT_FOUND) )
+	{
+	    if ( job_get_state(job) == JOB_STATE_CANCELED )
+	    {
+		lpjs_log("%s(): Canceled job %lu never started on %s.  Removing...\n",
+			 __FUNCTION__, job_get_job_id(job), hostname);
+		lpjs_remove_pending_job(pending_jobs, job_get_job_id(job));
+		lpjs_log_job(job, ACCOUNTING_CANCELED, 0);
+		job_free(&job);
+		continue;
+	    }
+	    lpjs_log("%s(): Job %lu never started on %s.  Requeuing...\n",
+		     __FUNCTION__, job_get_job_id(job), hostname);
+	    job_set_state(job, JOB_STATE_PENDING);
+	    free(job_get_compute_node(job));
+	    job_set_compute_node(job, strdup("TBD"));
+	    // DISPATCH records carry the updated specs of a queued job
+	    lpjs_journal_append(LPJS_JOURNAL_DISPATCH, job);
+	    ++requeued;
+	}
+	++c;
+    }
+    
+    node_set_procs_used(node, 0);
+    node_set_phys_MiB_used(node, 0);
+    lpjs_telemetry_release_all(node);
+    for (c = 0; c < inventory->count; ++c)
+    {
+	entry = &inventory->entries[c];
+	if ( (index = job_list_find_job_id(running_jobs, entry->job_id))
+		!= JOB_LIST_NOT_FOUND )
+	{
+	    job = job_list_get_jobs_ae(running_jobs, index);
+	    if ( strcmp(job_get_compute_node(job), hostname) != 0 )
+		lpjs_log("%s(): Error: Job %lu is running on both %s and %s.\n",
+			 __FUNCTION__, entry->job_id,
+			 job_get_compute_node(job), hostname);
+	}
+	else if ( (index = job_list_find_job_id(pending_jobs, entry->job_id))
+		    != JOB_LIST_NOT_FOUND )
+	{
+	    /*
+	     *  Started, but the start notice was lost, or is yet to come.
+	     *  lpjs_update_job() accepts a start notice for a job that is
+	     *  already running.
+	     */
+	    job = job_list_get_jobs_ae(pending_jobs, index);
+	    lpjs_log("%s(): Job %lu is running on %s.  Moving to running list...\n",
+		     __FUNCTION__, entry->job_id, hostname);
+	    free(job_get_compute_node(job));
+	    job_set_compute_node(job, strdup(hostname));
+	    job_set_chaperone_pid(job, entry->chaperone_pid);
+	    if ( entry->job_pid != 0 )
+		job_set_job_pid(job, entry->job_pid);
+	    job_list_remove_job(pending_jobs, entry->job_id);
+	    if ( job_get_state(job) == JOB_STATE_CANCELED )
+	    {
+		lpjs_log("%s(): Job %lu was canceled.  Terminating...\n",
+			 __FUNCTION__, entry->job_id);
+		lpjs_journal_append(LPJS_JOURNAL_CANCEL, job);
+		lpjs_kill_processes(node_list, job);
+		lpjs_log_job(job, ACCOUNTING_CANCELED, 0);
+		job_free(&job);
+	    }
+	    else
+	    {
+		job_set_state(job, JOB_STATE_RUNNING);
+		if ( job_get_start_time(job) == 0 )
+		    job_set_start_time(job, time(NULL));
+		job_list_add_job(running_jobs, job);
+		lpjs_journal_append(LPJS_JOURNAL_START, job);
+	    }
+	    ++adopted;
+	}
+	else
+	{
+	    lpjs_log("%s(): Warning: Unknown job %lu on %s, chaperone PID %d.\n",
+		     __FUNCTION__, entry->job_id, hostname,
+		     entry->chaperone_pid);
+	    ++unknown;
+	}
+	
+	// Chaperones for canceled and unknown jobs hold resources until they exit
+	node_set_procs_used(node, node_get_procs_used(node) + entry->procs);
+	node_set_phys_MiB_used(node, node_get_phys_MiB_used(node) +
+			       entry->procs * entry->pmem_per_proc);
     }
+    
+    lpjs_log("%s(): %s: %zu chaperones, %u lost, %u requeued, %u adopted, %u unknown.  Using %u procs, %lu MiB.\n",
+	     __FUNCTION__, hostname, inventory->count, lost, requeued,
+	     adopted, unknown, node_get_procs_used(node),
+	     node_get_phys_MiB_used(node));
 }
 
 
@@ -875,6 +1876,8 @@ void    lpjs_process_compute_node_checkin(int msg_fd, const char *incoming_msg,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Hold reply for the journal commit in
+ *                          lpjs_process_events()
  ***************************************************************************/
 
 int     lpjs_submit(int msg_fd, const char *incoming_msg,
@@ -884,12 +1887,15 @@ int     lpjs_submit(int msg_fd, const char *incoming_msg,
 
 {
     char        script_path[PATH_MAX + 1],
+		outgoing_msg[LPJS_MSG_LEN_MAX + 1],
 		*end,
 		*script_text;
     // Terminates process if malloc() fails, no check required
     job_t       *submission = job_new(),
 		*job;
-    int         c, job_array_index;
+    int         c;
+    unsigned long   first_job_id, last_job_id;
+    pool_task_t *reply;
     
     // Payload from lpjs submit is a job description in JOB_SPEC_FORMAT
     job_read_from_string(submission, incoming_msg + 1, &end);
@@ -898,8 +1904,9 @@ int     lpjs_submit(int msg_fd, const char *incoming_msg,
     {
 	lpjs_log("%s(): Error: Rejecting job submission from root.\n",
 		__FUNCTION__);
-	// msg_fd is closed below
-	lpjs_send_munge(msg_fd, "Error: Cannot run jobs as root.\n", lpjs_no_close);
+	reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	lpjs_reply_add(reply, "Error: Cannot run jobs as root.\n");
+	lpjs_reply_send(reply);
     }
     else
     {
@@ -908,21 +1915,55 @@ int     lpjs_submit(int msg_fd, const char *incoming_msg,
 	
 	snprintf(script_path, PATH_MAX + 1, "%s/%s",
 		 job_get_submit_dir(submission), job_get_script_name(submission));
-	for (c = 0; c < job_get_job_count(submission); ++c)
+	lpjs_log("%s(): Submit script %s:%s from %d, %d\n", __FUNCTION__,
+		job_get_submit_node(submission), script_path, munge_uid,
+		munge_gid);
+	
+	/*
+	 *  Store the script once for the whole array, then journal the
+	 *  jobs.  The reply is held until the journal is synced, once for
+	 *  all requests in this pass of lpjs_process_events().
+	 */
+	first_job_id = lpjs_journal_reserve_job_ids(job_get_job_count(submission));
+	last_job_id = first_job_id + job_get_job_count(submission) - 1;
+	if ( lpjs_spool_script(first_job_id, script_text) != LPJS_SUCCESS )
 	{
-	    lpjs_log("%s(): Submit script %s:%s from %d, %d\n", __FUNCTION__,
-		    job_get_submit_node(submission), script_path, munge_uid,
-		    munge_gid);
-	    job_array_index = c + 1;    // Job arrays are 1-based
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	    lpjs_reply_add(reply, "Error: Failed to spool script.\n");
+	    lpjs_reply_send(reply);
+	}
+	else
+	{
+	    job_set_submit_time(submission, time(NULL));
+	    job_stamp(submission, JOB_TIMING_SUBMITTED);
+	    for (c = 0; c < job_get_job_count(submission); ++c)
+	    {
+		// Create a separate job_t object for each member of the job array
+		// job_dup() terminates process if malloc() fails
+		job = job_dup(submission);
+		// Job arrays are 1-based
+		lpjs_queue_job(pending_jobs, job, first_job_id + c, c + 1);
+	    }
+	    
+	    if ( first_job_id == last_job_id )
+		snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
+			 "Spooled job %lu.\n", first_job_id);
+	    else
+		snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
+			 "Spooled jobs %lu through %lu.\n",
+			 first_job_id, last_job_id);
+	    lpjs_log("%s(): %s", __FUNCTION__, outgoing_msg);
 	    
-	    // Create a separate job_t object for each member of the job array
-	    // job_dup() terminates process if malloc() fails
-	    job = job_dup(submission);
-	    lpjs_queue_job(msg_fd, pending_jobs, job, job_array_index, script_text);
+	    // Back to submit command for terminal output
+	    reply = lpjs_reply_new(msg_fd, LPJS_REPLY_EOT);
+	    lpjs_reply_add(reply, outgoing_msg);
+	    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1,
+		     "Error: Failed to commit jobs %lu through %lu to the journal.  They were not queued.\n",
+		     first_job_id, last_job_id);
+	    lpjs_reply_hold(reply, outgoing_msg);
 	}
     }
     
-    lpjs_dispatchd_safe_close(msg_fd);
     job_free(&submission);
     
     return EX_OK;
@@ -939,6 +1980,7 @@ int     lpjs_submit(int msg_fd, const char *incoming_msg,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-22  Jason Bacon Factor out from lpjs_process_events()
+ *  2026-10-19  Jason Bacon Send EOT from a worker thread
  ***************************************************************************/
 
 int     lpjs_cancel(int msg_fd, const char *incoming_msg,
@@ -958,6 +2000,7 @@ int     lpjs_cancel(int msg_fd, const char *incoming_msg,
     {
 	lpjs_log("%s(): Bug: Malformed job_id: '%s'\n",
 		__FUNCTION__, incoming_msg);
+	lpjs_reply_send(lpjs_reply_new(msg_fd, LPJS_REPLY_EOT));
 	return -1;
     }
     
@@ -977,8 +2020,9 @@ int     lpjs_cancel(int msg_fd, const char *incoming_msg,
 	    else
 	    {
 		lpjs_remove_pending_job(pending_jobs, job_id);
-		job_free(&job);
 		lpjs_log("%s(): Canceled pending job %lu...\n", __FUNCTION__, job_id);
+		lpjs_log_job(job, ACCOUNTING_CANCELED, 0);
+		job_free(&job);
 	    }
 	}
 	else
@@ -989,12 +2033,13 @@ int     lpjs_cancel(int msg_fd, const char *incoming_msg,
     {
 	lpjs_log("%s(): Canceled running job %lu...\n", __FUNCTION__, job_id);
 	lpjs_kill_processes(node_list, job);
+	lpjs_log_job(job, ACCOUNTING_CANCELED, 0);
 	job_free(&job);
     }
     else
 	lpjs_log("%s(): Error: No such active job ID: %lu.\n", __FUNCTION__, job_id);
 	
-    lpjs_dispatchd_safe_close(msg_fd);
+    lpjs_reply_send(lpjs_reply_new(msg_fd, LPJS_REPLY_EOT));
     
     return LPJS_SUCCESS;
 }
@@ -1010,6 +2055,7 @@ int     lpjs_cancel(int msg_fd, const char *incoming_msg,
  *  History: 
  *  Date        Name        Modification
  *  2024-05-08  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Send without a verification reply
  ***************************************************************************/
 
 int     lpjs_kill_processes(node_list_t *node_list, job_t *job)
@@ -1062,8 +2108,8 @@ int     lpjs_kill_processes(node_list_t *node_list, job_t *job)
 
     snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%u",
 	    LPJS_COMPD_REQUEST_CANCEL, chaperone_pid);
-    if ( lpjs_send_munge(compute_node_fd, outgoing_msg,
-			 lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
+    if ( lpjs_send_node_munge(compute_node_fd, outgoing_msg,
+			      lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
     {
 	lpjs_log("%s(): Error: Failed to send cancel request.\n", __FUNCTION__);
 	return 0;
@@ -1075,132 +2121,106 @@ int     lpjs_kill_processes(node_list_t *node_list, job_t *job)
 
 /***************************************************************************
  *  Description:
- *      Add a job to the queue
- *
- *  Returns:
- *      LPJS_SUCCESS on success
+ *      Commit the journal records of one event loop pass, and send the
+ *      replies held for them.  Jobs submitted in the pass are not
+ *      dispatched until committed (see lpjs_select_next_job()), so if
+ *      the commit fails they can be removed from the queue, and their
+ *      submitters told so, rather than run after a failure reply.
+ *      Otherwise they are dispatched now.
  *
  *  History: 
  *  Date        Name        Modification
- *  2021-09-30  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Begin
  ***************************************************************************/
 
-int     lpjs_queue_job(int msg_fd, job_list_t *pending_jobs, job_t *job,
-		       unsigned long job_array_index, const char *script_text)
+void    lpjs_commit_pass(node_list_t *node_list, job_list_t *pending_jobs,
+			 job_list_t *running_jobs)
 
 {
-    char    pending_dir[PATH_MAX + 1],
-	    script_path[PATH_MAX + 2],
-	    specs_path[PATH_MAX + 11],
-	    job_id_path[PATH_MAX + 1],
-	    job_id_buff[LPJS_MAX_INT_DIGITS + 1],
-	    outgoing_msg[LPJS_MSG_LEN_MAX + 1];
-    int     fd;
-    ssize_t bytes;
-    unsigned long   next_job_id;
-    FILE    *fp;
-    
-    lpjs_log("%s(): Spooling %s...\n", __FUNCTION__, job_get_script_name(job));
+    bool    submitted = (lpjs_journal_uncommitted_job_id() != 0);
     
-    snprintf(job_id_path, PATH_MAX + 1, "%s/next-job", LPJS_SPOOL_DIR);
-    if ( (fd = open(job_id_path, O_RDONLY)) == -1 )
-	next_job_id = 1;
+    lpjs_journal_checkpoint(pending_jobs, running_jobs, node_list);
+    // Compaction may fail after the snapshot holds the new jobs
+    if ( lpjs_journal_uncommitted_job_id() != 0 )
+    {
+	lpjs_drop_uncommitted(pending_jobs);
+	lpjs_reply_release(false);
+    }
     else
     {
-	bytes = read(fd, job_id_buff, LPJS_MAX_INT_DIGITS + 1);
-	if ( bytes == -1 )
+	lpjs_reply_release(true);
+	if ( submitted )
 	{
-	    lpjs_log("%s(): Error: Can't read %s: %s\n",
-		    __FUNCTION__, job_id_path, strerror(errno));
-	    exit(EX_DATAERR);
+	    lpjs_dispatch_jobs(node_list, pending_jobs, running_jobs);
+	    // As for jobs dispatched by event handlers, before the next pass
+	    lpjs_journal_commit();
 	}
-	sscanf(job_id_buff, "%lu", &next_job_id);
-	close(fd);
-    }
-    
-    job_set_job_id(job, next_job_id);
-    job_set_array_index(job, job_array_index);
-    
-    snprintf(pending_dir, PATH_MAX + 1, "%s/%lu", LPJS_PENDING_DIR,
-	    next_job_id);
-    if ( xt_rmkdir(pending_dir, 0755) != 0 )
-    {
-	fprintf(stderr, "Cannot create %s: %s\n", pending_dir, strerror(errno));
-	return LPJS_WRITE_FAILED;
     }
+}
 
-    snprintf(script_path, PATH_MAX + 2, "%s/%s", pending_dir,
-	    xt_basename(job_get_script_name(job)));
-    
-    if ( (fd = open(script_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
-    {
-	lpjs_log("%s(): Error: Failed to copy %s to %s: %s\n", __FUNCTION__,
-		job_get_script_name(job), script_path, strerror(errno));
-	return LPJS_WRITE_FAILED;
-    }
-    
-    if ( write(fd, script_text, strlen(script_text)) == -1 )
-    {
-	lpjs_log("%s(): Error: write() failed for %s: %s\n", __FUNCTION__,
-		script_path, strerror(errno));
-	close(fd);
-	return LPJS_WRITE_FAILED;
-    }
-    close(fd);
-    
-    /*
-     *  Write basic job specs to a file for the dispatcher
-     */
-    
-    snprintf(specs_path, PATH_MAX + 11, "%s/job.specs", pending_dir);
-    // FIXME: Switch to low-level I/O?
-    if ( (fp = fopen(specs_path, "w")) == NULL )
-    {
-	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
-		specs_path, strerror(errno));
-	return LPJS_WRITE_FAILED;
-    }
-    if ( job_print_full_specs(job, fp) < 0 )
-    {
-	lpjs_log("%s(): Error: write() failed for %s: %s\n", __FUNCTION__,
-		specs_path, strerror(errno));
-	fclose(fp);
-	return LPJS_WRITE_FAILED;
-    }
-    fclose(fp);
-    
-    // Back to submit command for terminal output
-    snprintf(outgoing_msg, LPJS_MSG_LEN_MAX, "Spooled job %lu to %s.\n",
-	    next_job_id, pending_dir);
-    if ( lpjs_send_munge(msg_fd, outgoing_msg,
-			 lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
-    {
-	lpjs_log("%s(): Error: Failed to send response.\n", __FUNCTION__);
-	// FIXME: Should we continue?
-    }
-    
-    // FIXME: Log job queue event to the job log
-    // lpjs_log_job()
+
+/***************************************************************************
+ *  Description:
+ *      Remove jobs whose submission could not be committed to the
+ *      journal, and their SUBMIT records from the journal buffer.
+ *      They were never dispatched, so no other records refer to
+ *      them.  Their scripts are removed by the next compaction.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_drop_uncommitted(job_list_t *pending_jobs)
+
+{
+    unsigned long   first_job_id = lpjs_journal_uncommitted_job_id(),
+		    job_id;
+    size_t          c,
+		    removed = 0;
+    job_t           *job;
     
-    // Bump job num after successful spool
-    if ( (fd = open(job_id_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
-    {
-	lpjs_log("%s(): Error: Cannot update %s: %s\n", __FUNCTION__,
-		job_id_path, strerror(errno));
-	return LPJS_WRITE_FAILED;
-    }
-    else
+    // Newest last, so removing from the end moves little
+    for (c = job_list_get_count(pending_jobs); c-- > 0; )
     {
-	if ( xt_dprintf(fd, "%lu\n", ++next_job_id) < 0 )
+	job_id = job_get_job_id(job_list_get_jobs_ae(pending_jobs, c));
+	if ( (job_id >= first_job_id) &&
+	     ((job = job_list_remove_job(pending_jobs, job_id)) != NULL) )
 	{
-	    lpjs_log("%s(): Error: write() failed for %job_id_path: %s\n", __FUNCTION__,
-		    script_path, strerror(errno));
-	    close(fd);
-	    return LPJS_WRITE_FAILED;
+	    job_free(&job);
+	    ++removed;
 	}
-	close(fd);
     }
+    lpjs_log("%s(): Error: Removed %zu jobs from %lu on, not committed.\n",
+	     __FUNCTION__, removed, first_job_id);
+    lpjs_journal_discard_uncommitted();
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a job to the queue.  The journal record is buffered, so the
+ *      caller must lpjs_journal_commit() before acknowledging the
+ *      submission.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS on success
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2021-09-30  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Journal instead of per-job spool directories
+ ***************************************************************************/
+
+int     lpjs_queue_job(job_list_t *pending_jobs, job_t *job,
+		       unsigned long job_id, unsigned long job_array_index)
+
+{
+    job_set_job_id(job, job_id);
+    job_set_array_index(job, job_array_index);
+    job_set_state(job, JOB_STATE_PENDING);
     
+    lpjs_journal_append(LPJS_JOURNAL_SUBMIT, job);
     job_list_add_job(pending_jobs, job);
     
     return LPJS_SUCCESS;
@@ -1216,6 +2236,7 @@ int     lpjs_queue_job(int msg_fd, job_list_t *pending_jobs, job_t *job,
  *  History: 
  *  Date        Name        Modification
  *  2024-05-01  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record launch stage stamps
  ***************************************************************************/
 
 int     lpjs_update_job(node_list_t *node_list, char *payload,
@@ -1223,64 +2244,67 @@ int     lpjs_update_job(node_list_t *node_list, char *payload,
 
 {
     char    *compute_node,
-	    *p,
-	    pending_job_dir[PATH_MAX + 1],
-	    running_job_dir[PATH_MAX + 1 - 10],
-	    specs_path[PATH_MAX + 1];
-    FILE    *fp;
+	    *p;
     unsigned long   job_id;
     pid_t   chaperone_pid, job_pid;
     size_t  job_list_index;
     job_t   *job;
+    intmax_t    exec_time;
     
     p = payload;
     compute_node = strsep(&p, " ");
-    sscanf(p, "%lu %u %u", &job_id, &chaperone_pid, &job_pid);
+    // Chaperones older than launch timing don't send exec_time
+    if ( sscanf(p, "%lu %u %u %jd", &job_id, &chaperone_pid, &job_pid,
+		&exec_time) != 4 )
+	exec_time = 0;
     lpjs_log("%s(): job_id = %lu  chaperone_pid = %u  job_pid = %u\n",
 	    __FUNCTION__, job_id, chaperone_pid, job_pid);
     
     job_list_index = job_list_find_job_id(pending_jobs, job_id);
     if ( job_list_index == JOB_LIST_NOT_FOUND )
-	lpjs_log("%s(): Error: Job id not found.  This is a software bug.\n",
-		__FUNCTION__);
+    {
+	// Already moved to running by lpjs_reconcile_node() after a restart
+	job_list_index = job_list_find_job_id(running_jobs, job_id);
+	if ( job_list_index == JOB_LIST_NOT_FOUND )
+	    lpjs_log("%s(): Error: Job id not found.  This is a software bug.\n",
+		    __FUNCTION__);
+	else
+	{
+	    job = job_list_get_jobs_ae(running_jobs, job_list_index);
+	    job_set_chaperone_pid(job, chaperone_pid);
+	    job_set_job_pid(job, job_pid);
+	    if ( job_get_start_time(job) == 0 )
+		job_set_start_time(job, time(NULL));
+	    if ( job_get_timing_ae(job, JOB_TIMING_STARTED) == 0 )
+	    {
+		job_set_timing_ae(job, JOB_TIMING_EXECED, exec_time);
+		job_stamp(job, JOB_TIMING_STARTED);
+	    }
+	    lpjs_journal_append(LPJS_JOURNAL_START, job);
+	}
+    }
     else
     {
-	// FIXME: Check success of all steps below
-	// Move job from pending spool dir to running
-	snprintf(pending_job_dir, PATH_MAX + 1,
-		LPJS_PENDING_DIR "/%lu", job_id);
-	snprintf(running_job_dir, PATH_MAX + 1 - 10,
-		LPJS_RUNNING_DIR "/%lu", job_id);
-	// lpjs_debug("%s(): Moving %s to %s...\n", __FUNCTION__,
-	//              pending_job_dir, running_job_dir);
-	rename(pending_job_dir, running_job_dir);
-	
 	// Add node and PID info to job object
 	job = job_list_get_jobs_ae(pending_jobs, job_list_index);
 	// lpjs_debug("%s(): Adding %s %lu %lu to job %lu\n",
 	//        __FUNCTION__, compute_node, chaperone_pid, job_pid, job_id);
+	free(job_get_compute_node(job));
 	job_set_compute_node(job, strdup(compute_node));
 	job_set_chaperone_pid(job, chaperone_pid);
 	job_set_job_pid(job, job_pid);
+	job_set_start_time(job, time(NULL));
+	job_set_timing_ae(job, JOB_TIMING_EXECED, exec_time);
+	job_stamp(job, JOB_TIMING_STARTED);
+	if ( job_get_state(job) != JOB_STATE_CANCELED )
+	    job_set_state(job, JOB_STATE_RUNNING);
 
 	// Update in-memory job lists
 	job_list_add_job(running_jobs, job);
 	job_list_remove_job(pending_jobs, job_get_job_id(job));
 	
-	// FIXME: Update specs file in running dir with node and PIDs
-	snprintf(specs_path, PATH_MAX + 1, "%s/job.specs", running_job_dir);
-	lpjs_log("%s(): Storing updated specs to %s.\n",
-		__FUNCTION__, specs_path);
-	
-	// FIXME: Switch to low-level I/O?
-	if ( (fp = fopen(specs_path, "w")) == NULL )
-	{
-	    lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
-		    specs_path, strerror(errno));
-	    return LPJS_WRITE_FAILED;
-	}
-	job_print_full_specs(job, fp);
-	fclose(fp);
+	// Record node and PIDs, committed at the end of this event loop pass
+	lpjs_journal_append(LPJS_JOURNAL_START, job);
 	
 	/*
 	 *  If job was canceled while still pending but after dispatched,
@@ -1293,6 +2317,7 @@ int     lpjs_update_job(node_list_t *node_list, char *payload,
 		    __FUNCTION__, job_id);
 	    lpjs_remove_running_job(running_jobs, job_id);
 	    lpjs_kill_processes(node_list, job);
+	    lpjs_log_job(job, ACCOUNTING_CANCELED, 0);
 	    job_free(&job);
 	}
     }
@@ -1313,17 +2338,16 @@ int     lpjs_update_job(node_list_t *node_list, char *payload,
  *  History: 
  *  Date        Name        Modification
  *  2024-05-08  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Leave node usage to checkin reconciliation
  ***************************************************************************/
 
-int     lpjs_load_job_list(job_list_t *job_list, node_list_t *node_list,
-			   char *spool_dir)
+int     lpjs_load_job_list(job_list_t *job_list, char *spool_dir)
 
 {
     DIR             *dp;
     struct dirent   *entry;
     char            specs_path[PATH_MAX + 1];
     extern FILE     *Log_stream;
-    node_t          *compute_node;
     
     lpjs_log("%s(): Reloading jobs from %s...\n", __FUNCTION__, spool_dir);
     if ( (dp = opendir(spool_dir)) == NULL )
@@ -1356,23 +2380,8 @@ int     lpjs_load_job_list(job_list_t *job_list, node_list_t *node_list,
 	    lpjs_log("%s(): Loaded job #%s\n", __FUNCTION__, entry->d_name);
 	    job_list_add_job(job_list, job);
 	    
-	    // FIXME: Update node status if job is running
-	    // This code is untested
-	    if ( strcmp(spool_dir, LPJS_RUNNING_DIR) == 0 )
-	    {
-		compute_node = node_list_find_hostname(node_list,
-						       job_get_compute_node(job));
-		node_adjust_resources(compute_node, job, NODE_RESOURCE_ALLOCATE);
-		/* Replaces...
-		node_set_procs_used(compute_node,
-				    node_get_procs_used(compute_node) +
-				    job_get_procs_per_job(job));
-		node_set_phys_MiB_used(compute_node,
-				       node_get_phys_MiB_used(compute_node) +
-				       job_get_procs_per_job(job) *
-				       job_get_pmem_per_proc(job));
-		*/
-	    }
+	    // Node usage for running jobs is set when the node checks in
+	    // and reports its live chaperones.  See lpjs_reconcile_node().
 	}
     }
     closedir(dp);
@@ -1386,24 +2395,52 @@ int     lpjs_load_job_list(job_list_t *job_list, node_list_t *node_list,
 
 /***************************************************************************
  *  Description:
- *      Gracefully shut down in the event of an interrupt signal
+ *      Request a graceful shutdown on SIGINT or SIGTERM.  The signal
+ *      may arrive in the middle of a journal append or commit, so only
+ *      set a flag and wake up the event loop, which calls
+ *      lpjs_dispatchd_terminate() between passes.
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-28  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Remove status board
+ *  2026-10-19  Jason Bacon Defer shutdown to the event loop
  ***************************************************************************/
 
 void    lpjs_dispatchd_terminate_handler(int s2)
 
+{
+    int     saved_errno = errno;
+    
+    Terminate_requested = 1;
+    if ( Terminate_pipe[1] != -1 )
+	write(Terminate_pipe[1], "", 1);
+    errno = saved_errno;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Gracefully shut down after an interrupt signal: commit the
+ *      journal and close connections to compute nodes.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Split from lpjs_dispatchd_terminate_handler()
+ ***************************************************************************/
+
+void    lpjs_dispatchd_terminate(node_list_t *node_list)
+
 {
     node_t  *node;
     int     c;
-    extern node_list_t *Node_list;
     
     lpjs_log("%s(): Received signal, shutting down...\n", __FUNCTION__);
-    for (c = 0; c < node_list_get_compute_node_count(Node_list); ++c)
+    lpjs_journal_commit();
+    lpjs_board_remove();
+    for (c = 0; c < node_list_get_compute_node_count(node_list); ++c)
     {
-	node = node_list_get_compute_nodes_ae(Node_list, c);
+	node = node_list_get_compute_nodes_ae(node_list, c);
 	if ( node_get_msg_fd(node) != -1 )
 	{
 	    lpjs_log("%s(): Closing connection with %s...\n",
@@ -1440,6 +2477,7 @@ void    lpjs_dispatchd_sigpipe(int s2)
  *  History: 
  *  Date        Name        Modification
  *  2024-12-08  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Release unused request for oversubscribe
  ***************************************************************************/
 
 int     adjust_resources(node_list_t *node_list, job_list_t *job_list,
@@ -1464,6 +2502,8 @@ int     adjust_resources(node_list_t *node_list, job_list_t *job_list,
     }
     job = job_list_get_jobs_ae(job_list, job_index);
     node_adjust_resources(node, job, direction);
+    if ( direction == NODE_RESOURCE_RELEASE )
+	lpjs_telemetry_release(node, job);
     
     return 0;   // FIXME: Define return codes
 }
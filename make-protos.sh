@@ -2,7 +2,11 @@
 
 for file in lpjs_dispatchd.c lpjs_compd.c config.c network.c misc.c \
 	    scheduler.c job.c job-list.c node.c node-pseudo.c node-list.c \
-	    realpath.c chaperone.c cancel.c nodes.c; do
+	    realpath.c chaperone.c cancel.c nodes.c jobs.c journal.c \
+	    cleanup.c snapshot.c inventory.c logger.c accounting.c \
+	    history.c metrics.c loadgen.c auth.c sha256.c bench.c trace.c \
+	    pool.c board.c supervisor.c rlimit.c relay.c pace.c heartbeat.c \
+	    proctree.c telemetry.c cgroup.c job-usage.c; do
     proto_file=${file%.c}-protos.h
     echo $file $proto_file
     # User's pkgsrc before system
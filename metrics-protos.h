@@ -0,0 +1,17 @@
+/* metrics.c */
+void lpjs_metrics_init(void);
+void lpjs_histogram_add(lpjs_histogram_t *histogram, uint64_t us);
+uint64_t lpjs_metrics_elapsed_us(const struct timespec *start);
+void lpjs_metrics_observe(lpjs_metric_t metric, const struct timespec *start);
+void lpjs_metrics_observe_request(int request, const struct timespec *start);
+void lpjs_metrics_count_dispatch(void);
+double lpjs_metrics_dispatch_rate(void);
+void lpjs_metrics_set_queue_depth(unsigned long pending_jobs, unsigned long running_jobs);
+void lpjs_metrics_printf(char *buff, size_t buff_size, size_t *len, const char *format, ...);
+uint64_t lpjs_histogram_quantile(const lpjs_histogram_t *histogram, double quantile);
+void lpjs_histogram_summary(const lpjs_histogram_t *histogram, const char *prefix, const char *name, char *buff, size_t buff_size, size_t *len);
+void lpjs_histogram_prometheus(const lpjs_histogram_t *histogram, const char *name, const char *label, char *buff, size_t buff_size, size_t *len);
+size_t lpjs_metrics_format(char *buff, size_t buff_size, int format);
+void lpjs_metrics_reply(pool_task_t *reply, int format);
+struct timeval *lpjs_metrics_dump_timeout(struct timeval *timeout);
+int lpjs_metrics_dump_if_due(void);
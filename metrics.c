@@ -0,0 +1,579 @@
+/***************************************************************************
+ *  Description:
+ *      Dispatchd performance metrics.  Recording is a few integer
+ *      updates, so it is cheap enough to leave on in production.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>     // PATH_MAX
+
+#include "lpjs.h"
+#include "network.h"
+#include "config.h"
+#include "misc.h"
+#include "metrics.h"
+
+static lpjs_histogram_t Histograms[LPJS_METRIC_COUNT];
+// Indexed by request code, 0 for unreadable or invalid requests
+static lpjs_histogram_t Request_histograms[LPJS_DISPATCHD_REQUEST_END];
+static uint64_t         Dispatches;
+static uint64_t         Rate_counts[LPJS_METRICS_RATE_SECONDS];
+static time_t           Rate_times[LPJS_METRICS_RATE_SECONDS];
+static unsigned long    Pending_jobs, Running_jobs;
+static time_t           Start_time, Next_dump;
+
+static const uint64_t   Bucket_bounds[LPJS_METRICS_BUCKETS] =
+			    LPJS_METRICS_BUCKET_BOUNDS;
+
+static const char       *Metric_names[LPJS_METRIC_COUNT] =
+{
+    [LPJS_METRIC_EVENT_LOOP] = "event_loop",
+    [LPJS_METRIC_SCHEDULE] = "schedule_pass",
+    [LPJS_METRIC_AUTH_ENCODE] = "auth_encode",
+    [LPJS_METRIC_AUTH_DECODE] = "auth_decode",
+    [LPJS_METRIC_SPOOL_WRITE] = "spool_write",
+    [LPJS_METRIC_SNAPSHOT_WRITE] = "snapshot_write",
+    [LPJS_METRIC_BOARD_PUBLISH] = "board_publish"
+};
+
+static const char       *Request_names[LPJS_DISPATCHD_REQUEST_END] =
+{
+    [0] = "invalid",
+    [LPJS_DISPATCHD_REQUEST_COMPD_CHECKIN] = "compd_checkin",
+    [LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS] = "chaperone_status",
+    [LPJS_DISPATCHD_REQUEST_JOB_STARTED] = "job_started",
+    [LPJS_DISPATCHD_REQUEST_JOB_COMPLETE] = "job_complete",
+    [LPJS_DISPATCHD_REQUEST_NODE_LIST] = "node_list",
+    [LPJS_DISPATCHD_REQUEST_JOB_LIST] = "job_list",
+    [LPJS_DISPATCHD_REQUEST_SUBMIT] = "submit",
+    [LPJS_DISPATCHD_REQUEST_CANCEL] = "cancel",
+    [LPJS_DISPATCHD_REQUEST_PAUSE] = "pause",
+    [LPJS_DISPATCHD_REQUEST_RESUME] = "resume",
+    [LPJS_DISPATCHD_REQUEST_STATS] = "stats",
+    [LPJS_DISPATCHD_REQUEST_JOB_REPORTS] = "job_reports"
+};
+
+/***************************************************************************
+ *  Description:
+ *      Start the clock for uptime and dispatch rate, and schedule the
+ *      first metrics dump if a metrics-file is configured
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_init(void)
+
+{
+    extern lpjs_config_t    Config;
+
+    Start_time = time(NULL);
+    Next_dump = Start_time + Config.metrics_interval;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add one observation to a histogram.  Safe to call from worker
+ *      threads.  A report may see a count and sum from slightly
+ *      different moments, which does not matter for monitoring.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Atomic updates for worker threads
+ ***************************************************************************/
+
+void    lpjs_histogram_add(lpjs_histogram_t *histogram, uint64_t us)
+
+{
+    int         c;
+    uint64_t    max_us;
+
+    // Last bound is UINT64_MAX, so this always terminates
+    for (c = 0; us > Bucket_bounds[c]; ++c)
+	;
+    atomic_fetch_add_explicit(&histogram->buckets[c], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum_us, us, memory_order_relaxed);
+    max_us = atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+    while ( (us > max_us) &&
+	    ! atomic_compare_exchange_weak_explicit(&histogram->max_us,
+		    &max_us, us, memory_order_relaxed, memory_order_relaxed) )
+	;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Microseconds elapsed since start, a CLOCK_MONOTONIC reading
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t    lpjs_metrics_elapsed_us(const struct timespec *start)
+
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000 +
+	   (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record the time since start for a timed operation.  start
+ *      should be set with clock_gettime(CLOCK_MONOTONIC, &start).
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_observe(lpjs_metric_t metric, const struct timespec *start)
+
+{
+    lpjs_histogram_add(&Histograms[metric], lpjs_metrics_elapsed_us(start));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record the time since start for a request from
+ *      lpjs_check_listen_fd().  Unknown codes and failed receives
+ *      are recorded as request 0.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_observe_request(int request, const struct timespec *start)
+
+{
+    if ( (request < 0) || (request >= LPJS_DISPATCHD_REQUEST_END) )
+	request = 0;
+    lpjs_histogram_add(&Request_histograms[request],
+		       lpjs_metrics_elapsed_us(start));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count a job dispatched to a compute node.  Per-second counts
+ *      for the past LPJS_METRICS_RATE_SECONDS are kept in a ring
+ *      indexed by the time.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_count_dispatch(void)
+
+{
+    time_t  now = time(NULL);
+    int     slot = now % LPJS_METRICS_RATE_SECONDS;
+
+    ++Dispatches;
+    if ( Rate_times[slot] != now )
+    {
+	Rate_times[slot] = now;
+	Rate_counts[slot] = 0;
+    }
+    ++Rate_counts[slot];
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Average dispatches per second over the past
+ *      LPJS_METRICS_RATE_SECONDS, or since startup if sooner
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+double  lpjs_metrics_dispatch_rate(void)
+
+{
+    time_t      now = time(NULL), seconds;
+    uint64_t    dispatches = 0;
+    int         c;
+
+    for (c = 0; c < LPJS_METRICS_RATE_SECONDS; ++c)
+	if ( now - Rate_times[c] < LPJS_METRICS_RATE_SECONDS )
+	    dispatches += Rate_counts[c];
+    seconds = now - Start_time + 1;
+    if ( seconds > LPJS_METRICS_RATE_SECONDS )
+	seconds = LPJS_METRICS_RATE_SECONDS;
+    return (double)dispatches / seconds;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Update queue depth gauges
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_set_queue_depth(unsigned long pending_jobs,
+				     unsigned long running_jobs)
+
+{
+    Pending_jobs = pending_jobs;
+    Running_jobs = running_jobs;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append formatted text to buff, truncating if full
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_metrics_printf(char *buff, size_t buff_size, size_t *len,
+			    const char *format, ...)
+
+{
+    va_list ap;
+    int     bytes;
+
+    if ( *len >= buff_size - 1 )
+	return;
+    va_start(ap, format);
+    bytes = vsnprintf(buff + *len, buff_size - *len, format, ap);
+    va_end(ap);
+    if ( bytes > 0 )
+	*len = (*len + bytes < buff_size) ? *len + bytes : buff_size - 1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Estimate a quantile from histogram buckets.  Reports the upper
+ *      bound of the bucket containing it, or the max for the last.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t    lpjs_histogram_quantile(const lpjs_histogram_t *histogram,
+				    double quantile)
+
+{
+    uint64_t    rank, seen = 0;
+    int         c;
+
+    if ( histogram->count == 0 )
+	return 0;
+    rank = histogram->count * quantile + 0.5;
+    if ( rank < 1 )
+	rank = 1;
+    for (c = 0; c < LPJS_METRICS_BUCKETS - 1; ++c)
+    {
+	seen += histogram->buckets[c];
+	if ( seen >= rank )
+	    return Bucket_bounds[c] < histogram->max_us ?
+		   Bucket_bounds[c] : histogram->max_us;
+    }
+    return histogram->max_us;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format one histogram as a row of the "lpjs stats" summary
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_histogram_summary(const lpjs_histogram_t *histogram,
+			       const char *prefix, const char *name,
+			       char *buff, size_t buff_size, size_t *len)
+
+{
+    char    label[LPJS_FIELD_MAX + 1];
+
+    snprintf(label, LPJS_FIELD_MAX + 1, "%s%s", prefix, name);
+    lpjs_metrics_printf(buff, buff_size, len,
+	"%-24s %10ju %10.3f %10.3f %10.3f %10.3f\n", label,
+	(uintmax_t)histogram->count,
+	histogram->count == 0 ? 0.0 :
+	    histogram->sum_us / 1000.0 / histogram->count,
+	lpjs_histogram_quantile(histogram, 0.5) / 1000.0,
+	lpjs_histogram_quantile(histogram, 0.99) / 1000.0,
+	histogram->max_us / 1000.0);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format one histogram in Prometheus text format.  label is
+ *      empty or a label pair such as request="submit".
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_histogram_prometheus(const lpjs_histogram_t *histogram,
+				  const char *name, const char *label,
+				  char *buff, size_t buff_size, size_t *len)
+
+{
+    uint64_t    cumulative = 0;
+    const char  *sep = *label == '\0' ? "" : ",";
+    char        labels[LPJS_FIELD_MAX + 1] = "";
+    int         c;
+
+    // Prometheus expects no braces for sum and count without a label
+    if ( *label != '\0' )
+	snprintf(labels, LPJS_FIELD_MAX + 1, "{%s}", label);
+
+    for (c = 0; c < LPJS_METRICS_BUCKETS - 1; ++c)
+    {
+	cumulative += histogram->buckets[c];
+	lpjs_metrics_printf(buff, buff_size, len,
+	    "lpjs_%s_seconds_bucket{%s%sle=\"%g\"} %ju\n", name, label, sep,
+	    Bucket_bounds[c] / 1000000.0, (uintmax_t)cumulative);
+    }
+    lpjs_metrics_printf(buff, buff_size, len,
+	"lpjs_%s_seconds_bucket{%s%sle=\"+Inf\"} %ju\n"
+	"lpjs_%s_seconds_sum%s %.6f\n"
+	"lpjs_%s_seconds_count%s %ju\n",
+	name, label, sep, (uintmax_t)histogram->count,
+	name, labels, histogram->sum_us / 1000000.0,
+	name, labels, (uintmax_t)histogram->count);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format all metrics into buff, either as a human-readable summary
+ *      or in Prometheus text format.
+ *
+ *  Returns:
+ *      Length of the text in buff
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  lpjs_metrics_format(char *buff, size_t buff_size, int format)
+
+{
+    size_t  len = 0;
+    time_t  uptime = time(NULL) - Start_time;
+    char    name[LPJS_FIELD_MAX + 1],
+	    label[LPJS_FIELD_MAX + 1];
+    int     c;
+
+    *buff = '\0';
+    if ( format == LPJS_METRICS_FORMAT_PROMETHEUS )
+    {
+	lpjs_metrics_printf(buff, buff_size, &len,
+	    "# TYPE lpjs_start_time_seconds gauge\n"
+	    "lpjs_start_time_seconds %jd\n"
+	    "# TYPE lpjs_pending_jobs gauge\n"
+	    "lpjs_pending_jobs %lu\n"
+	    "# TYPE lpjs_running_jobs gauge\n"
+	    "lpjs_running_jobs %lu\n"
+	    "# TYPE lpjs_dispatches_total counter\n"
+	    "lpjs_dispatches_total %ju\n"
+	    "# HELP lpjs_dispatches_per_second Average over the past %d seconds\n"
+	    "# TYPE lpjs_dispatches_per_second gauge\n"
+	    "lpjs_dispatches_per_second %.3f\n",
+	    (intmax_t)Start_time, Pending_jobs, Running_jobs,
+	    (uintmax_t)Dispatches, LPJS_METRICS_RATE_SECONDS,
+	    lpjs_metrics_dispatch_rate());
+
+	for (c = 0; c < LPJS_METRIC_COUNT; ++c)
+	{
+	    snprintf(name, LPJS_FIELD_MAX + 1, "%s_duration", Metric_names[c]);
+	    lpjs_metrics_printf(buff, buff_size, &len,
+		"# TYPE lpjs_%s_seconds histogram\n", name);
+	    lpjs_histogram_prometheus(&Histograms[c], name, "",
+				      buff, buff_size, &len);
+	}
+
+	lpjs_metrics_printf(buff, buff_size, &len,
+	    "# TYPE lpjs_request_duration_seconds histogram\n");
+	for (c = 0; c < LPJS_DISPATCHD_REQUEST_END; ++c)
+	{
+	    if ( Request_names[c] == NULL )
+		continue;
+	    snprintf(label, LPJS_FIELD_MAX + 1, "request=\"%s\"",
+		     Request_names[c]);
+	    lpjs_histogram_prometheus(&Request_histograms[c],
+				      "request_duration", label,
+				      buff, buff_size, &len);
+	}
+    }
+    else
+    {
+	lpjs_metrics_printf(buff, buff_size, &len,
+	    "Uptime %jd-%02d:%02d:%02d  Pending %lu  Running %lu  "
+	    "Dispatched %ju (%.2f/s over %ds)\n\n",
+	    (intmax_t)(uptime / 86400), (int)(uptime % 86400 / 3600),
+	    (int)(uptime % 3600 / 60), (int)(uptime % 60),
+	    Pending_jobs, Running_jobs, (uintmax_t)Dispatches,
+	    lpjs_metrics_dispatch_rate(), LPJS_METRICS_RATE_SECONDS);
+	lpjs_metrics_printf(buff, buff_size, &len,
+	    "%-24s %10s %10s %10s %10s %10s\n", "Operation (ms)",
+	    "Count", "Mean", "p50", "p99", "Max");
+	for (c = 0; c < LPJS_METRIC_COUNT; ++c)
+	    lpjs_histogram_summary(&Histograms[c], "", Metric_names[c],
+				   buff, buff_size, &len);
+	for (c = 0; c < LPJS_DISPATCHD_REQUEST_END; ++c)
+	{
+	    // Skip request types not seen, to keep it short
+	    if ( (Request_names[c] != NULL) &&
+		 (Request_histograms[c].count > 0) )
+		lpjs_histogram_summary(&Request_histograms[c], "request ",
+				       Request_names[c], buff, buff_size, &len);
+	}
+    }
+
+    return len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add formatted metrics to a reply.  lpjs_reply_add() splits
+ *      them into messages at line boundaries.  Caller sends the reply.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ ***************************************************************************/
+
+void    lpjs_metrics_reply(pool_task_t *reply, int format)
+
+{
+    char    text[LPJS_METRICS_TEXT_MAX + 1];
+
+    lpjs_metrics_format(text, LPJS_METRICS_TEXT_MAX + 1, format);
+    lpjs_reply_add(reply, text);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Time until the next dump to Config.metrics_file, for select()
+ *
+ *  Returns:
+ *      timeout, or LPJS_NO_SELECT_TIMEOUT if no metrics-file is set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+struct timeval  *lpjs_metrics_dump_timeout(struct timeval *timeout)
+
+{
+    extern lpjs_config_t    Config;
+    time_t                  now;
+
+    if ( Config.metrics_file[0] == '\0' )
+	return LPJS_NO_SELECT_TIMEOUT;
+
+    now = time(NULL);
+    timeout->tv_sec = Next_dump > now ? Next_dump - now : 0;
+    timeout->tv_usec = 0;
+    return timeout;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write Prometheus metrics to Config.metrics_file if the dump
+ *      interval has passed.  Written to a temporary file and renamed,
+ *      so readers such as the node_exporter textfile collector never
+ *      see a partial file.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_metrics_dump_if_due(void)
+
+{
+    extern lpjs_config_t    Config;
+    char    text[LPJS_METRICS_TEXT_MAX + 1],
+	    temp_path[PATH_MAX + 1];
+    size_t  len;
+    time_t  now = time(NULL);
+    int     fd;
+
+    if ( (Config.metrics_file[0] == '\0') || (now < Next_dump) )
+	return LPJS_SUCCESS;
+    Next_dump = now + Config.metrics_interval;
+
+    len = lpjs_metrics_format(text, LPJS_METRICS_TEXT_MAX + 1,
+			      LPJS_METRICS_FORMAT_PROMETHEUS);
+    if ( snprintf(temp_path, PATH_MAX + 1, "%s.new", Config.metrics_file)
+	 > PATH_MAX )
+    {
+	lpjs_log("%s(): Error: %s is too long.\n", __FUNCTION__,
+		 Config.metrics_file);
+	return LPJS_WRITE_FAILED;
+    }
+    if ( (fd = open(temp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    if ( lpjs_write_all(fd, text, len) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	close(fd);
+	unlink(temp_path);
+	return LPJS_WRITE_FAILED;
+    }
+    close(fd);
+    if ( rename(temp_path, Config.metrics_file) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot rename %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	unlink(temp_path);
+	return LPJS_WRITE_FAILED;
+    }
+    return LPJS_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#ifndef _LPJS_METRICS_H_
+#define _LPJS_METRICS_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>       // struct timespec
+#include <sys/time.h>   // struct timeval
+
+#ifndef _LPJS_NETWORK_H_
+#include "network.h"    // LPJS_DISPATCHD_REQUEST_*
+#endif
+
+#ifndef _LPJS_POOL_H_
+#include "pool.h"       // pool_task_t for replies
+#endif
+
+/*
+ *  Counters and latency histograms for dispatchd, reported by
+ *  "lpjs stats" and optionally dumped to Config.metrics_file in
+ *  Prometheus text format.  Credential timings are also recorded by
+ *  the worker threads in pool.c, so histogram updates are atomic.
+ *  Everything else is recorded only by the dispatchd main thread.
+ *  Other programs also record credential timings through network.c,
+ *  but never report them.
+ */
+
+// Operations timed outside of request processing
+typedef enum
+{
+    LPJS_METRIC_EVENT_LOOP,     // One event loop iteration, excluding wait
+    LPJS_METRIC_SCHEDULE,       // One lpjs_dispatch_jobs() pass
+    LPJS_METRIC_AUTH_ENCODE,    // Credential for the configured backend
+    LPJS_METRIC_AUTH_DECODE,
+    LPJS_METRIC_SPOOL_WRITE,    // Journal commit, including fsync()
+    LPJS_METRIC_SNAPSHOT_WRITE, // Journal compaction
+    LPJS_METRIC_BOARD_PUBLISH,  // Status board update
+    LPJS_METRIC_COUNT
+}   lpjs_metric_t;
+
+// Histogram bucket upper bounds in microseconds, + Inf bucket
+#define LPJS_METRICS_BUCKETS    20
+#define LPJS_METRICS_BUCKET_BOUNDS \
+    { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, \
+      100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, \
+      UINT64_MAX }
+
+#define LPJS_METRICS_RATE_SECONDS   60  // Window for dispatches per second
+#define LPJS_METRICS_TEXT_MAX       65536
+#define LPJS_METRICS_INTERVAL       60      // Default dump interval
+
+// Second byte of LPJS_DISPATCHD_REQUEST_STATS
+#define LPJS_METRICS_FORMAT_SUMMARY     's'
+#define LPJS_METRICS_FORMAT_PROMETHEUS  'p'
+
+typedef struct
+{
+    _Atomic uint64_t    count;
+    _Atomic uint64_t    sum_us;
+    _Atomic uint64_t    max_us;
+    _Atomic uint64_t    buckets[LPJS_METRICS_BUCKETS];  // Not cumulative
+}   lpjs_histogram_t;
+
+#include "metrics-protos.h"
+
+#endif  // _LPJS_METRICS_H_
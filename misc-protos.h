@@ -8,3 +8,8 @@ const char *xt_basename(const char *restrict str);
 ssize_t lpjs_load_script(const char *script_path, char *script_buff, size_t buff_size);
 char *lpjs_get_marker_filename(char shared_fs_marker[], const char *hostname, size_t array_size);
 void lpjs_job_log_dir(const char *log_parent, unsigned long job_id, char *log_dir, size_t array_size);
+char *lpjs_strdup(const char *str);
+int lpjs_write_all(int fd, const void *buff, size_t len);
+double lpjs_elapsed_ms(const struct timespec *start, const struct timespec *end);
+int64_t lpjs_time_us(void);
+int64_t lpjs_monotonic_us(void);
@@ -14,6 +14,16 @@
 #include "misc.h"
 #include "node-list.h"
 #include "network.h"
+#include "config.h"
+#include "logger.h"
+#include "metrics.h"     // LPJS_METRICS_INTERVAL
+#include "pool.h"        // LPJS_POOL_THREADS_AUTO
+#include "pace.h"        // LPJS_PACE_DEFAULT_RATE
+#include "heartbeat.h"   // LPJS_HEARTBEAT_INTERVAL, LPJS_RECONNECT_GRACE
+#include "telemetry.h"   // LPJS_TELEMETRY_INTERVAL
+#include "proctree.h"    // LPJS_CANCEL_GRACE
+#include "job-usage.h"   // LPJS_USAGE_INTERVAL
+#include "relay.h"       // LPJS_COMPD_SOCKET_GROUP
 
 /*
  *  Avoid globals like the plague, but make an exception here so
@@ -22,18 +32,42 @@
  */
 FILE        *Log_stream;
 node_list_t *Node_list;
-bool        Debug = true;   // FIXME: Control with --debug flag
 char        Pid_path[PATH_MAX + 1];
 
+// Defaults for settings not in the config file
+lpjs_config_t   Config =
+{
+    .log_level = LPJS_LOG_LEVEL_NORMAL,
+    .log_sync = LPJS_LOG_SYNC_ERRORS,
+    .metrics_interval = LPJS_METRICS_INTERVAL,
+    .auth = LPJS_AUTH_MUNGE,
+    .auth_key_file = LPJS_AUTH_KEY_FILE,
+    .worker_threads = LPJS_POOL_THREADS_AUTO,
+    .job_supervisor = LPJS_SUPERVISOR_CHAPERONE,
+    .checkin_rate = LPJS_PACE_DEFAULT_RATE,
+    .heartbeat_interval = LPJS_HEARTBEAT_INTERVAL,
+    .reconnect_grace = LPJS_RECONNECT_GRACE,
+    .telemetry_interval = LPJS_TELEMETRY_INTERVAL,
+    .memory_policy = LPJS_MEMORY_REQUESTED,
+    .oversubscribe_margin = LPJS_OVERSUBSCRIBE_MARGIN,
+    .oversubscribe_reserve = LPJS_OVERSUBSCRIBE_RESERVE,
+    .job_cgroups = true,
+    .cancel_grace = LPJS_CANCEL_GRACE,
+    .usage_interval = LPJS_USAGE_INTERVAL,
+    .compd_socket_group = LPJS_COMPD_SOCKET_GROUP
+};
+
 /***************************************************************************
  *  Description:
  *      Log messages to stream of choice, usually either stderr if running
  *      as a foreground process, or PREFIX/var/log/lpjs by default
- *      if daemonized.
+ *      if daemonized.  Messages containing "Error:" or "Bug:" are
+ *      logged as errors.  See logger.c.
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-28  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Use buffered logger with levels
  ***************************************************************************/
 
 int     lpjs_log(const char *format, ...)
@@ -42,51 +76,34 @@ int     lpjs_log(const char *format, ...)
     int         status;
     va_list     ap;
     
-    // Code duplicated in lpjs_debug(), but not worth factoring out
     va_start(ap, format);
-    
-    fprintf(Log_stream, "%s ", xt_str_localtime("%m-%d %H:%M:%S"));
-    
-    // FIXME: Add time stamp?
-    status = vfprintf(Log_stream, format, ap);
-    
-    // Commit immediately so last message in the log is not
-    // misleading in the event of a crash
-    fflush(Log_stream);
-    fsync(fileno(Log_stream));
-    
+    status = lpjs_log_vwrite(lpjs_log_level(format), format, ap);
     va_end(ap);
     
     return status;
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Log messages only if log-level is debug1 or higher
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Use buffered logger with levels
+ ***************************************************************************/
+
 int     lpjs_debug(const char *format, ...)
 
 {
     int         status;
     va_list     ap;
     
-    if ( Debug )
-    {
-	// Code duplicated in lpjs_log), but not worth factoring out
-	va_start(ap, format);
-
-	fprintf(Log_stream, "%s ", xt_str_localtime("%m-%d %H:%M:%S"));
-	
-	// FIXME: Add time stamp?
-	status = vfprintf(Log_stream, format, ap);
-	
-	// Commit immediately so last message in the log is not
-	// misleading in the event of a crash
-	fflush(Log_stream);
-	fsync(fileno(Log_stream));
-	
-	va_end(ap);
-	return status;
-    }
-    else
-	return 0;
+    va_start(ap, format);
+    status = lpjs_log_vwrite(LPJS_LOG_LEVEL_DEBUG1, format, ap);
+    va_end(ap);
+    
+    return status;
 }
 
 
@@ -273,7 +290,6 @@ ssize_t lpjs_load_script(const char *script_path,
 {
     ssize_t bytes;
     int     fd;
-    extern FILE *Log_stream;
     
     if ( (fd = open(script_path, O_RDONLY)) == -1 )
     {
@@ -352,3 +368,117 @@ void    lpjs_job_log_dir(const char *log_parent, unsigned long job_id,
 	    log_parent, job_id);
 }
 
+
+/***************************************************************************
+ *  Description:
+ *      strdup() that terminates the process if malloc() fails
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *lpjs_strdup(const char *str)
+
+{
+    char    *copy;
+
+    if ( (copy = strdup(str)) == NULL )
+    {
+	lpjs_log("%s(): Error: strdup() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    return copy;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      write() the whole buffer, retrying short writes
+ *
+ *  Returns:
+ *      0 on success, -1 on failure with errno set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_write_all(int fd, const void *buff, size_t len)
+
+{
+    const char  *p = buff;
+    ssize_t     bytes;
+
+    while ( len > 0 )
+    {
+	if ( (bytes = write(fd, p, len)) == -1 )
+	{
+	    if ( errno == EINTR )
+		continue;
+	    return -1;
+	}
+	p += bytes;
+	len -= bytes;
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Milliseconds between two clock_gettime() readings
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+double  lpjs_elapsed_ms(const struct timespec *start, const struct timespec *end)
+
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0 +
+	   (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Current time in microseconds since the epoch.  Wall clock time,
+ *      unlike CLOCK_MONOTONIC, is comparable across restarts and hosts,
+ *      the latter within the accuracy of NTP.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t lpjs_time_us(void)
+
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Current time in microseconds on the monotonic clock, for
+ *      measuring intervals within one process, unaffected by clock
+ *      adjustments.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t lpjs_monotonic_us(void)
+
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
@@ -1,13 +1,29 @@
 #ifndef _LPJS_MISC_H_
 #define _LPJS_MISC_H_
 
+#include <time.h>   // struct timespec
+#include <stdint.h> // int64_t
+
+/*
+ *  Messages are logged if their level is <= Config.log_level.
+ *  lpjs_log() classifies messages tagged "Error:" or "Bug:" as errors.
+ */
 enum
 {
+    LPJS_LOG_LEVEL_ERROR,
     LPJS_LOG_LEVEL_NORMAL,
     LPJS_LOG_LEVEL_DEBUG1,
     LPJS_LOG_LEVEL_DEBUG2
 };
 
+// When log messages must reach the disk (config tag log-sync)
+typedef enum
+{
+    LPJS_LOG_SYNC_ALWAYS,       // Every message, before lpjs_log() returns
+    LPJS_LOG_SYNC_ERRORS,       // Error messages, before lpjs_log() returns
+    LPJS_LOG_SYNC_INTERVAL      // At most every Config.log_sync_ms
+}   log_sync_t;
+
 #include "misc-protos.h"
 
 #endif
@@ -4,7 +4,17 @@ int lpjs_print_response(int msg_fd, const char *caller_name);
 ssize_t lpjs_send(int msg_fd, int send_flags, const char *format, ...);
 ssize_t lpjs_recv(int msg_fd, char *buff, size_t buff_len, int flags, int timeout);
 ssize_t lpjs_recv_munge(int msg_fd, char **payload, int flags, int timeout, uid_t *uid, gid_t *gid, int (*close_function)(int));
+ssize_t lpjs_recv_node_munge(int msg_fd, char **payload, int flags, int timeout, uid_t *uid, gid_t *gid, int (*close_function)(int));
+ssize_t lpjs_recv_munge_msg(int msg_fd, char **payload, int flags, int timeout, uid_t *uid, gid_t *gid, int (*close_function)(int), bool node_connection);
 int lpjs_send_munge(int msg_fd, const char *msg, int (*close_function)(int));
+int lpjs_send_node_munge(int msg_fd, const char *msg, int (*close_function)(int));
+int lpjs_send_munge_msg(int msg_fd, const char *msg, int (*close_function)(int), bool await_reply);
 int lpjs_wait_close(int msg_fd);
 int lpjs_dispatchd_safe_close(int msg_fd);
 int lpjs_no_close(int fd);
+void lpjs_backoff_init(lpjs_backoff_t *backoff);
+unsigned lpjs_backoff_next_ms(lpjs_backoff_t *backoff);
+unsigned lpjs_backoff_wait(lpjs_backoff_t *backoff);
+bool lpjs_backoff_hint(lpjs_backoff_t *backoff, const char *msg);
+void lpjs_send_heartbeat(int msg_fd, const char *telemetry);
+bool lpjs_is_heartbeat(const char *msg, ssize_t bytes);
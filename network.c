@@ -8,8 +8,9 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <stdarg.h>
+#include <stdint.h>     // uintptr_t
+#include <time.h>
 
-#include <munge.h>
 #include <xtend/string.h>   // strlcpy() on Linux
 #include <xtend/net.h>
 #include <xtend/file.h>
@@ -18,6 +19,9 @@
 #include "network.h"
 #include "lpjs.h"
 #include "misc.h"
+#include "metrics.h"
+#include "auth.h"
+#include "trace.h"
 
 /***************************************************************************
  *  Description:
@@ -280,16 +284,81 @@ ssize_t lpjs_recv(int msg_fd, char *buff, size_t buff_len, int flags,
  *  History: 
  *  Date        Name        Modification
  *  2024-02-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Time munge_decode()
+ *  2026-10-19  Jason Bacon Use configured auth backend
+ *  2026-10-19  Jason Bacon Read from capture during replay
+ *  2026-10-19  Jason Bacon Return LPJS_RECV_HEARTBEAT for heartbeats
+ *  2026-10-19  Jason Bacon Return telemetry sent with a heartbeat
+ *  2026-10-19  Jason Bacon Reject heartbeats, see lpjs_recv_node_munge()
  ***************************************************************************/
 
 ssize_t lpjs_recv_munge(int msg_fd, char **payload, int flags, int timeout,
 			uid_t *uid, gid_t *gid, int(*close_function)(int))
 
+{
+    return lpjs_recv_munge_msg(msg_fd, payload, flags, timeout, uid, gid,
+			       close_function, false);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Receive on the persistent connection between compd and
+ *      dispatchd.  Like lpjs_recv_munge(), but heartbeats, which only
+ *      compute nodes send, are accepted, and no verification reply is
+ *      sent.  Either end may send at any time, so a reply could cross
+ *      with the other end's next message.  Senders on this connection
+ *      use lpjs_send_node_munge(), which does not wait for one.
+ *
+ *      Heartbeats are unauthenticated, so they must not be accepted
+ *      on connections from anyone else.
+ *
+ *  Returns:
+ *      As lpjs_recv_munge(), or LPJS_RECV_HEARTBEAT for a heartbeat,
+ *      with *payload set to its telemetry or NULL
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon No verification reply
+ ***************************************************************************/
+
+ssize_t lpjs_recv_node_munge(int msg_fd, char **payload, int flags,
+			     int timeout, uid_t *uid, gid_t *gid,
+			     int(*close_function)(int))
+
+{
+    return lpjs_recv_munge_msg(msg_fd, payload, flags, timeout, uid, gid,
+			       close_function, true);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Common code for lpjs_recv_munge() and lpjs_recv_node_munge().
+ *      A heartbeat is accepted only on a node connection.  Otherwise,
+ *      the connection is closed with close_function() without
+ *      allocating anything.  Verified messages are acknowledged only
+ *      on other connections.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_recv_munge()
+ ***************************************************************************/
+
+ssize_t lpjs_recv_munge_msg(int msg_fd, char **payload, int flags,
+			    int timeout, uid_t *uid, gid_t *gid,
+			    int(*close_function)(int), bool node_connection)
+
 {
     ssize_t     bytes_read;
     int         payload_len;
-    munge_err_t munge_status;
+    auth_status_t   auth_status;
     char        incoming_msg[LPJS_MSG_LEN_MAX + 1];
+    struct timespec start;
+    
+    if ( lpjs_trace_replaying() )
+	return lpjs_trace_replay_recv(payload, uid, gid);
     
     bytes_read = lpjs_recv(msg_fd, incoming_msg, LPJS_MSG_LEN_MAX + 1,
 			   flags, timeout);
@@ -309,20 +378,40 @@ ssize_t lpjs_recv_munge(int msg_fd, char **payload, int flags, int timeout,
 	// FIXME: What should we really do here?
 	return LPJS_RECV_FAILED;
     }
+    else if ( lpjs_is_heartbeat(incoming_msg, bytes_read) )
+    {
+	if ( ! node_connection )
+	{
+	    close_function(msg_fd);
+	    lpjs_log("%s(): Error: Heartbeat on fd = %d, not a node connection.\n",
+		     __FUNCTION__, msg_fd);
+	    return LPJS_RECV_FAILED;
+	}
+	
+	// Telemetry, if any, is unauthenticated like the heartbeat
+	if ( bytes_read > 2 )
+	    *payload = lpjs_strdup(incoming_msg + 1);
+	else
+	    *payload = NULL;
+	return LPJS_RECV_HEARTBEAT;
+    }
     else
     {
-	munge_status = munge_decode(incoming_msg, NULL, (void **)payload,
-				    &payload_len, uid, gid);
-	if ( munge_status != EMUNGE_SUCCESS )
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	auth_status = lpjs_auth_decode(msg_fd, incoming_msg, payload,
+				       &payload_len, uid, gid);
+	lpjs_metrics_observe(LPJS_METRIC_AUTH_DECODE, &start);
+	if ( auth_status != LPJS_AUTH_OK )
 	{
 	    close_function(msg_fd);
-	    lpjs_log("%s(): Error: munge_decode(fd = %d) failed.  %zd bytes, Error = %s\n",
-		     __FUNCTION__, msg_fd, bytes_read, munge_strerror(munge_status));
+	    lpjs_log("%s(): Error: lpjs_auth_decode(fd = %d) failed.  %zd bytes, Error = %s\n",
+		     __FUNCTION__, msg_fd, bytes_read, lpjs_auth_strerror(auth_status));
 	    return -1;  // FIXME: Define return codes
 	}
 	
 	// Acknolwedge successful receipt of message
-	lpjs_send(msg_fd, 0, LPJS_MUNGE_CRED_VERIFIED);
+	if ( ! node_connection )
+	    lpjs_send(msg_fd, 0, LPJS_MUNGE_CRED_VERIFIED);
 	return payload_len;
     }
 }
@@ -330,7 +419,8 @@ ssize_t lpjs_recv_munge(int msg_fd, char **payload, int flags, int timeout,
 
 /***************************************************************************
  *  Description:
- *      Send a munge-encoded message
+ *      Send a message with a credential from the configured auth
+ *      backend (see auth.c).  The name predates other backends.
  *
  *  Returns:
  *      EX_OK on success, various other error codes
@@ -338,27 +428,83 @@ ssize_t lpjs_recv_munge(int msg_fd, char **payload, int flags, int timeout,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-21  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Time munge_encode()
+ *  2026-10-19  Jason Bacon Use configured auth backend
+ *  2026-10-19  Jason Bacon No-op during replay
+ *  2026-10-19  Jason Bacon Skip heartbeats ahead of the acknowledgment
+ *  2026-10-19  Jason Bacon Factor out lpjs_send_munge_msg()
  ***************************************************************************/
 
 int     lpjs_send_munge(int msg_fd, const char *msg, int(*close_function)(int))
 
+{
+    return lpjs_send_munge_msg(msg_fd, msg, close_function, true);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send on the persistent connection between compd and dispatchd,
+ *      without waiting for a verification reply.  See
+ *      lpjs_recv_node_munge().  Messages that need an answer get one
+ *      of their own, such as LPJS_CHAPERONE_FORKED for a new job, or
+ *      LPJS_COMPD_REQUEST_REPORTS_ACK for a batch of job reports.
+ *
+ *  Returns:
+ *      LPJS_MSG_SENT on success, LPJS_MUNGE_FAILED or LPJS_SEND_FAILED
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_send_node_munge(int msg_fd, const char *msg,
+			     int(*close_function)(int))
+
+{
+    return lpjs_send_munge_msg(msg_fd, msg, close_function, false);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Common code for lpjs_send_munge() and lpjs_send_node_munge().
+ *      Wait for the receiver's verification reply if await_reply is
+ *      true.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from lpjs_send_munge()
+ ***************************************************************************/
+
+int     lpjs_send_munge_msg(int msg_fd, const char *msg,
+			    int(*close_function)(int), bool await_reply)
+
 {
     char        *cred,
 		incoming_msg[LPJS_MSG_LEN_MAX + 1];
     ssize_t     bytes;
-    munge_err_t munge_status;
+    auth_status_t   auth_status;
+    struct timespec start;
     
-    if ( (munge_status = munge_encode(&cred, NULL, msg, strlen(msg))) != EMUNGE_SUCCESS )
+    if ( lpjs_trace_replaying() )
+	return LPJS_MSG_SENT;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    auth_status = lpjs_auth_encode(msg, &cred);
+    lpjs_metrics_observe(LPJS_METRIC_AUTH_ENCODE, &start);
+    if ( auth_status != LPJS_AUTH_OK )
     {
-	lpjs_log("%s(): Error: munge_encode(fd = %d) failed: %s.\n",
-		__FUNCTION__, msg_fd, munge_strerror(munge_status));
+	lpjs_log("%s(): Error: lpjs_auth_encode(fd = %d) failed: %s.\n",
+		__FUNCTION__, msg_fd, lpjs_auth_strerror(auth_status));
 	// May be close(), lpjs_dispatchd_safe_close(), or lpjs_no_close()
 	close_function(msg_fd);
 	return LPJS_MUNGE_FAILED;
     }
 
     // lpjs_debug("%s(): Sending %zd bytes: %s...\n", __FUNCTION__, strlen(cred), cred);
-    if ( lpjs_send(msg_fd, 0, cred) < 0 )
+    // Payload may contain %, as in "rsync -av %w/", so not a format
+    if ( lpjs_send(msg_fd, 0, "%s", cred) < 0 )
     {
 	lpjs_log("%s(): Error: Failed to send credential to dispatchd",
 		__FUNCTION__);
@@ -368,10 +514,14 @@ int     lpjs_send_munge(int msg_fd, const char *msg, int(*close_function)(int))
 	return LPJS_SEND_FAILED;
     }
     free(cred);
+    if ( ! await_reply )
+	return LPJS_MSG_SENT;
     
     // lpjs_debug("%s(): Waiting for response.\n", __FUNCTION__);
-    // Read acknowledgment
-    bytes = lpjs_recv(msg_fd, incoming_msg, LPJS_MSG_LEN_MAX, 0, 0);
+    // Read acknowledgment, which may follow heartbeats from compd
+    do
+	bytes = lpjs_recv(msg_fd, incoming_msg, LPJS_MSG_LEN_MAX, 0, 0);
+    while ( lpjs_is_heartbeat(incoming_msg, bytes) );
     if ( bytes == LPJS_RECV_FAILED )
     {
 	lpjs_log("%s(): Error: lpjs_recv(fd = %d) failed.\n",
@@ -405,6 +555,7 @@ int     lpjs_send_munge(int msg_fd, const char *msg, int(*close_function)(int))
  *  History: 
  *  Date        Name        Modification
  *  2024-12-15  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon No-op during replay
  ***************************************************************************/
 
 int     lpjs_wait_close(int msg_fd)
@@ -412,6 +563,9 @@ int     lpjs_wait_close(int msg_fd)
 {
     char    buff[64];
     
+    if ( lpjs_trace_replaying() )
+	return 0;
+    
     /*
      *  Wait until EOF is signaled due to the other end being closed.
      *  FIXME: No data should be read here.  The first read() should
@@ -438,11 +592,16 @@ int     lpjs_wait_close(int msg_fd)
  *  History: 
  *  Date        Name        Modification
  *  2024-01-14  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon No-op during replay
  ***************************************************************************/
 
 int     lpjs_dispatchd_safe_close(int msg_fd)
 
 {
+    // Nothing is open, see trace.c
+    if ( lpjs_trace_replaying() )
+	return 0;
+    
     /*
      *  Client must be looking for the EOT character at the end of
      *  a read, or this is useless.  If this fails, closing msg_fd
@@ -467,3 +626,165 @@ int     lpjs_no_close(int fd)
 {
     return 0;
 }
+
+
+/***************************************************************************
+ *  Description:
+ *      Start a new series of attempts to reach dispatchd.  The seed
+ *      differs between processes and threads started together, so
+ *      their delays do not match.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_backoff_init(lpjs_backoff_t *backoff)
+
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    backoff->attempts = 0;
+    backoff->retry_after_ms = 0;
+    backoff->seed = (unsigned)now.tv_nsec ^ ((unsigned)getpid() << 16) ^
+		    (unsigned)(uintptr_t)backoff;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compute the delay before the next attempt: The retry-after
+ *      hint from dispatchd if there is one, plus a little jitter, or
+ *      else a random time between half and all of the current limit,
+ *      which doubles with each attempt up to LPJS_BACKOFF_MAX_MS.
+ *
+ *  Returns:
+ *      Delay in milliseconds
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_backoff_next_ms(lpjs_backoff_t *backoff)
+
+{
+    unsigned    ceiling, delay;
+    
+    if ( backoff->retry_after_ms > 0 )
+    {
+	// dispatchd is up and has reserved a time for us
+	delay = backoff->retry_after_ms +
+		rand_r(&backoff->seed) % (LPJS_RETRY_AFTER_JITTER_MS + 1);
+	backoff->retry_after_ms = 0;
+	backoff->attempts = 0;
+	return delay;
+    }
+    
+    ceiling = LPJS_BACKOFF_MAX_MS;
+    if ( (backoff->attempts < 16) &&
+	 ((LPJS_BACKOFF_MIN_MS << backoff->attempts) < LPJS_BACKOFF_MAX_MS) )
+	ceiling = LPJS_BACKOFF_MIN_MS << backoff->attempts;
+    ++backoff->attempts;
+    
+    return ceiling / 2 + rand_r(&backoff->seed) % (ceiling / 2 + 1);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Sleep before the next attempt to reach dispatchd.
+ *
+ *  Returns:
+ *      Delay in milliseconds
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_backoff_wait(lpjs_backoff_t *backoff)
+
+{
+    unsigned        delay = lpjs_backoff_next_ms(backoff);
+    struct timespec ts;
+    
+    ts.tv_sec = delay / 1000;
+    ts.tv_nsec = (delay % 1000) * 1000000L;
+    while ( (nanosleep(&ts, &ts) != 0) && (errno == EINTR) )
+	;
+    return delay;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check a reply to a checkin for a retry-after hint from
+ *      dispatchd, and save the delay for lpjs_backoff_next_ms().
+ *
+ *  Returns:
+ *      true if msg is a hint, false otherwise
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_backoff_hint(lpjs_backoff_t *backoff, const char *msg)
+
+{
+    unsigned long   delay;
+    char            *end;
+    size_t          len = strlen(LPJS_RETRY_AFTER_MSG);
+    
+    if ( strncmp(msg, LPJS_RETRY_AFTER_MSG, len) != 0 )
+	return false;
+    
+    delay = strtoul(msg + len, &end, 10);
+    if ( (end == msg + len) || (delay > LPJS_BACKOFF_MAX_MS) )
+	delay = LPJS_BACKOFF_MAX_MS;
+    // 0 means no hint, and dispatchd never sends 0
+    backoff->retry_after_ms = delay > 0 ? delay : 1;
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send a heartbeat from compd to dispatchd, with a resource
+ *      report from telemetry_to_str() or NULL.  Failures are not
+ *      reported here, but show up as a lost connection.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Optional telemetry
+ ***************************************************************************/
+
+void    lpjs_send_heartbeat(int msg_fd, const char *telemetry)
+
+{
+    lpjs_send(msg_fd, 0, "%s%s", LPJS_HEARTBEAT_MSG,
+	      telemetry == NULL ? "" : telemetry);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether a message read by lpjs_recv() is a heartbeat,
+ *      with or without telemetry.  bytes includes the '\0' sent by
+ *      lpjs_send().
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Allow telemetry
+ ***************************************************************************/
+
+bool    lpjs_is_heartbeat(const char *msg, ssize_t bytes)
+
+{
+    return (bytes >= 2) && (msg[0] == LPJS_HEARTBEAT) &&
+	   (msg[bytes - 1] == '\0');
+}
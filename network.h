@@ -20,13 +20,18 @@ enum
     LPJS_DISPATCHD_REQUEST_SUBMIT,
     LPJS_DISPATCHD_REQUEST_CANCEL,
     LPJS_DISPATCHD_REQUEST_PAUSE,
-    LPJS_DISPATCHD_REQUEST_RESUME
+    LPJS_DISPATCHD_REQUEST_RESUME,
+    LPJS_DISPATCHD_REQUEST_STATS,
+    // Internal event: chaperone reports relayed by compd, see relay.h
+    LPJS_DISPATCHD_REQUEST_JOB_REPORTS,
+    LPJS_DISPATCHD_REQUEST_END      // Not a request, must be last
 };
 
 enum
 {
     LPJS_COMPD_REQUEST_NEW_JOB = 1,
-    LPJS_COMPD_REQUEST_CANCEL
+    LPJS_COMPD_REQUEST_CANCEL,
+    LPJS_COMPD_REQUEST_REPORTS_ACK
 };
 
 typedef enum
@@ -37,7 +42,7 @@ typedef enum
     // monitoring for new requests
     LPJS_CHAPERONE_FORKED = 1,
     
-    // The rest are sent by chaperone on a new socket connection
+    // The rest are sent by chaperone through compd, see relay.h
     LPJS_CHAPERONE_OK,
     LPJS_CHAPERONE_SCRIPT_FAILED,
     LPJS_CHAPERONE_OSERR,
@@ -53,6 +58,7 @@ typedef enum
 // Must be <= 0, since recv returns number of bytes
 #define LPJS_RECV_FAILED    -1  // bytes returned
 #define LPJS_RECV_TIMEOUT   -2  // bytes returned
+#define LPJS_RECV_HEARTBEAT -3  // bytes returned, payload is telemetry or NULL
 // FIXME: Getting spurious timeouts on dispatch response
 // Keep timeouts small so dispatchd doesn't hang waiting for a msg
 #define LPJS_CHAPERONE_STATUS_TIMEOUT   500000
@@ -62,6 +68,18 @@ typedef enum
 #define LPJS_EOT                '\004'
 #define LPJS_EOT_MSG            "\004"
 
+/*
+ *  compd sends a heartbeat on its persistent connection every
+ *  heartbeat-interval seconds.  It is a bare message with no credential,
+ *  since the connection was authorized at checkin, and gets no
+ *  acknowledgement, so it can never be mistaken for a reply by either
+ *  end.  Receivers skip it wherever they read from a compd connection.
+ *  A heartbeat may carry a resource report following the code, see
+ *  telemetry.h.  See heartbeat.c.
+ */
+#define LPJS_HEARTBEAT          '\026' // ASCII SYN
+#define LPJS_HEARTBEAT_MSG      "\026"
+
 // IPv6 max address size is 39
 #define LPJS_TEXT_IP_ADDRESS_MAX    64
 // FIXME: 4096 is just a guestimate
@@ -79,8 +97,30 @@ typedef enum
 #define LPJS_IP_TCP_PORT        (short)6818 // Need short for htons()
 #define LPJS_RETRY_TIME         5
 
+/*
+ *  Reconnecting to dispatchd backs off exponentially from
+ *  LPJS_BACKOFF_MIN_MS to LPJS_BACKOFF_MAX_MS, waiting a random time
+ *  between half and all of the current limit, so that nodes dropped
+ *  together by a dispatchd restart do not return together.  dispatchd
+ *  may instead answer a checkin with LPJS_RETRY_AFTER_MSG and a delay
+ *  in milliseconds, to pace nodes checking in.  See lpjs_backoff_*().
+ */
+#define LPJS_BACKOFF_MIN_MS         500
+#define LPJS_BACKOFF_MAX_MS         30000
+#define LPJS_RETRY_AFTER_MSG        "Retry after "
+#define LPJS_RETRY_AFTER_JITTER_MS  200
+
+typedef struct
+{
+    unsigned    attempts;       // Failures since the last success
+    unsigned    retry_after_ms; // Hint from dispatchd, or 0
+    unsigned    seed;           // For rand_r()
+}   lpjs_backoff_t;
+
 #define LPJS_MUNGE_CRED_VERIFIED     "MCD"
 
+#include <stdbool.h>
+
 #ifndef _SYS_POLL_H_
 #include <sys/poll.h>
 #endif
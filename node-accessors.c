@@ -530,3 +530,71 @@ time_t    node_get_last_ping(node_t *node_ptr)
 {
     return node_ptr->last_ping;
 }
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <node.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for heartbeat_slot member in a node_t structure.
+ *      Use this function to get heartbeat_slot in a node_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      node_ptr        Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member heartbeat_slot.
+ *
+ *  Examples:
+ *      node_t          node;
+ *      int             heartbeat_slot;
+ *
+ *      heartbeat_slot = node_get_heartbeat_slot(&node);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from node-private.h
+ ***************************************************************************/
+
+int    node_get_heartbeat_slot(node_t *node_ptr)
+
+{
+    return node_ptr->heartbeat_slot;
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <node.h>
+ *      
+ *
+ *  Description:
+ *      Accessor for telemetry member in a node_t structure.
+ *      Use this function to get telemetry in a node_t object
+ *      from non-member functions.
+ *
+ *  Arguments:
+ *      node_ptr        Pointer to the structure to set
+ *
+ *  Returns:
+ *      Value of the structure member telemetry.
+ *
+ *  Examples:
+ *      node_t          node;
+ *      telemetry_t *   telemetry;
+ *
+ *      telemetry = node_get_telemetry(&node);
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from node-private.h
+ ***************************************************************************/
+
+telemetry_t *    node_get_telemetry(node_t *node_ptr)
+
+{
+    return node_ptr->telemetry;
+}
@@ -25,3 +25,5 @@ char *node_get_state(node_t *node_ptr);
 char node_get_state_ae(node_t *node_ptr, size_t c);
 int node_get_msg_fd(node_t *node_ptr);
 time_t node_get_last_ping(node_t *node_ptr);
+int node_get_heartbeat_slot(node_t *node_ptr);
+telemetry_t *node_get_telemetry(node_t *node_ptr);
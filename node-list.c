@@ -12,6 +12,7 @@
 #include "network.h"
 #include "lpjs.h"
 #include "misc.h"
+#include "telemetry.h"
 
 
 /***************************************************************************
@@ -114,14 +115,16 @@ void    node_list_update_compute(node_list_t *node_list, node_t *node)
 
 /***************************************************************************
  *  Description:
- *      Send current node list to msg_fd in human-readable format
+ *      Add current node list to a reply in human-readable format
  *  
  *  History: 
  *  Date        Name        Modification
  *  2021-09-26  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add to a reply sent by a worker thread
+ *  2026-10-19  Jason Bacon Add telemetry
  ***************************************************************************/
 
-void    node_list_send_status(int msg_fd, node_list_t *node_list)
+void    node_list_reply_status(pool_task_t *reply, node_list_t *node_list)
 
 {
     unsigned        c,
@@ -172,27 +175,28 @@ void    node_list_send_status(int msg_fd, node_list_t *node_list)
 	    NODE_STATUS_FORMAT, "Total", "down",
 	    procs_down, 0, mem_down, (size_t)0, "-", "-");
     strlcat(outgoing_msg, temp, LPJS_MSG_LEN_MAX + 1);
-
-    // Only dispatchd calls this function, so wait for client to close first
-    if ( lpjs_send_munge(msg_fd, outgoing_msg,
-			 lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
+    
+    // Measured resource use, for nodes that have reported any
+    for (c = 0; c < node_list->compute_node_count; ++c)
+	if ( node_get_telemetry(node_list->compute_nodes[c]) != NULL )
+	    break;
+    if ( c < node_list->compute_node_count )
     {
-	lpjs_log("%s(): Error: Failed to send node list info.\n", __FUNCTION__);
-	lpjs_dispatchd_safe_close(msg_fd);
-	return; // FIXME: Define return codes
+	snprintf(temp, LPJS_MSG_LEN_MAX + 1,
+		 "\n" NODE_TELEMETRY_HEADER_FORMAT, "Measured", "Age",
+		 "Load1", "Load5", "Load15", "FreeMiB", "AvailMiB",
+		 "SwapMiB", "JobsMiB");
+	strlcat(outgoing_msg, temp, LPJS_MSG_LEN_MAX + 1);
+	for (c = 0; c < node_list->compute_node_count; ++c)
+	{
+	    telemetry_status_to_str(node_list->compute_nodes[c], temp,
+				    LPJS_MSG_LEN_MAX + 1);
+	    strlcat(outgoing_msg, temp, LPJS_MSG_LEN_MAX + 1);
+	}
     }
-    
-    /*
-     *  Closing the listener first results in "address already in use"
-     *  errors on restart.  Send an EOT character to signal the end of
-     *  transmission, so the client can close first and avoid a wait
-     *  state for the socket.
-     */
-    if ( lpjs_send_munge(msg_fd, LPJS_EOT_MSG, lpjs_dispatchd_safe_close)
-			 != LPJS_MSG_SENT )
-	lpjs_log("%s(): Error: Failed to send EOT.\n", __FUNCTION__);
-    else
-	lpjs_log("%s(): EOT sent.\n", __FUNCTION__);
+
+    // EOT is sent when the reply closes the connection
+    lpjs_reply_add(reply, outgoing_msg);
 }
 
 
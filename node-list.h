@@ -9,6 +9,10 @@ typedef struct node_list node_list_t;
 
 #define LPJS_MAX_NODES  1024
 
+#ifndef _LPJS_POOL_H_
+#include "pool.h"       // pool_task_t for replies
+#endif
+
 #include "node-list-rvs.h"
 #include "node-list-accessors.h"
 #include "node-list-mutators.h"
@@ -992,3 +992,107 @@ int     node_set_last_ping(node_t *node_ptr, time_t new_last_ping)
 	return NODE_DATA_OK;
     }
 }
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <node.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for heartbeat_slot member in a node_t structure.
+ *      Use this function to set heartbeat_slot in a node_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      heartbeat_slot is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      node_ptr        Pointer to the structure to set
+ *      new_heartbeat_slot  The new value for heartbeat_slot
+ *
+ *  Returns:
+ *      NODE_DATA_OK if the new value is acceptable and assigned
+ *      NODE_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      node_t          node;
+ *      int             new_heartbeat_slot;
+ *
+ *      if ( node_set_heartbeat_slot(&node, new_heartbeat_slot)
+ *              == NODE_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from node-private.h
+ ***************************************************************************/
+
+int     node_set_heartbeat_slot(node_t *node_ptr, int new_heartbeat_slot)
+
+{
+    if ( false )
+	return NODE_DATA_OUT_OF_RANGE;
+    else
+    {
+	node_ptr->heartbeat_slot = new_heartbeat_slot;
+	return NODE_DATA_OK;
+    }
+}
+
+
+/***************************************************************************
+ *  Library:
+ *      #include <node.h>
+ *      
+ *
+ *  Description:
+ *      Mutator for telemetry member in a node_t structure.
+ *      Use this function to set telemetry in a node_t object
+ *      from non-member functions.  This function performs a direct
+ *      assignment for scalar or pointer structure members.  If
+ *      telemetry is a pointer, data previously pointed to should
+ *      be freed before calling this function to avoid memory
+ *      leaks.
+ *
+ *  Arguments:
+ *      node_ptr        Pointer to the structure to set
+ *      new_telemetry   The new value for telemetry
+ *
+ *  Returns:
+ *      NODE_DATA_OK if the new value is acceptable and assigned
+ *      NODE_DATA_OUT_OF_RANGE otherwise
+ *
+ *  Examples:
+ *      node_t          node;
+ *      telemetry_t *   new_telemetry;
+ *
+ *      if ( node_set_telemetry(&node, new_telemetry)
+ *              == NODE_DATA_OK )
+ *      {
+ *      }
+ *
+ *  See also:
+ *      (3)
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  gen-get-set Auto-generated from node-private.h
+ ***************************************************************************/
+
+int     node_set_telemetry(node_t *node_ptr, telemetry_t * new_telemetry)
+
+{
+    if ( new_telemetry == NULL )
+	return NODE_DATA_OUT_OF_RANGE;
+    else
+    {
+	node_ptr->telemetry = new_telemetry;
+	return NODE_DATA_OK;
+    }
+}
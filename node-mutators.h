@@ -33,3 +33,5 @@ int node_set_state_ae(node_t *node_ptr, size_t c, char new_state_element);
 int node_set_state_cpy(node_t *node_ptr, char *new_state, size_t array_size);
 int node_set_msg_fd(node_t *node_ptr, int new_msg_fd);
 int node_set_last_ping(node_t *node_ptr, time_t new_last_ping);
+int node_set_heartbeat_slot(node_t *node_ptr, int new_heartbeat_slot);
+int node_set_telemetry(node_t *node_ptr, telemetry_t *new_telemetry);
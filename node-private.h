@@ -25,6 +25,10 @@ struct node
     // For detecting odd comm issues, where socket connection drop
     // cannot be detected directly
     time_t          last_ping;
+    // Timer wheel slot holding this node, or -1, see heartbeat.c
+    int             heartbeat_slot;
+    // Last resource report from compd or NULL, see telemetry.c
+    struct telemetry    *telemetry;
 };
 
 #include "node.h"
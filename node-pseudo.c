@@ -34,6 +34,9 @@ int     node_set_procs_available(node_t *node, unsigned procs)
 unsigned    node_get_phys_MiB_available(node_t *node)
 
 {
+    // Used may exceed total under memory-policy oversubscribe
+    if ( node->phys_MiB_used > node->phys_MiB )
+	return 0;
     return node->phys_MiB - node->phys_MiB_used;
 }
 
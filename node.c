@@ -64,6 +64,8 @@ void    node_init(node_t *node)
     node->state = "offline";
     node->msg_fd = NODE_MSG_FD_NOT_OPEN;
     node->last_ping = 0;
+    node->heartbeat_slot = -1;
+    node->telemetry = NULL;
 }
 
 
@@ -18,10 +18,11 @@
 #endif
 
 typedef struct node node_t;
+typedef struct telemetry telemetry_t;   // See telemetry.h
 
 #define NODE_MSG_FD_NOT_OPEN        -1
-#define NODE_STATUS_HEADER_FORMAT   "%-20s %-8s %5s %4s %7s %7s %-9s %-9s\n"
-#define NODE_STATUS_FORMAT          "%-20s %-8s %5u %4u %7zu %7zu %-9s %-9s\n"
+#define NODE_STATUS_HEADER_FORMAT   "%-20s %-11s %5s %4s %7s %7s %-9s %-9s\n"
+#define NODE_STATUS_FORMAT          "%-20s %-11s %5u %4u %7zu %7zu %-9s %-9s\n"
 #define NODE_SPECS_LEN              1024
 
 typedef enum
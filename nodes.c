@@ -1,11 +1,12 @@
 /***************************************************************************
  *  Description:
- *      List currently running and queued nodes.  Node info is queried from
- *      lpjs_dispatchd.
+ *      List currently running and queued nodes.  Node info is read from
+ *      the status board on the head node, or queried from lpjs_dispatchd.
  *
  *  History: 
  *  Date        Name        Modification
  *  2021-09-25  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Read the status board if available
  ***************************************************************************/
 
 #include <stdio.h>
@@ -17,10 +18,13 @@
 #include <xtend/string.h>   // strlcat() on linux
 
 #include "node-list.h"
+#include "job-list.h"
 #include "config.h"
 #include "network.h"
 #include "lpjs.h"
 #include "misc.h"
+#include "pool.h"
+#include "board.h"
 #include "nodes-protos.h"
 
 int     main (int argc, char *argv[])
@@ -29,6 +33,9 @@ int     main (int argc, char *argv[])
     int         msg_fd;
     // Terminates process if malloc() fails, no check required
     node_list_t *node_list = node_list_new();
+    job_list_t  *pending_jobs = job_list_new(),
+		*running_jobs = job_list_new();
+    pool_task_t *reply;
     char        outgoing_msg[LPJS_MSG_LEN_MAX + 1];
     extern FILE *Log_stream;
     
@@ -51,6 +58,18 @@ int     main (int argc, char *argv[])
     // Shared functions may use lpjs_log
     Log_stream = stderr;
     
+    // No request needed to list nodes on the head node while
+    // dispatchd is running
+    if ( (outgoing_msg[0] == LPJS_DISPATCHD_REQUEST_NODE_LIST) &&
+	 (lpjs_board_load(node_list, pending_jobs, running_jobs)
+	  == LPJS_SUCCESS) )
+    {
+	reply = lpjs_reply_new(-1, LPJS_REPLY_EOT);
+	node_list_reply_status(reply, node_list);
+	lpjs_reply_print(reply, stdout);
+	return EX_OK;
+    }
+    
     // Get hostname of head node
     lpjs_load_config(node_list, LPJS_CONFIG_HEAD_ONLY, stderr);
 
@@ -0,0 +1,3 @@
+/* pace.c */
+void lpjs_pace_start(unsigned rate);
+unsigned lpjs_pace_checkin(const char *hostname);
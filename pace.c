@@ -0,0 +1,146 @@
+/***************************************************************************
+ *  Description:
+ *      Checkin pacing for dispatchd, using the generic cell rate
+ *      algorithm: Each admitted checkin advances a theoretical arrival
+ *      time (TAT) by the interval between checkins at the configured
+ *      rate.  A checkin is admitted if the TAT is less than the burst
+ *      allowance ahead of now.  Otherwise the host is given the TAT as
+ *      a reserved slot and told how long to wait, and the TAT moves on,
+ *      so each node waiting its turn holds a distinct slot.  A host
+ *      returning at or after its slot is admitted regardless of load.
+ *
+ *      Only the main dispatchd thread calls these functions.  Pacing
+ *      is not started for replay, so captured checkins replay as they
+ *      were first processed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "misc.h"
+#include "pace.h"
+
+static int64_t      Pace_interval_us = 0,   // 0 = not pacing
+		    Pace_burst_us,
+		    Pace_tat_us = 0;
+static pace_slot_t  *Pace_slots = NULL;
+static size_t       Pace_slot_count = 0,
+		    Pace_slot_array_size = 0;
+
+/***************************************************************************
+ *  Description:
+ *      Begin pacing checkins at rate per second, or not at all if
+ *      rate is LPJS_PACE_UNLIMITED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_pace_start(unsigned rate)
+
+{
+    if ( rate == LPJS_PACE_UNLIMITED )
+	return;
+    
+    Pace_interval_us = 1000000 / rate > 0 ? 1000000 / rate : 1;
+    Pace_burst_us = 1000000;
+    Pace_tat_us = lpjs_monotonic_us();
+    lpjs_log("%s(): Pacing checkins at %u per second.\n", __FUNCTION__,
+	     rate);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Decide whether to admit a checkin from hostname now
+ *
+ *  Returns:
+ *      0 to admit the checkin, otherwise milliseconds until the
+ *      slot reserved for hostname
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    lpjs_pace_checkin(const char *hostname)
+
+{
+    int64_t     now_us, slot_us;
+    size_t      c, kept;
+    pace_slot_t *slot = NULL;
+    
+    if ( Pace_interval_us == 0 )
+	return 0;
+    
+    now_us = lpjs_monotonic_us();
+    
+    // Drop reservations for hosts that never came back
+    for (c = kept = 0; c < Pace_slot_count; ++c)
+    {
+	if ( now_us - Pace_slots[c].slot_us < LPJS_PACE_SLOT_EXPIRE )
+	    Pace_slots[kept++] = Pace_slots[c];
+    }
+    Pace_slot_count = kept;
+    
+    for (c = 0; c < Pace_slot_count; ++c)
+    {
+	if ( strcmp(Pace_slots[c].hostname, hostname) == 0 )
+	{
+	    slot = &Pace_slots[c];
+	    break;
+	}
+    }
+    
+    if ( slot != NULL )
+    {
+	// Already counted in the TAT when reserved
+	if ( now_us >= slot->slot_us )
+	{
+	    *slot = Pace_slots[--Pace_slot_count];
+	    return 0;
+	}
+	// Early, e.g. a compd restarted while waiting: Same slot
+	return (slot->slot_us - now_us + 999) / 1000;
+    }
+    
+    if ( Pace_tat_us < now_us )
+	Pace_tat_us = now_us;
+    if ( Pace_tat_us - now_us <= Pace_burst_us )
+    {
+	Pace_tat_us += Pace_interval_us;
+	return 0;
+    }
+    
+    // Over the rate: Reserve the next slot
+    slot_us = Pace_tat_us;
+    Pace_tat_us += Pace_interval_us;
+    if ( Pace_slot_count == Pace_slot_array_size )
+    {
+	Pace_slot_array_size = Pace_slot_array_size == 0 ? 64 :
+			       Pace_slot_array_size * 2;
+	Pace_slots = realloc(Pace_slots,
+			     Pace_slot_array_size * sizeof(*Pace_slots));
+	if ( Pace_slots == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    slot = &Pace_slots[Pace_slot_count++];
+    strlcpy(slot->hostname, hostname, LPJS_HOSTNAME_MAX + 1);
+    slot->slot_us = slot_us;
+    
+    return (slot_us - now_us + 999) / 1000;
+}
+
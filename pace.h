@@ -0,0 +1,33 @@
+#ifndef _LPJS_PACE_H_
+#define _LPJS_PACE_H_
+
+#include <stdint.h>
+#include <stddef.h>     // size_t
+
+#ifndef _LPJS_H_
+#include "lpjs.h"       // LPJS_HOSTNAME_MAX
+#endif
+
+/*
+ *  Pacing of compute node checkins by dispatchd, so that the nodes
+ *  dropped by a restart are let back in at a steady rate instead of
+ *  all at once.  A checkin that would exceed the rate is answered with
+ *  "Retry after ms", reserving the next free time slot for that host,
+ *  and the connection is closed.  Up to one second's worth of checkins
+ *  are admitted without delay, so small clusters are never paced.
+ *  See lpjs_pace_checkin() and lpjs_backoff_*() in network.c.
+ */
+
+#define LPJS_PACE_UNLIMITED     0       // checkin-rate 0
+#define LPJS_PACE_DEFAULT_RATE  100     // Checkins per second
+#define LPJS_PACE_SLOT_EXPIRE   60000000 // us unused before freed
+
+typedef struct
+{
+    char        hostname[LPJS_HOSTNAME_MAX + 1];
+    int64_t     slot_us;        // Monotonic time reserved for this host
+}   pace_slot_t;
+
+#include "pace-protos.h"
+
+#endif  // _LPJS_PACE_H_
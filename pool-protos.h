@@ -0,0 +1,20 @@
+/* pool.c */
+int lpjs_pool_start(int threads);
+int lpjs_pool_done_fd(void);
+bool lpjs_pool_submit(pool_task_t *task);
+pool_task_t *lpjs_pool_next_done(void);
+void *lpjs_pool_worker(void *arg);
+void lpjs_pool_run_task(pool_task_t *task);
+pool_task_t *lpjs_pool_task_new(pool_task_kind_t kind, int msg_fd);
+void lpjs_pool_task_free(pool_task_t *task);
+pool_task_t *lpjs_reply_new(int msg_fd, pool_reply_close_t close);
+void lpjs_reply_add(pool_task_t *reply, const char *text);
+void lpjs_reply_append(pool_task_t *reply, const char *text, size_t len);
+void lpjs_reply_end_chunk(pool_task_t *reply);
+void lpjs_reply_send(pool_task_t *reply);
+void lpjs_reply_print(pool_task_t *reply, FILE *stream);
+void lpjs_reply_hold(pool_task_t *reply, const char *fail_text);
+void lpjs_reply_release(bool committed);
+void lpjs_pool_ring_init(pool_ring_t *ring);
+bool lpjs_pool_ring_push(pool_ring_t *ring, pool_task_t *task);
+pool_task_t *lpjs_pool_ring_pop(pool_ring_t *ring);
@@ -0,0 +1,673 @@
+/***************************************************************************
+ *  Description:
+ *      Worker thread pool for dispatchd.
+ *
+ *      The dispatchd event loop and scheduler remain the only code
+ *      that touches the job and node lists, so none of them need
+ *      locking.  What can be done without them is handed to workers:
+ *
+ *      Receiving a request on a new connection, including the
+ *      credential decode and acknowledgment.  A slow or stalled client
+ *      no longer holds up every other request.  The decoded payload
+ *      comes back to the main thread for processing.
+ *
+ *      Sending a reply, including the credential encode for each
+ *      message, the EOT, and the wait for the client to hang up.  The
+ *      main thread formats the reply into a pool_task_t from its own
+ *      state with lpjs_reply_add(), and a worker sends it.  Listings
+ *      are combined into as few messages as possible, rather than one
+ *      message and acknowledgment per job.
+ *
+ *      Tasks are passed through two bounded lock-free rings: one from
+ *      the main thread to the workers and one back.  Each task queued
+ *      for the workers is matched by one byte written to a pipe, on
+ *      which idle workers block, and the main thread watches a second
+ *      pipe in select() for finished tasks.
+ *
+ *      If the pool is not started, or the ring is full, tasks run
+ *      immediately on the calling thread, as before the pool.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>      // sched_yield()
+#include <signal.h>
+#include <pthread.h>
+
+#include "lpjs.h"
+#include "network.h"
+#include "trace.h"      // lpjs_trace_replaying()
+#include "misc.h"
+#include "pool.h"
+
+#define LPJS_POOL_RING_MASK (LPJS_POOL_RING_SLOTS - 1)
+
+static pool_ring_t  Pool_work,      // Main thread to workers
+		    Pool_done;      // Received requests back to main
+static int          Pool_work_fd[2] = { -1, -1 },
+		    Pool_done_fd[2] = { -1, -1 };
+static unsigned     Pool_threads = 0;
+// Replies waiting for the journal commit, main thread only
+static pool_task_t  *Held_head = NULL,
+		    *Held_tail = NULL;
+
+/***************************************************************************
+ *  Description:
+ *      Start the worker threads.  threads may be LPJS_POOL_THREADS_AUTO
+ *      for one per CPU less one for the main thread, or 0 to run
+ *      everything on the main thread.  Must be called after
+ *      daemonizing, since threads do not survive fork().
+ *
+ *  Returns:
+ *      0 on success, or an errno value
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_pool_start(int threads)
+
+{
+    pthread_t   thread;
+    sigset_t    all_signals, old_mask;
+    long        cpus;
+    int         status = 0;
+
+    if ( threads == LPJS_POOL_THREADS_AUTO )
+    {
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	threads = cpus > 1 ? cpus - 1 : 1;
+    }
+    if ( threads > LPJS_POOL_THREADS_MAX )
+	threads = LPJS_POOL_THREADS_MAX;
+    if ( threads < 1 )
+    {
+	lpjs_log("%s(): Worker threads disabled.\n", __FUNCTION__);
+	return 0;
+    }
+
+    if ( (pipe(Pool_work_fd) != 0) || (pipe(Pool_done_fd) != 0) )
+    {
+	status = errno;
+	lpjs_log("%s(): Error: pipe() failed: %s\n", __FUNCTION__,
+		 strerror(status));
+	return status;
+    }
+    // Workers block on the work pipe.  The main thread must not block
+    // on the done pipe, and a full one means a wakeup is pending.
+    fcntl(Pool_done_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(Pool_done_fd[1], F_SETFL, O_NONBLOCK);
+    fcntl(Pool_work_fd[0], F_SETFD, FD_CLOEXEC);
+    fcntl(Pool_work_fd[1], F_SETFD, FD_CLOEXEC);
+    fcntl(Pool_done_fd[0], F_SETFD, FD_CLOEXEC);
+    fcntl(Pool_done_fd[1], F_SETFD, FD_CLOEXEC);
+    lpjs_pool_ring_init(&Pool_work);
+    lpjs_pool_ring_init(&Pool_done);
+
+    // Workers inherit a full signal mask, so signals go to the main thread
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+    for (Pool_threads = 0; Pool_threads < threads; ++Pool_threads)
+    {
+	if ( (status = pthread_create(&thread, NULL, lpjs_pool_worker,
+				      NULL)) != 0 )
+	{
+	    lpjs_log("%s(): Error: Cannot create worker thread: %s\n",
+		     __FUNCTION__, strerror(status));
+	    break;
+	}
+	pthread_detach(thread);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    lpjs_log("%s(): Started %u worker threads.\n", __FUNCTION__,
+	     Pool_threads);
+    return Pool_threads > 0 ? 0 : status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Descriptor that becomes readable when workers have finished
+ *      tasks for lpjs_pool_next_done(), for select()
+ *
+ *  Returns:
+ *      The descriptor, or -1 if the pool is not running
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_pool_done_fd(void)
+
+{
+    return Pool_threads > 0 ? Pool_done_fd[0] : -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Queue a task for the workers.  Called only by the main thread.
+ *
+ *  Returns:
+ *      true if queued, false if the caller must run it with
+ *      lpjs_pool_run_task(), because the pool is not running or
+ *      all slots are in use
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_pool_submit(pool_task_t *task)
+
+{
+    if ( (Pool_threads == 0) || ! lpjs_pool_ring_push(&Pool_work, task) )
+	return false;
+
+    // One byte per task, so each byte wakes one worker for one task.
+    // Never blocks: The pipe holds far more bytes than the ring tasks.
+    while ( (write(Pool_work_fd[1], "", 1) == -1) && (errno == EINTR) )
+	;
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the next received request from the workers, if any.
+ *      Called only by the main thread.  The wake pipe is emptied
+ *      before the last check of the ring, so a task finished after
+ *      that check always leaves the pipe readable.
+ *
+ *  Returns:
+ *      A LPJS_POOL_TASK_RECV task, or NULL
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+pool_task_t *lpjs_pool_next_done(void)
+
+{
+    pool_task_t *task;
+    char        junk[64];
+
+    if ( Pool_threads == 0 )
+	return NULL;
+    if ( (task = lpjs_pool_ring_pop(&Pool_done)) == NULL )
+    {
+	while ( read(Pool_done_fd[0], junk, sizeof(junk)) > 0 )
+	    ;
+	task = lpjs_pool_ring_pop(&Pool_done);
+    }
+    return task;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Worker thread main loop
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *lpjs_pool_worker(void *arg)
+
+{
+    pool_task_t *task;
+    char        token;
+
+    while ( true )
+    {
+	if ( read(Pool_work_fd[0], &token, 1) != 1 )
+	    continue;   // EINTR
+
+	// The task was published before the byte was written
+	while ( (task = lpjs_pool_ring_pop(&Pool_work)) == NULL )
+	    sched_yield();
+	lpjs_pool_run_task(task);
+
+	if ( task->kind == LPJS_POOL_TASK_REPLY )
+	    lpjs_pool_task_free(task);
+	else
+	{
+	    // Never drop a request: Wait for the main thread to catch up
+	    while ( ! lpjs_pool_ring_push(&Pool_done, task) )
+		sched_yield();
+	    write(Pool_done_fd[1], "", 1);
+	}
+    }
+
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Do the I/O for a task.  Called by workers, and by the main
+ *      thread for tasks that could not be queued.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_pool_run_task(pool_task_t *task)
+
+{
+    char    *msg;
+
+    switch(task->kind)
+    {
+	case    LPJS_POOL_TASK_RECV:
+	    // FIXME: Timeouts temporarily disabled to debug hung connections
+	    // Main thread closes msg_fd on failure, so don't close it here
+	    task->bytes = lpjs_recv_munge(task->msg_fd, &task->payload, 0, 0,
+					  &task->uid, &task->gid, lpjs_no_close);
+	    if ( task->bytes < 1 )
+		task->payload = NULL;   // Nothing allocated
+	    break;
+
+	case    LPJS_POOL_TASK_REPLY:
+	    if ( task->chunk_len > 0 )
+		lpjs_reply_end_chunk(task);
+	    for (msg = task->text; msg < task->text + task->text_len;
+		 msg += strlen(msg) + 1)
+	    {
+		if ( lpjs_send_munge(task->msg_fd, msg, lpjs_no_close)
+		     != LPJS_MSG_SENT )
+		{
+		    lpjs_log("%s(): Error: Failed to send reply on fd = %d.\n",
+			     __FUNCTION__, task->msg_fd);
+		    close(task->msg_fd);
+		    return;
+		}
+	    }
+	    if ( task->close == LPJS_REPLY_EOT )
+		lpjs_dispatchd_safe_close(task->msg_fd);
+	    else if ( ! lpjs_trace_replaying() )   // Nothing open, see trace.c
+	    {
+		lpjs_wait_close(task->msg_fd);
+		close(task->msg_fd);
+	    }
+	    break;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for pool_task_t.  Terminates the process if
+ *      malloc() fails.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+pool_task_t *lpjs_pool_task_new(pool_task_kind_t kind, int msg_fd)
+
+{
+    pool_task_t *task;
+
+    if ( (task = calloc(1, sizeof(*task))) == NULL )
+    {
+	lpjs_log("%s(): Error: calloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    task->kind = kind;
+    task->msg_fd = msg_fd;
+    task->close = LPJS_REPLY_EOT;
+    return task;
+}
+
+
+void    lpjs_pool_task_free(pool_task_t *task)
+
+{
+    free(task->payload);
+    free(task->text);
+    free(task->fail_text);
+    free(task);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Start a reply on msg_fd.  Add messages with lpjs_reply_add()
+ *      and hand it off with lpjs_reply_send() or lpjs_reply_hold().
+ *      A reply with no messages just closes the connection.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+pool_task_t *lpjs_reply_new(int msg_fd, pool_reply_close_t close)
+
+{
+    pool_task_t *reply;
+
+    reply = lpjs_pool_task_new(LPJS_POOL_TASK_REPLY, msg_fd);
+    reply->close = close;
+    return reply;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append text to a reply.  The client prints messages in order,
+ *      so consecutive additions are combined into messages of up to
+ *      LPJS_REPLY_CHUNK_MAX bytes, split at line boundaries.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_add(pool_task_t *reply, const char *text)
+
+{
+    size_t  len, room, take;
+
+    for (len = strlen(text); len > 0; text += take, len -= take)
+    {
+	room = LPJS_REPLY_CHUNK_MAX - reply->chunk_len;
+	if ( len <= room )
+	    take = len;
+	else
+	{
+	    // Break after the last complete line that fits
+	    for (take = room; (take > 0) && (text[take - 1] != '\n'); --take)
+		;
+	    if ( (take == 0) && (reply->chunk_len > 0) )
+	    {
+		// Start the next message with this line
+		lpjs_reply_end_chunk(reply);
+		continue;
+	    }
+	    else if ( take == 0 )
+		take = room;    // One line longer than a message
+	}
+	lpjs_reply_append(reply, text, take);
+	if ( take < len )
+	    lpjs_reply_end_chunk(reply);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Copy len bytes of text to the unfinished message of a reply
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_append(pool_task_t *reply, const char *text, size_t len)
+
+{
+    // Leave room for the NUL from lpjs_reply_end_chunk()
+    if ( reply->text_len + len + 1 > reply->text_size )
+    {
+	while ( reply->text_len + len + 1 > reply->text_size )
+	    reply->text_size = reply->text_size == 0 ? 1024 :
+			       reply->text_size * 2;
+	if ( (reply->text = realloc(reply->text, reply->text_size)) == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    memcpy(reply->text + reply->text_len, text, len);
+    reply->text_len += len;
+    reply->chunk_len += len;
+}
+
+
+void    lpjs_reply_end_chunk(pool_task_t *reply)
+
+{
+    // lpjs_reply_append() always leaves room
+    reply->text[reply->text_len++] = '\0';
+    reply->chunk_len = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Hand a reply to the workers, or send it now if they are busy
+ *      or not running.  The reply must not be used after this.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_send(pool_task_t *reply)
+
+{
+    if ( ! lpjs_pool_submit(reply) )
+    {
+	lpjs_pool_run_task(reply);
+	lpjs_pool_task_free(reply);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print a reply instead of sending it, for commands that format
+ *      it locally from the status board.  The reply is freed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_print(pool_task_t *reply, FILE *stream)
+
+{
+    char    *msg;
+
+    if ( reply->chunk_len > 0 )
+	lpjs_reply_end_chunk(reply);
+    for (msg = reply->text; msg < reply->text + reply->text_len;
+	 msg += strlen(msg) + 1)
+	fputs(msg, stream);
+    lpjs_pool_task_free(reply);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Keep a reply until the journal records it depends on are
+ *      committed, then send it with lpjs_reply_release().  If the
+ *      commit fails, fail_text is sent instead.  This lets all
+ *      requests in one event loop pass share a single fsync(),
+ *      without acknowledging anything that is not on disk.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_hold(pool_task_t *reply, const char *fail_text)
+
+{
+    if ( (reply->fail_text = strdup(fail_text)) == NULL )
+    {
+	lpjs_log("%s(): Error: strdup() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    if ( Held_tail == NULL )
+	Held_head = reply;
+    else
+	Held_tail->next = reply;
+    Held_tail = reply;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send replies held by lpjs_reply_hold(), after the journal
+ *      commit that they wait for
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_reply_release(bool committed)
+
+{
+    pool_task_t *reply, *next;
+
+    for (reply = Held_head; reply != NULL; reply = next)
+    {
+	next = reply->next;
+	reply->next = NULL;
+	if ( ! committed )
+	{
+	    reply->text_len = reply->chunk_len = 0;
+	    lpjs_reply_add(reply, reply->fail_text);
+	}
+	lpjs_reply_send(reply);
+    }
+    Held_head = Held_tail = NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Lock-free bounded ring of tasks, safe for any number of
+ *      producers and consumers.  Each slot sequence number tells
+ *      whether the slot is free for the producer at that position
+ *      or filled for the consumer, as in logger.c.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_pool_ring_init(pool_ring_t *ring)
+
+{
+    size_t  c;
+
+    if ( (ring->slots = malloc(LPJS_POOL_RING_SLOTS * sizeof(*ring->slots)))
+	 == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    for (c = 0; c < LPJS_POOL_RING_SLOTS; ++c)
+	atomic_init(&ring->slots[c].seq, c);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a task at the tail of a ring
+ *
+ *  Returns:
+ *      true, or false if the ring is full
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_pool_ring_push(pool_ring_t *ring, pool_task_t *task)
+
+{
+    pool_slot_t *slot;
+    size_t      pos, seq;
+    intptr_t    diff;
+
+    pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while ( true )
+    {
+	slot = &ring->slots[pos & LPJS_POOL_RING_MASK];
+	seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+	diff = (intptr_t)seq - (intptr_t)pos;
+	if ( diff == 0 )
+	{
+	    if ( atomic_compare_exchange_weak_explicit(&ring->tail, &pos,
+		    pos + 1, memory_order_relaxed, memory_order_relaxed) )
+		break;
+	}
+	else if ( diff < 0 )
+	    return false;
+	else
+	    pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+
+    slot->task = task;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the task at the head of a ring
+ *
+ *  Returns:
+ *      The oldest task, or NULL if the ring is empty
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+pool_task_t *lpjs_pool_ring_pop(pool_ring_t *ring)
+
+{
+    pool_slot_t *slot;
+    pool_task_t *task;
+    size_t      pos, seq;
+    intptr_t    diff;
+
+    pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while ( true )
+    {
+	slot = &ring->slots[pos & LPJS_POOL_RING_MASK];
+	seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+	diff = (intptr_t)seq - (intptr_t)(pos + 1);
+	if ( diff == 0 )
+	{
+	    if ( atomic_compare_exchange_weak_explicit(&ring->head, &pos,
+		    pos + 1, memory_order_relaxed, memory_order_relaxed) )
+		break;
+	}
+	else if ( diff < 0 )
+	    return NULL;
+	else
+	    pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    }
+
+    task = slot->task;
+    // Free the slot for the next pass around the ring
+    atomic_store_explicit(&slot->seq, pos + LPJS_POOL_RING_SLOTS,
+			  memory_order_release);
+    return task;
+}
@@ -0,0 +1,77 @@
+#ifndef _LPJS_POOL_H_
+#define _LPJS_POOL_H_
+
+#include <stdio.h>      // FILE
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/types.h>  // ssize_t, uid_t, gid_t
+#include <time.h>       // struct timespec
+
+/*
+ *  Worker threads for dispatchd.  The main thread keeps sole ownership
+ *  of the job and node lists.  Workers only read and decode requests
+ *  on new connections, and encode and send replies that the main
+ *  thread has already formatted, so they share no dispatchd state.
+ *  Tasks go to the workers and come back through bounded lock-free
+ *  rings, using the same slot sequence scheme as the log ring in
+ *  logger.h.  See pool.c.
+ */
+
+#define LPJS_POOL_RING_SLOTS    1024    // Must be a power of 2
+#define LPJS_POOL_THREADS_MAX   64
+#define LPJS_POOL_THREADS_AUTO  -1      // One per CPU, less the main thread
+#define LPJS_POOL_SOURCE_MAX    64      // Peer address, for captures
+#define LPJS_REPLY_CHUNK_MAX    8192    // Max bytes per reply message
+
+typedef enum
+{
+    LPJS_POOL_TASK_RECV,        // Read and decode a request
+    LPJS_POOL_TASK_REPLY        // Send a reply and close the connection
+}   pool_task_kind_t;
+
+// How a reply ends the connection
+typedef enum
+{
+    LPJS_REPLY_EOT,             // Send EOT, wait for the client to hang up
+    LPJS_REPLY_WAIT             // Just wait for the client to hang up
+}   pool_reply_close_t;
+
+typedef struct pool_task
+{
+    struct pool_task    *next;  // Replies held for the journal commit
+    pool_task_kind_t    kind;
+    int                 msg_fd;
+    struct timespec     start;  // Connection accepted
+    char                source[LPJS_POOL_SOURCE_MAX + 1];
+
+    // LPJS_POOL_TASK_RECV results
+    ssize_t             bytes;  // lpjs_recv_munge() return value
+    char                *payload;
+    uid_t               uid;
+    gid_t               gid;
+
+    // LPJS_POOL_TASK_REPLY: Messages, each NUL-terminated
+    pool_reply_close_t  close;
+    char                *text,
+			*fail_text;     // Sent instead if the commit fails
+    size_t              text_len,
+			text_size,
+			chunk_len;      // Length of the unfinished message
+}   pool_task_t;
+
+typedef struct
+{
+    atomic_size_t   seq;
+    pool_task_t     *task;
+}   pool_slot_t;
+
+typedef struct
+{
+    pool_slot_t                 *slots;
+    _Alignas(64) atomic_size_t  tail;
+    _Alignas(64) atomic_size_t  head;
+}   pool_ring_t;
+
+#include "pool-protos.h"
+
+#endif  // _LPJS_POOL_H_
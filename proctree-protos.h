@@ -0,0 +1,15 @@
+/* proctree.c */
+proctree_t *proctree_new(void);
+void proctree_free(proctree_t *tree);
+proctree_proc_t *proctree_add(proctree_t *tree, pid_t pid, pid_t ppid, pid_t pgid, size_t rss_KiB, bool zombie);
+int proctree_pid_cmp(const void *a, const void *b);
+int proctree_load(proctree_t *tree);
+proctree_proc_t *proctree_find(proctree_t *tree, pid_t pid);
+bool proctree_is_descendant(proctree_t *tree, pid_t pid, pid_t ancestor);
+size_t proctree_rss_KiB(proctree_t *tree, pid_t root);
+double proctree_cpu_sec(proctree_t *tree, pid_t root);
+int proctree_io_bytes(pid_t pid, uint64_t *read_bytes, uint64_t *write_bytes);
+proctree_t *proctree_family(pid_t root);
+unsigned proctree_signal(proctree_t *tree, int sig);
+unsigned proctree_signal_family(pid_t root, int sig);
+unsigned proctree_terminate(pid_t root, unsigned grace_sec);
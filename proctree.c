@@ -0,0 +1,596 @@
+/***************************************************************************
+ *  Description:
+ *      Snapshot of the processes on a compute node, for finding the
+ *      processes belonging to each job.  See proctree.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>     // PATH_MAX
+#include <sysexits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#if defined(__FreeBSD__)
+#include <sys/sysctl.h>
+#include <sys/user.h>       // struct kinfo_proc
+#include <sys/proc.h>       // SZOMB
+#elif defined(__linux__)
+#include <dirent.h>
+#include <ctype.h>
+#endif
+
+#include "lpjs.h"
+#include "misc.h"
+#include "proctree.h"
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for proctree_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+proctree_t  *proctree_new(void)
+
+{
+    proctree_t  *tree;
+
+    if ( (tree = malloc(sizeof(*tree))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    tree->count = 0;
+    tree->array_size = 0;
+    tree->procs = NULL;
+
+    return tree;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Destructor for proctree_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    proctree_free(proctree_t *tree)
+
+{
+    free(tree->procs);
+    free(tree);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a process to the snapshot
+ *
+ *  Returns:
+ *      The new entry, for filling in the remaining fields
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Return the entry
+ ***************************************************************************/
+
+proctree_proc_t *proctree_add(proctree_t *tree, pid_t pid, pid_t ppid,
+			      pid_t pgid, size_t rss_KiB, bool zombie)
+
+{
+    proctree_proc_t *proc;
+
+    if ( tree->count == tree->array_size )
+    {
+	tree->array_size = (tree->array_size == 0) ? 256 :
+			   tree->array_size * 2;
+	tree->procs = realloc(tree->procs,
+			      tree->array_size * sizeof(*tree->procs));
+	if ( tree->procs == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    proc = &tree->procs[tree->count++];
+    proc->pid = pid;
+    proc->ppid = ppid;
+    proc->pgid = pgid;
+    proc->rss_KiB = rss_KiB;
+    proc->cpu_sec = 0.0;
+    proc->threads = 1;
+    proc->zombie = zombie;
+    return proc;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      qsort() and bsearch() comparison by pid
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     proctree_pid_cmp(const void *a, const void *b)
+
+{
+    pid_t   pid_a = ((const proctree_proc_t *)a)->pid,
+	    pid_b = ((const proctree_proc_t *)b)->pid;
+
+    return (pid_a > pid_b) - (pid_a < pid_b);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Replace the snapshot with the processes running now.  Processes
+ *      that exit while it is being taken are skipped.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if the process table could
+ *      not be read, in which case the snapshot is empty
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add CPU time and threads
+ ***************************************************************************/
+
+int     proctree_load(proctree_t *tree)
+
+{
+    tree->count = 0;
+
+#if defined(__FreeBSD__)
+    int                 mib[3] = { CTL_KERN, KERN_PROC, KERN_PROC_PROC };
+    struct kinfo_proc   *kp = NULL;
+    proctree_proc_t     *proc;
+    size_t              len, c;
+    long                page_KiB = getpagesize() / 1024;
+
+    // The table may grow between the two calls
+    do
+    {
+	if ( sysctl(mib, 3, NULL, &len, NULL, 0) != 0 )
+	{
+	    free(kp);
+	    return LPJS_READ_FAILED;
+	}
+	len += len / 8;
+	if ( (kp = realloc(kp, len)) == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }   while ( (sysctl(mib, 3, kp, &len, NULL, 0) != 0) && (errno == ENOMEM) );
+
+    for (c = 0; c < len / sizeof(*kp); ++c)
+    {
+	proc = proctree_add(tree, kp[c].ki_pid, kp[c].ki_ppid, kp[c].ki_pgid,
+			    kp[c].ki_rssize * page_KiB,
+			    kp[c].ki_stat == SZOMB);
+	proc->cpu_sec = TIMEVAL_SEC(kp[c].ki_rusage.ru_utime) +
+			TIMEVAL_SEC(kp[c].ki_rusage.ru_stime) +
+			TIMEVAL_SEC(kp[c].ki_rusage_ch.ru_utime) +
+			TIMEVAL_SEC(kp[c].ki_rusage_ch.ru_stime);
+	proc->threads = kp[c].ki_numthreads;
+    }
+    free(kp);
+
+#elif defined(__linux__)
+    DIR             *dir;
+    struct dirent   *entry;
+    FILE            *fp;
+    proctree_proc_t *proc;
+    char            path[PATH_MAX + 1],
+		    stat_line[1024],
+		    *p,
+		    state;
+    int             ppid, pgid;
+    unsigned long   utime, stime;
+    long            cutime, cstime, threads, rss_pages,
+		    page_KiB = sysconf(_SC_PAGESIZE) / 1024;
+    double          clk_tck = sysconf(_SC_CLK_TCK);
+
+    if ( (dir = opendir("/proc")) == NULL )
+	return LPJS_READ_FAILED;
+    while ( (entry = readdir(dir)) != NULL )
+    {
+	if ( ! isdigit((unsigned char)entry->d_name[0]) )
+	    continue;
+	snprintf(path, PATH_MAX + 1, "/proc/%s/stat", entry->d_name);
+	if ( (fp = fopen(path, "r")) == NULL )
+	    continue;
+	p = fgets(stat_line, sizeof(stat_line), fp);
+	fclose(fp);
+
+	// The command name is in parentheses and may contain anything
+	if ( (p == NULL) || ((p = strrchr(stat_line, ')')) == NULL) )
+	    continue;
+	// Fields 3 to 24 of proc(5)
+	if ( sscanf(p + 2, "%c %d %d %*s %*s %*s %*s %*s %*s %*s %*s"
+		    " %lu %lu %ld %ld %*s %*s %ld %*s %*s %*s %ld",
+		    &state, &ppid, &pgid, &utime, &stime, &cutime, &cstime,
+		    &threads, &rss_pages) == 9 )
+	{
+	    proc = proctree_add(tree, atoi(entry->d_name), ppid, pgid,
+				rss_pages * page_KiB, state == 'Z');
+	    proc->cpu_sec = (utime + stime + cutime + cstime) / clk_tck;
+	    proc->threads = threads;
+	}
+    }
+    closedir(dir);
+
+#else
+    return LPJS_READ_FAILED;
+#endif
+
+    qsort(tree->procs, tree->count, sizeof(*tree->procs), proctree_pid_cmp);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Look up a process in the snapshot
+ *
+ *  Returns:
+ *      Pointer to the process, or NULL if it is not in the snapshot
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+proctree_proc_t *proctree_find(proctree_t *tree, pid_t pid)
+
+{
+    proctree_proc_t key;
+
+    key.pid = pid;
+    return bsearch(&key, tree->procs, tree->count, sizeof(*tree->procs),
+		   proctree_pid_cmp);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether pid is ancestor or one of its descendants
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    proctree_is_descendant(proctree_t *tree, pid_t pid, pid_t ancestor)
+
+{
+    proctree_proc_t *proc;
+    unsigned        depth;
+
+    for (depth = 0; (pid > 1) && (depth < PROCTREE_MAX_DEPTH); ++depth)
+    {
+	if ( pid == ancestor )
+	    return true;
+	if ( (proc = proctree_find(tree, pid)) == NULL )
+	    return false;
+	pid = proc->ppid;
+    }
+    return false;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Total resident memory of a process and all of its descendants
+ *
+ *  Returns:
+ *      RSS in KiB, 0 if root is not running
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  proctree_rss_KiB(proctree_t *tree, pid_t root)
+
+{
+    size_t  c, rss_KiB = 0;
+
+    for (c = 0; c < tree->count; ++c)
+	if ( proctree_is_descendant(tree, tree->procs[c].pid, root) )
+	    rss_KiB += tree->procs[c].rss_KiB;
+    return rss_KiB;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Total CPU time of root and its descendants in the snapshot,
+ *      including children they have reaped
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+double  proctree_cpu_sec(proctree_t *tree, pid_t root)
+
+{
+    size_t  c;
+    double  cpu_sec = 0.0;
+
+    for (c = 0; c < tree->count; ++c)
+	if ( proctree_is_descendant(tree, tree->procs[c].pid, root) )
+	    cpu_sec += tree->procs[c].cpu_sec;
+    return cpu_sec;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Bytes a process has read from and written to storage, including
+ *      children it has reaped.  Reads through the page cache do not
+ *      count.  Linux only, from /proc/pid/io, which is readable by
+ *      the process owner and root.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if not available
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     proctree_io_bytes(pid_t pid, uint64_t *read_bytes,
+			  uint64_t *write_bytes)
+
+{
+#if defined(__linux__)
+    FILE        *fp;
+    char        path[PATH_MAX + 1],
+		line[128];
+    uintmax_t   value;
+    int         found = 0;
+
+    snprintf(path, PATH_MAX + 1, "/proc/%d/io", pid);
+    if ( (fp = fopen(path, "r")) == NULL )
+	return LPJS_READ_FAILED;
+    while ( fgets(line, sizeof(line), fp) != NULL )
+    {
+	if ( sscanf(line, "read_bytes: %ju", &value) == 1 )
+	{
+	    *read_bytes = value;
+	    ++found;
+	}
+	else if ( sscanf(line, "write_bytes: %ju", &value) == 1 )
+	{
+	    *write_bytes = value;
+	    ++found;
+	}
+    }
+    fclose(fp);
+    return found == 2 ? LPJS_SUCCESS : LPJS_READ_FAILED;
+#else
+    return LPJS_READ_FAILED;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find root and all of its descendants running now, e.g. to
+ *      signal them again after their ancestry is lost
+ *
+ *  Returns:
+ *      A new snapshot holding only them, empty if the process table
+ *      could not be read
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+proctree_t  *proctree_family(pid_t root)
+
+{
+    // Terminates process if malloc() fails, no check required
+    proctree_t      *tree = proctree_new(),
+		    *family = proctree_new();
+    proctree_proc_t *proc;
+    size_t          c;
+
+    if ( proctree_load(tree) == LPJS_SUCCESS )
+    {
+	// Already sorted by PID
+	for (c = 0; c < tree->count; ++c)
+	{
+	    proc = &tree->procs[c];
+	    if ( ! proc->zombie &&
+		 proctree_is_descendant(tree, proc->pid, root) )
+		*proctree_add(family, proc->pid, proc->ppid, proc->pgid,
+			      proc->rss_KiB, false) = *proc;
+	}
+    }
+    proctree_free(tree);
+    return family;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send a signal to every process in a snapshot
+ *
+ *  Returns:
+ *      The number of processes signaled
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    proctree_signal(proctree_t *tree, int sig)
+
+{
+    size_t      c;
+    unsigned    signaled = 0;
+
+    for (c = 0; c < tree->count; ++c)
+	if ( kill(tree->procs[c].pid, sig) == 0 )
+	    ++signaled;
+    return signaled;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send a signal to root and all of its descendants running now
+ *
+ *  Returns:
+ *      The number of processes signaled
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    proctree_signal_family(pid_t root, int sig)
+
+{
+    proctree_t  *family = proctree_family(root);
+    unsigned    signaled;
+
+    signaled = proctree_signal(family, sig);
+    proctree_free(family);
+    return signaled;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Terminate root and all of its descendants within about
+ *      grace_sec seconds, for canceling a job.  See proctree.h.
+ *
+ *      The family is found while stopped, so members that have left
+ *      the job's process group are found as long as their ancestry
+ *      is intact, and none can fork a process that is missed.  Once
+ *      stopped, they are remembered by PID, since their ancestry is
+ *      lost as soon as their parents exit.  A PID reused by another
+ *      process within the grace period could be killed in error, as
+ *      with any PID-based kill.
+ *
+ *  Returns:
+ *      The number of processes that had to be killed with SIGKILL
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+unsigned    proctree_terminate(pid_t root, unsigned grace_sec)
+
+{
+    // Terminates process if malloc() fails, no check required
+    proctree_t  *tree = proctree_new(),
+		*family = proctree_new();
+    proctree_proc_t *proc;
+    size_t      c, found, pass;
+    unsigned    alive, killed = 0;
+    int64_t     deadline;
+    bool        snapshot = true;
+
+    for (pass = 0; pass < PROCTREE_STOP_PASSES; ++pass)
+    {
+	if ( proctree_load(tree) != LPJS_SUCCESS )
+	{
+	    // No process table here: root is all we can find
+	    snapshot = false;
+	    if ( family->count == 0 )
+		proctree_add(family, root, 0, root, 0, false);
+	    kill(root, SIGSTOP);
+	    break;
+	}
+	for (c = found = 0; c < tree->count; ++c)
+	{
+	    proc = &tree->procs[c];
+	    if ( proctree_is_descendant(tree, proc->pid, root) &&
+		 ! proc->zombie &&
+		 (proctree_find(family, proc->pid) == NULL) )
+	    {
+		kill(proc->pid, SIGSTOP);
+		proctree_add(family, proc->pid, proc->ppid, proc->pgid, 0,
+			     false);
+		// Kept sorted for proctree_find()
+		qsort(family->procs, family->count, sizeof(*family->procs),
+		      proctree_pid_cmp);
+		++found;
+	    }
+	}
+	if ( found == 0 )
+	    break;
+    }
+
+    lpjs_log("%s(): Terminating %zu processes under %d...\n", __FUNCTION__,
+	     family->count, root);
+    for (c = 0; c < family->count; ++c)
+	kill(family->procs[c].pid, SIGTERM);
+    for (c = 0; c < family->count; ++c)
+	kill(family->procs[c].pid, SIGCONT);
+
+    // Zombies are done, though not reaped by their parents yet
+    deadline = lpjs_time_us() + (int64_t)grace_sec * 1000000;
+    do
+    {
+	usleep(PROCTREE_POLL_US);
+	if ( snapshot && (proctree_load(tree) != LPJS_SUCCESS) )
+	    snapshot = false;
+	for (c = alive = 0; c < family->count; ++c)
+	{
+	    proc = proctree_find(tree, family->procs[c].pid);
+	    if ( ! snapshot || ((proc != NULL) && ! proc->zombie) )
+		++alive;
+	}
+    }   while ( (alive > 0) && (lpjs_time_us() < deadline) );
+
+    // Survivors, and anything they started during the grace period
+    if ( snapshot )
+    {
+	for (c = 0; c < tree->count; ++c)
+	{
+	    proc = &tree->procs[c];
+	    if ( ! proc->zombie &&
+		 ((proctree_find(family, proc->pid) != NULL) ||
+		  proctree_is_descendant(tree, proc->pid, root)) &&
+		 (kill(proc->pid, SIGKILL) == 0) )
+		++killed;
+	}
+    }
+    else
+    {
+	for (c = 0; c < family->count; ++c)
+	    if ( kill(family->procs[c].pid, SIGKILL) == 0 )
+		++killed;
+    }
+    if ( killed > 0 )
+	lpjs_log("%s(): Killed %u processes still running after %u seconds.\n",
+		 __FUNCTION__, killed, grace_sec);
+
+    proctree_free(tree);
+    proctree_free(family);
+    return killed;
+}
@@ -0,0 +1,54 @@
+#ifndef _LPJS_PROCTREE_H_
+#define _LPJS_PROCTREE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>  // pid_t
+
+/*
+ *  Snapshot of all processes on this host, for finding everything a
+ *  job has started.  Jobs run in their own process group, but their
+ *  processes may leave it with setsid() or setpgid(), so processes are
+ *  matched to a job by following parent PIDs up to the job's
+ *  chaperone or script.  Orphans reparented to init are lost this way,
+ *  as they are to everything short of cgroups or jails.
+ *
+ *  Read from /proc on Linux and sysctl() on FreeBSD.  Elsewhere the
+ *  snapshot is empty.  See proctree.c.  CPU time includes children
+ *  that have been reaped, so the total for a job's processes covers
+ *  those that have exited as well, unless orphaned first.
+ *
+ *  proctree_terminate() kills a job's whole family at once when it is
+ *  canceled: stop every member so none can fork unseen, SIGTERM and
+ *  SIGCONT them all, wait up to one grace period for them to exit,
+ *  then SIGKILL what is left.
+ */
+
+#define PROCTREE_MAX_DEPTH      256     // Guards against cycles from PID reuse
+#define PROCTREE_STOP_PASSES    8       // Snapshots to catch forks in flight
+#define PROCTREE_POLL_US        100000  // Checks for exits during grace
+#define LPJS_CANCEL_GRACE       2       // Seconds from SIGTERM to SIGKILL
+
+#define TIMEVAL_SEC(tv)         ((tv).tv_sec + (tv).tv_usec / 1000000.0)
+
+typedef struct
+{
+    pid_t           pid;
+    pid_t           ppid;
+    pid_t           pgid;
+    size_t          rss_KiB;
+    double          cpu_sec;    // User + system, with reaped children
+    unsigned        threads;
+    bool            zombie;     // Exited, not yet reaped
+}   proctree_proc_t;
+
+typedef struct
+{
+    size_t          count;
+    size_t          array_size;
+    proctree_proc_t *procs;     // Sorted by pid
+}   proctree_t;
+
+#include "proctree-protos.h"
+
+#endif  // _LPJS_PROCTREE_H_
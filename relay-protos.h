@@ -0,0 +1,17 @@
+/* relay.c */
+relay_t *relay_new(void);
+relay_report_t *relay_append(relay_report_t **reports, size_t *count, size_t *array_size);
+int relay_listen(relay_t *relay);
+int relay_join_socket_group(void);
+int relay_peer_uid(int fd, uid_t *uid);
+bool relay_report_permitted(relay_report_t *report, inventory_t *inventory);
+void relay_poll_fds(relay_t *relay, struct pollfd **poll_fds, size_t *poll_fds_size, nfds_t *nfds);
+int relay_read_report(relay_report_t *report);
+void relay_check(relay_t *relay, int compd_msg_fd, inventory_t *inventory);
+void relay_add(relay_t *relay, const char *record, unsigned long release_job_id);
+void relay_send(relay_t *relay, int compd_msg_fd);
+void relay_ack(relay_t *relay, const char *payload, int compd_msg_fd, inventory_t *inventory);
+void relay_requeue(relay_t *relay, int compd_msg_fd);
+bool relay_is_report(int code);
+int lpjs_relay_report(const char *record);
+void lpjs_relay_report_loop(const char *record);
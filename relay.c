@@ -0,0 +1,741 @@
+/***************************************************************************
+ *  Description:
+ *      Relay of job reports from chaperones through lpjs_compd.
+ *
+ *      A chaperone used to open a new connection to dispatchd, with a
+ *      munge round trip, for each launch status, start, and completion
+ *      report.  When many short jobs finish together, that becomes a
+ *      storm of connections on dispatchd's listening socket.  Instead,
+ *      chaperones hand reports to compd over a local UNIX socket, and
+ *      compd forwards them in batches on the connection it already
+ *      holds to dispatchd.  See relay.h for the protocol.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>   // chmod()
+#include <sys/un.h>
+#include <grp.h>        // getgrnam(), setgroups()
+
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "misc.h"
+#include "network.h"
+#include "config.h"
+#include "inventory.h"
+#include "relay.h"
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for relay_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+relay_t *relay_new(void)
+
+{
+    relay_t *relay;
+
+    if ( (relay = malloc(sizeof(*relay))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    relay->listen_fd = -1;
+    relay->receiving = NULL;
+    relay->receiving_count = 0;
+    relay->receiving_size = 0;
+    relay->queue = NULL;
+    relay->queue_count = 0;
+    relay->queue_size = 0;
+    relay->sent_count = 0;
+    relay->batch = 0;
+    relay->sent_time = 0;
+
+    return relay;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Make room for one more report at the end of an array
+ *
+ *  Returns:
+ *      Address of the new report
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+relay_report_t  *relay_append(relay_report_t **reports, size_t *count,
+			      size_t *array_size)
+
+{
+    if ( *count == *array_size )
+    {
+	*array_size = (*array_size == 0) ? 64 : *array_size * 2;
+	*reports = realloc(*reports, *array_size * sizeof(**reports));
+	if ( *reports == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    return &(*reports)[(*count)++];
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create the UNIX socket chaperones report to.  Chaperones run as
+ *      the job owner, so when compd runs as root, the socket is mode
+ *      0660 and owned by Config.compd_socket_group, which job processes
+ *      are added to by relay_join_socket_group().  Otherwise, it is
+ *      mode 0600, as jobs run as the same user as compd.  Who may
+ *      report on which job is checked by relay_check().  A stale socket
+ *      from a previous compd is replaced.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the socket cannot be
+ *      created or the group does not exist
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Limit access to compd-socket-group
+ ***************************************************************************/
+
+int     relay_listen(relay_t *relay)
+
+{
+    struct sockaddr_un  addr;
+    struct group        *gr_ent = NULL;
+    mode_t              old_mask;
+    int                 status;
+    extern lpjs_config_t    Config;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if ( strlcpy(addr.sun_path, LPJS_COMPD_SOCKET, sizeof(addr.sun_path))
+	 >= sizeof(addr.sun_path) )
+    {
+	lpjs_log("%s(): Error: Socket path too long: %s\n", __FUNCTION__,
+		 LPJS_COMPD_SOCKET);
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( (getuid() == 0) &&
+	 ((gr_ent = getgrnam(Config.compd_socket_group)) == NULL) )
+    {
+	lpjs_log("%s(): Error: compd-socket-group %s: No such group.\n",
+		 __FUNCTION__, Config.compd_socket_group);
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( (relay->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 )
+    {
+	lpjs_log("%s(): Error: socket() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    fcntl(relay->listen_fd, F_SETFL, O_NONBLOCK);
+    fcntl(relay->listen_fd, F_SETFD, FD_CLOEXEC);
+
+    // Created 0600, so it is never open to others
+    unlink(LPJS_COMPD_SOCKET);
+    old_mask = umask(0177);
+    status = bind(relay->listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+    if ( (status != 0) ||
+	 ((gr_ent != NULL) &&
+	  ((chown(LPJS_COMPD_SOCKET, 0, gr_ent->gr_gid) != 0) ||
+	   (chmod(LPJS_COMPD_SOCKET, 0660) != 0))) ||
+	 (listen(relay->listen_fd, LPJS_CONNECTION_QUEUE_MAX) != 0) )
+    {
+	lpjs_log("%s(): Error: Cannot listen on %s: %s\n", __FUNCTION__,
+		 LPJS_COMPD_SOCKET, strerror(errno));
+	close(relay->listen_fd);
+	relay->listen_fd = -1;
+	return LPJS_WRITE_FAILED;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add Config.compd_socket_group to the supplementary groups of a
+ *      job process, so the chaperone can report to compd after
+ *      switching to the job owner.  Must be called while still root.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the groups cannot be set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     relay_join_socket_group(void)
+
+{
+    struct group    *gr_ent;
+    gid_t           *groups;
+    int             count, max = sysconf(_SC_NGROUPS_MAX);
+    extern lpjs_config_t    Config;
+
+    if ( (gr_ent = getgrnam(Config.compd_socket_group)) == NULL )
+    {
+	lpjs_log("%s(): Error: compd-socket-group %s: No such group.\n",
+		 __FUNCTION__, Config.compd_socket_group);
+	return LPJS_WRITE_FAILED;
+    }
+
+    if ( (groups = malloc((max + 1) * sizeof(*groups))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    if ( (count = getgroups(max, groups)) == -1 )
+    {
+	lpjs_log("%s(): Error: getgroups() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	free(groups);
+	return LPJS_WRITE_FAILED;
+    }
+    groups[count++] = gr_ent->gr_gid;
+    if ( setgroups(count, groups) != 0 )
+    {
+	lpjs_log("%s(): Error: setgroups() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	free(groups);
+	return LPJS_WRITE_FAILED;
+    }
+    free(groups);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Get the user ID of the process at the other end of a chaperone
+ *      connection, from the kernel, so it cannot be forged
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if it is not available
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     relay_peer_uid(int fd, uid_t *uid)
+
+{
+#ifdef __linux__
+    struct ucred    cred;
+    socklen_t       len = sizeof(cred);
+
+    if ( getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 )
+	return LPJS_READ_FAILED;
+    *uid = cred.uid;
+#else
+    gid_t           gid;
+
+    if ( getpeereid(fd, uid, &gid) != 0 )
+	return LPJS_READ_FAILED;
+#endif
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check that a chaperone may send a report: root may report on
+ *      any job, other users only on jobs in the inventory that run as
+ *      them.  The job ID follows the request code in a launch status
+ *      report, and the hostname in others.
+ *
+ *  Returns:
+ *      true if the report is accepted
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    relay_report_permitted(relay_report_t *report, inventory_t *inventory)
+
+{
+    unsigned long   job_id;
+    size_t          c;
+    int             fields;
+
+    if ( report->peer_uid == 0 )
+	return true;
+
+    if ( report->record[0] == LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS )
+	fields = sscanf(report->record + 1, "%lu", &job_id);
+    else
+	fields = sscanf(report->record + 1, "%*s %lu", &job_id);
+
+    if ( (fields != 1) ||
+	 ((c = inventory_find(inventory, job_id)) == INVENTORY_NOT_FOUND) ||
+	 (inventory->entries[c].uid != report->peer_uid) )
+    {
+	lpjs_log("%s(): Error: Rejected report from uid %u: %s\n",
+		 __FUNCTION__, (unsigned)report->peer_uid, report->record);
+	return false;
+    }
+
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add the listening socket and chaperones still sending to the
+ *      poll() array of the compd event loop, growing it if needed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    relay_poll_fds(relay_t *relay, struct pollfd **poll_fds,
+		       size_t *poll_fds_size, nfds_t *nfds)
+
+{
+    size_t  c, n = *nfds;
+
+    if ( *poll_fds_size < n + relay->receiving_count + 1 )
+    {
+	*poll_fds_size = n + relay->receiving_count + 64;
+	*poll_fds = realloc(*poll_fds, *poll_fds_size * sizeof(**poll_fds));
+	if ( *poll_fds == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+
+    if ( relay->listen_fd != -1 )
+    {
+	(*poll_fds)[n].fd = relay->listen_fd;
+	(*poll_fds)[n].events = POLLIN;
+	(*poll_fds)[n++].revents = 0;
+    }
+    for (c = 0; c < relay->receiving_count; ++c)
+    {
+	(*poll_fds)[n].fd = relay->receiving[c].fd;
+	(*poll_fds)[n].events = POLLIN;
+	(*poll_fds)[n++].revents = 0;
+    }
+    *nfds = n;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read what is available of a report, without blocking
+ *
+ *  Returns:
+ *      1 if the report is complete, 0 if more is expected, -1 if the
+ *      connection should be dropped
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     relay_read_report(relay_report_t *report)
+
+{
+    ssize_t bytes;
+    char    *end;
+
+    bytes = read(report->fd, report->record + report->len,
+		 RELAY_RECORD_MAX + 1 - report->len);
+    if ( bytes == -1 )
+	return (errno == EAGAIN) || (errno == EINTR) ? 0 : -1;
+    else if ( bytes == 0 )
+	return -1;
+
+    report->len += bytes;
+    report->record[report->len] = '\0';
+    if ( (end = memchr(report->record, '\n', report->len)) == NULL )
+    {
+	if ( report->len > RELAY_RECORD_MAX )
+	{
+	    lpjs_log("%s(): Error: Report longer than %d bytes.\n",
+		     __FUNCTION__, RELAY_RECORD_MAX);
+	    return -1;
+	}
+	return 0;
+    }
+
+    *end = '\0';
+    report->len = end - report->record;
+    if ( ! relay_is_report(report->record[0]) )
+    {
+	lpjs_log("%s(): Error: Invalid report code: %d\n", __FUNCTION__,
+		 report->record[0]);
+	return -1;
+    }
+
+    return 1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Called on every pass of the compd event loop: Accept chaperone
+ *      connections, queue completed reports from permitted users, and
+ *      send a batch if none is awaiting acknowledgement.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Check the user of each chaperone
+ ***************************************************************************/
+
+void    relay_check(relay_t *relay, int compd_msg_fd, inventory_t *inventory)
+
+{
+    int             fd, status;
+    size_t          c, kept;
+    time_t          now = time(NULL);
+    relay_report_t  *report;
+    uid_t           peer_uid;
+
+    if ( relay->listen_fd != -1 )
+    {
+	while ( (fd = accept(relay->listen_fd, NULL, NULL)) != -1 )
+	{
+	    if ( relay_peer_uid(fd, &peer_uid) != LPJS_SUCCESS )
+	    {
+		lpjs_log("%s(): Error: Cannot get chaperone uid: %s\n",
+			 __FUNCTION__, strerror(errno));
+		close(fd);
+		continue;
+	    }
+	    fcntl(fd, F_SETFL, O_NONBLOCK);
+	    fcntl(fd, F_SETFD, FD_CLOEXEC);
+	    report = relay_append(&relay->receiving, &relay->receiving_count,
+				  &relay->receiving_size);
+	    report->fd = fd;
+	    report->peer_uid = peer_uid;
+	    report->len = 0;
+	    report->accept_time = now;
+	    report->release_job_id = 0;
+	}
+    }
+
+    // Queue in order of completion, not connection
+    for (c = kept = 0; c < relay->receiving_count; ++c)
+    {
+	report = &relay->receiving[c];
+	status = relay_read_report(report);
+	if ( (status == 0) && (now - report->accept_time > RELAY_ACK_TIMEOUT) )
+	{
+	    lpjs_log("%s(): Error: Timed out reading report.\n", __FUNCTION__);
+	    status = -1;
+	}
+	else if ( (status == 1) &&
+		  ! relay_report_permitted(report, inventory) )
+	    status = -1;
+
+	if ( status == 1 )
+	    *relay_append(&relay->queue, &relay->queue_count,
+			  &relay->queue_size) = *report;
+	else if ( status == -1 )
+	    close(report->fd);
+	else
+	    relay->receiving[kept++] = *report;
+    }
+    relay->receiving_count = kept;
+
+    relay_send(relay, compd_msg_fd);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Queue a report from compd itself.  If release_job_id is not 0,
+ *      that job's inventory entry is removed once dispatchd has the
+ *      report.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    relay_add(relay_t *relay, const char *record,
+		  unsigned long release_job_id)
+
+{
+    relay_report_t  *report;
+
+    report = relay_append(&relay->queue, &relay->queue_count,
+			  &relay->queue_size);
+    report->fd = RELAY_NO_CLIENT;
+    report->peer_uid = 0;
+    report->len = strlcpy(report->record, record, RELAY_RECORD_MAX + 1);
+    report->accept_time = time(NULL);
+    report->release_job_id = release_job_id;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send queued reports to dispatchd in one message, unless a batch
+ *      is already awaiting acknowledgement.  A batch not acknowledged
+ *      within RELAY_ACK_TIMEOUT is sent again.  dispatchd tolerates
+ *      duplicate reports.  No verification reply is awaited, since
+ *      dispatchd may be sending a job or cancel at the same time.  The
+ *      acknowledgement arrives as a message of its own, handled by the
+ *      compd event loop.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Don't wait for a verification reply
+ ***************************************************************************/
+
+void    relay_send(relay_t *relay, int compd_msg_fd)
+
+{
+    char    outgoing_msg[LPJS_MSG_LEN_MAX + 1];
+    size_t  c, len;
+    time_t  now = time(NULL);
+
+    if ( relay->queue_count == 0 )
+	return;
+
+    if ( relay->sent_count > 0 )
+    {
+	if ( now - relay->sent_time < RELAY_ACK_TIMEOUT )
+	    return;
+	lpjs_log("%s(): Error: Batch %lu not acknowledged, resending.\n",
+		 __FUNCTION__, relay->batch);
+    }
+
+    len = snprintf(outgoing_msg, LPJS_MSG_LEN_MAX + 1, "%c%lu\n",
+		   LPJS_DISPATCHD_REQUEST_JOB_REPORTS, ++relay->batch);
+    for (c = 0; (c < relay->queue_count) &&
+		(len + relay->queue[c].len + 1 < LPJS_MSG_LEN_MAX); ++c)
+    {
+	memcpy(outgoing_msg + len, relay->queue[c].record,
+	       relay->queue[c].len);
+	len += relay->queue[c].len;
+	outgoing_msg[len++] = '\n';
+    }
+    outgoing_msg[len] = '\0';
+
+    // A lost connection is noticed by the event loop in main()
+    if ( lpjs_send_node_munge(compd_msg_fd, outgoing_msg, lpjs_no_close)
+	 != LPJS_MSG_SENT )
+    {
+	lpjs_log("%s(): Error: Failed to send batch %lu.\n", __FUNCTION__,
+		 relay->batch);
+	relay->sent_count = 0;
+	return;
+    }
+    relay->sent_count = c;
+    relay->sent_time = now;
+    lpjs_debug("%s(): Sent %zu reports in batch %lu.\n", __FUNCTION__,
+	       c, relay->batch);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Act on an acknowledgement from dispatchd.  payload is the batch
+ *      number.  Releases the chaperones and inventory entries waiting
+ *      on the batch, and sends the next.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    relay_ack(relay_t *relay, const char *payload, int compd_msg_fd,
+		  inventory_t *inventory)
+
+{
+    unsigned long   batch;
+    char            *end;
+    size_t          c;
+    bool            released = false;
+    relay_report_t  *report;
+
+    batch = strtoul(payload, &end, 10);
+    if ( (*end != '\0') || (batch != relay->batch) ||
+	 (relay->sent_count == 0) )
+    {
+	// Late ack for a batch that was sent again
+	lpjs_debug("%s(): Ignoring ack for batch %s.\n", __FUNCTION__,
+		   payload);
+	return;
+    }
+
+    for (c = 0; c < relay->sent_count; ++c)
+    {
+	report = &relay->queue[c];
+	if ( report->fd != RELAY_NO_CLIENT )
+	{
+	    // Chaperone may be gone, nothing to do about it
+	    write(report->fd, LPJS_EOT_MSG, 1);
+	    close(report->fd);
+	}
+	if ( report->release_job_id != 0 )
+	{
+	    inventory_remove(inventory, report->release_job_id);
+	    released = true;
+	}
+    }
+    if ( released )
+	inventory_save(inventory, LPJS_COMPD_INVENTORY);
+
+    relay->queue_count -= relay->sent_count;
+    memmove(relay->queue, relay->queue + relay->sent_count,
+	    relay->queue_count * sizeof(*relay->queue));
+    relay->sent_count = 0;
+
+    relay_send(relay, compd_msg_fd);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Resend the outstanding batch, if any, on a new connection to
+ *      dispatchd.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    relay_requeue(relay_t *relay, int compd_msg_fd)
+
+{
+    relay->sent_count = 0;
+    relay_send(relay, compd_msg_fd);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check for a request code that may be relayed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    relay_is_report(int code)
+
+{
+    return (code == LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS) ||
+	   (code == LPJS_DISPATCHD_REQUEST_JOB_STARTED) ||
+	   (code == LPJS_DISPATCHD_REQUEST_JOB_COMPLETE);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send one report to lpjs_compd and wait until dispatchd has it.
+ *      Used by chaperones.  record begins with the request code.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, LPJS_WRITE_FAILED if compd cannot be reached,
+ *      or LPJS_READ_FAILED if the connection was lost before
+ *      acknowledgement
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_relay_report(const char *record)
+
+{
+    struct sockaddr_un  addr;
+    char                msg[RELAY_RECORD_MAX + 2],
+			ack;
+    int                 fd;
+    ssize_t             len, bytes;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strlcpy(addr.sun_path, LPJS_COMPD_SOCKET, sizeof(addr.sun_path));
+    len = snprintf(msg, RELAY_RECORD_MAX + 2, "%s\n", record);
+
+    if ( (fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 )
+	return LPJS_WRITE_FAILED;
+    if ( (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+	 (write(fd, msg, len) != len) )
+    {
+	lpjs_log("%s(): Error: Cannot send report to compd: %s\n",
+		 __FUNCTION__, strerror(errno));
+	close(fd);
+	return LPJS_WRITE_FAILED;
+    }
+
+    // No timeout: dispatchd may be down for a while
+    while ( ((bytes = read(fd, &ack, 1)) == -1) && (errno == EINTR) )
+	;
+    close(fd);
+    if ( bytes != 1 )
+    {
+	lpjs_log("%s(): Error: Lost connection to compd.\n", __FUNCTION__);
+	return LPJS_READ_FAILED;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Send a report to lpjs_compd, retrying indefinitely with
+ *      exponential backoff and jitter, so the chaperones on a node
+ *      do not all return at once after a compd restart
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Back off with jitter
+ ***************************************************************************/
+
+void    lpjs_relay_report_loop(const char *record)
+
+{
+    lpjs_backoff_t  backoff;
+    unsigned        delay;
+    
+    lpjs_backoff_init(&backoff);
+    while ( lpjs_relay_report(record) != LPJS_SUCCESS )
+    {
+	delay = lpjs_backoff_wait(&backoff);
+	lpjs_log("%s(): Retrying after %u ms...\n", __FUNCTION__, delay);
+    }
+}
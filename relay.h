@@ -0,0 +1,74 @@
+#ifndef _LPJS_RELAY_H_
+#define _LPJS_RELAY_H_
+
+#include <stdbool.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/types.h>  // ssize_t, uid_t
+
+#ifndef _LPJS_H_
+#include "lpjs.h"       // LPJS_HOSTNAME_MAX
+#endif
+
+#ifndef _LPJS_INVENTORY_H_
+#include "inventory.h"
+#endif
+
+/*
+ *  Job report relay: Chaperones on a compute node send launch status,
+ *  start, and completion reports to lpjs_compd on LPJS_COMPD_SOCKET,
+ *  one report per connection, as the request code byte and text that
+ *  would follow it in a report sent directly to dispatchd, ending
+ *  with a newline.  compd queues them in order of arrival and
+ *  forwards them in batches on its connection to dispatchd:
+ *
+ *      LPJS_DISPATCHD_REQUEST_JOB_REPORTS batch-number\n
+ *      report\n
+ *      ...
+ *
+ *  One batch is outstanding at a time.  dispatchd acknowledges each
+ *  with LPJS_COMPD_REQUEST_REPORTS_ACK batch-number, and compd then
+ *  sends one byte back to each chaperone in the batch, which closes
+ *  the connection.  Unacknowledged batches are sent again after
+ *  reconnecting to dispatchd or after RELAY_ACK_TIMEOUT seconds.  A
+ *  chaperone whose connection is lost before the acknowledgement,
+ *  e.g. due to a compd restart, sends the report again.
+ *
+ *  The socket is mode 0660, group LPJS_COMPD_SOCKET_GROUP, which job
+ *  processes are added to.  compd accepts a report only from root, or
+ *  from the user the job it names runs as, according to the
+ *  inventory, so users cannot forge reports for each other's jobs.
+ */
+
+#define RELAY_RECORD_MAX    (LPJS_HOSTNAME_MAX + 256)
+#define RELAY_ACK_TIMEOUT   30  // Seconds
+#define RELAY_NO_CLIENT     -1  // Report from compd itself
+#define LPJS_COMPD_SOCKET_GROUP "lpjs"  // Default compd-socket-group
+
+typedef struct
+{
+    int             fd;             // Chaperone connection or RELAY_NO_CLIENT
+    uid_t           peer_uid;       // Of the chaperone
+    char            record[RELAY_RECORD_MAX + 2];
+    size_t          len;
+    time_t          accept_time;
+    unsigned long   release_job_id; // Inventory entry to drop, or 0
+}   relay_report_t;
+
+typedef struct
+{
+    int             listen_fd;
+    relay_report_t  *receiving;     // Connections without a full report
+    size_t          receiving_count;
+    size_t          receiving_size;
+    relay_report_t  *queue;         // Oldest first
+    size_t          queue_count;
+    size_t          queue_size;
+    size_t          sent_count;     // Leading reports awaiting ack
+    unsigned long   batch;          // Number of the last batch sent
+    time_t          sent_time;
+}   relay_t;
+
+#include "relay-protos.h"
+
+#endif  // _LPJS_RELAY_H_
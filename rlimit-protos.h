@@ -0,0 +1,3 @@
+/* rlimit.c */
+void lpjs_set_job_limits(size_t pmem_per_proc);
+void enforce_resource_limits(pid_t pid, size_t mem_per_proc);
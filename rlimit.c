@@ -0,0 +1,99 @@
+/***************************************************************************
+ *  Description:
+ *      Resource limits for job processes, applied by the chaperone or
+ *      by a supervising lpjs_compd before exec()ing the job script.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from chaperone.c
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>     // getpid()
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#include <sys/resource.h>   // setrlimit()
+
+#include "lpjs.h"
+#include "misc.h"
+#include "rlimit.h"
+
+/***************************************************************************
+ *  Description:
+ *      Apply limits for a job to the calling process, which is about
+ *      to exec() the job script.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Factor out from chaperone main()
+ ***************************************************************************/
+
+void    lpjs_set_job_limits(size_t pmem_per_proc)
+
+{
+    struct rlimit   rss_limit;
+    
+    // Suggest resource limits.  RSS cannot be controlled at all
+    // on Linux, so this has no effect there, where cgroups are used
+    // instead (see cgroup.c).  On BSD systems, RSS limits
+    // influence pager behavior, so that processes exceeding their
+    // RSS limit are preferentially paged out when memory is tight.
+    rss_limit.rlim_cur = pmem_per_proc * 1024 * 1024;
+    rss_limit.rlim_max = pmem_per_proc * 1024 * 1024;
+    setrlimit(RLIMIT_RSS, &rss_limit);
+    
+    enforce_resource_limits(getpid(), pmem_per_proc);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Enforce the memory limit of a job process where the OS supports
+ *      it.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2024-05-08  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Fix Linux macro, defer to cgroups
+ ***************************************************************************/
+
+void    enforce_resource_limits(pid_t pid, size_t mem_per_proc)
+
+{
+#if defined(__APPLE__)
+#elif defined(__DragonFly__)
+#elif defined(__FreeBSD__)
+    
+    // Use rctl
+    // FIXME: This needs to be run as root
+    #include <sys/rctl.h>
+    int     enabled;
+    size_t  len = sizeof(int);
+    char    rule[LPJS_RCTL_RULE_MAX + 1];
+    
+    if ( sysctlbyname("kern.racct.enable", &enabled, &len, NULL, 0) != 0 )
+	lpjs_log("%s(): sysctl kern.racct.enable failed.\n", __FUNCTION__);
+    else
+	if ( enabled == 1 )
+	{
+	    // Limit RSS to mem_per_proc MiB
+	    snprintf(rule, LPJS_RCTL_RULE_MAX + 1,
+		    "process:%d:memoryuse:deny=%zu",
+		    pid, mem_per_proc * 1024 * 1024);
+	    lpjs_log("%s(): Adding rctl rule: %s\n", __FUNCTION__, rule);
+	    if ( rctl_add_rule(rule, LPJS_RCTL_RULE_MAX + 1, NULL, 0) != 0 )
+		lpjs_log("%s(): rctl_add_rule() failed: %s\n",
+			__FUNCTION__, strerror(errno));
+	}
+	else
+	    lpjs_log("%s(): kern.racct.enable is not enabled.\n", __FUNCTION__);
+
+#elif defined(__linux__)
+    // Limited by the job's cgroup, set up by lpjs_compd as root before
+    // this process was forked, see cgroup.c
+#elif defined(__NetBSD__)
+#elif defined(__OpenBSD__)
+#endif
+}
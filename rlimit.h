@@ -0,0 +1,10 @@
+#ifndef _LPJS_RLIMIT_H_
+#define _LPJS_RLIMIT_H_
+
+#include <sys/types.h>  // pid_t, size_t
+
+#define LPJS_RCTL_RULE_MAX  128
+
+#include "rlimit-protos.h"
+
+#endif  // _LPJS_RLIMIT_H_
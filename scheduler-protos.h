@@ -4,6 +4,11 @@ int lpjs_dispatch_next_job(node_list_t *node_list, job_list_t *pending_jobs, job
 int lpjs_dispatch_jobs(node_list_t *node_list, job_list_t *pending_jobs, job_list_t *running_jobs);
 unsigned long lpjs_select_next_job(job_list_t *pending_jobs, job_t **job);
 int lpjs_match_nodes(job_t *job, node_list_t *node_list, node_list_t *matched_nodes);
-int lpjs_get_usable_procs(job_t *job, node_t *node);
+int lpjs_get_usable_procs(job_t *job, node_t *node, job_pending_reason_t *reason);
+size_t lpjs_oversubscribe_MiB(job_t *job, node_t *node, size_t requested_avail);
 job_t *lpjs_remove_pending_job(job_list_t *pending_jobs, unsigned long job_id);
 job_t *lpjs_remove_running_job(job_list_t *running_jobs, unsigned long job_id);
+void lpjs_remove_legacy_spool_dir(const char *spool_dir, unsigned long job_id);
+bool lpjs_is_job_report(int code);
+void lpjs_defer_node_message(node_t *node, char *payload, ssize_t bytes);
+bool lpjs_next_deferred_message(node_t **node, char **payload, ssize_t *bytes);
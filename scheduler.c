@@ -4,8 +4,8 @@
 #include <string.h>     // strerror()
 #include <errno.h>
 #include <unistd.h>     // close()
-#include <sys/wait.h>
 #include <sysexits.h>
+#include <stdbool.h>
 
 #include <xtend/file.h>
 #include <xtend/math.h>     // XT_MIN()
@@ -16,6 +16,26 @@
 #include "scheduler.h"
 #include "network.h"
 #include "misc.h"       // lpjs_log()
+#include "logger.h"     // lpjs_log_enabled()
+#include "journal.h"
+#include "cleanup.h"
+#include "metrics.h"
+#include "trace.h"
+#include "heartbeat.h"
+#include "telemetry.h"
+#include "config.h"
+
+// Job reports received while awaiting fork verification
+typedef struct deferred_msg
+{
+    struct deferred_msg *next;
+    node_t              *node;
+    char                *payload;
+    ssize_t             bytes;
+}   deferred_msg_t;
+
+static deferred_msg_t   *Deferred_head = NULL,
+			*Deferred_tail = NULL;
 
 /***************************************************************************
  *  Description:
@@ -54,6 +74,10 @@ int     lpjs_select_nodes()
  *  History: 
  *  Date        Name        Modification
  *  2024-01-22  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Capture fork verification, handle failed recv
+ *  2026-10-19  Jason Bacon Defer job reports from supervising compd
+ *  2026-10-19  Jason Bacon Accept heartbeats only from the node
+ *  2026-10-19  Jason Bacon Send job without a verification reply
  ***************************************************************************/
 
 int     lpjs_dispatch_next_job(node_list_t *node_list,
@@ -64,11 +88,10 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
     job_t       *job;
     // Terminates process if malloc() fails, no check required
     node_list_t *matched_nodes = node_list_new();
-    char        pending_path[PATH_MAX + 1],
-		script_path[PATH_MAX + 2],
+    char        script_path[PATH_MAX + 1],
 		script_buff[LPJS_SCRIPT_SIZE_MAX + 1],
 		outgoing_msg[LPJS_JOB_MSG_MAX + 1],
-		*munge_payload;
+		*munge_payload = NULL;
     int         compd_msg_fd,
 		node_count;
     ssize_t     script_size,
@@ -96,6 +119,7 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
     {
 	lpjs_log("%s(): Found %u available nodes.\n",
 		__FUNCTION__, node_list_get_compute_node_count(matched_nodes));
+	job_stamp(job, JOB_TIMING_SELECTED);
 	
 	/*
 	 *  Do not move from pending to running yet.
@@ -104,13 +128,10 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 	 */
 	
 	/*
-	 *  Load script from spool/lpjs/pending
+	 *  Load script from spool/lpjs/scripts
 	 */
 	
-	snprintf(pending_path, PATH_MAX + 1, "%s/%lu",
-		 LPJS_PENDING_DIR, job_get_job_id(job));
-	snprintf(script_path, PATH_MAX + 2, "%s/%s",
-		 pending_path, job_get_script_name(job));
+	lpjs_spool_script_path(job, script_path, PATH_MAX + 1);
 	script_size = lpjs_load_script(script_path, script_buff,
 				       LPJS_SCRIPT_SIZE_MAX + 1);
 
@@ -142,17 +163,18 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 	    outgoing_msg[0] = LPJS_COMPD_REQUEST_NEW_JOB;
 	    job_print_to_string(job, outgoing_msg + 1, LPJS_JOB_MSG_MAX + 1);
 
-	    lpjs_log("%s(): Job specs: %s\n", __FUNCTION__, outgoing_msg + 1);
+	    lpjs_debug("%s(): Job specs: %s\n", __FUNCTION__, outgoing_msg + 1);
 	    
 	    // FIXME: Check for truncation
 	    strlcat(outgoing_msg, script_buff, LPJS_JOB_MSG_MAX + 1);
-	    if ( lpjs_send_munge(compd_msg_fd, outgoing_msg,
-				 lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
+	    if ( lpjs_send_node_munge(compd_msg_fd, outgoing_msg,
+				      lpjs_dispatchd_safe_close) != LPJS_MSG_SENT )
 	    {
 		lpjs_log("%s(): Error: Failed to send job to compd.\n", __FUNCTION__);
 		free(matched_nodes);
 		return node_count;
 	    }
+	    job_stamp(job, JOB_TIMING_SENT);
 	    
 	    /*
 	     *  Get chaperone launch status back from compd.
@@ -168,10 +190,39 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 	    
 	    lpjs_log("%s(): Awaiting chaperone fork verification from %s compd...\n",
 		     __FUNCTION__, node_get_hostname(node));
-	    payload_bytes = lpjs_recv_munge(compd_msg_fd, &munge_payload,
-					    0, LPJS_CHAPERONE_STATUS_TIMEOUT,
-					    &uid, &gid,
-					    lpjs_dispatchd_safe_close);
+	    
+	    /*
+	     *  compd sends relayed report batches, and reports of jobs
+	     *  it supervises, on this connection at any time, so some
+	     *  may arrive ahead of the verification.  Set reports aside
+	     *  for the event loop.  For the same reason, the job was
+	     *  sent without awaiting a verification reply, which could
+	     *  have crossed with a report.
+	     */
+	    while ( true )
+	    {
+		payload_bytes = lpjs_recv_node_munge(compd_msg_fd, &munge_payload,
+					0, LPJS_CHAPERONE_STATUS_TIMEOUT,
+					&uid, &gid,
+					lpjs_dispatchd_safe_close);
+		if ( payload_bytes == LPJS_RECV_HEARTBEAT )
+		{
+		    lpjs_heartbeat_seen(node, true);
+		    if ( munge_payload != NULL )
+		    {
+			lpjs_telemetry_update(node, munge_payload, running_jobs);
+			free(munge_payload);
+		    }
+		    continue;
+		}
+		lpjs_trace_capture(LPJS_TRACE_REPLY, node_get_hostname(node),
+				   munge_payload, payload_bytes, uid, gid);
+		if ( (payload_bytes < 1) ||
+		     ! lpjs_is_job_report(munge_payload[0]) )
+		    break;
+		lpjs_defer_node_message(node, munge_payload, payload_bytes);
+	    }
+	    
 	    if ( payload_bytes == LPJS_RECV_TIMEOUT )
 	    {
 		lpjs_log("%s(): Error: Timed out awaiting dispatch status.\n",
@@ -180,6 +231,15 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 			 node_get_hostname(node));
 		node_set_state(node, "down");
 	    }
+	    // No payload is allocated on failure
+	    else if ( payload_bytes < 1 )
+	    {
+		lpjs_log("%s(): Error: Failed to read dispatch status.\n",
+			 __FUNCTION__);
+		lpjs_log("%s(): Setting %s to down.\n", __FUNCTION__,
+			 node_get_hostname(node));
+		node_set_state(node, "down");
+	    }
 	    else if ( munge_payload[0] != LPJS_CHAPERONE_FORKED )
 	    {
 		lpjs_log("%s(): Bug: Should have received LPJS_CHAPERONE_FORKED.\n",
@@ -208,7 +268,13 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 
 		lpjs_debug("%s(): Chaperone fork verification received.\n",
 			    __FUNCTION__);
+		job_stamp(job, JOB_TIMING_FORKED);
 		job_set_state(job, JOB_STATE_DISPATCHED);
+		free(job_get_compute_node(job));
+		job_set_compute_node(job, strdup(node_get_hostname(node)));
+		lpjs_journal_append(LPJS_JOURNAL_DISPATCH, job);
+		lpjs_journal_note_dispatch();
+		lpjs_metrics_count_dispatch();
 		
 		// FIXME: This will need adjustment for MPI jobs at the least
 		node_adjust_resources(node, job, NODE_RESOURCE_ALLOCATE);
@@ -220,6 +286,8 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
 		    job_get_pmem_per_proc(job) * job_get_procs_per_job(job));
 		*/
 	    }
+	    if ( payload_bytes > 0 )
+		free(munge_payload);
 	}
 	
 	/*
@@ -248,6 +316,7 @@ int     lpjs_dispatch_next_job(node_list_t *node_list,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-29  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record scheduling pass time
  ***************************************************************************/
 
 
@@ -257,11 +326,14 @@ int     lpjs_dispatch_jobs(node_list_t *node_list,
 
 {
     int     nodes;
+    struct timespec start;
     
+    clock_gettime(CLOCK_MONOTONIC, &start);
     // Dispatch as many jobs as possible before resuming
     while ( (nodes = lpjs_dispatch_next_job(node_list, pending_jobs,
 					    running_jobs)) > 0 )
 	lpjs_log("%s(): %d nodes available.\n", __FUNCTION__, nodes);
+    lpjs_metrics_observe(LPJS_METRIC_SCHEDULE, &start);
 
     return 0;
 }
@@ -278,15 +350,16 @@ int     lpjs_dispatch_jobs(node_list_t *node_list,
  *  History: 
  *  Date        Name        Modification
  *  2024-01-29  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Hold jobs not yet committed to the journal
  ***************************************************************************/
 
 unsigned long   lpjs_select_next_job(job_list_t *pending_jobs, job_t **job)
 
 {
     unsigned long   low_job_id;
-    extern FILE     *Log_stream;
     size_t          c;
     job_t           *temp_job;
+    char            specs[JOB_STR_MAX_LEN + 1];
     
     if ( job_list_get_count(pending_jobs) == 0 )
 	return 0;
@@ -307,9 +380,22 @@ unsigned long   lpjs_select_next_job(job_list_t *pending_jobs, job_t **job)
 	
 	*job = job_list_get_jobs_ae(pending_jobs, c);
 	low_job_id = job_get_job_id(*job);
+	// Submitted this pass, dispatched once on disk, see lpjs_commit_pass()
+	if ( (lpjs_journal_uncommitted_job_id() != 0) &&
+	     (low_job_id >= lpjs_journal_uncommitted_job_id()) )
+	{
+	    lpjs_debug("%s(): Job %lu is not yet committed.\n",
+		       __FUNCTION__, low_job_id);
+	    return 0;
+	}
 	lpjs_log("%s(): Selected job %lu to dispatch.\n",
 		 __FUNCTION__, low_job_id);
-	job_print_full_specs(*job, Log_stream);
+	if ( lpjs_log_enabled(LPJS_LOG_LEVEL_DEBUG1) )
+	{
+	    // Through the log queue, to keep lines in order
+	    job_print_to_string(*job, specs, JOB_STR_MAX_LEN + 1);
+	    lpjs_debug("%s(): %s", __FUNCTION__, specs);
+	}
 	return low_job_id;
     }
 }
@@ -317,10 +403,14 @@ unsigned long   lpjs_select_next_job(job_list_t *pending_jobs, job_t **job)
 
 /***************************************************************************
  *  Description:
+ *      Find nodes with enough free procs and memory for job.
+ *      If there are not enough, record the reason in the job for
+ *      lpjs jobs, rather than logging each node on every pass.
  *  
  *  History: 
  *  Date        Name        Modification
  *  2024-02-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Record pending reason, no per-node logging
  ***************************************************************************/
 
 int     lpjs_match_nodes(job_t *job, node_list_t *node_list,
@@ -332,43 +422,39 @@ int     lpjs_match_nodes(job_t *job, node_list_t *node_list,
 		c,
 		usable_procs,   // Procs with enough mem
 		total_usable,
-		total_required;
+		total_required,
+		up_nodes,
+		memory_short;   // Procs free, but without enough mem
+    job_pending_reason_t    node_reason;
     
-    lpjs_log("%s(): Job %u requires %u procs, %lu MiB / proc.\n",
-	    __FUNCTION__,
-	    job_get_job_id(job), job_get_min_procs_per_node(job),
-	    job_get_pmem_per_proc(job));
-    
-    total_usable = 0;
+    total_usable = up_nodes = memory_short = 0;
     total_required = job_get_procs_per_job(job);
     for (c = node_count = 0;
 	 (c < node_list_get_compute_node_count(node_list)) &&
 	 (total_usable < total_required); ++c)
     {
 	node = node_list_get_compute_nodes_ae(node_list, c);
-	if ( strcmp(node_get_state(node), "up") != 0 )
-	    lpjs_log("%s(): %s is unavailable.\n",
-		    __FUNCTION__, node_get_hostname(node));
-	else
+	if ( strcmp(node_get_state(node), "up") == 0 )
 	{
-	    // lpjs_log("Checking %s...\n", node_get_hostname(node));
-	    usable_procs = lpjs_get_usable_procs(job, node);
+	    ++up_nodes;
+	    usable_procs = lpjs_get_usable_procs(job, node, &node_reason);
 	    usable_procs = XT_MIN(usable_procs, total_required - total_usable);
 	    
 	    if ( usable_procs > 0 )
 	    {
-		lpjs_log("%s(): Using %u procs on %s.\n", __FUNCTION__,
-			usable_procs, node_get_hostname(node));
 		// FIXME: Set # procs to use on node
 		node_list_add_compute_node(matched_nodes, node);
 		total_usable += usable_procs;
 		++node_count;
 	    }
+	    else if ( node_reason == JOB_PENDING_MEMORY )
+		memory_short += job_get_min_procs_per_node(job);
 	}
     }
     
     if ( total_usable == total_required )
     {
+	job_set_pending_reason(job, JOB_PENDING_NONE);
 	lpjs_log("%s(): Using nodes:\n", __FUNCTION__);
 	for (c = 0; c < node_list_get_compute_node_count(matched_nodes); ++c)
 	{
@@ -376,8 +462,13 @@ int     lpjs_match_nodes(job_t *job, node_list_t *node_list,
 	    lpjs_log("%s(): %s\n", __FUNCTION__, node_get_hostname(node));
 	}
     }
+    else if ( up_nodes == 0 )
+	job_set_pending_reason(job, JOB_PENDING_NO_NODES);
+    // Memory is the limit if the job would fit in the free procs
+    else if ( total_usable + memory_short >= total_required )
+	job_set_pending_reason(job, JOB_PENDING_MEMORY);
     else
-	lpjs_log("%s(): Insufficient resources available.\n", __FUNCTION__);
+	job_set_pending_reason(job, JOB_PENDING_PROCS);
     
     return node_count;
 }
@@ -385,38 +476,55 @@ int     lpjs_match_nodes(job_t *job, node_list_t *node_list,
 
 /***************************************************************************
  *  Description:
+ *      Return the number of procs on node usable by job, which is
+ *      min_procs_per_node or 0.  If 0, *reason is set to
+ *      JOB_PENDING_PROCS or JOB_PENDING_MEMORY.
  *  
  *  History: 
  *  Date        Name        Modification
  *  2024-02-23  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Return reason instead of logging
+ *  2026-10-19  Jason Bacon memory-policy measured
+ *  2026-10-19  Jason Bacon memory-policy oversubscribe
  ***************************************************************************/
 
-int     lpjs_get_usable_procs(job_t *job, node_t *node)
+int     lpjs_get_usable_procs(job_t *job, node_t *node,
+			      job_pending_reason_t *reason)
 
 {
     int         required_procs,
 		available_procs,    // Total free
 		usable_procs;       // Total free with enough mem
-    size_t      available_mem;
+    size_t      available_mem,
+		required_mem;
+    extern lpjs_config_t    Config;
     
     required_procs = job_get_min_procs_per_node(job);
+    required_mem = job_get_pmem_per_proc(job) * required_procs;
     available_mem = node_get_phys_MiB_available(node);
+    
+    // Memory used outside LPJS, or by jobs beyond their request
+    if ( Config.memory_policy == LPJS_MEMORY_MEASURED )
+	available_mem = XT_MIN(available_mem, lpjs_telemetry_avail_MiB(node));
     available_procs = node_get_procs(node) - node_get_procs_used(node);
-    lpjs_log("%s(): %s: procs = %u  mem = %lu\n", __FUNCTION__,
-	     node_get_hostname(node), available_procs, available_mem);
+    *reason = JOB_PENDING_NONE;
     if ( available_procs >= required_procs )
     {
-	if ( (available_mem >= job_get_pmem_per_proc(job) * required_procs) )
+	// Only needed, and only logged, if the request does not fit
+	if ( (Config.memory_policy == LPJS_MEMORY_OVERSUBSCRIBE) &&
+	     (available_mem < required_mem) )
+	    available_mem = lpjs_oversubscribe_MiB(job, node, available_mem);
+	if ( available_mem >= required_mem )
 	    usable_procs = required_procs;
 	else
 	{
-	    lpjs_log("%s(): Not enough memory available.\n", __FUNCTION__);
+	    *reason = JOB_PENDING_MEMORY;
 	    usable_procs = 0;
 	}
     }
     else
     {
-	lpjs_log("%s(): Not enough procs available.\n", __FUNCTION__);
+	*reason = JOB_PENDING_PROCS;
 	usable_procs = 0;
     }
     return usable_procs;
@@ -425,66 +533,235 @@ int     lpjs_get_usable_procs(job_t *job, node_t *node)
 
 /***************************************************************************
  *  Description:
- *  
+ *      Memory on node available to job under memory-policy
+ *      oversubscribe: what is not requested by running jobs, plus what
+ *      they requested beyond their measured peaks and margin (see
+ *      telemetry.h).  Nothing is added if the node last reported less
+ *      than oversubscribe-reserve percent of its memory available, or
+ *      has not reported recently.  Admissions are logged, as are
+ *      refusals at debug level, since they repeat every pass.
+ *
+ *      Jobs admitted beyond requests push phys_MiB_used past phys_MiB,
+ *      so unrequested memory is computed signed and the overshoot
+ *      comes out of the reclaimable memory.  Otherwise, the same
+ *      reclaimable memory would be given to every job admitted before
+ *      the next report.  Requests on the node are thus capped at
+ *      phys_MiB plus reclaimable memory.
+ *
  *  Returns:
+ *      MiB available to job, at least requested_avail
  *
  *  History: 
  *  Date        Name        Modification
- *  2024-05-03  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Deduct earlier admissions from reclaim
  ***************************************************************************/
 
-job_t   *lpjs_remove_pending_job(job_list_t *pending_jobs, unsigned long job_id)
+size_t  lpjs_oversubscribe_MiB(job_t *job, node_t *node,
+			       size_t requested_avail)
 
 {
-    char    pending_path[PATH_MAX + 1];
-    pid_t   pid;
-    int     status;
+    extern lpjs_config_t    Config;
+    size_t  required_mem = job_get_pmem_per_proc(job) *
+			   job_get_min_procs_per_node(job),
+	    reclaim_mem = lpjs_telemetry_reclaim_MiB(node),
+	    measured_avail = lpjs_telemetry_avail_MiB(node),
+	    reserve = node_get_phys_MiB(node) *
+		      Config.oversubscribe_reserve / 100;
+    long    unrequested = (long)node_get_phys_MiB(node) -
+			  (long)node_get_phys_MiB_used(node),
+	    available = unrequested + (long)reclaim_mem;
+    
+    if ( reclaim_mem == 0 )
+	return requested_avail;
     
-    if ( (pid = fork()) == 0 )
+    if ( measured_avail < reserve )
     {
-	snprintf(pending_path, PATH_MAX + 1, "%s/%lu",
-		 LPJS_PENDING_DIR, job_id);
-	lpjs_log("%s(): Removing job %s...\n", __FUNCTION__, pending_path);
-	execlp("rm", "rm", "-rf", pending_path, NULL);
-	lpjs_log("%s(): Error: exec(rm -rf %s) failed.\n", __FUNCTION__, pending_path);
-	exit(EX_OSERR);
+	lpjs_debug("%s(): Job %lu not admitted to %s: %zu MiB available by measurement, below reserve %zu.\n",
+		   __FUNCTION__, job_get_job_id(job), node_get_hostname(node),
+		   measured_avail, reserve);
+	return requested_avail;
     }
-    else
+    
+    if ( available < (long)required_mem )
     {
-	// WEXITED is implicitly set for waitpid(), but specify for readability
-	waitpid(pid, &status, WEXITED);
-	if ( status != 0 )
-	    lpjs_log("%s(): rm failed, status = %d.\n", __FUNCTION__, status);
+	lpjs_debug("%s(): Job %lu not admitted to %s: needs %zu MiB, %ld unrequested, %zu unused by jobs.\n",
+		   __FUNCTION__, job_get_job_id(job), node_get_hostname(node),
+		   required_mem, unrequested, reclaim_mem);
+	return requested_avail;
     }
     
-    return job_list_remove_job(pending_jobs, job_id);
+    lpjs_log("%s(): Job %lu admitted to %s beyond requests: needs %zu MiB, %ld unrequested, %zu unused by jobs, %zu available by measurement.\n",
+	     __FUNCTION__, job_get_job_id(job), node_get_hostname(node),
+	     required_mem, unrequested, reclaim_mem, measured_avail);
+    return available;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove a job from the pending queue, e.g. when canceled.
+ *      The journal record is committed at the end of the current
+ *      event loop pass.
+ *
+ *  Returns:
+ *      Pointer to the removed job, or NULL if not found
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2024-05-03  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Journal instead of removing spool dir
+ ***************************************************************************/
+
+job_t   *lpjs_remove_pending_job(job_list_t *pending_jobs, unsigned long job_id)
+
+{
+    job_t   *job;
+    
+    if ( (job = job_list_remove_job(pending_jobs, job_id)) != NULL )
+	lpjs_journal_append(LPJS_JOURNAL_CANCEL, job);
+    lpjs_remove_legacy_spool_dir(LPJS_PENDING_DIR, job_id);
+    
+    return job;
 }
 
 
-// FIXME: merge this with above
+/***************************************************************************
+ *  Description:
+ *      Remove a job from the running queue when it completes.
+ *      The journal record is committed at the end of the current
+ *      event loop pass.
+ *
+ *  Returns:
+ *      Pointer to the removed job, or NULL if not found
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2024-05-03  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Journal instead of removing spool dir
+ ***************************************************************************/
+
 job_t   *lpjs_remove_running_job(job_list_t *running_jobs, unsigned long job_id)
 
 {
-    char    running_path[PATH_MAX + 1];
-    pid_t   pid;
-    int     status;
+    job_t   *job;
+    
+    if ( (job = job_list_remove_job(running_jobs, job_id)) != NULL )
+	lpjs_journal_append(LPJS_JOURNAL_COMPLETE, job);
+    lpjs_remove_legacy_spool_dir(LPJS_RUNNING_DIR, job_id);
+    
+    return job;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the per-job spool directory of a job queued by an
+ *      LPJS version that predates the journal.  Nothing to do for
+ *      jobs submitted since.  Removal is done by the cleanup thread,
+ *      so this does not wait for the file system.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Merge from lpjs_remove_*_job()
+ *  2026-10-19  Jason Bacon Queue for cleanup thread instead of rm -rf
+ ***************************************************************************/
+
+void    lpjs_remove_legacy_spool_dir(const char *spool_dir,
+				     unsigned long job_id)
+
+{
+    char        job_path[PATH_MAX + 1];
     
-    if ( (pid = fork()) == 0 )
+    snprintf(job_path, PATH_MAX + 1, "%s/%lu", spool_dir, job_id);
+    lpjs_cleanup_queue(job_path);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether a message on a compute node connection is a job
+ *      report, which compd sends on its own when supervising jobs or
+ *      relaying chaperone reports, rather than a reply to dispatchd.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add relayed report batches
+ ***************************************************************************/
+
+bool    lpjs_is_job_report(int code)
+
+{
+    return (code == LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS) ||
+	   (code == LPJS_DISPATCHD_REQUEST_JOB_STARTED) ||
+	   (code == LPJS_DISPATCHD_REQUEST_JOB_COMPLETE) ||
+	   (code == LPJS_DISPATCHD_REQUEST_JOB_REPORTS);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Save a job report received by lpjs_dispatch_next_job(), to be
+ *      processed by the event loop after dispatching is done.  Takes
+ *      ownership of payload.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_defer_node_message(node_t *node, char *payload, ssize_t bytes)
+
+{
+    deferred_msg_t  *msg;
+    
+    if ( (msg = malloc(sizeof(*msg))) == NULL )
     {
-	snprintf(running_path, PATH_MAX + 1, "%s/%lu",
-		 LPJS_RUNNING_DIR, job_id);
-	lpjs_log("%s(): Removing job %s...\n", __FUNCTION__, running_path);
-	execlp("rm", "rm", "-rf", running_path, NULL);
-	lpjs_log("%s(): exec(rm -rf %s) failed.\n", __FUNCTION__, running_path);
-	exit(EX_OSERR);
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
     }
+    msg->next = NULL;
+    msg->node = node;
+    msg->payload = payload;
+    msg->bytes = bytes;
+    if ( Deferred_tail == NULL )
+	Deferred_head = msg;
     else
-    {
-	// WEXITED is implicitly set for waitpid(), but specify for readability
-	waitpid(pid, &status, WEXITED);
-	if ( status != 0 )
-	    lpjs_log("%s(): rm failed, status = %d.\n", __FUNCTION__, status);
-    }
+	Deferred_tail->next = msg;
+    Deferred_tail = msg;
+    lpjs_debug("%s(): Deferred report %d from %s.\n", __FUNCTION__,
+	       payload[0], node_get_hostname(node));
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Remove the oldest deferred job report.  The caller owns the
+ *      payload.
+ *
+ *  Returns:
+ *      true if a report was returned, false if there are none
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    lpjs_next_deferred_message(node_t **node, char **payload,
+				   ssize_t *bytes)
+
+{
+    deferred_msg_t  *msg;
+    
+    if ( (msg = Deferred_head) == NULL )
+	return false;
+    if ( (Deferred_head = msg->next) == NULL )
+	Deferred_tail = NULL;
+    *node = msg->node;
+    *payload = msg->payload;
+    *bytes = msg->bytes;
+    free(msg);
     
-    return job_list_remove_job(running_jobs, job_id);
+    return true;
 }
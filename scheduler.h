@@ -1,6 +1,9 @@
 #ifndef _LPJS_SCHEDULER_H_
 #define _LPJS_SCHEDULER_H_
 
+#include <stdbool.h>
+#include <sys/types.h>  // ssize_t
+
 #include "scheduler-protos.h"
 
 #endif
@@ -0,0 +1,8 @@
+/* sha256.c */
+void lpjs_sha256_init(lpjs_sha256_t *ctx);
+void lpjs_sha256_transform(lpjs_sha256_t *ctx, const unsigned char *block);
+void lpjs_sha256_update(lpjs_sha256_t *ctx, const void *data, size_t len);
+void lpjs_sha256_final(lpjs_sha256_t *ctx, unsigned char digest[32]);
+void lpjs_hmac_sha256_init(lpjs_hmac_sha256_t *ctx, const unsigned char *key, size_t key_len);
+void lpjs_hmac_sha256_update(lpjs_hmac_sha256_t *ctx, const void *data, size_t len);
+void lpjs_hmac_sha256_final(lpjs_hmac_sha256_t *ctx, unsigned char mac[32]);
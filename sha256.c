@@ -0,0 +1,250 @@
+/***************************************************************************
+ *  Description:
+ *      SHA-256 (FIPS 180-4) and HMAC-SHA256 (RFC 2104) for the hmac
+ *      authentication backend, so it needs no crypto library.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <string.h>
+#include <stdint.h>
+
+#include "sha256.h"
+
+#define ROTR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t   K[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/***************************************************************************
+ *  Description:
+ *      Start a new SHA-256 hash
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_sha256_init(lpjs_sha256_t *ctx)
+
+{
+    static const uint32_t   initial_state[8] =
+    {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(ctx->state, initial_state, sizeof(initial_state));
+    ctx->total_len = 0;
+    ctx->block_len = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Mix one 64-byte block into the hash state
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_sha256_transform(lpjs_sha256_t *ctx, const unsigned char *block)
+
+{
+    uint32_t    w[64], a, b, c, d, e, f, g, h, t1, t2;
+    int         i;
+
+    for (i = 0; i < 16; ++i)
+	w[i] = (uint32_t)block[i * 4] << 24 |
+	       (uint32_t)block[i * 4 + 1] << 16 |
+	       (uint32_t)block[i * 4 + 2] << 8 |
+	       (uint32_t)block[i * 4 + 3];
+    for (i = 16; i < 64; ++i)
+	w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10)) +
+	       w[i - 7] +
+	       (ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+	       w[i - 16];
+
+    a = ctx->state[0];
+    b = ctx->state[1];
+    c = ctx->state[2];
+    d = ctx->state[3];
+    e = ctx->state[4];
+    f = ctx->state[5];
+    g = ctx->state[6];
+    h = ctx->state[7];
+    for (i = 0; i < 64; ++i)
+    {
+	t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) +
+	     ((e & f) ^ (~e & g)) + K[i] + w[i];
+	t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) +
+	     ((a & b) ^ (a & c) ^ (b & c));
+	h = g;
+	g = f;
+	f = e;
+	e = d + t1;
+	d = c;
+	c = b;
+	b = a;
+	a = t1 + t2;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add len bytes of data to the hash
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_sha256_update(lpjs_sha256_t *ctx, const void *data, size_t len)
+
+{
+    const unsigned char *p = data;
+    size_t              n;
+
+    ctx->total_len += len;
+    while ( len > 0 )
+    {
+	n = LPJS_SHA256_BLOCK_LEN - ctx->block_len;
+	if ( n > len )
+	    n = len;
+	memcpy(ctx->block + ctx->block_len, p, n);
+	ctx->block_len += n;
+	p += n;
+	len -= n;
+	if ( ctx->block_len == LPJS_SHA256_BLOCK_LEN )
+	{
+	    lpjs_sha256_transform(ctx, ctx->block);
+	    ctx->block_len = 0;
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Pad the message and store the 32-byte hash in digest
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_sha256_final(lpjs_sha256_t *ctx,
+			  unsigned char digest[LPJS_SHA256_DIGEST_LEN])
+
+{
+    uint64_t        bit_len = ctx->total_len * 8;
+    unsigned char   pad = 0x80;
+    int             i;
+
+    lpjs_sha256_update(ctx, &pad, 1);
+    pad = 0;
+    while ( ctx->block_len != LPJS_SHA256_BLOCK_LEN - 8 )
+	lpjs_sha256_update(ctx, &pad, 1);
+    for (i = 0; i < 8; ++i)
+	ctx->block[LPJS_SHA256_BLOCK_LEN - 8 + i] = bit_len >> (56 - i * 8);
+    lpjs_sha256_transform(ctx, ctx->block);
+
+    for (i = 0; i < 8; ++i)
+    {
+	digest[i * 4] = ctx->state[i] >> 24;
+	digest[i * 4 + 1] = ctx->state[i] >> 16;
+	digest[i * 4 + 2] = ctx->state[i] >> 8;
+	digest[i * 4 + 3] = ctx->state[i];
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Start an HMAC-SHA256 with the given key
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_hmac_sha256_init(lpjs_hmac_sha256_t *ctx,
+			      const unsigned char *key, size_t key_len)
+
+{
+    unsigned char   key_block[LPJS_SHA256_BLOCK_LEN],
+		    inner_pad[LPJS_SHA256_BLOCK_LEN];
+    lpjs_sha256_t   key_hash;
+    int             i;
+
+    // Keys longer than a block are hashed first
+    memset(key_block, 0, LPJS_SHA256_BLOCK_LEN);
+    if ( key_len > LPJS_SHA256_BLOCK_LEN )
+    {
+	lpjs_sha256_init(&key_hash);
+	lpjs_sha256_update(&key_hash, key, key_len);
+	lpjs_sha256_final(&key_hash, key_block);
+    }
+    else
+	memcpy(key_block, key, key_len);
+
+    for (i = 0; i < LPJS_SHA256_BLOCK_LEN; ++i)
+    {
+	inner_pad[i] = key_block[i] ^ 0x36;
+	ctx->outer_pad[i] = key_block[i] ^ 0x5c;
+    }
+    lpjs_sha256_init(&ctx->inner);
+    lpjs_sha256_update(&ctx->inner, inner_pad, LPJS_SHA256_BLOCK_LEN);
+}
+
+
+void    lpjs_hmac_sha256_update(lpjs_hmac_sha256_t *ctx,
+				const void *data, size_t len)
+
+{
+    lpjs_sha256_update(&ctx->inner, data, len);
+}
+
+
+void    lpjs_hmac_sha256_final(lpjs_hmac_sha256_t *ctx,
+			       unsigned char mac[LPJS_SHA256_DIGEST_LEN])
+
+{
+    unsigned char   inner_digest[LPJS_SHA256_DIGEST_LEN];
+    lpjs_sha256_t   outer;
+
+    lpjs_sha256_final(&ctx->inner, inner_digest);
+    lpjs_sha256_init(&outer);
+    lpjs_sha256_update(&outer, ctx->outer_pad, LPJS_SHA256_BLOCK_LEN);
+    lpjs_sha256_update(&outer, inner_digest, LPJS_SHA256_DIGEST_LEN);
+    lpjs_sha256_final(&outer, mac);
+}
@@ -0,0 +1,27 @@
+#ifndef _LPJS_SHA256_H_
+#define _LPJS_SHA256_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LPJS_SHA256_BLOCK_LEN   64
+#define LPJS_SHA256_DIGEST_LEN  32
+
+typedef struct
+{
+    uint32_t        state[8];
+    uint64_t        total_len;      // Bytes hashed so far
+    size_t          block_len;      // Bytes waiting in block
+    unsigned char   block[LPJS_SHA256_BLOCK_LEN];
+}   lpjs_sha256_t;
+
+// HMAC-SHA256 (RFC 2104) state: Inner hash in progress + outer key pad
+typedef struct
+{
+    lpjs_sha256_t   inner;
+    unsigned char   outer_pad[LPJS_SHA256_BLOCK_LEN];
+}   lpjs_hmac_sha256_t;
+
+#include "sha256-protos.h"
+
+#endif  // _LPJS_SHA256_H_
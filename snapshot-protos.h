@@ -0,0 +1,7 @@
+/* snapshot.c */
+int lpjs_snapshot_write(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list, unsigned long next_job_id);
+void lpjs_snapshot_pack_job(snapshot_job_t *rec, snapshot_job_t *prev_rec, job_t *job, snapshot_strings_t *strings);
+uint32_t lpjs_snapshot_add_string(snapshot_strings_t *strings, const char *str);
+int lpjs_snapshot_load(job_list_t *pending_jobs, job_list_t *running_jobs, node_list_t *node_list, unsigned long *next_job_id);
+int lpjs_snapshot_validate(const void *map, size_t size);
+job_t *lpjs_snapshot_unpack_job(const snapshot_job_t *rec, const char *strings);
@@ -0,0 +1,447 @@
+/***************************************************************************
+ *  Description:
+ *      Binary snapshot of the dispatchd job queues and node allocations.
+ *
+ *      The snapshot is a header, fixed-size job and node records, and a
+ *      table of NUL-terminated strings, all checksummed.  At startup it
+ *      is mapped with mmap() and validated as a whole before any job is
+ *      created, so loading involves no parsing and no per-job file I/O.
+ *      Strings shared by consecutive jobs, e.g. elements of the same
+ *      job array, are stored once.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>      // open()
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "lpjs.h"
+#include "node-list.h"
+#include "job-list.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "misc.h"
+
+/***************************************************************************
+ *  Description:
+ *      Write the job lists and node allocations to LPJS_SNAPSHOT.
+ *      The snapshot is written to a temporary file and renamed, so a
+ *      crash leaves either the old or the new snapshot intact.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_snapshot_write(job_list_t *pending_jobs, job_list_t *running_jobs,
+			    node_list_t *node_list, unsigned long next_job_id)
+
+{
+    snapshot_header_t   header;
+    snapshot_job_t      *job_recs;
+    snapshot_node_t     *node_recs;
+    snapshot_strings_t  strings = { NULL, 0, 0 };
+    size_t              running_count = job_list_get_count(running_jobs),
+			pending_count = job_list_get_count(pending_jobs),
+			node_count = node_list_get_compute_node_count(node_list),
+			recs_size, c;
+    node_t              *node;
+    char                *temp_path = LPJS_SNAPSHOT ".new",
+			*buff;
+    int                 fd, status = LPJS_SUCCESS;
+
+    // Offset 0 is always valid, even with empty queues
+    lpjs_snapshot_add_string(&strings, "");
+    
+    recs_size = (running_count + pending_count) * sizeof(snapshot_job_t) +
+		node_count * sizeof(snapshot_node_t);
+    if ( (buff = malloc(recs_size + 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    job_recs = (snapshot_job_t *)buff;
+    node_recs = (snapshot_node_t *)(job_recs + running_count + pending_count);
+
+    // Running first, so they can be told apart by position
+    for (c = 0; c < running_count; ++c)
+	lpjs_snapshot_pack_job(&job_recs[c], c == 0 ? NULL : &job_recs[c - 1],
+			       job_list_get_jobs_ae(running_jobs, c), &strings);
+    for (c = 0; c < pending_count; ++c)
+	lpjs_snapshot_pack_job(&job_recs[running_count + c],
+			       c == 0 ? NULL : &job_recs[running_count + c - 1],
+			       job_list_get_jobs_ae(pending_jobs, c), &strings);
+    for (c = 0; c < node_count; ++c)
+    {
+	node = node_list_get_compute_nodes_ae(node_list, c);
+	memset(&node_recs[c], 0, sizeof(node_recs[c]));
+	node_recs[c].procs_used = node_get_procs_used(node);
+	node_recs[c].phys_MiB_used = node_get_phys_MiB_used(node);
+	node_recs[c].hostname =
+	    lpjs_snapshot_add_string(&strings, node_get_hostname(node));
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LPJS_SNAPSHOT_MAGIC, LPJS_SNAPSHOT_MAGIC_LEN);
+    header.version = LPJS_SNAPSHOT_VERSION;
+    header.byte_order = LPJS_SNAPSHOT_BYTE_ORDER;
+    header.next_job_id = next_job_id;
+    header.running_count = running_count;
+    header.pending_count = pending_count;
+    header.node_count = node_count;
+    header.strings_size = strings.len;
+    header.body_crc = lpjs_crc32_update(lpjs_crc32(buff, recs_size),
+					strings.buff, strings.len);
+    header.header_crc = lpjs_crc32(&header, sizeof(header));
+
+    if ( (fd = open(temp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 temp_path, strerror(errno));
+	status = LPJS_WRITE_FAILED;
+    }
+    else
+    {
+	if ( (lpjs_write_all(fd, &header, sizeof(header)) != 0) ||
+	     (lpjs_write_all(fd, buff, recs_size) != 0) ||
+	     (lpjs_write_all(fd, strings.buff, strings.len) != 0) ||
+	     (fsync(fd) != 0) )
+	{
+	    lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		     temp_path, strerror(errno));
+	    status = LPJS_WRITE_FAILED;
+	}
+	close(fd);
+    }
+    free(buff);
+    free(strings.buff);
+
+    if ( status == LPJS_SUCCESS )
+    {
+	if ( rename(temp_path, LPJS_SNAPSHOT) != 0 )
+	{
+	    lpjs_log("%s(): Error: Cannot rename %s: %s\n", __FUNCTION__,
+		     temp_path, strerror(errno));
+	    return LPJS_WRITE_FAILED;
+	}
+	lpjs_sync_dir(LPJS_SPOOL_DIR);
+    }
+
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fill in a snapshot record for job.  Strings equal to those of
+ *      the previous record share its string table entries.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_snapshot_pack_job(snapshot_job_t *rec, snapshot_job_t *prev_rec,
+			       job_t *job, snapshot_strings_t *strings)
+
+{
+    char    *fields[SNAPSHOT_JOB_STRINGS];
+    int     c;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->job_id = job_get_job_id(job);
+    rec->array_index = job_get_array_index(job);
+    rec->pmem_per_proc = job_get_pmem_per_proc(job);
+    rec->submit_time = job_get_submit_time(job);
+    rec->start_time = job_get_start_time(job);
+    for (c = 0; c < JOB_TIMING_STAGES; ++c)
+	rec->timing[c] = job_get_timing_ae(job, c);
+    rec->job_count = job_get_job_count(job);
+    rec->procs_per_job = job_get_procs_per_job(job);
+    rec->min_procs_per_node = job_get_min_procs_per_node(job);
+    rec->chaperone_pid = job_get_chaperone_pid(job);
+    rec->job_pid = job_get_job_pid(job);
+    rec->state = job_get_state(job);
+
+    fields[SNAPSHOT_USER_NAME] = job_get_user_name(job);
+    fields[SNAPSHOT_PRIMARY_GROUP_NAME] = job_get_primary_group_name(job);
+    fields[SNAPSHOT_SUBMIT_NODE] = job_get_submit_node(job);
+    fields[SNAPSHOT_SUBMIT_DIR] = job_get_submit_dir(job);
+    fields[SNAPSHOT_SCRIPT_NAME] = job_get_script_name(job);
+    fields[SNAPSHOT_COMPUTE_NODE] = job_get_compute_node(job);
+    fields[SNAPSHOT_LOG_DIR] = job_get_log_dir(job);
+    fields[SNAPSHOT_PUSH_COMMAND] = job_get_push_command(job);
+
+    for (c = 0; c < SNAPSHOT_JOB_STRINGS; ++c)
+    {
+	if ( (prev_rec != NULL) &&
+	     (strcmp(strings->buff + prev_rec->strings[c], fields[c]) == 0) )
+	    rec->strings[c] = prev_rec->strings[c];
+	else
+	    rec->strings[c] = lpjs_snapshot_add_string(strings, fields[c]);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append a string to the snapshot string table
+ *
+ *  Returns:
+ *      Offset of the string in the table
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint32_t    lpjs_snapshot_add_string(snapshot_strings_t *strings,
+				     const char *str)
+
+{
+    size_t      len = strlen(str) + 1;
+    uint32_t    offset = strings->len;
+
+    if ( strings->len + len > strings->size )
+    {
+	strings->size = (strings->size == 0) ? 65536 : strings->size * 2;
+	while ( strings->len + len > strings->size )
+	    strings->size *= 2;
+	if ( (strings->buff = realloc(strings->buff, strings->size)) == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    memcpy(strings->buff + strings->len, str, len);
+    strings->len += len;
+
+    return offset;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Restore the job lists and node allocations from LPJS_SNAPSHOT.
+ *      The whole file is validated before anything is loaded.  A
+ *      snapshot that exists but is invalid is a fatal error, since
+ *      starting with an empty queue would silently lose jobs.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if there is no snapshot
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_snapshot_load(job_list_t *pending_jobs, job_list_t *running_jobs,
+			   node_list_t *node_list, unsigned long *next_job_id)
+
+{
+    int                 fd;
+    struct stat         st;
+    void                *map;
+    snapshot_header_t   *header;
+    snapshot_job_t      *job_recs;
+    snapshot_node_t     *node_recs;
+    const char          *strings;
+    node_t              *node;
+    size_t              c;
+
+    if ( (fd = open(LPJS_SNAPSHOT, O_RDONLY)) == -1 )
+	return LPJS_READ_FAILED;
+    if ( fstat(fd, &st) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot stat %s: %s\n", __FUNCTION__,
+		 LPJS_SNAPSHOT, strerror(errno));
+	exit(EX_IOERR);
+    }
+    if ( (size_t)st.st_size < sizeof(snapshot_header_t) )
+    {
+	lpjs_log("%s(): Error: %s is truncated.\n", __FUNCTION__, LPJS_SNAPSHOT);
+	exit(EX_DATAERR);
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ( map == MAP_FAILED )
+    {
+	lpjs_log("%s(): Error: Cannot mmap %s: %s\n", __FUNCTION__,
+		 LPJS_SNAPSHOT, strerror(errno));
+	exit(EX_IOERR);
+    }
+
+    if ( lpjs_snapshot_validate(map, st.st_size) != LPJS_SUCCESS )
+    {
+	// Don't guess: Starting with an empty queue would lose jobs
+	lpjs_log("%s(): Error: %s is not a valid version %d snapshot.\n",
+		 __FUNCTION__, LPJS_SNAPSHOT, LPJS_SNAPSHOT_VERSION);
+	exit(EX_DATAERR);
+    }
+
+    header = map;
+    job_recs = (snapshot_job_t *)(header + 1);
+    node_recs = (snapshot_node_t *)(job_recs + header->running_count +
+				    header->pending_count);
+    strings = (const char *)(node_recs + header->node_count);
+
+    *next_job_id = header->next_job_id;
+    for (c = 0; c < header->running_count; ++c)
+	job_list_add_job(running_jobs,
+			 lpjs_snapshot_unpack_job(&job_recs[c], strings));
+    for (c = 0; c < header->pending_count; ++c)
+	job_list_add_job(pending_jobs,
+	    lpjs_snapshot_unpack_job(&job_recs[header->running_count + c],
+				     strings));
+
+    for (c = 0; c < header->node_count; ++c)
+    {
+	node = node_list_find_hostname(node_list,
+				       strings + node_recs[c].hostname);
+	if ( node == NULL )
+	{
+	    if ( node_recs[c].procs_used > 0 )
+		lpjs_log("%s(): Warning: %s has running jobs, but is no longer in the config.\n",
+			 __FUNCTION__, strings + node_recs[c].hostname);
+	}
+	else
+	{
+	    node_set_procs_used(node, node_recs[c].procs_used);
+	    node_set_phys_MiB_used(node, node_recs[c].phys_MiB_used);
+	}
+    }
+
+    munmap(map, st.st_size);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check the magic, version, byte order, size, and checksums of a
+ *      mapped snapshot, and that all string offsets are in range.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if anything is wrong
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_snapshot_validate(const void *map, size_t size)
+
+{
+    snapshot_header_t   header;
+    const snapshot_job_t    *job_recs;
+    const snapshot_node_t   *node_recs;
+    const char          *body = (const char *)map + sizeof(header);
+    uint32_t            header_crc;
+    uint64_t            job_count, c;
+    int                 s;
+
+    memcpy(&header, map, sizeof(header));
+    header_crc = header.header_crc;
+    header.header_crc = 0;
+    if ( (memcmp(header.magic, LPJS_SNAPSHOT_MAGIC, LPJS_SNAPSHOT_MAGIC_LEN) != 0) ||
+	 (header.version != LPJS_SNAPSHOT_VERSION) ||
+	 (header.byte_order != LPJS_SNAPSHOT_BYTE_ORDER) ||
+	 (lpjs_crc32(&header, sizeof(header)) != header_crc) )
+	return LPJS_READ_FAILED;
+
+    // Guard against overflow before computing the expected size
+    job_count = header.running_count + header.pending_count;
+    if ( (job_count > JOB_LIST_MAX_JOBS) ||
+	 (header.node_count > size) || (header.strings_size > size) ||
+	 (size != sizeof(header) + job_count * sizeof(snapshot_job_t) +
+		  header.node_count * sizeof(snapshot_node_t) +
+		  header.strings_size) ||
+	 (lpjs_crc32(body, size - sizeof(header)) != header.body_crc) )
+	return LPJS_READ_FAILED;
+
+    // Strings must be terminated, and offsets must be within the table
+    if ( (header.strings_size == 0) || (((const char *)map)[size - 1] != '\0') )
+	return LPJS_READ_FAILED;
+    job_recs = (const snapshot_job_t *)body;
+    for (c = 0; c < job_count; ++c)
+	for (s = 0; s < SNAPSHOT_JOB_STRINGS; ++s)
+	    if ( job_recs[c].strings[s] >= header.strings_size )
+		return LPJS_READ_FAILED;
+    node_recs = (const snapshot_node_t *)(job_recs + job_count);
+    for (c = 0; c < header.node_count; ++c)
+	if ( node_recs[c].hostname >= header.strings_size )
+	    return LPJS_READ_FAILED;
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create a job from a snapshot record
+ *
+ *  Returns:
+ *      Pointer to the new job_t object
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+job_t   *lpjs_snapshot_unpack_job(const snapshot_job_t *rec,
+				  const char *strings)
+
+{
+    // job_new() terminates the process if malloc fails
+    job_t   *job = job_new();
+    int     c;
+
+    job_set_job_id(job, rec->job_id);
+    job_set_array_index(job, rec->array_index);
+    job_set_pmem_per_proc(job, rec->pmem_per_proc);
+    job_set_submit_time(job, rec->submit_time);
+    job_set_start_time(job, rec->start_time);
+    for (c = 0; c < JOB_TIMING_STAGES; ++c)
+	job_set_timing_ae(job, c, rec->timing[c]);
+    job_set_job_count(job, rec->job_count);
+    job_set_procs_per_job(job, rec->procs_per_job);
+    job_set_min_procs_per_node(job, rec->min_procs_per_node);
+    job_set_chaperone_pid(job, rec->chaperone_pid);
+    job_set_job_pid(job, rec->job_pid);
+    job_set_state(job, rec->state);
+
+    // job_init() allocates a default push command
+    free(job_get_push_command(job));
+    job_set_user_name(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_USER_NAME]));
+    job_set_primary_group_name(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_PRIMARY_GROUP_NAME]));
+    job_set_submit_node(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_SUBMIT_NODE]));
+    job_set_submit_dir(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_SUBMIT_DIR]));
+    job_set_script_name(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_SCRIPT_NAME]));
+    job_set_compute_node(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_COMPUTE_NODE]));
+    job_set_log_dir(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_LOG_DIR]));
+    job_set_push_command(job,
+	lpjs_strdup(strings + rec->strings[SNAPSHOT_PUSH_COMMAND]));
+
+    return job;
+}
@@ -0,0 +1,97 @@
+#ifndef _LPJS_SNAPSHOT_H_
+#define _LPJS_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#ifndef _LPJS_JOB_LIST_H_
+#include "job-list.h"
+#endif
+
+#ifndef _NODE_LIST_H_
+#include "node-list.h"
+#endif
+
+/*
+ *  Binary queue snapshot written by lpjs_journal_compact() and mapped
+ *  with mmap() at startup.  Layout:
+ *
+ *      snapshot_header_t
+ *      snapshot_job_t      [running_count]
+ *      snapshot_job_t      [pending_count]
+ *      snapshot_node_t     [node_count]
+ *      char                strings[strings_size]   NUL-terminated strings
+ *
+ *  The file is only ever read by the dispatchd that wrote it, so fields
+ *  are in host byte order.  LPJS_SNAPSHOT_BYTE_ORDER detects a spool
+ *  directory moved to a different architecture.
+ */
+
+#define LPJS_SNAPSHOT_MAGIC         "LPJSSNAP"
+#define LPJS_SNAPSHOT_MAGIC_LEN     8
+#define LPJS_SNAPSHOT_VERSION       4
+#define LPJS_SNAPSHOT_BYTE_ORDER    0x01020304
+
+typedef struct
+{
+    char        magic[LPJS_SNAPSHOT_MAGIC_LEN];
+    uint32_t    version;
+    uint32_t    byte_order;
+    uint64_t    next_job_id;
+    uint64_t    running_count;
+    uint64_t    pending_count;
+    uint64_t    node_count;
+    uint64_t    strings_size;
+    uint32_t    body_crc;       // Everything after the header
+    uint32_t    header_crc;     // Header with this field set to 0
+}   snapshot_header_t;
+
+// Offsets into the string table
+typedef enum
+{
+    SNAPSHOT_USER_NAME = 0,
+    SNAPSHOT_PRIMARY_GROUP_NAME,
+    SNAPSHOT_SUBMIT_NODE,
+    SNAPSHOT_SUBMIT_DIR,
+    SNAPSHOT_SCRIPT_NAME,
+    SNAPSHOT_COMPUTE_NODE,
+    SNAPSHOT_LOG_DIR,
+    SNAPSHOT_PUSH_COMMAND,
+    SNAPSHOT_JOB_STRINGS
+}   snapshot_job_string_t;
+
+typedef struct
+{
+    uint64_t    job_id;
+    uint64_t    array_index;
+    uint64_t    pmem_per_proc;
+    int64_t     submit_time;
+    int64_t     start_time;
+    int64_t     timing[JOB_TIMING_STAGES];
+    uint32_t    job_count;
+    uint32_t    procs_per_job;
+    uint32_t    min_procs_per_node;
+    int32_t     chaperone_pid;
+    int32_t     job_pid;
+    int32_t     state;
+    uint32_t    strings[SNAPSHOT_JOB_STRINGS];
+}   snapshot_job_t;
+
+// String table under construction
+typedef struct
+{
+    char        *buff;
+    size_t      len;
+    size_t      size;
+}   snapshot_strings_t;
+
+// Resources allocated to running jobs on each node
+typedef struct
+{
+    uint64_t    phys_MiB_used;
+    uint32_t    procs_used;
+    uint32_t    hostname;
+}   snapshot_node_t;
+
+#include "snapshot-protos.h"
+
+#endif  // _LPJS_SNAPSHOT_H_
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *  Description:
+ *      Show dispatchd performance metrics: request counts and
+ *      latencies, scheduling and I/O times, and queue depth.
+ *
+ *  History: 
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sysexits.h>
+
+#include "node-list.h"
+#include "config.h"
+#include "network.h"
+#include "metrics.h"
+#include "lpjs.h"
+
+int     main(int argc,char *argv[])
+
+{
+    int         msg_fd;
+    // Terminates process if malloc() fails, no check required
+    node_list_t *node_list = node_list_new();
+    extern FILE *Log_stream;
+    char        outgoing_msg[LPJS_MSG_LEN_MAX + 1];
+    
+    outgoing_msg[1] = LPJS_METRICS_FORMAT_SUMMARY;
+    if ( (argc == 2) && (strcmp(argv[1], "--prometheus") == 0) )
+	outgoing_msg[1] = LPJS_METRICS_FORMAT_PROMETHEUS;
+    else if ( argc != 1 )
+    {
+	fprintf (stderr, "Usage: %s [--prometheus]\n", argv[0]);
+	return EX_USAGE;
+    }
+
+    // Shared functions may use lpjs_log
+    Log_stream = stderr;
+    
+    // Get hostname of head node
+    lpjs_load_config(node_list, LPJS_CONFIG_HEAD_ONLY, stderr);
+
+    if ( (msg_fd = lpjs_connect_to_dispatchd(node_list)) == -1 )
+    {
+	perror("lpjs-stats: Failed to connect to dispatch");
+	return EX_IOERR;
+    }
+
+    outgoing_msg[0] = LPJS_DISPATCHD_REQUEST_STATS;
+    outgoing_msg[2] = '\0';
+    if ( lpjs_send_munge(msg_fd, outgoing_msg, close) != LPJS_MSG_SENT )
+    {
+	perror("lpjs-stats: Failed to send message to dispatch");
+	close(msg_fd);
+	return EX_IOERR;
+    }
+
+    lpjs_print_response(msg_fd, "lpjs-stats");
+    close (msg_fd);
+
+    return EX_OK;
+}
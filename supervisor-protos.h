@@ -0,0 +1,16 @@
+/* supervisor.c */
+supervisor_t *supervisor_new(void);
+int supervisor_start(supervisor_t *supervisor);
+void supervisor_sigchld_handler(int s2);
+void supervisor_add(supervisor_t *supervisor, unsigned long job_id, pid_t pid, int launch_fd);
+void supervisor_adopt(supervisor_t *supervisor, inventory_t *inventory);
+size_t supervisor_find(supervisor_t *supervisor, pid_t pid);
+bool supervisor_cancel(supervisor_t *supervisor, pid_t pid);
+void supervisor_kill(supervised_job_t *job);
+struct pollfd *supervisor_poll_fds(supervisor_t *supervisor, int compd_msg_fd, nfds_t *nfds);
+void supervisor_read_launch(supervised_job_t *job);
+void supervisor_hold_inventory(inventory_t *inventory, unsigned long job_id);
+bool supervisor_report(supervisor_t *supervisor, supervised_job_t *job, relay_t *relay);
+void supervisor_check(supervisor_t *supervisor, relay_t *relay, inventory_t *inventory);
+void supervisor_sample(supervisor_t *supervisor);
+void supervisor_add_cgroup_usage(supervised_job_t *job);
@@ -0,0 +1,705 @@
+/***************************************************************************
+ *  Description:
+ *      Job supervision by lpjs_compd, for "job-supervisor compd".
+ *
+ *      A chaperone per job costs a process for the life of the job,
+ *      plus a config load and three connections to dispatchd.  When
+ *      compd supervises, it forks each job script directly (see
+ *      lpjs_supervise_job()), becomes a subreaper so that orphaned
+ *      job processes are reparented to it rather than init, and reaps
+ *      everything from its event loop through a SIGCHLD self-pipe.
+ *      Start, launch failure, and completion reports are queued with
+ *      those relayed from chaperones, and go over the connection compd
+ *      already holds to dispatchd (see relay.c).
+ *
+ *      The job stays in the inventory until dispatchd acknowledges its
+ *      completion report, as it would if its chaperone were still
+ *      trying to send it.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <inttypes.h>   // intmax_t
+#include <limits.h>     // PATH_MAX
+#include <sys/wait.h>
+#include <sys/resource.h>   // struct rusage
+
+#ifdef __linux__
+#include <sys/prctl.h>      // PR_SET_CHILD_SUBREAPER
+#elif defined(__FreeBSD__) || defined(__DragonFly__)
+#include <sys/procctl.h>    // PROC_REAP_ACQUIRE
+#endif
+
+#include "lpjs.h"
+#include "misc.h"
+#include "network.h"
+#include "inventory.h"
+#include "relay.h"
+#include "supervisor.h"
+#include "config.h"
+#include "cgroup.h"
+
+// Written by the SIGCHLD handler to wake the event loop
+static int  Sigchld_pipe[2] = { -1, -1 };
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for supervisor_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+supervisor_t    *supervisor_new(void)
+
+{
+    supervisor_t    *supervisor;
+
+    if ( (supervisor = malloc(sizeof(*supervisor))) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    supervisor->count = 0;
+    supervisor->array_size = 0;
+    supervisor->jobs = NULL;
+    supervisor->reaping = false;
+    supervisor->poll_fds = NULL;
+    supervisor->poll_fds_size = 0;
+    gethostname(supervisor->hostname, LPJS_HOSTNAME_MAX + 1);
+    supervisor->proctree = proctree_new();
+    supervisor->next_sample = 0;
+
+    return supervisor;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Take over reaping from sigchld_handler().  Exited children are
+ *      reaped by supervisor_check(), so that the exit status of
+ *      supervised jobs can be reported.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_WRITE_FAILED if the self-pipe cannot
+ *      be created
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     supervisor_start(supervisor_t *supervisor)
+
+{
+    int     c;
+
+    if ( pipe(Sigchld_pipe) != 0 )
+    {
+	lpjs_log("%s(): Error: pipe() failed: %s\n", __FUNCTION__,
+		 strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+    for (c = 0; c < 2; ++c)
+    {
+	fcntl(Sigchld_pipe[c], F_SETFL, O_NONBLOCK);
+	fcntl(Sigchld_pipe[c], F_SETFD, FD_CLOEXEC);
+    }
+
+    /*
+     *  Job processes left behind when a script exits, such as daemons
+     *  started by the script, are reparented to compd instead of init,
+     *  so compd knows about them and reaps them.
+     */
+#if defined(__linux__)
+    if ( prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0) != 0 )
+	lpjs_log("%s(): Warning: PR_SET_CHILD_SUBREAPER failed: %s\n",
+		 __FUNCTION__, strerror(errno));
+#elif defined(__FreeBSD__) || defined(__DragonFly__)
+    if ( procctl(P_PID, getpid(), PROC_REAP_ACQUIRE, NULL) != 0 )
+	lpjs_log("%s(): Warning: PROC_REAP_ACQUIRE failed: %s\n",
+		 __FUNCTION__, strerror(errno));
+#endif
+
+    supervisor->reaping = true;
+    signal(SIGCHLD, supervisor_sigchld_handler);
+    lpjs_log("%s(): Supervising jobs in compd.\n", __FUNCTION__);
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wake the event loop to reap children.  Reaping is left to
+ *      supervisor_check(), which has the job table.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_sigchld_handler(int s2)
+
+{
+    int     saved_errno = errno;
+
+    // Pipe full means a wakeup is already pending
+    write(Sigchld_pipe[1], "", 1);
+    errno = saved_errno;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a newly forked job.  launch_fd is the read end of the
+ *      child's launch pipe.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_add(supervisor_t *supervisor, unsigned long job_id,
+		       pid_t pid, int launch_fd)
+
+{
+    supervised_job_t    *job;
+
+    if ( supervisor->count == supervisor->array_size )
+    {
+	supervisor->array_size = (supervisor->array_size == 0) ? 64 :
+				 supervisor->array_size * 2;
+	supervisor->jobs = realloc(supervisor->jobs,
+			supervisor->array_size * sizeof(*supervisor->jobs));
+	if ( supervisor->jobs == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    job = &supervisor->jobs[supervisor->count++];
+    job->job_id = job_id;
+    job->pid = pid;
+    job->launch_fd = launch_fd;
+    // Replaced by the child's first record.  EOF without one is a crash.
+    job->launch.status = LPJS_CHAPERONE_OSERR;
+    job->launch.exec_time = 0;
+    job->adopted = false;
+    job->start_sent = false;
+    job->exited = false;
+    job->status = 0;
+    job->complete_sent = false;
+    job->kill_time = 0;
+    job->family = NULL;
+    job_usage_init(&job->usage);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Watch jobs started by a previous compd, whose scripts are
+ *      still running.  They are no longer our children, so their exit
+ *      is detected by polling, and their exit status is unknown.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_adopt(supervisor_t *supervisor, inventory_t *inventory)
+
+{
+    size_t              c;
+    inventory_entry_t   *entry;
+    supervised_job_t    *job;
+
+    for (c = 0; c < inventory->count; ++c)
+    {
+	entry = &inventory->entries[c];
+	if ( (entry->job_pid != 0) &&
+	     (entry->chaperone_pid == entry->job_pid) )
+	{
+	    supervisor_add(supervisor, entry->job_id, entry->job_pid, -1);
+	    job = &supervisor->jobs[supervisor->count - 1];
+	    job->launch.status = LPJS_CHAPERONE_OK;
+	    job->adopted = true;
+	    job->start_sent = true;
+	    lpjs_log("%s(): Adopted job %lu, PID %d.\n", __FUNCTION__,
+		     entry->job_id, entry->job_pid);
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find a running supervised job by script PID.  Exited jobs are
+ *      skipped, as their PIDs may have been reused.
+ *
+ *  Returns:
+ *      Index of the job, or SUPERVISOR_NOT_FOUND
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Skip exited jobs
+ ***************************************************************************/
+
+size_t  supervisor_find(supervisor_t *supervisor, pid_t pid)
+
+{
+    size_t  c;
+
+    for (c = 0; c < supervisor->count; ++c)
+	if ( (supervisor->jobs[c].pid == pid) && ! supervisor->jobs[c].exited )
+	    return c;
+
+    return SUPERVISOR_NOT_FOUND;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Cancel a supervised job: SIGTERM to all its processes now, and
+ *      SIGKILL from supervisor_check() if it is still running after
+ *      cancel-grace seconds.  Does not wait, unlike the chaperone.
+ *
+ *      Its processes are found through its cgroup, or else its
+ *      process group and descendants.  The latter are remembered for
+ *      SIGKILL, since they are orphaned if the script exits first.
+ *      This misses those that had left the group and been orphaned
+ *      before the cancel.
+ *
+ *  Returns:
+ *      true if pid is a supervised job, false if it may be a chaperone
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Signal the job's cgroup or process tree
+ ***************************************************************************/
+
+bool    supervisor_cancel(supervisor_t *supervisor, pid_t pid)
+
+{
+    size_t              c;
+    supervised_job_t    *job;
+    extern lpjs_config_t    Config;
+
+    // An exited job awaiting its completion report is listed under
+    // compd's own PID.  Never signal ourselves.
+    if ( pid == getpid() )
+	return true;
+
+    if ( (c = supervisor_find(supervisor, pid)) == SUPERVISOR_NOT_FOUND )
+    {
+	// Exited, but dispatchd may not know yet
+	for (c = 0; c < supervisor->count; ++c)
+	    if ( supervisor->jobs[c].pid == pid )
+		return true;
+	return false;
+    }
+
+    job = &supervisor->jobs[c];
+    if ( job->kill_time != 0 )
+	return true;    // Already canceled
+
+    lpjs_log("%s(): Sending SIGTERM to job %lu, process group %d...\n",
+	     __FUNCTION__, job->job_id, pid);
+    if ( lpjs_cgroup_signal(job->job_id, SIGTERM) == 0 )
+    {
+	// Before the script can exit, orphaning the rest
+	// Terminates process if malloc() fails, no check required
+	job->family = proctree_family(pid);
+	proctree_signal(job->family, SIGTERM);
+    }
+    killpg(pid, SIGTERM);
+    if ( Config.cancel_grace == 0 )
+	supervisor_kill(job);
+    else
+	job->kill_time = time(NULL) + Config.cancel_grace;
+
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      SIGKILL everything left of a canceled job, even after its
+ *      script has exited
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_kill(supervised_job_t *job)
+
+{
+    lpjs_log("%s(): Sending SIGKILL to job %lu, process group %d...\n",
+	     __FUNCTION__, job->job_id, job->pid);
+    if ( lpjs_cgroup_kill(job->job_id) != LPJS_SUCCESS )
+    {
+	// Once reaped, the script's PID and process group may be reused
+	if ( job->family != NULL )
+	    proctree_signal(job->family, SIGKILL);
+	if ( ! job->exited )
+	{
+	    proctree_signal_family(job->pid, SIGKILL);
+	    killpg(job->pid, SIGKILL);
+	}
+    }
+    if ( job->family != NULL )
+    {
+	proctree_free(job->family);
+	job->family = NULL;
+    }
+    job->kill_time = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fill the poll() array for the compd event loop: The connection
+ *      to dispatchd first, then the SIGCHLD pipe and launch pipes.
+ *
+ *  Returns:
+ *      The array, which belongs to the supervisor
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+struct pollfd   *supervisor_poll_fds(supervisor_t *supervisor,
+				     int compd_msg_fd, nfds_t *nfds)
+
+{
+    size_t  c, n;
+
+    if ( supervisor->poll_fds_size < supervisor->count + 2 )
+    {
+	supervisor->poll_fds_size = supervisor->count + 64;
+	supervisor->poll_fds = realloc(supervisor->poll_fds,
+		supervisor->poll_fds_size * sizeof(*supervisor->poll_fds));
+	if ( supervisor->poll_fds == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+
+    // POLLERR and POLLHUP are actually always set.  Listing POLLHUP here
+    // just for documentation.
+    supervisor->poll_fds[0].fd = compd_msg_fd;
+    supervisor->poll_fds[0].events = POLLIN | POLLHUP;
+    supervisor->poll_fds[0].revents = 0;
+    n = 1;
+    if ( Sigchld_pipe[0] != -1 )
+    {
+	supervisor->poll_fds[n].fd = Sigchld_pipe[0];
+	supervisor->poll_fds[n].events = POLLIN;
+	supervisor->poll_fds[n++].revents = 0;
+    }
+    for (c = 0; c < supervisor->count; ++c)
+    {
+	if ( supervisor->jobs[c].launch_fd != -1 )
+	{
+	    supervisor->poll_fds[n].fd = supervisor->jobs[c].launch_fd;
+	    supervisor->poll_fds[n].events = POLLIN;
+	    supervisor->poll_fds[n++].revents = 0;
+	}
+    }
+    *nfds = n;
+
+    return supervisor->poll_fds;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read launch records from a job's pipe, without blocking.  The
+ *      pipe reaches EOF when the script is exec()ed or the child
+ *      exits.  Records are smaller than PIPE_BUF, so reads are never
+ *      partial.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_read_launch(supervised_job_t *job)
+
+{
+    supervisor_launch_t launch;
+    ssize_t             bytes;
+
+    while ( (bytes = read(job->launch_fd, &launch, sizeof(launch)))
+	    == sizeof(launch) )
+	job->launch = launch;
+
+    if ( (bytes == 0) || ((bytes == -1) && (errno != EAGAIN) &&
+			  (errno != EINTR)) )
+    {
+	close(job->launch_fd);
+	job->launch_fd = -1;
+	lpjs_debug("%s(): Job %lu launch status %d.\n", __FUNCTION__,
+		   job->job_id, job->launch.status);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Keep the inventory entry of an exited job until its completion
+ *      is acknowledged, under compd's own PID so that inventory_prune()
+ *      sees it as live.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_hold_inventory(inventory_t *inventory,
+				  unsigned long job_id)
+
+{
+    size_t  c;
+
+    if ( (c = inventory_find(inventory, job_id)) != INVENTORY_NOT_FOUND )
+    {
+	inventory->entries[c].chaperone_pid = getpid();
+	inventory_save(inventory, LPJS_COMPD_INVENTORY);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Queue the reports due for a job for dispatchd.
+ *
+ *  Returns:
+ *      true if nothing more will be reported, so the job can be
+ *      dropped
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Queue reports in the relay
+ *  2026-10-19  Jason Bacon Report completion only once
+ *  2026-10-19  Jason Bacon Add measured usage
+ ***************************************************************************/
+
+bool    supervisor_report(supervisor_t *supervisor, supervised_job_t *job,
+			  relay_t *relay)
+
+{
+    char    record[RELAY_RECORD_MAX + 1],
+	    usage_str[JOB_USAGE_STR_MAX + 1];
+
+    if ( job->complete_sent )
+	return true;
+    if ( job->launch_fd != -1 )
+	return false;
+
+    // Same reports a chaperone sends, see lpjs_send_chaperone_status_loop(),
+    // lpjs_job_start_notice_loop(), and lpjs_chaperone_completion_loop()
+    if ( job->launch.status != LPJS_CHAPERONE_OK )
+    {
+	snprintf(record, RELAY_RECORD_MAX + 1, "%c%lu %d %s",
+		 LPJS_DISPATCHD_REQUEST_CHAPERONE_STATUS, job->job_id,
+		 job->launch.status, supervisor->hostname);
+	relay_add(relay, record, job->job_id);
+	lpjs_log("%s(): Job %lu failed to launch: %d\n", __FUNCTION__,
+		 job->job_id, job->launch.status);
+	job->complete_sent = true;
+	return true;
+    }
+
+    if ( ! job->start_sent )
+    {
+	snprintf(record, RELAY_RECORD_MAX + 1, "%c%s %lu %d %d %jd",
+		 LPJS_DISPATCHD_REQUEST_JOB_STARTED, supervisor->hostname,
+		 job->job_id, job->pid, job->pid,
+		 (intmax_t)job->launch.exec_time);
+	relay_add(relay, record, 0);
+	job->start_sent = true;
+    }
+
+    if ( ! job->exited )
+	return false;
+
+    snprintf(record, RELAY_RECORD_MAX + 1, "%c%s %lu %d %s",
+	     LPJS_DISPATCHD_REQUEST_JOB_COMPLETE, supervisor->hostname,
+	     job->job_id, job->status,
+	     job_usage_to_str(&job->usage, usage_str, JOB_USAGE_STR_MAX + 1));
+    relay_add(relay, record, job->job_id);
+    lpjs_log("%s(): Job %lu completion queued, used %s.\n", __FUNCTION__,
+	     job->job_id, job_usage_describe(&job->usage, usage_str,
+					     JOB_USAGE_STR_MAX + 1));
+    job->complete_sent = true;
+
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Called on every pass of the compd event loop: Collect launch
+ *      status, reap exited children, finish cancellations, and queue
+ *      any reports that are due.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Queue reports in the relay
+ *  2026-10-19  Jason Bacon Kill canceled jobs with supervisor_kill()
+ *  2026-10-19  Jason Bacon Measure usage
+ ***************************************************************************/
+
+void    supervisor_check(supervisor_t *supervisor, relay_t *relay,
+			 inventory_t *inventory)
+
+{
+    extern lpjs_config_t   Config;
+    char                wakeups[64];
+    int                 status;
+    pid_t               pid;
+    size_t              c, kept;
+    time_t              now;
+    supervised_job_t    *job;
+    struct rusage       ru;
+
+    for (c = 0; c < supervisor->count; ++c)
+	if ( supervisor->jobs[c].launch_fd != -1 )
+	    supervisor_read_launch(&supervisor->jobs[c]);
+
+    if ( supervisor->reaping )
+    {
+	// Drain wakeups before reaping, so that none are missed
+	while ( read(Sigchld_pipe[0], wakeups, sizeof(wakeups)) > 0 )
+	    ;
+
+	// Includes chaperones and orphans reparented to us as subreaper
+	while ( (pid = wait4(-1, &status, WNOHANG, &ru)) > 0 )
+	{
+	    if ( (c = supervisor_find(supervisor, pid)) == SUPERVISOR_NOT_FOUND )
+		continue;
+	    job = &supervisor->jobs[c];
+
+	    // The child is gone, so the pipe holds all it will ever write
+	    if ( job->launch_fd != -1 )
+		supervisor_read_launch(job);
+	    job->exited = true;
+	    job->status = status;
+	    job_usage_add_rusage(&job->usage, &ru);
+	    supervisor_add_cgroup_usage(job);
+	    lpjs_log("%s(): Job %lu exited with status %d.\n", __FUNCTION__,
+		     job->job_id, status);
+	    if ( job->launch.status == LPJS_CHAPERONE_OK )
+		supervisor_hold_inventory(inventory, job->job_id);
+	}
+    }
+
+    now = time(NULL);
+    if ( (Config.usage_interval > 0) && (now >= supervisor->next_sample) )
+    {
+	supervisor_sample(supervisor);
+	supervisor->next_sample = now + Config.usage_interval;
+    }
+
+    for (c = 0; c < supervisor->count; ++c)
+    {
+	job = &supervisor->jobs[c];
+	if ( job->adopted && ! job->exited &&
+	     (kill(job->pid, 0) != 0) && (errno == ESRCH) )
+	{
+	    job->exited = true;
+	    job->status = SUPERVISOR_STATUS_UNKNOWN;
+	    supervisor_add_cgroup_usage(job);
+	    lpjs_log("%s(): Adopted job %lu exited.\n", __FUNCTION__,
+		     job->job_id);
+	    supervisor_hold_inventory(inventory, job->job_id);
+	}
+
+	// Orphans of a canceled job may outlive it
+	if ( (job->kill_time != 0) && (now >= job->kill_time) )
+	    supervisor_kill(job);
+    }
+
+    // Keep canceled jobs until their grace period is over
+    for (c = kept = 0; c < supervisor->count; ++c)
+    {
+	if ( ! supervisor_report(supervisor, &supervisor->jobs[c], relay) ||
+	     (supervisor->jobs[c].kill_time != 0) )
+	    supervisor->jobs[kept++] = supervisor->jobs[c];
+    }
+    supervisor->count = kept;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Update the usage of running jobs from one read of the process
+ *      table.  See job-usage.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_sample(supervisor_t *supervisor)
+
+{
+    size_t              c;
+    bool                loaded = false;
+    supervised_job_t    *job;
+
+    for (c = 0; c < supervisor->count; ++c)
+    {
+	job = &supervisor->jobs[c];
+	if ( job->exited || (job->launch.status != LPJS_CHAPERONE_OK) )
+	    continue;
+	// No need to read the process table if no jobs are running
+	if ( ! loaded )
+	{
+	    if ( proctree_load(supervisor->proctree) != LPJS_SUCCESS )
+		return;
+	    loaded = true;
+	}
+	job_usage_sample(&job->usage, supervisor->proctree, job->pid);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Merge the usage of an exited job's cgroup, if it has one
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    supervisor_add_cgroup_usage(supervised_job_t *job)
+
+{
+    char            dir[PATH_MAX + 1];
+    cgroup_usage_t  cg_usage;
+
+    if ( (lpjs_cgroup_job_dir(job->job_id, dir, PATH_MAX + 1) != NULL) &&
+	 (lpjs_cgroup_usage(dir, &cg_usage) == LPJS_SUCCESS) )
+	job_usage_add_cgroup(&job->usage, &cg_usage);
+}
@@ -0,0 +1,86 @@
+#ifndef _LPJS_SUPERVISOR_H_
+#define _LPJS_SUPERVISOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/types.h>  // pid_t
+
+#ifndef _LPJS_H_
+#include "lpjs.h"       // LPJS_HOSTNAME_MAX
+#endif
+
+#ifndef _LPJS_NETWORK_H_
+#include "network.h"    // chaperone_status_t
+#endif
+
+#ifndef _LPJS_INVENTORY_H_
+#include "inventory.h"
+#endif
+
+#ifndef _LPJS_RELAY_H_
+#include "relay.h"
+#endif
+
+#ifndef _LPJS_PROCTREE_H_
+#include "proctree.h"
+#endif
+
+#ifndef _LPJS_JOB_USAGE_H_
+#include "job-usage.h"
+#endif
+
+/*
+ *  Jobs supervised by lpjs_compd itself ("job-supervisor compd"),
+ *  instead of a chaperone process per job.  compd forks each script
+ *  directly, reaps it from its event loop, and queues its start and
+ *  completion reports with those relayed from chaperones.  The forked
+ *  child writes supervisor_launch_t records to a close-on-exec pipe,
+ *  so compd learns the exec() time or why the launch failed without
+ *  waiting for it.  Running jobs are sampled every usage-interval
+ *  seconds, and their usage is sent with the completion report, as
+ *  the chaperone does.  See supervisor.c.
+ */
+
+#define SUPERVISOR_NOT_FOUND        ((size_t)-1)
+#define SUPERVISOR_STATUS_UNKNOWN   -1  // Exit of a job adopted at startup
+
+typedef struct
+{
+    int32_t         status;         // chaperone_status_t
+    int64_t         exec_time;      // lpjs_time_us() just before exec()
+}   supervisor_launch_t;
+
+typedef struct
+{
+    unsigned long   job_id;
+    pid_t           pid;            // Script, and its process group
+    int             launch_fd;      // Launch pipe, -1 once at EOF
+    supervisor_launch_t launch;     // Last record received
+    bool            adopted;        // Started by an earlier compd
+    bool            start_sent;
+    bool            exited;
+    int             status;         // From waitpid() once exited
+    bool            complete_sent;
+    time_t          kill_time;      // When to SIGKILL after cancel, or 0
+    proctree_t      *family;        // Processes at cancel, if no cgroup
+    job_usage_t     usage;
+}   supervised_job_t;
+
+typedef struct
+{
+    size_t              count;
+    size_t              array_size;
+    supervised_job_t    *jobs;
+    bool                reaping;    // Started, reaping all children
+    struct pollfd       *poll_fds;
+    size_t              poll_fds_size;
+    char                hostname[LPJS_HOSTNAME_MAX + 1];
+    proctree_t          *proctree;  // For usage samples
+    time_t              next_sample;
+}   supervisor_t;
+
+#include "supervisor-protos.h"
+
+#endif  // _LPJS_SUPERVISOR_H_
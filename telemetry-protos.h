@@ -0,0 +1,15 @@
+/* telemetry.c */
+telemetry_t *telemetry_new(void);
+void telemetry_free(telemetry_t *telemetry);
+void telemetry_add_job(telemetry_t *telemetry, unsigned long job_id, size_t rss_MiB, unsigned long cpu_sec);
+void telemetry_sample_memory(telemetry_t *telemetry);
+void telemetry_sample(telemetry_t *telemetry, inventory_t *inventory, proctree_t *tree);
+char *telemetry_to_str(telemetry_t *telemetry, char *str, size_t buff_len);
+int telemetry_from_str(telemetry_t *telemetry, const char *str);
+void lpjs_telemetry_update(node_t *node, const char *str, job_list_t *running_jobs);
+void lpjs_telemetry_charge_jobs(telemetry_t *telemetry, job_list_t *running_jobs);
+void lpjs_telemetry_release(node_t *node, job_t *job);
+void lpjs_telemetry_release_all(node_t *node);
+size_t lpjs_telemetry_avail_MiB(node_t *node);
+size_t lpjs_telemetry_reclaim_MiB(node_t *node);
+void telemetry_status_to_str(node_t *node, char *str, size_t array_size);
@@ -0,0 +1,520 @@
+/***************************************************************************
+ *  Description:
+ *      Resource telemetry from compute nodes.  lpjs_compd measures
+ *      load, memory, and the RSS of each job, and dispatchd keeps the
+ *      last report for each node.  See telemetry.h.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>     // SIZE_MAX
+#include <sysexits.h>
+#include <unistd.h>     // getpid()
+#if defined(__FreeBSD__)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#include <vm/vm_param.h>    // struct xswdev
+#endif
+
+#include "lpjs.h"
+#include "misc.h"
+#include "config.h"
+#include "telemetry.h"
+
+/***************************************************************************
+ *  Description:
+ *      Constructor for telemetry_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+telemetry_t *telemetry_new(void)
+
+{
+    telemetry_t *telemetry;
+
+    if ( (telemetry = calloc(1, sizeof(*telemetry))) == NULL )
+    {
+	lpjs_log("%s(): Error: calloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+
+    return telemetry;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Destructor for telemetry_t
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    telemetry_free(telemetry_t *telemetry)
+
+{
+    free(telemetry->jobs);
+    free(telemetry);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a job's RSS and CPU time to a report
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add CPU time
+ ***************************************************************************/
+
+void    telemetry_add_job(telemetry_t *telemetry, unsigned long job_id,
+			  size_t rss_MiB, unsigned long cpu_sec)
+
+{
+    if ( telemetry->job_count == telemetry->job_array_size )
+    {
+	telemetry->job_array_size = (telemetry->job_array_size == 0) ? 64 :
+				    telemetry->job_array_size * 2;
+	telemetry->jobs = realloc(telemetry->jobs,
+		telemetry->job_array_size * sizeof(*telemetry->jobs));
+	if ( telemetry->jobs == NULL )
+	{
+	    lpjs_log("%s(): Error: realloc() failed.\n", __FUNCTION__);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    telemetry->jobs[telemetry->job_count].job_id = job_id;
+    telemetry->jobs[telemetry->job_count].rss_MiB = rss_MiB;
+    telemetry->jobs[telemetry->job_count].cpu_sec = cpu_sec;
+    ++telemetry->job_count;
+    telemetry->jobs_rss_MiB += rss_MiB;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Measure free memory, memory available without swapping, and
+ *      swap in use on this host.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    telemetry_sample_memory(telemetry_t *telemetry)
+
+{
+#if defined(__FreeBSD__)
+    u_int           free_pages, inactive_pages;
+    size_t          len, miblen;
+    int             mib[16], n;
+    struct xswdev   xsw;
+    uint64_t        swap_used_pages = 0;
+    long            page_KiB = getpagesize() / 1024;
+
+    len = sizeof(free_pages);
+    if ( sysctlbyname("vm.stats.vm.v_free_count", &free_pages, &len,
+		      NULL, 0) == 0 )
+	telemetry->mem_free_MiB = free_pages * page_KiB / 1024;
+
+    // Inactive pages are reclaimed before swapping
+    len = sizeof(inactive_pages);
+    if ( sysctlbyname("vm.stats.vm.v_inactive_count", &inactive_pages, &len,
+		      NULL, 0) == 0 )
+	telemetry->mem_avail_MiB = telemetry->mem_free_MiB +
+				   inactive_pages * page_KiB / 1024;
+
+    // What swapinfo(8) does, one swap device at a time
+    miblen = sizeof(mib) / sizeof(*mib) - 1;
+    if ( sysctlnametomib("vm.swap_info", mib, &miblen) == 0 )
+    {
+	for (n = 0; ; ++n)
+	{
+	    mib[miblen] = n;
+	    len = sizeof(xsw);
+	    if ( sysctl(mib, miblen + 1, &xsw, &len, NULL, 0) != 0 )
+		break;
+	    swap_used_pages += xsw.xsw_used;
+	}
+	telemetry->swap_used_MiB = swap_used_pages * page_KiB / 1024;
+    }
+
+#elif defined(__linux__)
+    FILE            *fp;
+    char            line[128];
+    unsigned long   kib,
+		    swap_total_KiB = 0,
+		    swap_free_KiB = 0;
+
+    if ( (fp = fopen("/proc/meminfo", "r")) == NULL )
+	return;
+    while ( fgets(line, sizeof(line), fp) != NULL )
+    {
+	if ( sscanf(line, "MemFree: %lu", &kib) == 1 )
+	    telemetry->mem_free_MiB = kib / 1024;
+	else if ( sscanf(line, "MemAvailable: %lu", &kib) == 1 )
+	    telemetry->mem_avail_MiB = kib / 1024;
+	else if ( sscanf(line, "SwapTotal: %lu", &kib) == 1 )
+	    swap_total_KiB = kib;
+	else if ( sscanf(line, "SwapFree: %lu", &kib) == 1 )
+	    swap_free_KiB = kib;
+    }
+    fclose(fp);
+    telemetry->swap_used_MiB = (swap_total_KiB - swap_free_KiB) / 1024;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Measure resource use on this host for lpjs_compd.  The RSS and
+ *      CPU time of each job in inventory are totals for its chaperone
+ *      or script and their descendants, found in tree, which is
+ *      reloaded here.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Add CPU time
+ ***************************************************************************/
+
+void    telemetry_sample(telemetry_t *telemetry, inventory_t *inventory,
+			 proctree_t *tree)
+
+{
+    size_t              c;
+    inventory_entry_t   *entry;
+    pid_t               compd_pid = getpid();
+
+    telemetry->time = time(NULL);
+    if ( getloadavg(telemetry->load_avg, 3) != 3 )
+	telemetry->load_avg[0] = telemetry->load_avg[1] =
+	    telemetry->load_avg[2] = 0.0;
+    telemetry->mem_free_MiB = telemetry->mem_avail_MiB =
+	telemetry->swap_used_MiB = 0;
+    telemetry_sample_memory(telemetry);
+
+    telemetry->job_count = 0;
+    telemetry->jobs_rss_MiB = 0;
+    if ( proctree_load(tree) != LPJS_SUCCESS )
+	return;
+    for (c = 0; (c < inventory->count) && (c < LPJS_TELEMETRY_JOBS_MAX); ++c)
+    {
+	entry = &inventory->entries[c];
+
+	// A supervised job that has exited, awaiting its report
+	if ( entry->chaperone_pid == compd_pid )
+	    continue;
+	telemetry_add_job(telemetry, entry->job_id,
+			  proctree_rss_KiB(tree, entry->chaperone_pid) / 1024,
+			  proctree_cpu_sec(tree, entry->chaperone_pid));
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Text form of a report, as described in telemetry.h
+ *
+ *  Returns:
+ *      str, or NULL if buff_len is too small
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *telemetry_to_str(telemetry_t *telemetry, char *str, size_t buff_len)
+
+{
+    size_t  c, len;
+
+    len = snprintf(str, buff_len, "%.2f %.2f %.2f %zu %zu %zu\n",
+		   telemetry->load_avg[0], telemetry->load_avg[1],
+		   telemetry->load_avg[2], telemetry->mem_free_MiB,
+		   telemetry->mem_avail_MiB, telemetry->swap_used_MiB);
+    for (c = 0; (c < telemetry->job_count) && (len < buff_len); ++c)
+	len += snprintf(str + len, buff_len - len, "%lu %zu %lu\n",
+			telemetry->jobs[c].job_id, telemetry->jobs[c].rss_MiB,
+			telemetry->jobs[c].cpu_sec);
+
+    return len < buff_len ? str : NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Replace a report with one parsed from text produced by
+ *      telemetry_to_str().  The time is left as it was.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, or LPJS_READ_FAILED if str is malformed, in which
+ *      case the report is incomplete
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     telemetry_from_str(telemetry_t *telemetry, const char *str)
+
+{
+    unsigned long   job_id, cpu_sec;
+    size_t          rss_MiB;
+    int             chars;
+
+    telemetry->job_count = 0;
+    telemetry->jobs_rss_MiB = 0;
+    if ( sscanf(str, "%lf %lf %lf %zu %zu %zu\n%n", &telemetry->load_avg[0],
+		&telemetry->load_avg[1], &telemetry->load_avg[2],
+		&telemetry->mem_free_MiB, &telemetry->mem_avail_MiB,
+		&telemetry->swap_used_MiB, &chars) != 6 )
+	return LPJS_READ_FAILED;
+    str += chars;
+
+    while ( *str != '\0' )
+    {
+	if ( (telemetry->job_count == LPJS_TELEMETRY_JOBS_MAX) ||
+	     (sscanf(str, "%lu %zu %lu\n%n", &job_id, &rss_MiB, &cpu_sec,
+		     &chars) != 3) )
+	    return LPJS_READ_FAILED;
+	telemetry_add_job(telemetry, job_id, rss_MiB, cpu_sec);
+	str += chars;
+    }
+
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record a report received from a compute node by dispatchd.
+ *      Peaks of jobs in running_jobs are updated, and the memory they
+ *      requested but are not charged for is noted for memory-policy
+ *      oversubscribe.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Track job peaks
+ ***************************************************************************/
+
+void    lpjs_telemetry_update(node_t *node, const char *str,
+			      job_list_t *running_jobs)
+
+{
+    telemetry_t *telemetry;
+
+    if ( (telemetry = node_get_telemetry(node)) == NULL )
+    {
+	// Terminates process if malloc() fails, no check required
+	telemetry = telemetry_new();
+	node_set_telemetry(node, telemetry);
+    }
+    if ( telemetry_from_str(telemetry, str) != LPJS_SUCCESS )
+    {
+	lpjs_log("%s(): Error: Invalid telemetry from %s.\n", __FUNCTION__,
+		 node_get_hostname(node));
+	telemetry->time = 0;
+    }
+    else
+    {
+	telemetry->time = time(NULL);
+	lpjs_telemetry_charge_jobs(telemetry, running_jobs);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Update the peak RSS and CPU time of each job in a report, and
+ *      what it is charged for memory-policy oversubscribe: the lesser
+ *      of its request and its peak plus oversubscribe-margin.  Jobs not
+ *      yet measured are charged their request.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ *  2026-10-19  Jason Bacon Update CPU time
+ ***************************************************************************/
+
+void    lpjs_telemetry_charge_jobs(telemetry_t *telemetry,
+				   job_list_t *running_jobs)
+
+{
+    extern lpjs_config_t    Config;
+    telemetry_job_t         *report;
+    job_t                   *job;
+    size_t                  c, index, requested_MiB, charged_MiB;
+
+    telemetry->reclaim_MiB = 0;
+    for (c = 0; c < telemetry->job_count; ++c)
+    {
+	report = &telemetry->jobs[c];
+	report->reclaim_MiB = 0;
+	if ( (index = job_list_find_job_id(running_jobs, report->job_id))
+		== JOB_LIST_NOT_FOUND )
+	    continue;
+	job = job_list_get_jobs_ae(running_jobs, index);
+	if ( report->rss_MiB > job_get_peak_rss_MiB(job) )
+	    job_set_peak_rss_MiB(job, report->rss_MiB);
+	if ( report->cpu_sec > job_get_cpu_sec(job) )
+	    job_set_cpu_sec(job, report->cpu_sec);
+	if ( job_get_peak_rss_MiB(job) == 0 )
+	    continue;
+	
+	requested_MiB = job_get_pmem_per_proc(job) *
+			job_get_procs_per_job(job);
+	charged_MiB = job_get_peak_rss_MiB(job) *
+		      (100 + Config.oversubscribe_margin) / 100;
+	if ( charged_MiB < requested_MiB )
+	{
+	    report->reclaim_MiB = requested_MiB - charged_MiB;
+	    telemetry->reclaim_MiB += report->reclaim_MiB;
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stop counting a job's unused request as free on its node, when
+ *      its resources are released.  Called by dispatchd, so that
+ *      memory is not given away twice before the next report.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_telemetry_release(node_t *node, job_t *job)
+
+{
+    telemetry_t *telemetry = node_get_telemetry(node);
+    size_t      c;
+
+    if ( telemetry == NULL )
+	return;
+    for (c = 0; c < telemetry->job_count; ++c)
+    {
+	if ( telemetry->jobs[c].job_id == job_get_job_id(job) )
+	{
+	    telemetry->reclaim_MiB -= telemetry->jobs[c].reclaim_MiB;
+	    telemetry->jobs[c].reclaim_MiB = 0;
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Forget the unused requests of all jobs on a node, e.g. when the
+ *      node's resources are recounted at checkin.  The next report
+ *      restores them for jobs still running.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_telemetry_release_all(node_t *node)
+
+{
+    telemetry_t *telemetry = node_get_telemetry(node);
+    size_t      c;
+
+    if ( telemetry == NULL )
+	return;
+    for (c = 0; c < telemetry->job_count; ++c)
+	telemetry->jobs[c].reclaim_MiB = 0;
+    telemetry->reclaim_MiB = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Memory available on a node without swapping, as last reported,
+ *      for memory-policy measured.
+ *
+ *  Returns:
+ *      Available MiB, or SIZE_MAX if there is no recent report
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  lpjs_telemetry_avail_MiB(node_t *node)
+
+{
+    extern lpjs_config_t    Config;
+    telemetry_t             *telemetry = node_get_telemetry(node);
+
+    if ( (telemetry == NULL) || (telemetry->time == 0) ||
+	 (time(NULL) - telemetry->time >
+	  LPJS_TELEMETRY_STALE_BEATS * Config.telemetry_interval) )
+	return SIZE_MAX;
+    return telemetry->mem_avail_MiB;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Memory requested by jobs on a node beyond what they are charged,
+ *      as of the last report, for memory-policy oversubscribe.
+ *
+ *  Returns:
+ *      Reclaimable MiB, or 0 if there is no recent report
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  lpjs_telemetry_reclaim_MiB(node_t *node)
+
+{
+    telemetry_t *telemetry = node_get_telemetry(node);
+
+    if ( lpjs_telemetry_avail_MiB(node) == SIZE_MAX )
+	return 0;
+    return telemetry->reclaim_MiB;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Format a node's last report for lpjs nodes, or an empty string
+ *      if there is none.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    telemetry_status_to_str(node_t *node, char *str, size_t array_size)
+
+{
+    telemetry_t *telemetry = node_get_telemetry(node);
+
+    if ( (telemetry == NULL) || (telemetry->time == 0) )
+	*str = '\0';
+    else
+	snprintf(str, array_size, NODE_TELEMETRY_FORMAT,
+		 node_get_hostname(node),
+		 (long)(time(NULL) - telemetry->time),
+		 telemetry->load_avg[0], telemetry->load_avg[1],
+		 telemetry->load_avg[2], telemetry->mem_free_MiB,
+		 telemetry->mem_avail_MiB, telemetry->swap_used_MiB,
+		 telemetry->jobs_rss_MiB);
+}
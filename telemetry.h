@@ -0,0 +1,83 @@
+#ifndef _LPJS_TELEMETRY_H_
+#define _LPJS_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <time.h>
+#include <sys/types.h>  // size_t
+
+#ifndef _LPJS_NODE_H_
+#include "node.h"       // telemetry_t
+#endif
+
+#ifndef _LPJS_INVENTORY_H_
+#include "inventory.h"
+#endif
+
+#ifndef _LPJS_PROCTREE_H_
+#include "proctree.h"
+#endif
+
+#ifndef _LPJS_JOB_LIST_H_
+#include "job-list.h"
+#endif
+
+/*
+ *  Resource use on a compute node, measured by lpjs_compd every
+ *  telemetry-interval seconds and sent with the next heartbeat (see
+ *  network.h).  Text form, following the heartbeat code:
+ *
+ *      load-1 load-5 load-15 mem-free-MiB mem-avail-MiB swap-used-MiB
+ *      job-id rss-MiB cpu-sec
+ *      ...
+ *
+ *  mem-avail is memory that can be used without swapping, i.e. free
+ *  memory plus caches that can be dropped.  A job's RSS and CPU time
+ *  are totals for its chaperone or script and all descendants, for
+ *  lpjs jobs --usage (see job-usage.h).  Values that
+ *  cannot be measured on a platform are 0.  dispatchd keeps the last
+ *  report for each node, for lpjs nodes and for memory-policy
+ *  measured.  See telemetry.c.
+ *
+ *  For memory-policy oversubscribe, dispatchd also keeps the peak RSS
+ *  of each running job, and charges it min(request, peak + margin).
+ *  The difference, summed over the jobs on a node, can be given to new
+ *  jobs there as long as the node reports enough memory available.
+ */
+
+#define LPJS_TELEMETRY_INTERVAL     30  // Seconds, default
+#define LPJS_TELEMETRY_STALE_BEATS  3   // Intervals before ignored
+#define LPJS_TELEMETRY_JOBS_MAX     1024
+#define LPJS_OVERSUBSCRIBE_MARGIN   25  // % of peak, default
+#define LPJS_OVERSUBSCRIBE_RESERVE  10  // % of node memory, default
+
+#define NODE_TELEMETRY_HEADER_FORMAT \
+	"%-20s %5s %6s %6s %6s %8s %8s %8s %8s\n"
+#define NODE_TELEMETRY_FORMAT \
+	"%-20s %4lds %6.2f %6.2f %6.2f %8zu %8zu %8zu %8zu\n"
+
+typedef struct
+{
+    unsigned long   job_id;
+    size_t          rss_MiB;
+    unsigned long   cpu_sec;
+    size_t          reclaim_MiB;    // dispatchd, requested - charged
+}   telemetry_job_t;
+
+// telemetry_t is declared in node.h
+struct telemetry
+{
+    time_t          time;           // Measured (compd), received (dispatchd)
+    double          load_avg[3];    // 1, 5, 15 minutes
+    size_t          mem_free_MiB;
+    size_t          mem_avail_MiB;
+    size_t          swap_used_MiB;
+    size_t          jobs_rss_MiB;   // Sum over jobs
+    size_t          reclaim_MiB;    // Ditto
+    size_t          job_count;
+    size_t          job_array_size;
+    telemetry_job_t *jobs;
+};
+
+#include "telemetry-protos.h"
+
+#endif  // _LPJS_TELEMETRY_H_
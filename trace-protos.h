@@ -0,0 +1,8 @@
+/* trace.c */
+int lpjs_trace_capture_open(const char *path);
+void lpjs_trace_capture(trace_kind_t kind, const char *source, const char *payload, ssize_t bytes, uid_t uid, gid_t gid);
+int lpjs_trace_replay_open(const char *path);
+bool lpjs_trace_replaying(void);
+void lpjs_trace_replay_counts(unsigned long *replies, unsigned long *mismatches);
+int lpjs_trace_read(trace_record_t *record, char *source, char **payload);
+ssize_t lpjs_trace_replay_recv(char **payload, uid_t *uid, gid_t *gid);
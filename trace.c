@@ -0,0 +1,352 @@
+/***************************************************************************
+ *  Description:
+ *      Capture and replay of dispatchd input.
+ *
+ *      "lpjs_dispatchd --capture file" records every message decoded
+ *      by dispatchd with a monotonic timestamp, its source, and the
+ *      authenticated uid and gid.  "lpjs_dispatchd --replay file"
+ *      feeds a capture back through the same handlers, so a production
+ *      workload becomes a repeatable benchmark and regression test.
+ *
+ *      During replay, network.c does no I/O.  Sends and closes succeed
+ *      immediately, and messages that handlers wait for, such as the
+ *      chaperone fork verification from compd, are taken from the
+ *      trace by lpjs_trace_replay_recv().  dispatchd is single-threaded,
+ *      so those replies follow the request that caused them.
+ *
+ *      Only the dispatchd main thread uses this, so no locking.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>      // open()
+#include <stdbool.h>
+#include <time.h>       // clock_gettime()
+
+#include <xtend/string.h>   // strlcpy() on Linux
+
+#include "lpjs.h"
+#include "network.h"
+#include "journal.h"    // lpjs_crc32()
+#include "trace.h"
+#include "misc.h"
+
+static int              Capture_fd = -1;
+static struct timespec  Capture_start;
+static FILE             *Replay_stream = NULL;
+// Record read ahead by lpjs_trace_replay_recv() that was not a reply
+static bool             Replay_peeked = false;
+static trace_record_t   Peek_record;
+static char             Peek_source[LPJS_TRACE_SOURCE_MAX + 1],
+			*Peek_payload;
+static unsigned long    Replay_replies = 0,
+			Replay_mismatches = 0;
+
+/***************************************************************************
+ *  Description:
+ *      Start capturing dispatchd input to path, replacing any
+ *      previous capture
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_WRITE_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_trace_capture_open(const char *path)
+
+{
+    trace_header_t  header;
+
+    if ( (Capture_fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0600)) == -1 )
+    {
+	lpjs_log("%s(): Error: Cannot create %s: %s\n", __FUNCTION__,
+		 path, strerror(errno));
+	return LPJS_WRITE_FAILED;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LPJS_TRACE_MAGIC, LPJS_TRACE_MAGIC_LEN);
+    header.version = LPJS_TRACE_VERSION;
+    header.byte_order = LPJS_TRACE_BYTE_ORDER;
+    header.start_time = time(NULL);
+    if ( lpjs_write_all(Capture_fd, &header, sizeof(header)) != 0 )
+    {
+	lpjs_log("%s(): Error: Cannot write %s: %s\n", __FUNCTION__,
+		 path, strerror(errno));
+	close(Capture_fd);
+	Capture_fd = -1;
+	return LPJS_WRITE_FAILED;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &Capture_start);
+    lpjs_log("%s(): Capturing input to %s.\n", __FUNCTION__, path);
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append one received message to the capture, if capturing.
+ *      bytes is the lpjs_recv_munge() return value, so failures and
+ *      timeouts that change dispatchd state are recorded as well.
+ *      Capture stops after a write error, rather than logging every
+ *      message that follows.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_trace_capture(trace_kind_t kind, const char *source,
+			   const char *payload, ssize_t bytes,
+			   uid_t uid, gid_t gid)
+
+{
+    // Static: Too large for the stack with LPJS_PAYLOAD_MAX
+    static char     buff[sizeof(trace_record_t) + LPJS_TRACE_SOURCE_MAX +
+			 LPJS_MSG_LEN_MAX];
+    trace_record_t  record;
+    struct timespec now;
+    size_t          payload_len = bytes > 0 ? bytes : 0;
+    char            *p;
+
+    if ( Capture_fd == -1 )
+	return;
+
+    if ( source == NULL )
+	source = "";
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    memset(&record, 0, sizeof(record));
+    record.time_ns = (now.tv_sec - Capture_start.tv_sec) * 1000000000ULL +
+		     now.tv_nsec - Capture_start.tv_nsec;
+    record.bytes = bytes;
+    record.uid = uid;
+    record.gid = gid;
+    record.source_len = strnlen(source, LPJS_TRACE_SOURCE_MAX);
+    record.kind = kind;
+    if ( payload_len > LPJS_MSG_LEN_MAX )
+	payload_len = LPJS_MSG_LEN_MAX;
+
+    // One write() per record, so a crash can only tear the last one
+    p = buff + sizeof(record);
+    memcpy(p, source, record.source_len);
+    memcpy(p + record.source_len, payload, payload_len);
+    record.crc = lpjs_crc32(p, record.source_len + payload_len);
+    memcpy(buff, &record, sizeof(record));
+
+    if ( lpjs_write_all(Capture_fd, buff, sizeof(record) +
+			record.source_len + payload_len) != 0 )
+    {
+	lpjs_log("%s(): Error: Write failed, capture stopped: %s\n",
+		 __FUNCTION__, strerror(errno));
+	close(Capture_fd);
+	Capture_fd = -1;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open a capture for replay.  From here on, network.c does
+ *      no I/O.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS or LPJS_READ_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_trace_replay_open(const char *path)
+
+{
+    trace_header_t  header;
+
+    if ( (Replay_stream = fopen(path, "r")) == NULL )
+    {
+	lpjs_log("%s(): Error: Cannot open %s: %s\n", __FUNCTION__,
+		 path, strerror(errno));
+	return LPJS_READ_FAILED;
+    }
+    if ( (fread(&header, sizeof(header), 1, Replay_stream) != 1) ||
+	 (memcmp(header.magic, LPJS_TRACE_MAGIC, LPJS_TRACE_MAGIC_LEN) != 0) )
+    {
+	lpjs_log("%s(): Error: %s is not an lpjs capture.\n", __FUNCTION__,
+		 path);
+	fclose(Replay_stream);
+	Replay_stream = NULL;
+	return LPJS_READ_FAILED;
+    }
+    if ( (header.version != LPJS_TRACE_VERSION) ||
+	 (header.byte_order != LPJS_TRACE_BYTE_ORDER) )
+    {
+	lpjs_log("%s(): Error: %s is version %u from a %s host.  Expected version %u.\n",
+		 __FUNCTION__, path, header.version,
+		 header.byte_order == LPJS_TRACE_BYTE_ORDER ?
+		    "same endian" : "different endian",
+		 LPJS_TRACE_VERSION);
+	fclose(Replay_stream);
+	Replay_stream = NULL;
+	return LPJS_READ_FAILED;
+    }
+    return LPJS_SUCCESS;
+}
+
+
+bool    lpjs_trace_replaying(void)
+
+{
+    return Replay_stream != NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Report replies read by handlers so far, and attempts to read a
+ *      reply where the capture had none
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    lpjs_trace_replay_counts(unsigned long *replies,
+				 unsigned long *mismatches)
+
+{
+    *replies = Replay_replies;
+    *mismatches = Replay_mismatches;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read the next record of a capture opened by
+ *      lpjs_trace_replay_open().  source must hold
+ *      LPJS_TRACE_SOURCE_MAX + 1 bytes.  *payload is allocated and
+ *      NUL-terminated if record->bytes > 0, otherwise NULL.
+ *
+ *  Returns:
+ *      LPJS_SUCCESS, LPJS_TRACE_EOF, or LPJS_READ_FAILED if the
+ *      record is truncated or corrupt
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     lpjs_trace_read(trace_record_t *record, char *source, char **payload)
+
+{
+    size_t      payload_len;
+    uint32_t    crc;
+
+    if ( Replay_peeked )
+    {
+	*record = Peek_record;
+	strlcpy(source, Peek_source, LPJS_TRACE_SOURCE_MAX + 1);
+	*payload = Peek_payload;
+	Replay_peeked = false;
+	return LPJS_SUCCESS;
+    }
+
+    *payload = NULL;
+    if ( fread(record, sizeof(*record), 1, Replay_stream) != 1 )
+	return feof(Replay_stream) ? LPJS_TRACE_EOF : LPJS_READ_FAILED;
+
+    payload_len = record->bytes > 0 ? record->bytes : 0;
+    if ( (record->source_len > LPJS_TRACE_SOURCE_MAX) ||
+	 (payload_len > LPJS_MSG_LEN_MAX) ||
+	 (fread(source, 1, record->source_len, Replay_stream) !=
+	    record->source_len) )
+	return LPJS_READ_FAILED;
+    source[record->source_len] = '\0';
+
+    if ( (*payload = malloc(payload_len + 1)) == NULL )
+    {
+	lpjs_log("%s(): Error: malloc() failed.\n", __FUNCTION__);
+	exit(EX_UNAVAILABLE);
+    }
+    if ( fread(*payload, 1, payload_len, Replay_stream) != payload_len )
+    {
+	free(*payload);
+	*payload = NULL;
+	return LPJS_READ_FAILED;
+    }
+    (*payload)[payload_len] = '\0';
+
+    crc = lpjs_crc32_update(lpjs_crc32(source, record->source_len),
+			    *payload, payload_len);
+    if ( crc != record->crc )
+    {
+	free(*payload);
+	*payload = NULL;
+	return LPJS_READ_FAILED;
+    }
+    if ( record->bytes <= 0 )
+    {
+	free(*payload);
+	*payload = NULL;
+    }
+    return LPJS_SUCCESS;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stand-in for lpjs_recv_munge() during replay.  The next record
+ *      should be the reply a handler is waiting for.  If it is not,
+ *      dispatchd has diverged from the capture, e.g. dispatched a job
+ *      to a different node.  Leave the record for the main replay
+ *      loop and fail the receive, as a dropped connection would.
+ *
+ *  Returns:
+ *      The captured lpjs_recv_munge() return value, or
+ *      LPJS_RECV_FAILED
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+ssize_t lpjs_trace_replay_recv(char **payload, uid_t *uid, gid_t *gid)
+
+{
+    trace_record_t  record;
+    char            source[LPJS_TRACE_SOURCE_MAX + 1],
+		    *record_payload;
+
+    *payload = NULL;
+    if ( lpjs_trace_read(&record, source, &record_payload) != LPJS_SUCCESS )
+    {
+	++Replay_mismatches;
+	return LPJS_RECV_FAILED;
+    }
+    if ( record.kind != LPJS_TRACE_REPLY )
+    {
+	lpjs_log("%s(): Warning: Expected a reply, got record kind %u from %s.\n",
+		 __FUNCTION__, record.kind, source);
+	++Replay_mismatches;
+	Peek_record = record;
+	strlcpy(Peek_source, source, LPJS_TRACE_SOURCE_MAX + 1);
+	Peek_payload = record_payload;
+	Replay_peeked = true;
+	return LPJS_RECV_FAILED;
+    }
+    ++Replay_replies;
+    *payload = record_payload;
+    *uid = record.uid;
+    *gid = record.gid;
+    return record.bytes;
+}
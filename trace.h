@@ -0,0 +1,61 @@
+#ifndef _LPJS_TRACE_H_
+#define _LPJS_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>     // INT_MAX
+#include <sys/types.h>  // ssize_t, uid_t, gid_t
+
+/*
+ *  Capture of every decoded message received by dispatchd, for
+ *  replaying through the same handlers with "lpjs_dispatchd --replay".
+ *  Layout:
+ *
+ *      trace_header_t
+ *      { trace_record_t, char source[source_len], char payload[len] } ...
+ *
+ *  len is bytes if bytes > 0, else 0.  Fields are in host byte order,
+ *  like the snapshot.  A record with a bad CRC can only be a torn
+ *  write at the end of a capture, so replay stops there.
+ */
+
+#define LPJS_TRACE_MAGIC        "LPJSTRCE"
+#define LPJS_TRACE_MAGIC_LEN    8
+#define LPJS_TRACE_VERSION      1
+#define LPJS_TRACE_BYTE_ORDER   0x01020304
+#define LPJS_TRACE_SOURCE_MAX   128     // IP address or hostname
+#define LPJS_TRACE_EOF          -1
+
+// Stands in for sockets during replay, never a real descriptor
+#define LPJS_TRACE_REPLAY_FD    INT_MAX
+
+typedef enum
+{
+    LPJS_TRACE_REQUEST = 0, // New connection to the listening socket
+    LPJS_TRACE_REPLY,       // Response read by dispatchd in a handler
+    LPJS_TRACE_NODE         // Activity on a compute node socket
+}   trace_kind_t;
+
+typedef struct
+{
+    char        magic[LPJS_TRACE_MAGIC_LEN];
+    uint32_t    version;
+    uint32_t    byte_order;
+    int64_t     start_time;     // Wall clock, for reference only
+}   trace_header_t;
+
+typedef struct
+{
+    uint64_t    time_ns;        // Monotonic, since start of capture
+    int64_t     bytes;          // lpjs_recv_munge() return value
+    uint32_t    uid;
+    uint32_t    gid;
+    uint32_t    crc;            // Source and payload
+    uint16_t    source_len;
+    uint8_t     kind;           // trace_kind_t
+    uint8_t     reserved;
+}   trace_record_t;
+
+#include "trace-protos.h"
+
+#endif  // _LPJS_TRACE_H_